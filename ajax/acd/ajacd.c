@@ -45,6 +45,11 @@
 #include "ajfileio.h"
 #include "ajsys.h"
 
+#ifndef WIN32
+#include <sys/wait.h>
+#endif
+#include <errno.h>
+
 #include "ajassem.h"
 #include "ajassemread.h"
 #include "ajassemwrite.h"
@@ -127,6 +132,7 @@ static AjBool acdOptions = AJFALSE;
 static AjBool acdStdout = AJFALSE;
 static AjBool acdCodeSet = AJFALSE;
 static AjBool acdWrapper = AJFALSE;
+static AjPStr acdJobfile = NULL;
 static AjPTable acdCodeTable = NULL;
 static AjBool acdKnowntypeSet = AJFALSE;
 static AjPTable acdKnowntypeTypeTable = NULL;
@@ -822,6 +828,7 @@ static AjPTable acdGrpTable = NULL;
 static void      acdAmbigApp(AjPStr* pambiglist, const AjPStr str);
 static void      acdAmbigAppC(AjPStr* pambiglist, const char* txt);
 static void      acdArgsParse(ajint argc, char * const argv[]);
+static void      acdArgsReset(ajint prompttry);
 static void      acdArgsScan(ajint argc, char * const argv[]);
 static ajint     acdAttrCount(ajint itype);
 static ajint     acdAttrKeyCount(ajint ikey);
@@ -973,6 +980,7 @@ static AjBool    acdIsRequired(const AcdPAcd thys);
 static AjBool    acdIsRightB(AjPStr* pstr, AjPList listwords);
 static AjBool    acdIsStype(const AcdPAcd thys);
 static AjBool    acdIsVtype(const AcdPAcd thys);
+static char**    acdJobRun(const AjPStr jobfile);
 static const AjPStr acdKnowntypeDesc(const AcdPAcd thys);
 static void      acdKnowntypeInit(void);
 static void      acdListAttr(const AcdPAttr attr, const AjPPStr valstr,
@@ -4198,6 +4206,9 @@ void ajAcdInitPV(const char *pgm, ajint argc, char * const argv[],
     ajint *kc = NULL;
     ajuint *kp = NULL;
     size_t pos;
+    AjPStr jobfile = NULL;
+    char** jobargs = NULL;
+    ajint prompttry;
 
     acdProgram = ajStrNewC(pgm);
 
@@ -4222,6 +4233,7 @@ void ajAcdInitPV(const char *pgm, ajint argc, char * const argv[],
 
     /* pre-parse the command line for special options */
     
+    prompttry = acdPromptTry;
     acdArgsScan(argc, argv);
     
     ajDebug("ajAcdInitPV pgm '%s' package '%s'\n", pgm, package);
@@ -4377,8 +4389,18 @@ void ajAcdInitPV(const char *pgm, ajint argc, char * const argv[],
     *k = (ajuint) ajListGetLength(acdListWords);
     ajListPushAppend(acdListCount, k);
     
-    acdCodeInit();
-    acdKnowntypeInit();
+    /*
+    ** The codes and known types files are needed up front only for help,
+    ** documentation, validation and the ACD log. Otherwise they are read
+    ** on first use
+    */
+
+    if(acdDoHelp || acdDoValid || acdDoPretty || acdDoTable ||
+       acdDoXsd || acdDoGalaxy || acdDoLog)
+    {
+        acdCodeInit();
+        acdKnowntypeInit();
+    }
 
     /* Parse the input to set the initial definitions */
     
@@ -4423,6 +4445,33 @@ void ajAcdInitPV(const char *pgm, ajint argc, char * const argv[],
     
     acdListReport("Definitions in ACD file");
     
+    /*
+    ** with a job file, each job continues from here in a child process
+    ** with its own command line, scanned again from the initial settings
+    */
+
+    if(!acdDoHelp && acdJobfile)
+    {
+        if(argc != 3)
+        {
+            ajErr("-jobfile cannot be used with other arguments");
+            ajExitBad();
+        }
+
+        jobfile = acdJobfile;
+        acdJobfile = NULL;
+
+        jobargs = acdJobRun(jobfile);
+        ajStrDel(&jobfile);
+
+        for(argc=0; jobargs[argc]; argc++)
+            continue;
+
+        argv = jobargs;
+        acdArgsReset(prompttry);
+        acdArgsScan(argc, argv);
+    }
+
     /* parse the command line and update the values */
     
     acdArgsParse(argc, argv);
@@ -24862,6 +24911,187 @@ AjBool ajAcdSetControl(const char* optionName)
 
 
 
+/* @funcstatic acdJobRun ******************************************************
+**
+** Runs each command line in a job file named by the -jobfile qualifier
+** in a child process forked after the ACD file has been read, so all jobs
+** share the initialisation.
+**
+** Each job line starts with the application name. Blank lines and lines
+** starting with '#' are ignored.
+**
+** The parent process waits for each job in turn and exits when all jobs
+** are done, with a failure status if any job failed.
+**
+** @param [r] jobfile [const AjPStr] Job file name
+** @return [char**] Argument list for the job, returned in the child process
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static char** acdJobRun(const AjPStr jobfile)
+{
+#ifndef WIN32
+    AjPFile jobf    = NULL;
+    AjPList joblist = NULL;
+    AjPStr jobline  = NULL;
+    AjPStr jobname  = NULL;
+    char* jobpgm    = NULL;
+    char** jobargs  = NULL;
+    ajuint ijob = 0;
+    ajuint ibad = 0;
+    pid_t pid;
+    pid_t retval;
+    int status = 0;
+
+    jobf = ajFileNewInNameS(jobfile);
+
+    if(!jobf)
+    {
+        ajErr("Unable to open job file '%S'", jobfile);
+        ajExitBad();
+    }
+
+    /*
+    ** read all jobs before the first fork:
+    ** children share the file offset with the parent
+    */
+
+    joblist = ajListstrNew();
+
+    while(ajReadlineTrim(jobf, &jobline))
+    {
+        ajStrTrimWhite(&jobline);
+
+        if(!ajStrGetLen(jobline) || ajStrGetCharFirst(jobline) == '#')
+            continue;
+
+        ajListstrPushAppend(joblist, jobline);
+        jobline = NULL;
+    }
+
+    ajFileClose(&jobf);
+
+    while(ajListstrPop(joblist, &jobline))
+    {
+        ijob++;
+        ajSysArglistBuildS(jobline, &jobpgm, &jobargs);
+
+        ajStrAssignC(&jobname, jobpgm);
+        ajFilenameTrimPath(&jobname);
+
+        if(!ajStrMatchS(jobname, acdProgram))
+        {
+            ajErr("Job %u is for '%S' not '%S': %S",
+                  ijob, jobname, acdProgram, jobline);
+            ibad++;
+        }
+        else
+        {
+            fflush(stdout);
+            fflush(stderr);
+
+            pid = fork();
+
+            if(pid == -1)
+                ajFatal("System fork failed");
+
+            if(!pid)
+            {
+                ajDebug("acdJobRun job %u '%S'\n", ijob, jobline);
+                ajListstrFreeData(&joblist);
+                ajStrDel(&jobline);
+                ajStrDel(&jobname);
+                AJFREE(jobpgm);
+
+                return jobargs;
+            }
+
+            while((retval=waitpid(pid,&status,0))!=pid)
+            {
+                if(retval == -1)
+                    if(errno != EINTR)
+                        break;
+            }
+
+            if(!WIFEXITED(status) || WEXITSTATUS(status))
+            {
+                ajWarn("Job %u failed: %S", ijob, jobline);
+                ibad++;
+            }
+        }
+
+        ajSysArglistFree(&jobargs);
+        AJFREE(jobpgm);
+        ajStrDel(&jobline);
+    }
+
+    ajListstrFree(&joblist);
+    ajStrDel(&jobname);
+
+    ajDebug("acdJobRun %u jobs %u failed\n", ijob, ibad);
+
+    acdCommandLine = ajFalse;
+
+    if(ibad)
+    {
+        ajErr("%u of %u jobs failed", ibad, ijob);
+        ajExitBad();
+    }
+
+    ajExit();
+#else
+    ajErr("Job file '%S' not supported on this system", jobfile);
+    ajExitBad();
+#endif
+
+    return NULL;
+}
+
+
+
+
+/* @funcstatic acdArgsReset ***************************************************
+**
+** Restores the special qualifier settings to their values before
+** the command line was scanned, so a job from a job file starts as a new
+** process would.
+**
+** @param [r] prompttry [ajint] Number of prompts before the command line
+**                              was scanned
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void acdArgsReset(ajint prompttry)
+{
+    acdDebug = ajFalse;
+    acdDebugSet = ajFalse;
+    acdStdout = ajFalse;
+    acdFilter = ajFalse;
+    acdOptions = ajFalse;
+    acdVerbose = ajFalse;
+    acdDoVersion = ajFalse;
+    acdDoHelp = ajFalse;
+    acdAuto = ajFalse;
+    acdPromptTry = prompttry;
+
+    AjErrorLevel.warning = ajTrue;
+    AjErrorLevel.error = ajTrue;
+    AjErrorLevel.fatal = ajTrue;
+    AjErrorLevel.die = ajTrue;
+
+    ajStrDel(&acdJobfile);
+
+    return;
+}
+
+
+
+
 /* @funcstatic acdArgsScan ****************************************************
 **
 ** Steps through the command line and checks for special qualifiers.
@@ -24961,6 +25191,9 @@ static void acdArgsScan(ajint argc, char * const argv[])
 	if(!strcmp(cp, "nodie"))
 	    AjErrorLevel.die = ajFalse;
 
+	if(!strcmp(cp, "jobfile") && (i+1) < argc)
+	    ajStrAssignC(&acdJobfile, argv[++i]);
+
 	if(!strcmp(cp, "help"))
 	    acdLog("acdArgsScan -help argv[%d]\n", i);
     }
@@ -33962,6 +34195,8 @@ static void acdValidKnowntype(const AcdPAcd thys)
     if (!defType)
 	ajFmtPrintS(&defType, "%S output", acdProgram);
 
+    acdKnowntypeInit();
+
     acdKnownType = ajTableFetchS(acdKnowntypeTypeTable, typestr);
     if (!acdKnownType)
     {
@@ -34123,6 +34358,8 @@ static const AjPStr acdKnowntypeDesc(const AcdPAcd thys)
     if(!ajStrGetLen(knowntype))
         return NULL;
 
+    acdKnowntypeInit();
+
     knowndesc = ajTableFetchS(acdKnowntypeDescTable, knowntype);
 
     return knowndesc;
@@ -370,6 +370,8 @@ typedef struct SeqSCdQry
 **
 ** @attr idcache [AjPBtcache] ID cache
 ** @attr Caches [AjPList] Caches for each query field
+** @attr Cachetable [AjPTable] Caches for each field name, shared by
+**                            all queries on the same field
 ** @attr files [AjPStr*] database filenames
 ** @attr reffiles [AjPStr**] database reference filenames
 ** @attr Skip [AjBool*] files numbers to exclude
@@ -389,6 +391,7 @@ typedef struct SeqSEmbossQry
 {
     AjPBtcache idcache;
     AjPList Caches;
+    AjPTable Cachetable;
 
     AjPStr *files;
     AjPStr **reffiles;
@@ -534,6 +537,11 @@ static AjBool     seqEmbossGcgReadSeq(AjPSeqin seqin);
 
 static AjBool     seqEmbossOpenCache(AjPQuery qry, const char *ext,
                                      AjPBtcache *cache);
+static ajuint     seqEmbossQryBatch(AjPQuery qry,
+                                    AjPQueryField const *fields,
+                                    AjPBtcache const *caches,
+                                    ajuint ifield, ajuint nfields,
+                                    ajulong *Pfdhits);
 static AjBool     seqEmbossQryClose(AjPQuery qry);
 static AjBool     seqEmbossQryEntry(AjPQuery qry);
 static AjBool     seqEmbossQryNext(AjPQuery qry);
@@ -1568,6 +1576,7 @@ static AjBool seqEmbossQryOpen(AjPQuery qry)
     qryd->nentries = -1;
 
     qryd->Caches = ajListNew();
+    qryd->Cachetable = ajTablestrNew(16);
 
     if(!ajStrGetLen(qry->IndexDir))
     {
@@ -1585,8 +1594,18 @@ static AjBool seqEmbossQryOpen(AjPQuery qry)
         field = ajListIterGet(iter);
 
         ajStrFmtLower(&field->Wildquery);
-        if(!seqEmbossOpenCache(qry, MAJSTRGETPTR(field->Field), &cache))
-            return ajFalse;
+
+        /* identifier lists can query one field many times */
+
+        cache = ajTablestrFetchS(qryd->Cachetable, field->Field);
+
+        if(!cache)
+        {
+            if(!seqEmbossOpenCache(qry, MAJSTRGETPTR(field->Field), &cache))
+                return ajFalse;
+            ajTablePut(qryd->Cachetable, ajStrNewS(field->Field), cache);
+        }
+
         ajListPushAppend(qryd->Caches, cache);
         cache = NULL;
     }
@@ -1821,7 +1840,7 @@ static AjBool seqEmbossQryNext(AjPQuery qry)
 
     if(!qryd->libs)
     {
-        qryd->libs = ajFileNewInNameS(qryd->files[entry->dbno]);
+        qryd->libs = ajFileNewInBgzfS(qryd->files[entry->dbno]);
 
         if(!qryd->libs)
         {
@@ -1834,7 +1853,7 @@ static AjBool seqEmbossQryNext(AjPQuery qry)
     if(qryd->reffiles && !qryd->libr)
     {
         ajFileClose(&qryd->libr);
-        qryd->libr = ajFileNewInNameS(qryd->reffiles[0][entry->dbno]);
+        qryd->libr = ajFileNewInBgzfS(qryd->reffiles[0][entry->dbno]);
 
         if(!qryd->libr)
         {
@@ -1860,6 +1879,131 @@ static AjBool seqEmbossQryNext(AjPQuery qry)
 
 
 
+/* @funcstatic seqEmbossQryBatch **********************************************
+**
+** Fetches a run of identifier queries with one pass through each
+** identifier index.
+**
+** A run is a series of terms, each an OR query on an identifier field
+** optionally followed by the same ELSE queries on other identifier
+** fields, as in a list of identifiers.
+**
+** @param [u] qry [AjPQuery] Query data
+** @param [r] fields [AjPQueryField const*] Query fields
+** @param [r] caches [AjPBtcache const*] Caches for each query field
+** @param [r] ifield [ajuint] Current query field
+** @param [r] nfields [ajuint] Number of query fields
+** @param [w] Pfdhits [ajulong*] Number of hits in the run
+** @return [ajuint] Number of query fields in the run,
+**                  or zero if there is no run to fetch
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint seqEmbossQryBatch(AjPQuery qry,
+                                AjPQueryField const *fields,
+                                AjPBtcache const *caches,
+                                ajuint ifield, ajuint nfields,
+                                ajulong *Pfdhits)
+{
+    AjPList keys = NULL;
+    AjPList misses = NULL;
+    AjPList hits = NULL;
+    AjPTable newtable = NULL;
+    AjPBtHitref newhit = NULL;
+    AjPQueryField fd;
+
+    ajuint nchain = 1;
+    ajuint nterms = 0;
+    ajuint i;
+    ajuint j;
+    AjBool ok;
+
+    fd = fields[ifield];
+
+    if(fd->Link != AJQLINK_INIT && fd->Link != AJQLINK_OR)
+        return 0;
+
+    while(ifield + nchain < nfields &&
+          fields[ifield+nchain]->Link == AJQLINK_ELSE &&
+          ajStrMatchS(fields[ifield+nchain]->Wildquery, fd->Wildquery))
+        nchain++;
+
+    for(i=ifield; i + nchain <= nfields; i += nchain)
+    {
+        if(i > ifield && fields[i]->Link != AJQLINK_OR)
+            break;
+
+        ok = ajTrue;
+
+        for(j=0; j < nchain; j++)
+        {
+            if(caches[i+j] != caches[ifield+j] ||
+               ajBtreeCacheIsSecondary(caches[i+j]) ||
+               ajStrIsWild(fields[i+j]->Wildquery) ||
+               (j && (fields[i+j]->Link != AJQLINK_ELSE ||
+                      !ajStrMatchS(fields[i+j]->Wildquery,
+                                   fields[i]->Wildquery))))
+            {
+                ok = ajFalse;
+                break;
+            }
+        }
+
+        if(!ok)
+            break;
+
+        nterms++;
+    }
+
+    if(nterms < 2)
+        return 0;
+
+    ajDebug("seqEmbossQryBatch field '%S' terms: %u fields: %u\n",
+            fd->Field, nterms, nchain);
+
+    keys = ajListstrNew();
+
+    for(i=0; i < nterms; i++)
+        ajListstrPushAppend(keys,
+                            ajStrNewS(fields[ifield+i*nchain]->Wildquery));
+
+    /* terms not found are tried on the next field */
+
+    hits = ajListNew();
+
+    for(j=0; j < nchain && ajListGetLength(keys); j++)
+    {
+        misses = ajListstrNew();
+        ajBtreeIdentFetchlistHitref(caches[ifield+j], keys, hits, misses);
+        ajListstrFreeData(&keys);
+        keys = misses;
+    }
+
+    ajListstrFreeData(&keys);
+
+    *Pfdhits = ajListGetLength(hits);
+
+    newtable = ajTableNewFunctionLen(*Pfdhits,
+                                     &ajBtreeHitrefCmp,
+                                     &ajBtreeHitrefHash,
+                                     NULL, &ajBtreeHitrefDelVoid);
+    while(ajListPop(hits, (void**)&newhit))
+        ajTablePutClean(newtable, newhit, newhit,
+                        NULL, &ajBtreeHitrefDelVoid);
+
+    ajListFree(&hits);
+
+    ajTableMergeOr(qry->ResultsTable, newtable);
+    ajTableDel(&newtable);
+
+    return nterms * nchain;
+}
+
+
+
+
 /* @funcstatic seqEmbossQryClose **********************************************
 **
 ** Closes query data for a B+tree index
@@ -1875,7 +2019,7 @@ static AjBool seqEmbossQryNext(AjPQuery qry)
 static AjBool seqEmbossQryClose(AjPQuery qry)
 {
     SeqPEmbossQry qryd;
-    void* item;
+    void** caches = NULL;
     ajint i;
     ajuint iref;
 
@@ -1889,12 +2033,19 @@ static AjBool seqEmbossQryClose(AjPQuery qry)
 
     qryd = qry->QryData;
 
-    while(ajListGetLength(qryd->Caches))
+    ajListFree(&qryd->Caches);
+
+    if(qryd->Cachetable)
     {
-        ajListPop(qryd->Caches, &item);
-        ajBtreeCacheDel((AjPBtcache*) &item);
+        ajTableToarrayValues(qryd->Cachetable, &caches);
+
+        for(i=0; caches[i]; i++)
+            ajBtreeCacheDel((AjPBtcache*) &caches[i]);
+
+        AJFREE(caches);
+        ajTablestrFreeKey(&qryd->Cachetable);
     }
-    ajListFree(&qryd->Caches);
+
     ajBtreeCacheDel(&qryd->idcache);
 
     ajListFree(&qry->ResultsList);
@@ -2040,10 +2191,8 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
 {
     SeqPEmbossQry qryd;
 
-    const AjPList fdlist;
-    const AjPList cachelist;
-    AjIList iter;
-    AjIList icache;
+    AjPQueryField *fields = NULL;
+    AjPBtcache *caches = NULL;
     AjPBtcache cache;
     AjPQueryField fd;
 
@@ -2052,6 +2201,9 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
     AjPTable newtable = NULL;
 
     ajuint i;
+    ajuint ifield;
+    ajuint nfields;
+    ajuint nbatch;
     ajulong lasthits = 0UL;
     ajulong fdhits = 0UL;
 
@@ -2060,20 +2212,18 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
 
     qryd = qry->QryData;
 
-    cachelist = qryd->Caches;
-
     ajTableSetDestroy(qry->ResultsTable, NULL, &ajBtreeHitrefDelVoid);
     ajTableSettypeUser(qry->ResultsTable,
                        &ajBtreeHitrefCmp, &ajBtreeHitrefHash);
 
-    fdlist = ajQueryGetallFields(qry);
+    nfields = (ajuint) ajListToarray(ajQueryGetallFields(qry),
+                                     (void***) &fields);
+    ajListToarray(qryd->Caches, (void***) &caches);
 
-    iter = ajListIterNewread(fdlist);
-    icache = ajListIterNewread(cachelist);
-    while(!ajListIterDone(iter))
+    for(ifield=0; ifield < nfields; ifield++)
     {
-        fd = ajListIterGet(iter);
-        cache = ajListIterGet(icache);
+        fd = fields[ifield];
+        cache = caches[ifield];
 
         ajDebug("field '%S' query: '%S'\n", fd->Field, fd->Wildquery);
 
@@ -2082,6 +2232,16 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
             continue;
         }
 
+        nbatch = seqEmbossQryBatch(qry, fields, caches, ifield, nfields,
+                                   &fdhits);
+
+        if(nbatch)
+        {
+            ifield += nbatch - 1;
+            lasthits = fdhits;
+            continue;
+        }
+
         /* is this a primary or secondary key (check the cache)? */
 
         if(ajBtreeCacheIsSecondary(cache))
@@ -2176,8 +2336,8 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
         lasthits = fdhits;
     }
 
-    ajListIterDel(&iter);
-    ajListIterDel(&icache);
+    AJFREE(fields);
+    AJFREE(caches);
 
     if(ajStrGetLen(qry->Organisms))
         seqEmbossQryOrganisms(qry);
@@ -2190,6 +2350,10 @@ static AjBool seqEmbossQryQuery(AjPQuery qry)
 
     ajTableClear(qry->ResultsTable);
 
+    /* read the entries in file order */
+
+    ajListSort(qry->ResultsList, &ajBtreeHitrefCompPos);
+
     if(ajListGetLength(qry->ResultsList))
         return ajTrue;
 
@@ -2419,7 +2583,7 @@ static AjBool seqEmbossGcgAll(AjPSeqin seqin)
         }
 
 
-        qryd->libs = ajFileNewInNameS(qryd->files[i]);
+        qryd->libs = ajFileNewInBgzfS(qryd->files[i]);
 
         if(!qryd->libs)
         {
@@ -2430,7 +2594,7 @@ static AjBool seqEmbossGcgAll(AjPSeqin seqin)
 
 
         if(qryd->reffiles)
-            qryd->libr = ajFileNewInNameS(qryd->reffiles[0][i]);
+            qryd->libr = ajFileNewInBgzfS(qryd->reffiles[0][i]);
 
         if(!qryd->libr)
         {
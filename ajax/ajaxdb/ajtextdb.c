@@ -498,6 +498,8 @@ typedef struct TextSObdaQry
 **
 ** @attr idcache  [AjPBtcache] ID cache
 ** @attr Caches   [AjPList]    Caches for each query field
+** @attr Cachetable [AjPTable] Caches for each field name, shared by
+**                             all queries on the same field
 ** @attr files    [AjPStr*]    Database filenames
 ** @attr Skip     [AjBool*]    Files numbers to exclude
 ** @attr libt     [AjPFile]    Primary (database source) file
@@ -514,6 +516,7 @@ typedef struct TextSEmbossQry
 {
     AjPBtcache idcache;
     AjPList Caches;
+    AjPTable Cachetable;
 
     AjPStr *files;
     AjBool *Skip;
@@ -695,6 +698,11 @@ static AjBool      textEmbossAll(AjPTextin textin);
 static AjBool	   textEmbossOpenCache(AjPQuery qry, const char* ext,
 				     AjPBtcache *cache);
 static AjBool      textEmbossQryOpen(AjPQuery qry);
+static ajuint      textEmbossQryBatch(AjPQuery qry,
+                                      AjPQueryField const *fields,
+                                      AjPBtcache const *caches,
+                                      ajuint ifield, ajuint nfields,
+                                      ajulong *Pfdhits);
 static AjBool      textEmbossQryClose(AjPQuery qry);
 static AjBool      textEmbossQryEntry(AjPQuery qry);
 static AjBool      textEmbossQryNamespace(AjPQuery qry);
@@ -4191,6 +4199,7 @@ static AjBool textEmbossQryOpen(AjPQuery qry)
     qryd->nentries = -1;
     
     qryd->Caches = ajListNew();
+    qryd->Cachetable = ajTablestrNew(16);
 
     if(!ajStrGetLen(qry->IndexDir))
     {
@@ -4207,8 +4216,18 @@ static AjBool textEmbossQryOpen(AjPQuery qry)
     {
         field = ajListIterGet(iter);
         ajStrFmtLower(&field->Wildquery);
-        if(!textEmbossOpenCache(qry, MAJSTRGETPTR(field->Field), &cache))
-            return ajFalse;
+
+        /* identifier lists can query one field many times */
+
+        cache = ajTablestrFetchS(qryd->Cachetable, field->Field);
+
+        if(!cache)
+        {
+            if(!textEmbossOpenCache(qry, MAJSTRGETPTR(field->Field), &cache))
+                return ajFalse;
+            ajTablePut(qryd->Cachetable, ajStrNewS(field->Field), cache);
+        }
+
         ajListPushAppend(qryd->Caches, cache);
         cache = NULL;
     }
@@ -4585,7 +4604,7 @@ static AjBool textEmbossQryNext(AjPQuery qry)
 
     if(!qryd->libt)
     {
-	qryd->libt = ajFileNewInNameS(qryd->files[entry->dbno]);
+	qryd->libt = ajFileNewInBgzfS(qryd->files[entry->dbno]);
 
 	if(!qryd->libt)
 	{
@@ -4610,6 +4629,131 @@ static AjBool textEmbossQryNext(AjPQuery qry)
 
 
 
+/* @funcstatic textEmbossQryBatch *********************************************
+**
+** Fetches a run of identifier queries with one pass through each
+** identifier index.
+**
+** A run is a series of terms, each an OR query on an identifier field
+** optionally followed by the same ELSE queries on other identifier
+** fields, as in a list of identifiers.
+**
+** @param [u] qry [AjPQuery] Query data
+** @param [r] fields [AjPQueryField const*] Query fields
+** @param [r] caches [AjPBtcache const*] Caches for each query field
+** @param [r] ifield [ajuint] Current query field
+** @param [r] nfields [ajuint] Number of query fields
+** @param [w] Pfdhits [ajulong*] Number of hits in the run
+** @return [ajuint] Number of query fields in the run,
+**                  or zero if there is no run to fetch
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint textEmbossQryBatch(AjPQuery qry,
+                                 AjPQueryField const *fields,
+                                 AjPBtcache const *caches,
+                                 ajuint ifield, ajuint nfields,
+                                 ajulong *Pfdhits)
+{
+    AjPList keys = NULL;
+    AjPList misses = NULL;
+    AjPList hits = NULL;
+    AjPTable newtable = NULL;
+    AjPBtHit newhit = NULL;
+    AjPQueryField fd;
+
+    ajuint nchain = 1;
+    ajuint nterms = 0;
+    ajuint i;
+    ajuint j;
+    AjBool ok;
+
+    fd = fields[ifield];
+
+    if(fd->Link != AJQLINK_INIT && fd->Link != AJQLINK_OR)
+        return 0;
+
+    while(ifield + nchain < nfields &&
+          fields[ifield+nchain]->Link == AJQLINK_ELSE &&
+          ajStrMatchS(fields[ifield+nchain]->Wildquery, fd->Wildquery))
+        nchain++;
+
+    for(i=ifield; i + nchain <= nfields; i += nchain)
+    {
+        if(i > ifield && fields[i]->Link != AJQLINK_OR)
+            break;
+
+        ok = ajTrue;
+
+        for(j=0; j < nchain; j++)
+        {
+            if(caches[i+j] != caches[ifield+j] ||
+               ajBtreeCacheIsSecondary(caches[i+j]) ||
+               ajStrIsWild(fields[i+j]->Wildquery) ||
+               (j && (fields[i+j]->Link != AJQLINK_ELSE ||
+                      !ajStrMatchS(fields[i+j]->Wildquery,
+                                   fields[i]->Wildquery))))
+            {
+                ok = ajFalse;
+                break;
+            }
+        }
+
+        if(!ok)
+            break;
+
+        nterms++;
+    }
+
+    if(nterms < 2)
+        return 0;
+
+    ajDebug("textEmbossQryBatch field '%S' terms: %u fields: %u\n",
+            fd->Field, nterms, nchain);
+
+    keys = ajListstrNew();
+
+    for(i=0; i < nterms; i++)
+        ajListstrPushAppend(keys,
+                            ajStrNewS(fields[ifield+i*nchain]->Wildquery));
+
+    /* terms not found are tried on the next field */
+
+    hits = ajListNew();
+
+    for(j=0; j < nchain && ajListGetLength(keys); j++)
+    {
+        misses = ajListstrNew();
+        ajBtreeIdentFetchlistHit(caches[ifield+j], keys, hits, misses);
+        ajListstrFreeData(&keys);
+        keys = misses;
+    }
+
+    ajListstrFreeData(&keys);
+
+    *Pfdhits = ajListGetLength(hits);
+
+    newtable = ajTableNewFunctionLen(*Pfdhits,
+                                     &ajBtreeHitCmp,
+                                     &ajBtreeHitHash,
+                                     NULL, &ajBtreeHitDelVoid);
+    while(ajListPop(hits, (void**)&newhit))
+        ajTablePutClean(newtable, newhit, newhit,
+                        NULL, &ajBtreeHitDelVoid);
+
+    ajListFree(&hits);
+
+    ajTableMergeOr(qry->ResultsTable, newtable);
+    ajTableDel(&newtable);
+
+    return nterms * nchain;
+}
+
+
+
+
 /* @funcstatic textEmbossQryClose *********************************************
 **
 ** Closes query data for a B+tree index
@@ -4625,7 +4769,7 @@ static AjBool textEmbossQryNext(AjPQuery qry)
 static AjBool textEmbossQryClose(AjPQuery qry)
 {
     TextPEmbossQry qryd;
-    void* item;
+    void** caches = NULL;
     ajint i;
 
     if(!qry)
@@ -4637,12 +4781,19 @@ static AjBool textEmbossQryClose(AjPQuery qry)
     ajDebug("textEmbossQryClose clean up qryd\n");
 
     qryd = qry->QryData;
-    while(ajListGetLength(qryd->Caches))
+
+    ajListFree(&qryd->Caches);
+
+    if(qryd->Cachetable)
     {
-        ajListPop(qryd->Caches, &item);
-        ajBtreeCacheDel((AjPBtcache*) &item);
+        ajTableToarrayValues(qryd->Cachetable, &caches);
+
+        for(i=0; caches[i]; i++)
+            ajBtreeCacheDel((AjPBtcache*) &caches[i]);
+
+        AJFREE(caches);
+        ajTablestrFreeKey(&qryd->Cachetable);
     }
-    ajListFree(&qryd->Caches);
     ajBtreeCacheDel(&qryd->idcache);
 
     if(qryd->Skip)
@@ -4846,10 +4997,8 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
 {
     TextPEmbossQry qryd;
 
-    const AjPList fdlist;
-    const AjPList cachelist;
-    AjIList iter;
-    AjIList icache;
+    AjPQueryField *fields = NULL;
+    AjPBtcache *caches = NULL;
     AjPBtcache cache;
     AjPQueryField fd;
     AjPBtHit newhit;
@@ -4857,6 +5006,9 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
     AjPTable newtable = NULL;
 
     ajuint i;
+    ajuint ifield;
+    ajuint nfields;
+    ajuint nbatch;
     ajulong lasthits = 0UL;
     ajulong fdhits = 0UL;
 
@@ -4865,24 +5017,20 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
 
     qryd = qry->QryData;
 
-    cachelist = qryd->Caches;
-    
     ajTableSetDestroy(qry->ResultsTable, NULL, &ajBtreeHitDelVoid);
     ajTableSettypeUser(qry->ResultsTable, &ajBtreeHitCmp, &ajBtreeHitHash);
 
-    fdlist = ajQueryGetallFields(qry);
+    nfields = (ajuint) ajListToarray(ajQueryGetallFields(qry),
+                                     (void***) &fields);
+    ajListToarray(qryd->Caches, (void***) &caches);
 
-    ajDebug("textEmbossQryQuery wild: %B list:%Lu fields:%Lu\n",
-            qry->Wild, ajListGetLength(qry->ResultsList),
-            ajListGetLength(fdlist));
+    ajDebug("textEmbossQryQuery wild: %B list:%Lu fields:%u\n",
+            qry->Wild, ajListGetLength(qry->ResultsList), nfields);
 
-    iter = ajListIterNewread(fdlist);
-    icache = ajListIterNewread(cachelist);
-
-    while(!ajListIterDone(iter))
+    for(ifield=0; ifield < nfields; ifield++)
     {
-        fd = ajListIterGet(iter);
-        cache = ajListIterGet(icache);
+        fd = fields[ifield];
+        cache = caches[ifield];
 
         ajDebug("field '%S' query: '%S'\n", fd->Field, fd->Wildquery);
 
@@ -4891,6 +5039,16 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
             continue;
         }
 
+        nbatch = textEmbossQryBatch(qry, fields, caches, ifield, nfields,
+                                    &fdhits);
+
+        if(nbatch)
+        {
+            ifield += nbatch - 1;
+            lasthits = fdhits;
+            continue;
+        }
+
         /* is this a primary or secondary key (check the cache)? */
 
         if(ajBtreeCacheIsSecondary(cache))
@@ -4986,8 +5144,8 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
         lasthits = fdhits;
     }
 
-    ajListIterDel(&iter);
-    ajListIterDel(&icache);
+    AJFREE(fields);
+    AJFREE(caches);
 
     if(ajStrGetLen(qry->Organisms))
         textEmbossQryOrganisms(qry);
@@ -5003,6 +5161,10 @@ static AjBool textEmbossQryQuery(AjPQuery qry)
 
     ajTableClear(qry->ResultsTable);
 
+    /* read the entries in file order */
+
+    ajListSort(qry->ResultsList, &ajBtreeHitCompPos);
+
     if(ajListGetLength(qry->ResultsList))
         return ajTrue;
 
@@ -1128,6 +1128,8 @@ static AjPSeqBamHeader asseminReadBamHeader(AjPAssemin assemin, AjPAssem assem)
     ajint tid;
     ajint filestat = 0;
     ajint tid_new = 0;
+    ajint beg;
+    ajint end;
     AjPTextin input;
     AjIList iterfield  = NULL;
     AjPQuery qry = NULL;
@@ -1220,11 +1222,16 @@ static AjPSeqBamHeader asseminReadBamHeader(AjPAssemin assemin, AjPAssem assem)
 	    assem->Count = tid_new;
 	    tid_new++;
 
-	    ajBamFetch(gzfile, idx, tid,
-		    assemin->cbegin,
-		    assemin->cend,
-		    assem,
-		    asseminAppendAlignmentRecs);
+	    /* 1-based -cbegin/-cend to a 0-based half-open region,
+	    ** defaulting to the whole reference sequence */
+
+	    beg = assemin->cbegin > 0 ? assemin->cbegin - 1 : 0;
+	    end = assemin->cend > 0 ? assemin->cend :
+		(ajint) header->target_len[tid];
+
+	    if(end > beg)
+		ajBamFetch(gzfile, idx, tid, beg, end,
+			   assem, asseminAppendAlignmentRecs);
 	}
 
 	AJNEW0(contig);
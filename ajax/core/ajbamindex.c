@@ -109,15 +109,9 @@ struct __bam_iter_t
     pair64_t *off;
 };
 
-typedef struct __bam_iter_t *bam_iter_t;
-
 
 static void bamBinDel(void** bin);
 static void bamIndexSave(const AjPBamIndex idx, FILE *fp);
-static void bamIterDel(bam_iter_t* iter);
-static bam_iter_t bamIterQuery(const AjPBamIndex idx, int tid,
-			       int beg, int end);
-static int bamIterRead(AjPSeqBamBgzf fp, bam_iter_t iter, AjPSeqBam);
 static AjPBamIndex bamIndexCore(AjPSeqBamBgzf fp);
 
 
@@ -1046,22 +1040,25 @@ static ajint bamChunkCompare(const void* a, const void* b)
 
 
 
-/* @funcstatic bamIterQuery ***************************************************
+/* @func ajBamIterQuery *****************************************************
+**
+** Query a region on a reference sequence
 **
-** query a region on a reference sequence
+** Only the chunks of the BAM file listed in the index bins overlapping
+** the region are visited by ajBamIterRead.
 **
 ** @param [r] idx [const AjPBamIndex] BAM index
 ** @param [r] tid [int] reference sequence id
-** @param [r] beg [int] 1-based start of target region, inclusive
-** @param [r] end [int] 1-based end of target region, inclusive
+** @param [r] beg [int] 0-based start of target region, inclusive
+** @param [r] end [int] 0-based end of target region, exclusive
 ** @return [bam_iter_t] iteration object
 **
-** @release 6.5.0
+** @release 6.6.0
 ** @@
 ******************************************************************************/
 
-static bam_iter_t bamIterQuery(const AjPBamIndex idx, int tid,
-			       int beg, int end)
+bam_iter_t ajBamIterQuery(const AjPBamIndex idx, int tid,
+                          int beg, int end)
 {
     pair64_t *off=NULL;
     AjPTable bindex = NULL;
@@ -1217,18 +1214,18 @@ static bam_iter_t bamIterQuery(const AjPBamIndex idx, int tid,
 
 
 
-/* @funcstatic bamIterDel *****************************************************
+/* @func ajBamIterDel *******************************************************
 **
 ** Deletes a BAM iteration object
 **
 ** @param [d] iterp [bam_iter_t*] pointer to iteration object to be deleted
 ** @return [void]
 **
-** @release 6.5.0
+** @release 6.6.0
 ** @@
 ******************************************************************************/
 
-static void bamIterDel(bam_iter_t* iterp)
+void ajBamIterDel(bam_iter_t* iterp)
 {
     bam_iter_t iter;
 
@@ -1246,20 +1243,22 @@ static void bamIterDel(bam_iter_t* iterp)
 
 
 
-/* @funcstatic bamIterRead ****************************************************
+/* @func ajBamIterRead ******************************************************
 **
-** ajBamFetch helper function retrieves data into alignment record b
+** Retrieves the next alignment record overlapping the query region
+** of a BAM iteration object
 **
 ** @param [u] fp [AjPSeqBamBgzf] BAM file
 ** @param [u] iter [bam_iter_t] BAM iteration object
 ** @param [u] b [AjPSeqBam] BAM record
-** @return [int] positive integer (1 or more) if a record successfully read
+** @return [int] positive integer (1 or more) if a record successfully read,
+**               -1 at the end of the region, less than -1 on error
 **
-** @release 6.5.0
+** @release 6.6.0
 ** @@
 ******************************************************************************/
 
-static int bamIterRead(AjPSeqBamBgzf fp, bam_iter_t iter, AjPSeqBam b)
+int ajBamIterRead(AjPSeqBamBgzf fp, bam_iter_t iter, AjPSeqBam b)
 {
     int ret;
 
@@ -1354,12 +1353,12 @@ int ajBamFetch(AjPSeqBamBgzf fp, const AjPBamIndex idx, int tid,
     AjPSeqBam b;
 
     AJNEW0(b);
-    iter = bamIterQuery(idx, tid, beg, end);
+    iter = ajBamIterQuery(idx, tid, beg, end);
 
-    while ((ret = bamIterRead(fp, iter, b)) >= 0)
+    while ((ret = ajBamIterRead(fp, iter, b)) >= 0)
 	func(b, data);
 
-    bamIterDel(&iter);
+    ajBamIterDel(&iter);
     ajSeqBamDel(&b);
 
     return (ret == -1)? 0 : ret;
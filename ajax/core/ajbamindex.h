@@ -165,9 +165,27 @@ typedef int (*bam_fetch_f)(AjPSeqBam b, void *data);
 
 
 
+
+/* @datatype bam_iter_t *******************************************************
+**
+** Iterator over the alignments overlapping a region of one reference
+** sequence, visiting only the BAM file chunks listed in the index
+**
+** @attr typedef [struct __bam_iter_t*] Value returned
+**
+******************************************************************************/
+typedef struct __bam_iter_t *bam_iter_t;
+
+
+
 int ajBamFetch(AjPSeqBamBgzf fp, const AjPBamIndex idx, int tid,
 	       int beg, int end, void *data, bam_fetch_f func);
 
+void ajBamIterDel(bam_iter_t* iterp);
+bam_iter_t ajBamIterQuery(const AjPBamIndex idx, int tid,
+                          int beg, int end);
+int ajBamIterRead(AjPSeqBamBgzf fp, bam_iter_t iter, AjPSeqBam b);
+
 int ajBamIndexBuild(const char *fn);
 void ajBamIndexDel(AjPBamIndex* idx);
 AjPBamIndex ajBamIndexLoad(const char *fn);
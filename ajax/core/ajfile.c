@@ -41,6 +41,7 @@
 #include "ajmath.h"
 #include "ajarr.h"
 #include "ajfileio.h"
+#include "ajseqbam.h"
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -118,6 +119,8 @@
 /* ========================================================================= */
 
 static ajuint fileBuffSize   = 2049;
+static ajuint fileBgzfBlocksize = 65536;
+static ajuint fileReadBlocksize = 1048576;
 static AjBool fileUsedStdin  = AJFALSE;
 static AjBool fileUsedStdout = AJFALSE;
 static AjBool fileUsedStderr = AJFALSE;
@@ -152,6 +155,8 @@ static AjPRegexp fileFilenameExp = NULL;
 /* =========================== private functions =========================== */
 /* ========================================================================= */
 
+static AjBool fileBgzfOpen(AjPFile file);
+static ajint  fileBgzfSeek(AjPFile file, ajlong offset, ajint wherefrom);
 static void   fileBuffLineDel(AjPFilebuff thys);
 static AjBool fileBuffLineNext(AjPFilebuff thys);
 static void   fileClose(AjPFile thys);
@@ -897,6 +902,7 @@ AjBool ajDiroutOpen(AjPDirout thys)
 ** @nam4rule Out Output file created or rewritten
 ** @nam4rule Outappend Output file appended to existing content
 ** @nam5rule Block File opened for block read with internal system functions
+** @nam5rule Bgzf File opened for block read of BGZF compressed data
 ** @nam5rule FromCfile C FILE* structure used to create file object
 ** @nam5rule Pipe Read from piped output of command
 ** @nam5rule ListinList List of files specified
@@ -1082,6 +1088,77 @@ AjPFile ajFileNewInBlockS(const AjPStr name, ajuint blocksize)
 
 
 
+/* @func ajFileNewInBgzfS *****************************************************
+**
+** Creates a new file object to read a named file which may be BGZF
+** block-compressed, as written by bgzip.
+**
+** Compressed files are read one block at a time and all file positions
+** are BGZF virtual offsets, so they can be saved in an index and passed
+** back to ajFileSeek. Other files are read as for ajFileNewInNameS.
+**
+** @param [r] name [const AjPStr] File name.
+** @return [AjPFile] New file object.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjPFile ajFileNewInBgzfS(const AjPStr name)
+{
+    AjPFile ret;
+
+    ret = ajFileNewInNameS(name);
+
+    if(!ret)
+        return NULL;
+
+    if(fileBgzfOpen(ret))
+        ajDebug("ajFileNewInBgzfS '%S' BGZF compressed\n", name);
+
+    return ret;
+}
+
+
+
+
+/* @funcstatic fileBgzfOpen ***************************************************
+**
+** Tests whether an open input file is BGZF compressed, and if so sets it
+** to read through a BGZF reader one block at a time.
+**
+** @param [u] file [AjPFile] Input file
+** @return [AjBool] True if the file is BGZF compressed
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool fileBgzfOpen(AjPFile file)
+{
+    if(!ajSeqBamBgzfTestFile(file->fp))
+        return ajFalse;
+
+    file->Bgzf = ajSeqBamBgzfNew(file->fp, "r");
+
+    if(!file->Bgzf)
+        return ajFalse;
+
+    AJFREE(file->Workbuffer);
+    AJFREE(file->Readblock);
+
+    file->Blocksize = fileBgzfBlocksize;
+    file->Readblock = ajCharNewRes(file->Blocksize+1);
+    file->Blockpos  = 0;
+    file->Blocklen  = 0;
+    file->Filepos   = 0;
+
+    return ajTrue;
+}
+
+
+
+
 /* @func ajFileNewInNameC *****************************************************
 **
 ** Creates a new file object to read a named file.
@@ -2133,6 +2210,12 @@ static void fileClose(AjPFile thys)
     AJFREE(thys->Workbuffer);
     AJFREE(thys->Readblock);
 
+    if(thys->Bgzf)
+    {
+        ajSeqBamBgzfClose(thys->Bgzf);
+        thys->Bgzf = NULL;
+    }
+
     return;
 }
 
@@ -2181,6 +2264,25 @@ AjBool ajFileReopenName(AjPFile file, const AjPStr name)
     if(!freopen(MAJSTRGETPTR(file->Name), "rb", file->fp))
         return ajFalse;
 
+    if(file->Bgzf)
+    {
+        ajSeqBamBgzfClose(file->Bgzf);
+        file->Bgzf = NULL;
+        file->Blockpos = 0;
+        file->Blocklen = 0;
+        fileBgzfOpen(file);
+    }
+    else if(file->Readblock)
+    {
+        /* the next file may be binary: it is read in blocks on request */
+        AJFREE(file->Readblock);
+        file->Blockpos = 0;
+        file->Blocklen = 0;
+        file->Blocksize = 0;
+    }
+
+    file->Viewlen = 0;
+
     return ajTrue;
 }
 
@@ -2259,14 +2361,17 @@ AjBool ajFileReopenNext(AjPFile file)
 **                    'ftell' function
 ** @nam4rule SetEof Set the end of file value for a file that has been read
 **                  without going past the last record.
+** @nam4rule SetBlocksize Set file to be read in large blocks
 ** @nam4rule SetUnbuffer Set file unbuffered
 **
 ** @argrule * file [AjPFile] File object
 ** @argrule Seek offset [ajlong] File offset to pass to system seek call
 ** @argrule Seek wherefrom [ajint] File wherefrom value to pass to
 **                                 system seek call
+** @argrule SetBlocksize blocksize [ajuint] Block size, zero for the default
 **
 ** @valrule Seek [ajint] Return value from seek
+** @valrule SetBlocksize [AjBool] True if the file is read in blocks
 ** @valrule SetUnbuffer [void]
 ** @valrule Fix [AjBool] End of file reached
 ** @valrule Eof [AjBool] End of file reached
@@ -2315,7 +2420,9 @@ AjBool ajFileFix(AjPFile file)
 
 AjBool ajFileResetEof(AjPFile file)
 {
-    if(feof(file->fp))
+    if(file->Readblock && file->Blockpos < file->Blocklen)
+        file->End = ajFalse;
+    else if(feof(file->fp))
         file->End = ajTrue;
     else
         file->End = ajFalse;
@@ -2330,6 +2437,10 @@ AjBool ajFileResetEof(AjPFile file)
 **
 ** Resets and returns the current position in an open file.
 **
+** For BGZF compressed files the position is the virtual offset of the
+** next line to be read. Files read in blocks also return the position
+** of the next line, as the system position is at the end of the block.
+**
 ** @param [u] file [AjPFile] File.
 ** @return [ajlong] Result of 'ftell'
 **
@@ -2342,6 +2453,9 @@ ajlong ajFileResetPos(AjPFile file)
     if(!file->fp)
         return 0;
 
+    if(file->Readblock)
+        return file->Filepos;
+
     file->Filepos = ftell(file->fp);
 
     return file->Filepos;
@@ -2357,6 +2471,10 @@ ajlong ajFileResetPos(AjPFile file)
 ** Resets the end-of-file flag End for cases where end-of-file was
 ** reached and then we seek back somewhere in the file.
 **
+** For BGZF compressed files the offset is a virtual offset from
+** ajFileResetPos, or a number of bytes of uncompressed data to skip
+** forward with SEEK_CUR.
+**
 ** @param [u] file [AjPFile] File.
 ** @param [r] offset [ajlong] Offset
 ** @param [r] wherefrom [ajint] Start of offset, as defined for 'fseek'.
@@ -2370,7 +2488,26 @@ ajint ajFileSeek(AjPFile file, ajlong offset, ajint wherefrom)
 {
     ajint ret;
 
+    if(file->Bgzf)
+        return fileBgzfSeek(file, offset, wherefrom);
+
     clearerr(file->fp);
+
+    if(file->Readblock)
+    {
+        /* SEEK_CUR is from the next line, not the end of the block */
+
+        if(wherefrom == SEEK_CUR)
+        {
+            offset += file->Filepos;
+            wherefrom = SEEK_SET;
+        }
+
+        file->Blockpos = 0;
+        file->Blocklen = 0;
+        file->Viewlen  = 0;
+    }
+
     ret = fseek(file->fp, offset, wherefrom);
 
     if(feof(file->fp))
@@ -2387,6 +2524,106 @@ ajint ajFileSeek(AjPFile file, ajlong offset, ajint wherefrom)
 
 
 
+/* @funcstatic fileBgzfSeek ***************************************************
+**
+** Sets the current position in an open BGZF compressed file.
+**
+** @param [u] file [AjPFile] File.
+** @param [r] offset [ajlong] Virtual offset, or bytes to skip for SEEK_CUR
+** @param [r] wherefrom [ajint] Start of offset, SEEK_SET or SEEK_CUR
+** @return [ajint] Zero on success, -1 on failure
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajint fileBgzfSeek(AjPFile file, ajlong offset, ajint wherefrom)
+{
+    ajlong blockstart;
+    ajint iread;
+    ajuint iskip;
+
+    clearerr(file->fp);
+    file->End = ajFalse;
+
+    if(wherefrom == SEEK_SET)
+    {
+        /* reuse the current block if the offset is in the unread part */
+
+        if(file->Blockpos < file->Blocklen)
+        {
+            blockstart = file->Filepos - file->Blockpos;
+
+            if((offset >> 16) == (blockstart >> 16) &&
+               offset >= blockstart &&
+               offset - blockstart < (ajlong) file->Blocklen)
+            {
+                file->Blockpos = (ajuint) (offset - blockstart);
+                file->Filepos = offset;
+
+                return 0;
+            }
+        }
+
+        file->Blockpos = 0;
+        file->Blocklen = 0;
+        file->Filepos = offset;
+
+        return (ajint) ajSeqBamBgzfSeek(file->Bgzf, offset, SEEK_SET);
+    }
+
+    if(wherefrom != SEEK_CUR || offset < 0)
+    {
+        ajErr("Unable to seek backwards or from end in compressed file '%F'",
+              file);
+        return -1;
+    }
+
+    blockstart = file->Filepos - file->Blockpos;
+
+    while(offset > 0)
+    {
+        if(file->Blockpos >= file->Blocklen)
+        {
+            blockstart = ajSeqBamBgzfTell(file->Bgzf);
+            iread = ajSeqBamBgzfReadBlock(file->Bgzf, file->Readblock,
+                                          file->Blocksize);
+
+            if(iread <= 0)
+            {
+                file->Blockpos = 0;
+                file->Blocklen = 0;
+                file->Filepos = ajSeqBamBgzfTell(file->Bgzf);
+                file->End = ajTrue;
+
+                return -1;
+            }
+
+            file->Blockpos = 0;
+            file->Blocklen = iread;
+            file->Readblock[iread] = '\0';
+        }
+
+        iskip = file->Blocklen - file->Blockpos;
+
+        if((ajlong) iskip > offset)
+            iskip = (ajuint) offset;
+
+        file->Blockpos += iskip;
+        offset -= iskip;
+    }
+
+    if(file->Blockpos < file->Blocklen)
+        file->Filepos = blockstart + file->Blockpos;
+    else
+        file->Filepos = ajSeqBamBgzfTell(file->Bgzf);
+
+    return 0;
+}
+
+
+
+
 /* @func ajFileSetEof *********************************************************
 **
 ** Ensures a binary file has reached the end of file and sets the
@@ -2418,6 +2655,48 @@ AjBool ajFileSetEof(AjPFile file)
 
 
 
+/* @func ajFileSetBlocksize ***************************************************
+**
+** Sets an input file to be read in large blocks with fread. Lines can then
+** be returned by ajReadlineView as views into the block without copying.
+**
+** Files already read in blocks, including BGZF compressed files, are
+** unchanged.
+**
+** @param [u] file [AjPFile] File object.
+** @param [r] blocksize [ajuint] Block size, zero for the default
+** @return [AjBool] True if the file is read in blocks
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool ajFileSetBlocksize(AjPFile file, ajuint blocksize)
+{
+    if(!file || !file->fp || file->App)
+        return ajFalse;
+
+    if(file->Readblock)
+        return ajTrue;
+
+    if(!blocksize)
+        blocksize = fileReadBlocksize;
+
+    file->Readblock = ajCharNewRes(blocksize+1);
+    file->Blocksize = blocksize;
+    file->Blockpos  = 0;
+    file->Blocklen  = 0;
+    file->Viewlen   = 0;
+
+    ajDebug("ajFileSetBlocksize '%S' blocksize:%u\n",
+            file->Name, blocksize);
+
+    return ajTrue;
+}
+
+
+
+
 /* @func ajFileSetUnbuffer ****************************************************
 **
 ** Turns off system buffering of an output file, for example to allow
@@ -3766,7 +4045,13 @@ void ajFilebuffClear(AjPFilebuff buff, ajint lines)
 
         buff->Lines = AJNEW0(buff->Last);
 
-        ajStrAssignS(&buff->Last->Line, buff->File->Buff);
+        if(buff->File->Viewlen)
+            ajStrAssignLenC(&buff->Last->Line,
+                            &buff->File->Readblock[buff->File->Blockpos -
+                                                   buff->File->Viewlen],
+                            buff->File->Viewlen);
+        else
+            ajStrAssignS(&buff->Last->Line, buff->File->Buff);
         buff->Curr = buff->Last;
         buff->Curr->Fpos = buff->Fpos;
         buff->Last->Next = NULL;
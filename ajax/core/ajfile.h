@@ -151,11 +151,15 @@ typedef enum AjOOutfileType
 ** @attr Buff [AjPStr] Buffer for latest line read
 ** @attr Workbuffer [char*] Block as a buffer for fgets etc
 ** @attr Readblock [char*] Block as a buffer for fread
-** @attr Filepos [ajlong] File offset for start of latest read
+** @attr Bgzf [struct AjSSeqBamBgzf*] BGZF reader for block-compressed files
+** @attr Filepos [ajlong] File offset for start of latest read,
+**                       a virtual offset for BGZF files
 ** @attr Blocksize [ajuint] Read block maximum size
 ** @attr Blockpos [ajuint] Read block position
 ** @attr Blocklen [ajuint] Read block length used
 ** @attr Buffsize [ajuint] Buffer size (zero for default size)
+** @attr Viewlen [ajuint] Length of the latest line if it was read as a view
+**                       ending at Blockpos in Readblock, zero if it is in Buff
 ** @attr Handle [ajint] AJAX file number 0 if unused
 ** @attr Pid [pid_t] Process PID if any (non-WIN32 only)
 ** @attr Process [HANDLE] Process handle (WIN32 only)
@@ -174,11 +178,13 @@ typedef struct AjSFile
     AjPStr Buff;
     char *Workbuffer;
     char *Readblock;
+    struct AjSSeqBamBgzf* Bgzf;
     ajlong Filepos;
     ajuint Blocksize;
     ajuint Blockpos;
     ajuint Blocklen;
     ajuint Buffsize;
+    ajuint Viewlen;
     ajint Handle;
     pid_t Pid;
     HANDLE Process;
@@ -495,6 +501,7 @@ AjPFile        ajFileNewFromCfile(FILE* file);
 AjPFile        ajFileNewInNameC(const char *name);
 AjPFile        ajFileNewInNameS(const AjPStr name);
 AjPFile        ajFileNewInBlockS(const AjPStr name, ajuint blocksize);
+AjPFile        ajFileNewInBgzfS(const AjPStr name);
 AjPFile        ajFileNewInPipe(const AjPStr name);
 AjPFile        ajFileNewInNamePathC(const char* name, const AjPStr path);
 AjPFile        ajFileNewInNamePathS(const AjPStr name, const AjPStr path);
@@ -540,6 +547,7 @@ AjBool         ajFilenameTestIncludePath(const AjPStr filename,
                                          const AjPStr exclude,
                                          const AjPStr include);
 void           ajFileTrace(const AjPFile thys);
+AjBool         ajFileSetBlocksize(AjPFile thys, ajuint blocksize);
 void           ajFileSetUnbuffer(AjPFile thys);
 
 ajuint         ajFileValueBuffsize(void);
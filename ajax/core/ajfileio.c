@@ -31,6 +31,7 @@
 #include "ajfileio.h"
 #include "ajutil.h"
 #include "ajfile.h"
+#include "ajseqbam.h"
 
 #include <string.h>
 #include <errno.h>
@@ -71,10 +72,13 @@ static void   filebuffLineAdd(AjPFilebuff thys, const AjPStr line);
 ** @nam2rule Readline
 ** @nam3rule Trim     Remove trailing newline and linefeed characters
 ** @nam3rule Append   Append to existing buffer
+** @nam3rule View     Return the line in place in a block read buffer
 ** @suffix   Pos      Return file position after read
 **
 ** @argrule * file [AjPFile] Input file object
 ** @argrule * Pdest [AjPStr*] Buffer (expanded automatically) for results
+** @argrule View Pline [const char**] Start of line
+** @argrule View Plen [ajuint*] Line length including the newline
 ** @argrule Pos Ppos [ajlong*] File position after read
 **
 ** @valrule * [AjBool] True on success
@@ -167,6 +171,8 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
     const char* pnewline = NULL;
 #ifndef __ppc__
     size_t iread;
+    ajint ibgzf;
+    ajlong bgzfstart = 0;
 #endif
 
     /*
@@ -179,6 +185,8 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
 
     MAJSTRDEL(Pdest);
 
+    file->Viewlen = 0;
+
     if(file->Buffsize)
     {
         buff  = MAJSTRGETUNIQUEPTR(&file->Buff);
@@ -204,6 +212,13 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
     
     *Ppos = file->Filepos;
 
+#ifndef __ppc__
+    /* virtual offset of the start of the current BGZF block */
+
+    if(file->Bgzf)
+        bgzfstart = file->Filepos - file->Blockpos;
+#endif
+
     while(buff)
     {
 	if(file->End)
@@ -218,7 +233,24 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
 #ifndef __ppc__
         if(file->Readblock)
         {
-            if(file->Blockpos >= file->Blocklen)
+            if(file->Blockpos >= file->Blocklen && file->Bgzf)
+            {
+                bgzfstart = ajSeqBamBgzfTell(file->Bgzf);
+                ibgzf = ajSeqBamBgzfReadBlock(file->Bgzf, file->Readblock,
+                                              file->Blocksize);
+
+                if(ibgzf < 0)
+                    ajFatal("Error reading BGZF compressed file '%S'",
+                            ajFileGetNameS(file));
+
+                if(!ipos)
+                    *Ppos = bgzfstart;
+
+                file->Blockpos = 0;
+                file->Blocklen = ibgzf;
+                file->Readblock[ibgzf] = '\0';
+            }
+            else if(file->Blockpos >= file->Blocklen)
             {
                 iread = fread(file->Readblock,
                               1, file->Blocksize,
@@ -302,7 +334,7 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
 	 ** (must be careful about that - we may just have read enough)
 	 */
 
-	if(((file->Readblock && !pnewline) || (jlen == (isize-1))) &&
+	if(((file->Readblock && !pnewline && cp) || (jlen == (isize-1))) &&
 	   (buff[ilen-1] != '\n'))
 	{
             MAJSTRSETVALIDLEN(&file->Buff, ilen); /* fix before resizing! */
@@ -322,7 +354,19 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
         }
     }
     
+#ifndef __ppc__
+    if(file->Bgzf)
+    {
+        if(file->Blockpos < file->Blocklen)
+            file->Filepos = bgzfstart + file->Blockpos;
+        else
+            file->Filepos = ajSeqBamBgzfTell(file->Bgzf);
+    }
+    else
+        file->Filepos += ilen;
+#else
     file->Filepos += ilen;
+#endif
 
     MAJSTRSETVALIDLEN(&file->Buff, ilen);
     if (MAJSTRGETCHARLAST(file->Buff) != '\n')
@@ -344,6 +388,133 @@ AjBool ajReadlinePos(AjPFile file, AjPStr* Pdest, ajlong* Ppos)
 
 
 
+/* @func ajReadlineView *******************************************************
+**
+** Reads a line from a file read in blocks (see ajFileSetBlocksize) and
+** returns it in place in the block, with its newline. The line is not
+** copied, and is valid only until the next read from the file.
+**
+** A line that runs past the end of the block is moved to the start
+** before the next block is read. The block grows if a line is longer.
+** Other files, and a last line with no newline, are read by
+** ajReadlinePos and returned from the file line buffer.
+**
+** @param [u] file [AjPFile] Input file.
+** @param [w] Pline [const char**] Start of line
+** @param [w] Plen [ajuint*] Line length including the newline
+** @param [w] Ppos [ajlong*] File position before the read.
+** @return [AjBool] ajTrue on success.
+** @category modify [AjPFile] Reads a record from a file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool ajReadlineView(AjPFile file, const char** Pline, ajuint* Plen,
+                      ajlong* Ppos)
+{
+    AjPStr tmpline = NULL;
+    const char* cp;
+    const char* pnewline;
+    size_t iread;
+    ajuint jlen;
+    AjBool ok;
+
+    if(!file->Readblock || file->Bgzf)
+    {
+        ok = ajReadlinePos(file, &tmpline, Ppos);
+        ajStrDel(&tmpline);
+
+        *Pline = ok ? MAJSTRGETPTR(file->Buff) : "";
+        *Plen  = ok ? MAJSTRGETLEN(file->Buff) : 0;
+
+        return ok;
+    }
+
+    file->Viewlen = 0;
+
+    if(file->End)
+    {
+        *Pline = "";
+        *Plen  = 0;
+        ajDebug("at EOF: File already read to end %F\n", file);
+
+        return ajFalse;
+    }
+
+    for(;;)
+    {
+        cp = &file->Readblock[file->Blockpos];
+        jlen = file->Blocklen - file->Blockpos;
+        pnewline = jlen ? memchr(cp, '\n', jlen) : NULL;
+
+        if(pnewline)
+        {
+            jlen = (ajuint) (pnewline - cp) + 1;
+            file->Blockpos += jlen;
+            file->Viewlen = jlen;
+            *Ppos = file->Filepos;
+            file->Filepos += jlen;
+            *Pline = cp;
+            *Plen  = jlen;
+
+            return ajTrue;
+        }
+
+        /* keep the start of a part line, growing the block if it is full */
+
+        if(file->Blockpos)
+        {
+            memmove(file->Readblock, cp, jlen);
+            file->Blockpos = 0;
+            file->Blocklen = jlen;
+        }
+        else if(jlen == file->Blocksize)
+        {
+            file->Blocksize *= 2;
+            AJCRESIZE(file->Readblock, file->Blocksize+1);
+        }
+
+        iread = fread(&file->Readblock[file->Blocklen], 1,
+                      file->Blocksize - file->Blocklen, file->fp);
+
+        if(!iread)
+        {
+            if(ferror(file->fp))
+                ajFatal("fread failed with error:%d '%s'",
+                        ferror(file->fp), strerror(ferror(file->fp)));
+
+            if(!file->Blocklen)
+            {
+                file->End = ajTrue;
+                *Pline = "";
+                *Plen  = 0;
+                ajDebug("EOF ajReadlineView file %F\n", file);
+
+                return ajFalse;
+            }
+
+            /* last line has no newline: add one as ajReadlinePos does */
+
+            ajStrAssignLenC(&file->Buff, file->Readblock, file->Blocklen);
+            ajStrAppendK(&file->Buff, '\n');
+            *Ppos = file->Filepos;
+            file->Filepos += file->Blocklen;
+            file->Blockpos = file->Blocklen;
+            *Pline = MAJSTRGETPTR(file->Buff);
+            *Plen  = MAJSTRGETLEN(file->Buff);
+
+            return ajTrue;
+        }
+
+        file->Blocklen += (ajuint) iread;
+        file->Readblock[file->Blocklen] = '\0';
+    }
+}
+
+
+
+
 /* @func ajReadlineTrim *******************************************************
 **
 ** Reads a line from a file and removes any trailing newline.
@@ -1853,11 +2024,14 @@ AjBool ajWritelineSpace(AjPFile file, const AjPStr line)
 ** @nam2rule Buffread
 ** @nam3rule Line     Read next line from buffer
 ** @nam4rule Trim     Remove trailing newline and linefeed characters
+** @nam4rule View     Return the line in place without copying
 ** @suffix   Pos      Return file position after read
 ** @suffix   Store    Append line to store buffer
 **
 ** @argrule * buff [AjPFilebuff] Input buffered file object
 ** @argrule Line Pdest [AjPStr*] Buffer (expanded automatically) for results
+** @argrule View Pline [const char**] Start of line
+** @argrule View Plen [ajuint*] Line length including the newline
 ** @argrule Pos Ppos [ajlong*] File position after read
 ** @argrule Store dostore [AjBool] If true, use store buffer
 ** @argrule Store Pstore [AjPStr*] Buffer to store text from file
@@ -2117,6 +2291,87 @@ AjBool ajBuffreadLineTrim(AjPFilebuff buff, AjPStr* Pdest)
 
 
 
+/* @func ajBuffreadLineView ***************************************************
+**
+** Reads a line from a buffered file and returns it without copying to
+** a string. The line is valid only until the next read or buffer clear.
+**
+** Lines already in the buffer are returned from the buffer. While the
+** file is buffered, for example to test input formats, new lines are
+** saved as for ajBuffreadLinePos so the buffer can be reset. Once the
+** buffer is turned off, a file read in blocks returns each line in
+** place in the block.
+**
+** @param [u] buff [AjPFilebuff] Buffered input file.
+** @param [w] Pline [const char**] Start of line
+** @param [w] Plen [ajuint*] Line length including the newline
+** @param [w] Ppos [ajlong*] File position before the read.
+** @return [AjBool] ajTrue if data was read.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool ajBuffreadLineView(AjPFilebuff buff, const char** Pline,
+                          ajuint* Plen, ajlong* Ppos)
+{
+    AjPStr tmpline = NULL;
+    AjBool ok;
+
+    *Ppos  = 0;
+    *Pline = "";
+    *Plen  = 0;
+
+    if(buff->Pos < buff->Size)
+    {
+	*Pline = MAJSTRGETPTR(buff->Curr->Line);
+	*Plen  = MAJSTRGETLEN(buff->Curr->Line);
+	*Ppos  = buff->Curr->Fpos;
+	buff->Prev = buff->Curr;
+	buff->Curr = buff->Curr->Next;
+	buff->Pos++;
+
+	return ajTrue;
+    }
+
+    if(!buff->File->Handle)
+	return ajFalse;
+
+    if(!buff->Nobuff)
+    {
+        ok = ajBuffreadLinePos(buff, &tmpline, Ppos);
+        ajStrDel(&tmpline);
+
+        if(ok)
+        {
+            *Pline = MAJSTRGETPTR(buff->Last->Line);
+            *Plen  = MAJSTRGETLEN(buff->Last->Line);
+        }
+
+        return ok;
+    }
+
+    ok = ajReadlineView(buff->File, Pline, Plen, &buff->Fpos);
+
+    if(!ok)
+    {
+        /* buffer clear - try another file */
+
+        if(buff->File->End && !buff->Size &&
+           ajFileReopenNext(buff->File))
+            return ajBuffreadLineView(buff, Pline, Plen, Ppos);
+
+        return ajFalse;
+    }
+
+    *Ppos = buff->Fpos;
+
+    return ajTrue;
+}
+
+
+
+
 /* @funcstatic filebuffLineAdd ************************************************
 **
 ** Appends a line to a buffer.
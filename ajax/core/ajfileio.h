@@ -118,6 +118,8 @@ AjBool         ajReadlinePos(AjPFile file, AjPStr *Pdest, ajlong* Ppos);
 AjBool         ajReadlineTrim(AjPFile file, AjPStr *Pdest);
 AjBool         ajReadlineTrimPos(AjPFile file, AjPStr *Pdest, ajlong* Ppos);
 AjBool         ajReadlineAppend(AjPFile file, AjPStr* Pdest);
+AjBool         ajReadlineView(AjPFile file, const char** Pline, ajuint* Plen,
+                              ajlong* Ppos);
 
 AjBool         ajBuffreadLine(AjPFilebuff buff, AjPStr *pdest);
 AjBool         ajBuffreadLinePos(AjPFilebuff buff, AjPStr *pdest,
@@ -127,6 +129,8 @@ AjBool         ajBuffreadLineStore(AjPFilebuff buff, AjPStr* pdest,
 AjBool         ajBuffreadLinePosStore(AjPFilebuff buff, AjPStr* pdest,
                                       ajlong* Ppos, AjBool store, AjPStr *astr);
 AjBool         ajBuffreadLineTrim(AjPFilebuff buff, AjPStr* pdest);
+AjBool         ajBuffreadLineView(AjPFilebuff buff, const char** Pline,
+                                  ajuint* Plen, ajlong* Ppos);
 
 /*
 ** End of prototype definitions
@@ -30,6 +30,7 @@
 #include "ajindex.h"
 #include "ajfileio.h"
 #include "ajutil.h"
+#include "ajnam.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -39,6 +40,9 @@
 #endif
 
 #include <sys/types.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
 
 #ifdef WIN32
@@ -58,6 +62,9 @@
 static AjPBtpage btreeTestpage = NULL;
 
 static AjBool btreeDoRootSync = AJFALSE;
+static ajint  btreeDoMmap = -1;
+static ajint  btreeDoStats = -1;
+static ajlong btreeAutocache = -1;
 
 static ajulong   statCallSync = 0UL;
 static ajulong   statCallRootSync = 0UL;
@@ -244,12 +251,18 @@ static void          btreeIdentFetchMultiHit(AjPBtcache cache,
 static void          btreeIdentFetchMultiHitref(AjPBtcache cache,
                                                 ajulong rootblock,
                                                 AjPList list);
+static void          btreeIdentFetchlist(AjPBtcache cache,
+                                         const AjPList keys,
+                                         AjPList hitlist, AjPList misslist,
+                                         AjBool isref);
 
 static AjBool        btreeKeyidMakeroot(AjPBtcache cache, AjPBtpage bucket);
 
 static AjBool        btreeKeyidExists(AjPBtcache cache, const AjPStr key);
 static AjPBtpage     btreeKeyidFind(AjPBtcache cache, const AjPStr key);
 static AjBool        btreeKeyidInsert(AjPBtcache cache, const AjPStr id);
+static AjBool        btreeKeyidAdd(AjPBtcache cache, ajulong treeblock,
+                                   const AjPStr id);
 
 static AjPBtpage     btreePrimaryFetchFindleafWild(AjPBtcache cache,
                                                    const AjPStr key);
@@ -317,6 +330,20 @@ static void          btreePageUncompressPribucket(AjPBtpage page,
 
 static void          btreeNocacheFetch(const AjPBtcache cache, AjPBtpage cpage,
                                        ajulong pagepos);
+static void          btreeCacheMap(AjPBtcache cache);
+static AjBool        btreeCacheMapFetch(const AjPBtcache cache,
+                                        AjPBtpage cpage,
+                                        ajulong pagepos, ajuint pagesize);
+static void          btreeCacheAutotune(AjPBtcache cache, ajulong pagepos,
+                                        AjBool secondary);
+static void          btreeCacheCount(AjPBtcache cache, const AjPBtpage cpage,
+                                     AjBool secondary);
+static ajlong        btreeCacheGetAutocache(void);
+static AjBool        btreeCacheGetDostats(void);
+static AjBool        btreeCachePageSeen(const AjPBtcache cache,
+                                        ajulong pagepos);
+static void          btreeCacheStatsFmt(const AjPBtcache cache, AjPStr *Pstr);
+static void          btreeCacheUnmap(AjPBtcache cache);
 static void          btreeCacheFetchSize(AjPBtcache cache, AjPBtpage cpage,
                                          ajulong pagepos, ajuint pagesize);
 
@@ -398,6 +425,8 @@ static ajulong       btreeGetBlockFirstN(AjPBtcache cache, unsigned char *buf,
                                          ajulong numkey);
 static ajulong       btreeGetBlockFirstS(AjPBtcache cache, unsigned char *buf,
                                          const AjPStr key);
+static AjBool        btreeKeyBeforeLastS(AjPBtcache cache, unsigned char *buf,
+                                         const AjPStr key);
 static void          btreeIdFree(AjPBtId *thys);
 static ajint         btreeIdCompare(const void *a, const void *b);
 
@@ -556,6 +585,13 @@ static void          btreeIdInsertKey(AjPBtcache cache, AjPBtpage page,
 static void          btreeIdSplitroot(AjPBtcache cache);
 static void          btreeIdentDupInsert(AjPBtcache cache, const AjPBtId newid,
                                          AjPBtId curid);
+static void          btreeLoadChild(AjPBtload load, ajuint level,
+                                    const AjPStr key, ajulong pagepos);
+static void          btreeLoadIdbucket(AjPBtload load);
+static void          btreeLoadLevel(AjPBtload load, ajuint level);
+static void          btreeLoadPribucket(AjPBtload load);
+static void          btreeLoadWrite(AjPBtload load, ajuint level,
+                                    ajuint first, ajuint n);
 static ajulong       btreeIdbucketIdlistAll(AjPBtcache cache, ajulong pagepos,
                                             AjPList idlist);
 
@@ -1342,6 +1378,8 @@ AjPBtcache ajBtreeIdcacheNewC(const char *filetxt, const char *exttxt,
             filelen = buf.st_size;
 
         cache->readonly = ajTrue;
+        cache->mapsize = filelen;
+        btreeCacheMap(cache);
     }
     else if(ajCharMatchC(mode, "rb+")) /* update */
     {
@@ -2304,6 +2342,453 @@ static void btreeSeccacheDestage(AjPBtcache cache, AjPBtpage cpage)
 
 
 
+/* @funcstatic btreeCacheMap **************************************************
+**
+** Map a read-only cache file into memory so that pages are copied from
+** the shared operating system page cache instead of being read with
+** fseek and fread.
+**
+** Mapping can be disabled by setting the EMBOSS_BTREEMMAP variable to
+** a false value. Any failure to map leaves the cache reading the file.
+**
+** @param [u] cache [AjPBtcache] cache
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeCacheMap(AjPBtcache cache)
+{
+#ifndef WIN32
+    AjPStr value = NULL;
+    AjBool domap = ajTrue;
+    void *map;
+
+    cache->mapbase = NULL;
+
+    if(btreeDoMmap < 0)
+    {
+        if(ajNamGetValueC("btreemmap", &value))
+        {
+            if(!ajStrToBool(value, &domap))
+                ajErr("Bad value for environment variable 'BTREEMMAP'");
+        }
+
+        btreeDoMmap = domap ? 1 : 0;
+        ajStrDel(&value);
+    }
+
+    if(!btreeDoMmap || !cache->mapsize ||
+       (ajulong) (size_t) cache->mapsize != cache->mapsize)
+        return;
+
+    map = mmap(NULL, (size_t) cache->mapsize, PROT_READ, MAP_SHARED,
+               fileno(cache->fp), 0);
+
+    if(map == MAP_FAILED)
+    {
+        ajDebug("btreeCacheMap mmap failed for '%S' %d: '%s'\n",
+                cache->filename, errno, strerror(errno));
+
+        return;
+    }
+
+#ifdef MADV_RANDOM
+    madvise(map, (size_t) cache->mapsize, MADV_RANDOM);
+#endif
+
+    cache->mapbase = (const unsigned char*) map;
+
+    ajDebug("btreeCacheMap '%S' mapped %Lu bytes\n",
+            cache->filename, cache->mapsize);
+#else
+    cache->mapbase = NULL;
+#endif
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeCacheMapFetch *********************************************
+**
+** Copy a cache page from the memory mapped index file
+**
+** @param [r] cache [const AjPBtcache] cache
+** @param [w] cpage [AjPBtpage] cache page
+** @param [r] pagepos [ajulong] page number
+** @param [r] pagesize [ajuint] page size
+**
+** @return [AjBool] True if the page was copied, false if the cache is
+**                  not mapped or the page extends beyond the mapped file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeCacheMapFetch(const AjPBtcache cache, AjPBtpage cpage,
+                                 ajulong pagepos, ajuint pagesize)
+{
+    if(!cache->mapbase)
+        return ajFalse;
+
+    if(pagepos > cache->mapsize || pagesize > cache->mapsize - pagepos)
+        return ajFalse;
+
+    memcpy(cpage->buf, cache->mapbase + pagepos, pagesize);
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic btreeCacheUnmap ************************************************
+**
+** Release the memory map of a read-only cache file
+**
+** @param [u] cache [AjPBtcache] cache
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeCacheUnmap(AjPBtcache cache)
+{
+#ifndef WIN32
+    if(cache->mapbase)
+        munmap((void*) cache->mapbase, (size_t) cache->mapsize);
+#endif
+
+    cache->mapbase = NULL;
+    cache->mapsize = 0UL;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeCachePageSeen *********************************************
+**
+** Tests whether a page has been read from disk before
+**
+** @param [r] cache [const AjPBtcache] cache
+** @param [r] pagepos [ajulong] page number
+**
+** @return [AjBool] True if the page was read before
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeCachePageSeen(const AjPBtcache cache, ajulong pagepos)
+{
+    if(!cache->pageseen)
+        return ajFalse;
+
+    if(ajTableFetchV(cache->pageseen, &pagepos))
+        return ajTrue;
+
+    return ajFalse;
+}
+
+
+
+
+/* @funcstatic btreeCacheCount ************************************************
+**
+** Counts a page read from disk in the cache statistics
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] cpage [const AjPBtpage] cache page just read
+** @param [r] secondary [AjBool] True for a secondary cache page
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeCacheCount(AjPBtcache cache, const AjPBtpage cpage,
+                            AjBool secondary)
+{
+    ajuint nodetype = 0;
+    ajulong *pagepos = NULL;
+
+    if(secondary)
+        cache->secbytes += cache->secpagesize;
+    else
+        cache->pribytes += cache->pripagesize;
+
+    GBT_NODETYPE(cpage->buf, &nodetype);
+
+    switch(nodetype)
+    {
+        case BT_ROOT:
+        case BT_INTERNAL:
+        case BT_SECROOT:
+        case BT_SECINTERNAL:
+            cache->nodereads++;
+            break;
+        case BT_LEAF:
+        case BT_SECLEAF:
+            cache->leafreads++;
+            break;
+        case BT_IDBUCKET:
+        case BT_OVERFLOW:
+        case BT_PRIBUCKET:
+        case BT_SECBUCKET:
+        case BT_NUMBUCKET:
+        case BT_SECOVERFLOW:
+            cache->bucketreads++;
+            break;
+        default:
+            break;
+    }
+
+    /* tracking distinct pages costs memory, so only when it is used */
+
+    if(!cache->pagestats &&
+       !btreeCacheGetDostats() && !btreeCacheGetAutocache())
+        return;
+
+    if(btreeCachePageSeen(cache, cpage->pagepos))
+    {
+        if(secondary)
+            cache->secrereads++;
+        else
+            cache->prirereads++;
+
+        return;
+    }
+
+    if(!cache->pageseen)
+        cache->pageseen = ajTableNewFunctionOpen(cache->pricachesize +
+                                                 cache->seccachesize,
+                                                 &ajTableulongCmp,
+                                                 &ajTableulongHash,
+                                                 &ajMemFree, NULL);
+
+    AJNEW0(pagepos);
+    *pagepos = cpage->pagepos;
+    ajTablePut(cache->pageseen, (void*) pagepos, (void*) pagepos);
+
+    if(secondary)
+        cache->secdistinct++;
+    else
+        cache->pridistinct++;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeCacheAutotune *********************************************
+**
+** Grows a full cache to the observed working set when a page read before
+** has to be read again.
+**
+** Autotuning is off unless the EMBOSS_BTREEAUTOCACHE variable sets the
+** maximum memory in megabytes for the pages of each cache.
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] pagepos [ajulong] page number about to be read
+** @param [r] secondary [AjBool] True for the secondary cache
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeCacheAutotune(AjPBtcache cache, ajulong pagepos,
+                               AjBool secondary)
+{
+    ajulong maxpages;
+    ajulong npages;
+
+    if(!btreeCacheGetAutocache() || !btreeCachePageSeen(cache, pagepos))
+        return;
+
+    if(secondary)
+    {
+        maxpages = (ajulong) btreeAutocache * 1024 * 1024 /
+            cache->secpagesize;
+        npages = cache->secdistinct;
+
+        if(npages > maxpages)
+            npages = maxpages;
+
+        if(npages > cache->seccachesize)
+        {
+            ajDebug("btreeCacheAutotune '%S' seccachesize %u => %Lu\n",
+                    cache->basename, cache->seccachesize, npages);
+            cache->seccachesize = (ajuint) npages;
+        }
+    }
+    else
+    {
+        maxpages = (ajulong) btreeAutocache * 1024 * 1024 /
+            cache->pripagesize;
+        npages = cache->pridistinct;
+
+        if(npages > maxpages)
+            npages = maxpages;
+
+        if(npages > cache->pricachesize)
+        {
+            ajDebug("btreeCacheAutotune '%S' cachesize %u => %Lu\n",
+                    cache->basename, cache->pricachesize, npages);
+            cache->pricachesize = (ajuint) npages;
+        }
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeCacheGetAutocache *****************************************
+**
+** Returns the maximum page memory in megabytes for autotuning a cache,
+** set by the EMBOSS_BTREEAUTOCACHE variable, or zero if autotuning is off
+**
+** @return [ajlong] Megabytes of cache pages, or zero
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajlong btreeCacheGetAutocache(void)
+{
+    AjPStr value = NULL;
+    ajulong megabytes = 0UL;
+
+    if(btreeAutocache < 0)
+    {
+        if(ajNamGetValueC("btreeautocache", &value))
+        {
+            if(!ajStrToUlong(value, &megabytes))
+                ajErr("Bad value for environment variable "
+                      "'BTREEAUTOCACHE'");
+        }
+
+        btreeAutocache = (ajlong) megabytes;
+        ajStrDel(&value);
+    }
+
+    return btreeAutocache;
+}
+
+
+
+
+/* @funcstatic btreeCacheGetDostats *******************************************
+**
+** Tests whether cache statistics are reported as each cache is closed,
+** set by the EMBOSS_BTREESTATS variable
+**
+** @return [AjBool] True if statistics are reported
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeCacheGetDostats(void)
+{
+    AjPStr value = NULL;
+    AjBool dostats = ajFalse;
+
+    if(btreeDoStats < 0)
+    {
+        btreeDoStats = 0;
+
+        if(ajNamGetValueC("btreestats", &value))
+        {
+            if(!ajStrToBool(value, &dostats))
+                ajErr("Bad value for environment variable 'BTREESTATS'");
+
+            if(dostats)
+                btreeDoStats = 1;
+        }
+
+        ajStrDel(&value);
+    }
+
+    return (btreeDoStats > 0);
+}
+
+
+
+
+/* @funcstatic btreeCacheStatsFmt *********************************************
+**
+** Formats the page statistics of a cache
+**
+** @param [r] cache [const AjPBtcache] cache
+** @param [w] Pstr [AjPStr*] Report text
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeCacheStatsFmt(const AjPBtcache cache, AjPStr *Pstr)
+{
+    ajulong prisuggest = cache->pricachesize;
+    ajulong secsuggest = cache->seccachesize;
+
+    /*
+    ** rereads show the working set did not fit in the cache.
+    ** A read-only cache also sees its whole working set, so it can shrink
+    */
+
+    if((cache->prirereads || cache->readonly) && cache->pridistinct)
+        prisuggest = cache->pridistinct;
+
+    if((cache->secrereads || cache->readonly) && cache->secdistinct)
+        secsuggest = cache->secdistinct;
+
+    ajFmtPrintS(Pstr,
+                "Cache '%S' primary: pages %u/%u pagesize %u "
+                "hits %Lu misses %Lu rereads %Lu evictions %Lu "
+                "bytes %Lu workingset %Lu\n",
+                cache->basename, cache->prilistLength, cache->pricachesize,
+                cache->pripagesize, cache->pricachehits, cache->prireads,
+                cache->prirereads, cache->prievictions, cache->pribytes,
+                cache->pridistinct);
+    ajFmtPrintAppS(Pstr,
+                   "Cache '%S' secondary: pages %u/%u pagesize %u "
+                   "hits %Lu misses %Lu rereads %Lu evictions %Lu "
+                   "bytes %Lu workingset %Lu\n",
+                   cache->basename, cache->seclistLength,
+                   cache->seccachesize, cache->secpagesize,
+                   cache->seccachehits, cache->secreads,
+                   cache->secrereads, cache->secevictions, cache->secbytes,
+                   cache->secdistinct);
+    ajFmtPrintAppS(Pstr,
+                   "Cache '%S' reads: node %Lu leaf %Lu bucket %Lu\n",
+                   cache->basename, cache->nodereads, cache->leafreads,
+                   cache->bucketreads);
+    ajFmtPrintAppS(Pstr,
+                   "Cache '%S' suggested cachesize: %Lu seccachesize: %Lu\n",
+                   cache->basename, prisuggest, secsuggest);
+
+    return;
+}
+
+
+
+
 /* @funcstatic btreeCacheFetchSize ********************************************
 **
 ** Fetch a cache page from disc
@@ -2327,6 +2812,13 @@ static void btreeCacheFetchSize(AjPBtcache cache, AjPBtpage cpage,
 
     /* ajDebug("In btreeCacheFetchSize\n"); */
 
+    if(btreeCacheMapFetch(cache, cpage, pagepos, pagesize))
+    {
+        cpage->pagepos = pagepos;
+
+        return;
+    }
+
     if(fseek(cache->fp,pagepos,SEEK_SET))
 	ajFatal("Seek error %d: '%s' in ajBtreeCacheFetchSize file %S",
                 ferror(cache->fp),
@@ -2376,6 +2868,15 @@ static void btreePricacheFetch(AjPBtcache cache, AjPBtpage cpage,
 
     /* ajDebug("In btreePricacheFetch\n"); */
 
+    if(btreeCacheMapFetch(cache, cpage, pagepos, cache->pripagesize))
+    {
+        cpage->pagepos = pagepos;
+        cache->prireads++;
+        btreeCacheCount(cache, cpage, ajFalse);
+
+        return;
+    }
+
     if(fseek(cache->fp,pagepos,SEEK_SET))
 	ajFatal("Seek error %d: '%s' in ajBtreePricacheFetch file %S",
                 ferror(cache->fp),
@@ -2397,6 +2898,7 @@ static void btreePricacheFetch(AjPBtcache cache, AjPBtpage cpage,
 
     cpage->pagepos = pagepos;
     cache->prireads++;
+    btreeCacheCount(cache, cpage, ajFalse);
     
     return;
 }
@@ -2426,6 +2928,15 @@ static void btreeSeccacheFetch(AjPBtcache cache, AjPBtpage cpage,
 
     /* ajDebug("In btreeSeccacheFetch\n"); */
 
+    if(btreeCacheMapFetch(cache, cpage, pagepos, cache->secpagesize))
+    {
+        cpage->pagepos = pagepos;
+        cache->secreads++;
+        btreeCacheCount(cache, cpage, ajTrue);
+
+        return;
+    }
+
     if(fseek(cache->fp,pagepos,SEEK_SET))
 	ajFatal("Seek error %d: '%s' in ajBtreeSeccacheFetch file %S",
                 ferror(cache->fp),
@@ -2447,6 +2958,7 @@ static void btreeSeccacheFetch(AjPBtcache cache, AjPBtpage cpage,
 
     cpage->pagepos = pagepos;
     cache->secreads++;
+    btreeCacheCount(cache, cpage, ajTrue);
     
     return;
 }
@@ -2826,6 +3338,7 @@ ajulong ajBtreeCacheDel(AjPBtcache *Pthis)
     AjPBtcache thys;
     AjPBtpage  page  = NULL;
     AjPBtpage  temp  = NULL;
+    AjPStr value = NULL;
     ajulong ret = 0UL;
 
     if(!Pthis || !*Pthis) return ret;
@@ -2833,6 +3346,13 @@ ajulong ajBtreeCacheDel(AjPBtcache *Pthis)
 
     /* ajDebug("In ajBtreeCacheDel\n"); */
 
+    if(btreeCacheGetDostats())
+    {
+        btreeCacheStatsFmt(thys, &value);
+        ajFmtError("%S", value);
+        ajStrDel(&value);
+    }
+
     /* clear the dirty / locked pages */
 
     if(!thys->readonly)
@@ -2884,7 +3404,9 @@ ajulong ajBtreeCacheDel(AjPBtcache *Pthis)
     ajStrDel(&thys->basename);
     ajStrDel(&thys->replace);
 
+    btreeCacheUnmap(thys);
     fclose(thys->fp);
+    ajTableDel(&thys->pageseen);
 
     ajTableFree(&thys->pripagetable);
     ajTableFree(&thys->secpagetable);
@@ -2937,6 +3459,33 @@ AjBool ajBtreeCacheIsSecondary(const AjPBtcache thys)
 
 
 
+/* @func ajBtreeCacheSetPagestats ********************************************
+**
+** Turns on counting of rereads and of the working set of distinct pages
+** read from disk, for reporting by ajBtreeCacheStatsReport
+**
+** Without this, pages are only tracked when the EMBOSS_BTREESTATS or
+** EMBOSS_BTREEAUTOCACHE variable is set.
+**
+** @param [u] cache [AjPBtcache] Cache object
+** @param [r] dostats [AjBool] True to count distinct pages
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeCacheSetPagestats(AjPBtcache cache, AjBool dostats)
+{
+    cache->pagestats = dostats;
+
+    return;
+}
+
+
+
+
 /* @func ajBtreeCacheStatsOut *************************************************
 **
 ** Cache statistics for writing a new index
@@ -3032,6 +3581,45 @@ void ajBtreeCacheStatsOut(AjPFile outf, const AjPBtcache cache,
 
 
 
+/* @func ajBtreeCacheStatsReport **********************************************
+**
+** Reports page cache statistics for a cache: hits, misses, evictions and
+** bytes read for the primary and secondary caches, disk reads by page
+** type, and a cache size that would hold the observed working set.
+**
+** Applications can also report for every cache they close by setting
+** the EMBOSS_BTREESTATS variable.
+**
+** Rereads and the working set are only counted for caches with
+** ajBtreeCacheSetPagestats set, or when EMBOSS_BTREESTATS or
+** EMBOSS_BTREEAUTOCACHE is set.
+**
+** @param [u] outf [AjPFile] output file
+** @param [r] cache [const AjPBtcache] cache object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeCacheStatsReport(AjPFile outf, const AjPBtcache cache)
+{
+    AjPStr tmpstr = NULL;
+
+    if(!cache) return;
+
+    btreeCacheStatsFmt(cache, &tmpstr);
+    ajFmtPrintF(outf, "%S", tmpstr);
+
+    ajStrDel(&tmpstr);
+
+    return;
+}
+
+
+
+
 /* @funcstatic btreePricacheControl *******************************************
 **
 ** Master control function for primary cache read/write
@@ -3062,9 +3650,13 @@ static AjPBtpage btreePricacheControl(AjPBtcache cache, ajulong pagepos,
     }
     else
     {
+        if(cache->prilistLength == cache->pricachesize)
+            btreeCacheAutotune(cache, pagepos, ajFalse);
+
 	if(cache->prilistLength == cache->pricachesize)
 	{
 	    ret = btreePricacheLruUnlink(cache);
+            cache->prievictions++;
 
 	    if(ret->dirty == BT_DIRTY)
 		btreePricacheDestage(cache,ret);
@@ -3130,9 +3722,13 @@ static AjPBtpage btreeSeccacheControl(AjPBtcache cache, ajulong pagepos,
     }
     else
     {
+        if(cache->seclistLength == cache->seccachesize)
+            btreeCacheAutotune(cache, pagepos, ajTrue);
+
 	if(cache->seclistLength == cache->seccachesize)
 	{
 	    ret = btreeSeccacheLruUnlink(cache);
+            cache->secevictions++;
 
 	    if(ret->dirty == BT_DIRTY)
 		btreeSeccacheDestage(cache,ret);
@@ -7242,6 +7838,57 @@ static ajulong btreeGetBlockFirstS(AjPBtcache cache, unsigned char *buf,
 
 
 
+/* @funcstatic btreeKeyBeforeLastS ********************************************
+**
+** Tests whether a key sorts before the last key in a node, so that a
+** search for any key between the node's first key and this key will
+** end in the same node.
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [u] buf [unsigned char *] page buffer
+** @param [r] key [const AjPStr] key
+**
+** @return [AjBool] True if the key sorts before the last key
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeKeyBeforeLastS(AjPBtcache cache, unsigned char *buf,
+                                  const AjPStr key)
+{
+    ajuint m;
+    unsigned char *lenptr = NULL;
+    unsigned char *keyptr = NULL;
+
+    ajuint    i;
+    ajuint    ival = 0U;
+
+    GBT_NKEYS(buf,&m);
+    if(!m)
+	ajFatal("btreeKeyBeforeLastS: No keys in node cache %S",
+                cache->filename);
+
+    lenptr =  PBT_KEYLEN(buf);
+    keyptr = lenptr + m * sizeof(ajuint);
+
+    for(i=1U; i<m; ++i)
+    {
+	BT_GETAJUINT(lenptr,&ival);
+        keyptr += ival+1;
+	keyptr += sizeof(ajulong);
+	lenptr += sizeof(ajuint);
+    }
+
+    if(strcmp((const char*)keyptr, MAJSTRGETPTR(key)) > 0)
+        return ajTrue;
+
+    return ajFalse;
+}
+
+
+
+
 /* @funcstatic btreeIdCompare *************************************************
 **
 ** Comparison function for ajListSort
@@ -8056,63 +8703,146 @@ void ajBtreeIdentFetchHitref(AjPBtcache cache, const AjPStr key,
 
 
 
-/* @func ajBtreeWriteParamsC **************************************************
+/* @funcstatic btreeIdentFetchlist ********************************************
 **
-** Write B+ tree parameters to file
+** Get hit structures for a list of identifiers in one pass through the tree
 **
-** @param [r] cache [const AjPBtcache] cache
-** @param [r] fntxt [const char *] file name
-** @param [r] exttxt [const char *] index file extension name
-** @param [r] idirtxt [const char *] index file directory
+** The identifiers are sorted so that each leaf node and each bucket is
+** read once for all the identifiers it holds.
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] keys [const AjPList] List of identifier strings
+** @param [w] hitlist [AjPList] List of hit or reference hit objects
+** @param [w] misslist [AjPList] List of identifiers not found, or NULL
+** @param [r] isref [AjBool] True to return reference hits
 **
 ** @return [void]
 **
-** @release 6.4.0
+** @release 6.6.0
 ** @@
 ******************************************************************************/
 
-void ajBtreeWriteParamsC(const AjPBtcache cache, const char *fntxt,
-			 const char *exttxt, const char *idirtxt)
+static void btreeIdentFetchlist(AjPBtcache cache, const AjPList keys,
+                                AjPList hitlist, AjPList misslist,
+                                AjBool isref)
 {
-    AjPStr  fname = NULL;
-    AjPFile outf  = NULL;
+    AjPBtpage page   = NULL;
+    AjPIdbucket bucket = NULL;
+    AjPBtId   tid    = NULL;
+    AjPStr *karray = NULL;
+    AjPStr *keystr = NULL;
 
-    fname = ajStrNewRes(128);
+    ajulong nkeys;
+    ajulong ikey;
+    ajuint nentries = 0U;
+    ajuint i;
+    ajuint dirtysave = 0U;
 
-    if(!*idirtxt)
-      ajFmtPrintS(&fname,"%s.p%s",fntxt,exttxt);
-    else
-      ajFmtPrintS(&fname,"%s%s%s.p%s",idirtxt,SLASH_STRING,fntxt,exttxt);
+    ajulong blockno = 0UL;
+    ajulong lastblock = 0UL;
+    AjBool found   = ajFalse;
 
-    if(!(outf = ajFileNewOutNameS(fname)))
-	ajFatal("Cannot open param file %S\n",fname);
+    if(!cache->countunique && !cache->countall)
+        return;
 
-    if(cache->secondary)
-        ajFmtPrintF(outf,"Type      %s\n","Secondary");
-    else
-        ajFmtPrintF(outf,"Type         %s\n","Identifier");
-    ajFmtPrintF(outf,"Compress     %B\n",cache->compressed);
-    ajFmtPrintF(outf,"Pages        %Lu\n",cache->pripagecount);
-    ajFmtPrintF(outf,"Secpages     %Lu\n",cache->secpagecount);
-    ajFmtPrintF(outf,"Order        %u\n",cache->porder);
-    ajFmtPrintF(outf,"Fill         %u\n",cache->pnperbucket);
-    ajFmtPrintF(outf,"Level        %u\n",cache->plevel);
-    ajFmtPrintF(outf,"Pagesize     %u\n",cache->pripagesize);
-    ajFmtPrintF(outf,"Cachesize    %u\n",cache->pricachesize);
-    ajFmtPrintF(outf,"Order2       %u\n",cache->sorder);
-    ajFmtPrintF(outf,"Fill2        %u\n",cache->snperbucket);
-    ajFmtPrintF(outf,"Secpagesize  %u\n",cache->secpagesize);
-    ajFmtPrintF(outf,"Seccachesize %u\n",cache->seccachesize);
-    ajFmtPrintF(outf,"Count        %Lu\n",cache->countunique);
-    ajFmtPrintF(outf,"Fullcount    %Lu\n",cache->countall);
-    ajFmtPrintF(outf,"Kwlimit      %u\n",cache->keylimit);
-    if(cache->secondary)
-        ajFmtPrintF(outf,"Idlimit      %u\n",cache->idlimit);
-    else
-        ajFmtPrintF(outf,"Reffiles     %u\n",cache->refcount);
+    if(isref && cache->refcount != 1)
+        ajWarn("ajBtreeIdentFetchlistHitref called for cache '%S' "
+               "with %u reference files",
+               cache->filename, cache->refcount);
 
-    ajFileClose(&outf);
-    ajStrDel(&fname);
+    nkeys = ajListToarray(keys, (void***) &karray);
+
+    if(!nkeys)
+        return;
+
+    AJCNEW0(keystr, nkeys);
+
+    for(ikey=0UL; ikey < nkeys; ikey++)
+    {
+        keystr[ikey] = ajStrNewS(karray[ikey]);
+        ajStrFmtQuery(&keystr[ikey]);
+    }
+
+    AJFREE(karray);
+
+    qsort(keystr, (size_t) nkeys, sizeof(AjPStr), &ajStrVcmp);
+
+    for(ikey=0UL; ikey < nkeys; ikey++)
+    {
+        if(ikey && ajStrMatchS(keystr[ikey], keystr[ikey-1]))
+            continue;
+
+        /*
+        ** Keys are sorted, so the last leaf serves this key too
+        ** unless the key is beyond its last key
+        */
+
+        if(!page || !btreeKeyBeforeLastS(cache, page->buf, keystr[ikey]))
+        {
+            if(page)
+                page->dirty = dirtysave;
+
+            page = btreeIdentFind(cache, keystr[ikey]);
+            dirtysave = page->dirty;
+            page->dirty = BT_LOCK;
+            page->lockfor = 1981;
+        }
+
+        blockno = btreeGetBlockS(cache, page->buf, keystr[ikey]);
+
+        if(!bucket || blockno != lastblock)
+        {
+            btreeIdbucketDel(&bucket);
+            bucket = btreeReadIdbucket(cache, blockno);
+            lastblock = blockno;
+        }
+
+        nentries = bucket->Nentries;
+
+        found = ajFalse;
+
+        for(i=0;i<nentries;++i)
+            if(!MAJSTRCMPS(bucket->Ids[i]->id, keystr[ikey]))
+            {
+                found = ajTrue;
+                break;
+            }
+
+        if(!found)
+        {
+            if(misslist)
+                ajListstrPushAppend(misslist, ajStrNewS(keystr[ikey]));
+
+            continue;
+        }
+
+        tid = bucket->Ids[i];
+
+        if(isref)
+        {
+            if(!tid->dups)
+                ajListPushAppend(hitlist, (void *) ajBtreeHitrefNewId(tid));
+            else
+                btreeIdentFetchMultiHitref(cache, tid->offset, hitlist);
+        }
+        else
+        {
+            if(!tid->dups)
+                ajListPushAppend(hitlist, (void *) ajBtreeHitNewId(tid));
+            else
+                btreeIdentFetchMultiHit(cache, tid->offset, hitlist);
+        }
+    }
+
+    if(page)
+        page->dirty = dirtysave;
+
+    btreeIdbucketDel(&bucket);
+
+    for(ikey=0UL; ikey < nkeys; ikey++)
+        ajStrDel(&keystr[ikey]);
+
+    AJFREE(keystr);
 
     return;
 }
@@ -8120,14 +8850,72 @@ void ajBtreeWriteParamsC(const AjPBtcache cache, const char *fntxt,
 
 
 
-/* @func ajBtreeWriteParamsS **************************************************
+/* @func ajBtreeIdentFetchlistHit *********************************************
+**
+** Get ID hit structures for a list of identifiers
+**
+** The tree is searched once for the sorted identifiers, sharing leaf and
+** bucket reads. Hits are returned in identifier order.
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] keys [const AjPList] List of identifier strings
+** @param [w] hitlist [AjPList] List of hit objects
+** @param [w] misslist [AjPList] List of identifiers not found, or NULL
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeIdentFetchlistHit(AjPBtcache cache, const AjPList keys,
+                              AjPList hitlist, AjPList misslist)
+{
+    btreeIdentFetchlist(cache, keys, hitlist, misslist, ajFalse);
+
+    return;
+}
+
+
+
+
+/* @func ajBtreeIdentFetchlistHitref ******************************************
+**
+** Get ID reference hit structures for a list of identifiers
+**
+** The tree is searched once for the sorted identifiers, sharing leaf and
+** bucket reads. Hits are returned in identifier order.
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] keys [const AjPList] List of identifier strings
+** @param [w] hitlist [AjPList] List of reference hit objects
+** @param [w] misslist [AjPList] List of identifiers not found, or NULL
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeIdentFetchlistHitref(AjPBtcache cache, const AjPList keys,
+                                 AjPList hitlist, AjPList misslist)
+{
+    btreeIdentFetchlist(cache, keys, hitlist, misslist, ajTrue);
+
+    return;
+}
+
+
+
+
+/* @func ajBtreeWriteParamsC **************************************************
 **
 ** Write B+ tree parameters to file
 **
 ** @param [r] cache [const AjPBtcache] cache
-** @param [r] fn [const AjPStr] file name
-** @param [r] ext [const AjPStr] index file extension name
-** @param [r] idir [const AjPStr] index file directory
+** @param [r] fntxt [const char *] file name
+** @param [r] exttxt [const char *] index file extension name
+** @param [r] idirtxt [const char *] index file directory
 **
 ** @return [void]
 **
@@ -8135,24 +8923,88 @@ void ajBtreeWriteParamsC(const AjPBtcache cache, const char *fntxt,
 ** @@
 ******************************************************************************/
 
-void ajBtreeWriteParamsS(const AjPBtcache cache, const AjPStr fn,
-                         const AjPStr ext, const AjPStr idir)
+void ajBtreeWriteParamsC(const AjPBtcache cache, const char *fntxt,
+			 const char *exttxt, const char *idirtxt)
 {
     AjPStr  fname = NULL;
     AjPFile outf  = NULL;
 
     fname = ajStrNewRes(128);
 
-    if(ajStrGetLen(idir))
-      ajFmtPrintS(&fname,"%S%s%S.p%S",idir,SLASH_STRING,fn,ext);
+    if(!*idirtxt)
+      ajFmtPrintS(&fname,"%s.p%s",fntxt,exttxt);
     else
-        ajFmtPrintS(&fname,"%S.p%S",fn,ext);
+      ajFmtPrintS(&fname,"%s%s%s.p%s",idirtxt,SLASH_STRING,fntxt,exttxt);
 
     if(!(outf = ajFileNewOutNameS(fname)))
 	ajFatal("Cannot open param file %S\n",fname);
 
     if(cache->secondary)
-        ajFmtPrintF(outf,"Type         %s\n","Secondary");
+        ajFmtPrintF(outf,"Type      %s\n","Secondary");
+    else
+        ajFmtPrintF(outf,"Type         %s\n","Identifier");
+    ajFmtPrintF(outf,"Compress     %B\n",cache->compressed);
+    ajFmtPrintF(outf,"Pages        %Lu\n",cache->pripagecount);
+    ajFmtPrintF(outf,"Secpages     %Lu\n",cache->secpagecount);
+    ajFmtPrintF(outf,"Order        %u\n",cache->porder);
+    ajFmtPrintF(outf,"Fill         %u\n",cache->pnperbucket);
+    ajFmtPrintF(outf,"Level        %u\n",cache->plevel);
+    ajFmtPrintF(outf,"Pagesize     %u\n",cache->pripagesize);
+    ajFmtPrintF(outf,"Cachesize    %u\n",cache->pricachesize);
+    ajFmtPrintF(outf,"Order2       %u\n",cache->sorder);
+    ajFmtPrintF(outf,"Fill2        %u\n",cache->snperbucket);
+    ajFmtPrintF(outf,"Secpagesize  %u\n",cache->secpagesize);
+    ajFmtPrintF(outf,"Seccachesize %u\n",cache->seccachesize);
+    ajFmtPrintF(outf,"Count        %Lu\n",cache->countunique);
+    ajFmtPrintF(outf,"Fullcount    %Lu\n",cache->countall);
+    ajFmtPrintF(outf,"Kwlimit      %u\n",cache->keylimit);
+    if(cache->secondary)
+        ajFmtPrintF(outf,"Idlimit      %u\n",cache->idlimit);
+    else
+        ajFmtPrintF(outf,"Reffiles     %u\n",cache->refcount);
+
+    ajFileClose(&outf);
+    ajStrDel(&fname);
+
+    return;
+}
+
+
+
+
+/* @func ajBtreeWriteParamsS **************************************************
+**
+** Write B+ tree parameters to file
+**
+** @param [r] cache [const AjPBtcache] cache
+** @param [r] fn [const AjPStr] file name
+** @param [r] ext [const AjPStr] index file extension name
+** @param [r] idir [const AjPStr] index file directory
+**
+** @return [void]
+**
+** @release 6.4.0
+** @@
+******************************************************************************/
+
+void ajBtreeWriteParamsS(const AjPBtcache cache, const AjPStr fn,
+                         const AjPStr ext, const AjPStr idir)
+{
+    AjPStr  fname = NULL;
+    AjPFile outf  = NULL;
+
+    fname = ajStrNewRes(128);
+
+    if(ajStrGetLen(idir))
+      ajFmtPrintS(&fname,"%S%s%S.p%S",idir,SLASH_STRING,fn,ext);
+    else
+        ajFmtPrintS(&fname,"%S.p%S",fn,ext);
+
+    if(!(outf = ajFileNewOutNameS(fname)))
+	ajFatal("Cannot open param file %S\n",fname);
+
+    if(cache->secondary)
+        ajFmtPrintF(outf,"Type         %s\n","Secondary");
     else
         ajFmtPrintF(outf,"Type         %s\n","Identifier");
     ajFmtPrintF(outf,"Compress     %B\n",cache->compressed);
@@ -12736,7 +13588,6 @@ static AjBool btreePribucketsReorder(AjPBtcache cache, AjPBtpage leaf)
 AjBool ajBtreeKeyIndex(AjPBtcache cache, const AjPStr keyword, const AjPStr id)
 {
     AjPBtpage spage   = NULL;
-    AjPBtpage page    = NULL;
     ajulong lblockno = 0UL;
     ajulong rblockno = 0UL;
     ajulong blockno  = 0UL;
@@ -12745,10 +13596,8 @@ AjBool ajBtreeKeyIndex(AjPBtcache cache, const AjPStr keyword, const AjPStr id)
     ajulong nkeys = 0U;
 
     ajuint nodetype = 0U;
-    ajulong right   = 0UL;
     
     ajuint n;
-    ajuint savedirty;
     unsigned char *buf   = NULL;
 
     ajulong treeblock = 0UL;
@@ -12783,32 +13632,11 @@ AjBool ajBtreeKeyIndex(AjPBtcache cache, const AjPStr keyword, const AjPStr id)
     {
         /* we have the keyword in the index */
 
-	cache->secrootblock = treeblock;
-	page = btreeSeccacheWrite(cache,cache->secrootblock);
-        savedirty = page->dirty;
-	page->dirty = BT_LOCK;
-        page->lockfor = 1281;
-	buf = page->buf;
-	GBT_RIGHT(buf,&right);
-	cache->slevel = (ajuint) right;
-
-	if(btreeKeyidInsert(cache,indexId))
-        {
+	if(btreeKeyidAdd(cache,treeblock,indexId))
             ++cache->countall;
-            GBT_NODETYPE(buf,&nodetype);
-            if(nodetype != BT_SECBUCKET)
-            {
-                right = (ajulong) cache->slevel;
-                SBT_RIGHT(buf,right);
-                page->dirty = BT_DIRTY;
-            }
-        }
         else
-        {
             newid = ajFalse;
-            page->dirty = savedirty;
-        }
-        
+
 	return newid;
     }
 
@@ -12884,6 +13712,62 @@ AjBool ajBtreeKeyIndex(AjPBtcache cache, const AjPStr keyword, const AjPStr id)
 
 
 
+/* @funcstatic btreeKeyidAdd **************************************************
+**
+** Add an identifier to the secondary tree of a keyword
+**
+** @param [u] cache [AjPBtcache] cache
+** @param [r] treeblock [ajulong] Root block of the keyword secondary tree
+** @param [r] id [const AjPStr] Identifier
+**
+** @return [AjBool] True if the identifier was added,
+**                  False if it exists already for the keyword
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeKeyidAdd(AjPBtcache cache, ajulong treeblock,
+                            const AjPStr id)
+{
+    AjPBtpage page = NULL;
+    unsigned char *buf = NULL;
+
+    ajuint nodetype = 0U;
+    ajulong right   = 0UL;
+    ajuint savedirty;
+
+    cache->secrootblock = treeblock;
+    page = btreeSeccacheWrite(cache,cache->secrootblock);
+    savedirty = page->dirty;
+    page->dirty = BT_LOCK;
+    page->lockfor = 1281;
+    buf = page->buf;
+    GBT_RIGHT(buf,&right);
+    cache->slevel = (ajuint) right;
+
+    if(!btreeKeyidInsert(cache,id))
+    {
+        page->dirty = savedirty;
+
+        return ajFalse;
+    }
+
+    GBT_NODETYPE(buf,&nodetype);
+
+    if(nodetype != BT_SECBUCKET)
+    {
+        right = (ajulong) cache->slevel;
+        SBT_RIGHT(buf,right);
+        page->dirty = BT_DIRTY;
+    }
+
+    return ajTrue;
+}
+
+
+
+
 /* @funcstatic btreeKeyFind ***************************************************
 **
 ** Get secondary root block matching a keyword
@@ -14180,6 +15064,8 @@ AjPBtcache ajBtreeSeccacheNewC(const char *filetxt, const char *exttxt,
             filelen = buf.st_size;
 
         cache->readonly = ajTrue;
+        cache->mapsize = filelen;
+        btreeCacheMap(cache);
     }
     else if(ajCharMatchC(mode, "rb+"))
     {
@@ -21278,6 +22164,604 @@ static void btreeIdentDupInsert(AjPBtcache cache, const AjPBtId newid,
 
 
 
+/* @func ajBtreeLoadNew *******************************************************
+**
+** Constructor for a bulk load of keys in sorted order into a new index
+**
+** Buckets are filled in turn and each leaf and internal node is written
+** when it is full, building the tree bottom-up. If the index already has
+** keys they are inserted one at a time instead.
+**
+** @param [u] cache [AjPBtcache] cache
+**
+** @return [AjPBtload] Bulk load object
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjPBtload ajBtreeLoadNew(AjPBtcache cache)
+{
+    AjPBtload load = NULL;
+
+    AJNEW0(load);
+
+    load->Cache = cache;
+
+    if(cache->countall)
+        load->Insert = ajTrue;
+
+    return load;
+}
+
+
+
+
+/* @func ajBtreeLoadDel *******************************************************
+**
+** Destructor for a bulk load object. Call ajBtreeLoadEnd first to
+** complete the index.
+**
+** @param [d] Pload [AjPBtload*] Bulk load object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeLoadDel(AjPBtload *Pload)
+{
+    AjPBtload load = NULL;
+    ajuint i;
+    ajuint j;
+
+    if(!Pload || !*Pload)
+        return;
+
+    load = *Pload;
+
+    btreeIdbucketDel(&load->Idbucket);
+    btreePribucketDel(&load->Pribucket);
+
+    for(i=0; i < load->Nlevels; i++)
+    {
+        for(j=0; j <= load->Cache->porder; j++)
+            ajStrDel(&load->Keys[i][j]);
+
+        AJFREE(load->Keys[i]);
+        AJFREE(load->Ptrs[i]);
+    }
+
+    AJFREE(load->Keys);
+    AJFREE(load->Ptrs);
+    AJFREE(load->Nptrs);
+    AJFREE(load->Nnodes);
+    ajStrDel(&load->Lastkey);
+
+    AJFREE(*Pload);
+
+    return;
+}
+
+
+
+
+/* @func ajBtreeLoadIdent *****************************************************
+**
+** Load an ID structure into the tree. IDs must be given in key order.
+** Repeated IDs are stored as duplicates in their order of loading.
+**
+** @param [u] load [AjPBtload] Bulk load object
+** @param [u] id [AjPBtId] Id object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeLoadIdent(AjPBtload load, AjPBtId id)
+{
+    AjPBtcache cache   = load->Cache;
+    AjPIdbucket bucket = NULL;
+    AjPBtId cid = NULL;
+    ajuint iref;
+    int cmp = 1;
+
+    if(load->Insert)
+    {
+        ajBtreeIdentIndex(cache, id);
+
+        return;
+    }
+
+    ajStrFmtQuery(&id->id);
+    ajStrAssignS(&indexId, id->id);
+    ajStrAssignC(&indexKeyword, "(none)");
+
+    if(!MAJSTRGETLEN(id->id))
+        return;
+
+    if(MAJSTRGETLEN(id->id) > cache->keylimit)
+        ajStrTruncateLen(&id->id, cache->keylimit);
+
+    if(!load->Idbucket)
+    {
+        load->Idbucket = btreeIdbucketNew(cache->pnperbucket, cache->refcount);
+        load->Idbucket->Nentries = 0;
+    }
+
+    bucket = load->Idbucket;
+
+    if(MAJSTRGETLEN(load->Lastkey))
+        cmp = strcmp(MAJSTRGETPTR(id->id), MAJSTRGETPTR(load->Lastkey));
+
+    if(cmp < 0)
+        ajFatal("ajBtreeLoadIdent: key '%S' follows '%S' cache %S",
+                id->id, load->Lastkey, cache->filename);
+
+    if(!cmp)
+    {
+        ++cache->countall;
+        btreeIdentDupInsert(cache, id, bucket->Ids[bucket->Nentries-1]);
+
+        return;
+    }
+
+    if(bucket->Nentries == cache->pnperbucket)
+        btreeLoadIdbucket(load);
+
+    cid = bucket->Ids[bucket->Nentries];
+    ajStrAssignS(&cid->id, id->id);
+    cid->dbno   = id->dbno;
+    cid->dups   = id->dups;
+    cid->offset = id->offset;
+
+    for(iref=0; iref < cache->refcount; iref++)
+        cid->refoffsets[iref] = id->refoffsets[iref];
+
+    bucket->keylen[bucket->Nentries] = BT_BUCKIDLEN(id->id) +
+        cache->refcount*BT_EXTRA;
+    ++bucket->Nentries;
+
+    ajStrAssignS(&load->Lastkey, id->id);
+    ++cache->countunique;
+    ++cache->countall;
+
+    return;
+}
+
+
+
+
+/* @func ajBtreeLoadKey *******************************************************
+**
+** Load a keyword and identifier into a secondary keyword index.
+** Keywords must be given in order.
+**
+** @param [u] load [AjPBtload] Bulk load object
+** @param [r] keyword [const AjPStr] keyword
+** @param [r] id [const AjPStr] entry identifier
+**
+** @return [AjBool] True if keyword and ID combination was loaded
+**                  False if keyword exists already for ID
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool ajBtreeLoadKey(AjPBtload load, const AjPStr keyword, const AjPStr id)
+{
+    AjPBtcache cache = load->Cache;
+    AjPPribucket bucket = NULL;
+    AjPBtPri pri = NULL;
+    ajulong secrootpage = 0UL;
+    int cmp = 1;
+
+    if(load->Insert)
+        return ajBtreeKeyIndex(cache, keyword, id);
+
+    if(!MAJSTRGETLEN(keyword))
+	return ajFalse;
+
+    ajStrAssignS(&indexKeyword, keyword);
+    ajStrAssignS(&indexId, id);
+    ajStrFmtQuery(&indexId);
+    ajStrFmtQuery(&indexKeyword);
+
+    if(MAJSTRGETLEN(indexKeyword) > cache->keylimit)
+        ajStrTruncateLen(&indexKeyword, cache->keylimit);
+
+    if(MAJSTRGETLEN(indexId) > cache->idlimit)
+        ajStrTruncateLen(&indexId, cache->idlimit);
+
+    if(!load->Pribucket)
+    {
+        load->Pribucket = btreePribucketNew(cache->pnperbucket);
+        load->Pribucket->Nentries = 0;
+    }
+
+    bucket = load->Pribucket;
+
+    if(MAJSTRGETLEN(load->Lastkey))
+        cmp = strcmp(MAJSTRGETPTR(indexKeyword), MAJSTRGETPTR(load->Lastkey));
+
+    if(cmp < 0)
+        ajFatal("ajBtreeLoadKey: keyword '%S' follows '%S' cache %S",
+                indexKeyword, load->Lastkey, cache->filename);
+
+    if(!cmp)
+    {
+        pri = bucket->codes[bucket->Nentries-1];
+
+        if(!btreeKeyidAdd(cache, pri->treeblock, indexId))
+            return ajFalse;
+
+        ++cache->countall;
+
+        return ajTrue;
+    }
+
+    if(bucket->Nentries == cache->pnperbucket)
+        btreeLoadPribucket(load);
+
+    /* new keyword: its secondary tree starts as a single bucket */
+
+    secrootpage = cache->totsize;
+    btreeWriteSecbucketEmpty(cache,secrootpage);
+    btreeSecbucketAdd(cache,secrootpage,indexId);
+
+    pri = bucket->codes[bucket->Nentries];
+    ajStrAssignS(&pri->keyword, indexKeyword);
+    pri->treeblock = secrootpage;
+    bucket->keylen[bucket->Nentries] = BT_BUCKPRILEN(indexKeyword);
+    ++bucket->Nentries;
+
+    ajStrAssignS(&load->Lastkey, indexKeyword);
+    ++cache->countunique;
+    ++cache->countall;
+
+    return ajTrue;
+}
+
+
+
+
+/* @func ajBtreeLoadEnd *******************************************************
+**
+** Complete a bulk load. The last bucket and the partly filled nodes at
+** each level are written, and the top node is written as the root.
+**
+** @param [u] load [AjPBtload] Bulk load object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void ajBtreeLoadEnd(AjPBtload load)
+{
+    AjPBtcache cache = load->Cache;
+    AjPBtpage page = NULL;
+    AjPStr *keys  = NULL;
+    ajulong *ptrs = NULL;
+    ajulong pagepos;
+    ajuint order;
+    ajuint level;
+    ajuint n;
+
+    if(load->Insert)
+        return;
+
+    btreeLoadIdbucket(load);
+    btreeLoadPribucket(load);
+
+    if(!load->Nlevels)
+        return;
+
+    order = cache->porder;
+
+    /*
+    ** Write the remaining nodes at each level until one level has
+    ** a single node, which becomes the root.
+    ** A full node and one more child are written as two nodes.
+    */
+
+    for(level=0; ; level++)
+    {
+        btreeLoadLevel(load, level);
+        n = load->Nptrs[level];
+
+        if(!load->Nnodes[level] && n <= order)
+            break;
+
+        if(n > order)
+        {
+            btreeLoadWrite(load, level, 0, n/2);
+            btreeLoadWrite(load, level, n/2, n - n/2);
+        }
+        else
+            btreeLoadWrite(load, level, 0, n);
+
+        load->Nptrs[level] = 0;
+    }
+
+    keys = load->Keys[level];
+    ptrs = load->Ptrs[level];
+
+    if(n == 1)
+    {
+        /* a single bucket: add an empty bucket on the left */
+
+        pagepos = cache->totsize;
+
+        if(load->Pribucket)
+            btreeWritePribucketEmpty(cache,pagepos);
+        else
+            btreeWriteIdbucketEmpty(cache,pagepos);
+
+        ajStrAssignS(&keys[1], keys[0]);
+        ptrs[1] = ptrs[0];
+        ptrs[0] = pagepos;
+        n = 2;
+    }
+
+    page = btreePricacheLocate(cache,0UL);
+
+    if(!page)
+        ajFatal("ajBtreeLoadEnd: root page has been unlocked cache %S",
+                cache->filename);
+
+    btreeWriteNode(cache,page,&keys[1],ptrs,n-1);
+    page->dirty = BT_LOCK;
+    page->lockfor = 1991;
+
+    cache->plevel = level;
+
+    ajDebug("ajBtreeLoadEnd '%S' keys %Lu levels %u\n",
+            cache->basename, cache->countunique, cache->plevel);
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeLoadIdbucket **********************************************
+**
+** Write the identifier bucket being filled by a bulk load
+**
+** @param [u] load [AjPBtload] Bulk load object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeLoadIdbucket(AjPBtload load)
+{
+    AjPIdbucket bucket = load->Idbucket;
+    ajulong pagepos;
+
+    if(!bucket || !bucket->Nentries)
+        return;
+
+    pagepos = load->Cache->totsize;
+    btreeWriteIdbucket(load->Cache,bucket,pagepos);
+    btreeLoadChild(load, 0, bucket->Ids[0]->id, pagepos);
+
+    bucket->Nentries = 0;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeLoadPribucket *********************************************
+**
+** Write the keyword bucket being filled by a bulk load
+**
+** @param [u] load [AjPBtload] Bulk load object
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeLoadPribucket(AjPBtload load)
+{
+    AjPPribucket bucket = load->Pribucket;
+    ajulong pagepos;
+
+    if(!bucket || !bucket->Nentries)
+        return;
+
+    pagepos = load->Cache->totsize;
+    btreeWritePribucket(load->Cache,bucket,pagepos);
+    btreeLoadChild(load, 0, bucket->codes[0]->keyword, pagepos);
+
+    bucket->Nentries = 0;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeLoadChild *************************************************
+**
+** Add a child page to the node being filled at one level of a bulk load.
+**
+** A node is written when another child arrives after it is full. The
+** last child is kept for the next node, so no node is left with a
+** single child.
+**
+** @param [u] load [AjPBtload] Bulk load object
+** @param [r] level [ajuint] Level, zero for leaf nodes
+** @param [r] key [const AjPStr] First key under the child page
+** @param [r] pagepos [ajulong] Child page number
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeLoadChild(AjPBtload load, ajuint level,
+                           const AjPStr key, ajulong pagepos)
+{
+    ajuint order = load->Cache->porder;
+    ajuint n;
+
+    btreeLoadLevel(load, level);
+
+    n = load->Nptrs[level];
+
+    if(n > order)
+    {
+        btreeLoadWrite(load, level, 0, order);
+
+        ajStrAssignS(&load->Keys[level][0], load->Keys[level][order]);
+        load->Ptrs[level][0] = load->Ptrs[level][order];
+        n = 1;
+    }
+
+    ajStrAssignS(&load->Keys[level][n], key);
+    load->Ptrs[level][n] = pagepos;
+    load->Nptrs[level] = n + 1;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeLoadLevel *************************************************
+**
+** Make sure a bulk load has node arrays for a level
+**
+** @param [u] load [AjPBtload] Bulk load object
+** @param [r] level [ajuint] Level, zero for leaf nodes
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeLoadLevel(AjPBtload load, ajuint level)
+{
+    ajuint nlevels = load->Nlevels;
+
+    if(level < nlevels)
+        return;
+
+    AJCRESIZE0(load->Keys, nlevels, level+1);
+    AJCRESIZE0(load->Ptrs, nlevels, level+1);
+    AJCRESIZE0(load->Nptrs, nlevels, level+1);
+    AJCRESIZE0(load->Nnodes, nlevels, level+1);
+
+    for(; nlevels <= level; nlevels++)
+    {
+        AJCNEW0(load->Keys[nlevels], load->Cache->porder+1);
+        AJCNEW0(load->Ptrs[nlevels], load->Cache->porder+1);
+    }
+
+    load->Nlevels = nlevels;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeLoadWrite *************************************************
+**
+** Write a node from children at one level of a bulk load and add it as
+** a child at the level above.
+**
+** Leaf nodes are linked to their neighbours. Child nodes are given their
+** parent page number.
+**
+** @param [u] load [AjPBtload] Bulk load object
+** @param [r] level [ajuint] Level, zero for leaf nodes
+** @param [r] first [ajuint] First child
+** @param [r] n [ajuint] Number of children
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeLoadWrite(AjPBtload load, ajuint level,
+                           ajuint first, ajuint n)
+{
+    AjPBtcache cache = load->Cache;
+    AjPBtpage page  = NULL;
+    AjPBtpage tpage = NULL;
+    AjPStr *keys  = &load->Keys[level][first];
+    ajulong *ptrs = &load->Ptrs[level][first];
+    unsigned char *buf = NULL;
+    ajulong pagepos;
+    ajulong lv = 0UL;
+    ajuint v   = 0U;
+    ajuint i;
+
+    page = btreePricacheNodenew(cache);
+    pagepos = page->pagepos;
+    buf = page->buf;
+
+    v = level ? BT_INTERNAL : BT_LEAF;
+    SBT_NODETYPE(buf,v);
+    lv = 0UL;
+    SBT_PREV(buf,lv);
+    lv = 0UL;
+    SBT_RIGHT(buf,lv);
+    lv = level ? 0UL : load->Lastleaf;
+    SBT_LEFT(buf,lv);
+
+    btreeWriteNode(cache,page,&keys[1],ptrs,n-1);
+    page->dirty = BT_DIRTY;
+
+    if(level)
+    {
+        for(i=0; i < n; i++)
+        {
+            tpage = btreePricacheRead(cache,ptrs[i]);
+            lv = pagepos;
+            SBT_PREV(tpage->buf,lv);
+            tpage->dirty = BT_DIRTY;
+        }
+    }
+    else
+    {
+        if(load->Lastleaf)
+        {
+            tpage = btreePricacheRead(cache,load->Lastleaf);
+            lv = pagepos;
+            SBT_RIGHT(tpage->buf,lv);
+            tpage->dirty = BT_DIRTY;
+        }
+
+        load->Lastleaf = pagepos;
+    }
+
+    ++load->Nnodes[level];
+
+    btreeLoadChild(load, level+1, keys[0], pagepos);
+
+    return;
+}
+
+
+
+
 #if 0
 /* #funcstatic btreeHybbucketIdlist *******************************************
 **
@@ -34731,6 +36215,24 @@ static void btreeNocacheFetch(const AjPBtcache cache, AjPBtpage cpage,
     else
         pagesize = cache->secpagesize;
 
+    if(btreeCacheMapFetch(cache, cpage, pagepos, pagesize))
+    {
+        if(ajBtreePageIsPrimary(cpage))
+        {
+            if(cache->pripagesize > pagesize)
+                pagesize = cache->pripagesize;
+        }
+        else if(cache->secpagesize > pagesize)
+            pagesize = cache->secpagesize;
+
+        if(btreeCacheMapFetch(cache, cpage, pagepos, pagesize))
+        {
+            cpage->pagepos = pagepos;
+
+            return;
+        }
+    }
+
     if(fseek(cache->fp,pagepos,SEEK_SET))
 	ajFatal("Seek error '%s' in btreeNocacheFetch file %S",
                 strerror(ferror(cache->fp)), cache->filename);
@@ -35429,6 +36931,50 @@ ajulong ajBtreeHitrefHash(const void* key, ajulong hashsize)
 
 
 
+/* @func ajBtreeHitCompPos ****************************************************
+**
+** Comparison function for ajListSort to sort B+tree hit objects into
+** database file order, so that the entries can be read sequentially.
+**
+** @param [r] item1 [const void*] Pointer to first hit
+** @param [r] item2 [const void*] Pointer to second hit
+** @return [ajint] Comparison result.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajint ajBtreeHitCompPos(const void* item1, const void* item2)
+{
+    return ajBtreeHitCmp(*(AjPBtHit const *) item1,
+                         *(AjPBtHit const *) item2);
+}
+
+
+
+
+/* @func ajBtreeHitrefCompPos *************************************************
+**
+** Comparison function for ajListSort to sort B+tree reference hit objects
+** into database file order, so that the entries can be read sequentially.
+**
+** @param [r] item1 [const void*] Pointer to first reference hit
+** @param [r] item2 [const void*] Pointer to second reference hit
+** @return [ajint] Comparison result.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajint ajBtreeHitrefCompPos(const void* item1, const void* item2)
+{
+    return ajBtreeHitrefCmp(*(AjPBtHitref const *) item1,
+                            *(AjPBtHitref const *) item2);
+}
+
+
+
+
 #if AJINDEX_STATIC
 /* @funcstatic btreePageDump **************************************************
 **
@@ -450,6 +450,11 @@ typedef struct AjSBtpage
 ** @attr replace [AjPStr] Replacement ID
 ** @attr pripagetable [AjPTable] Table of cached primary pages
 ** @attr secpagetable [AjPTable] Table of cached secondary pages
+** @attr pageseen [AjPTable] Table of pages read from disk, used to
+**                          measure the working set
+** @attr mapbase [const unsigned char*] Read-only memory map of the index
+**                                      file or NULL if pages are read
+**                                      with fread
 ** @attr totsize [ajulong] Tree index total length used
 ** @attr maxsize [ajulong] Tree index total length available
 ** @attr filesize [ajulong] Tree index length after any compression
@@ -465,6 +470,23 @@ typedef struct AjSBtpage
 ** @attr secreads [ajulong] Number of physical secondary page reads from disk
 ** @attr priwrites [ajulong] Number of physical primary page writes to disk
 ** @attr secwrites [ajulong] Number of physical secondary page writes to disk
+** @attr mapsize [ajulong] Length of the memory mapped index file
+** @attr prievictions [ajulong] Number of primary pages evicted from the cache
+** @attr secevictions [ajulong] Number of secondary pages evicted from
+**                              the cache
+** @attr pribytes [ajulong] Number of bytes read for primary pages
+** @attr secbytes [ajulong] Number of bytes read for secondary pages
+** @attr prirereads [ajulong] Number of primary page reads of pages read
+**                            before, which a larger cache would have kept
+** @attr secrereads [ajulong] Number of secondary page reads of pages read
+**                            before, which a larger cache would have kept
+** @attr pridistinct [ajulong] Number of different primary pages read,
+**                             the primary working set
+** @attr secdistinct [ajulong] Number of different secondary pages read,
+**                             the secondary working set
+** @attr nodereads [ajulong] Number of root and internal node page reads
+** @attr leafreads [ajulong] Number of leaf node page reads
+** @attr bucketreads [ajulong] Number of bucket and overflow page reads
 ** @attr pripagesize [ajuint] Size of primary cache pages
 ** @attr secpagesize [ajuint] Size of secondary cache pages
 ** @attr prilistLength [ajuint] Number of pages in primary cache
@@ -484,6 +506,7 @@ typedef struct AjSBtpage
 ** @attr readonly [AjBool] Read only flag
 ** @attr dodelete [AjBool] Deletion flag
 ** @attr compressed [AjBool] Index is compressed
+** @attr pagestats [AjBool] Count rereads and distinct pages read
 ******************************************************************************/
 
 typedef struct AjSBtCache
@@ -502,6 +525,8 @@ typedef struct AjSBtCache
     AjPStr replace;
     AjPTable pripagetable;
     AjPTable secpagetable;
+    AjPTable pageseen;
+    const unsigned char *mapbase;
     ajulong totsize;
     ajulong maxsize;
     ajulong filesize;
@@ -517,6 +542,18 @@ typedef struct AjSBtCache
     ajulong secreads;
     ajulong priwrites;
     ajulong secwrites;
+    ajulong mapsize;
+    ajulong prievictions;
+    ajulong secevictions;
+    ajulong pribytes;
+    ajulong secbytes;
+    ajulong prirereads;
+    ajulong secrereads;
+    ajulong pridistinct;
+    ajulong secdistinct;
+    ajulong nodereads;
+    ajulong leafreads;
+    ajulong bucketreads;
     ajuint pripagesize;
     ajuint secpagesize;
     ajuint prilistLength;
@@ -536,6 +573,7 @@ typedef struct AjSBtCache
     AjBool readonly;
     AjBool dodelete;
     AjBool compressed;
+    AjBool pagestats;
 } AjOBtcache;
 
 #define AjPBtcache AjOBtcache*
@@ -655,6 +693,48 @@ typedef struct AjSBtKeywild
 
 
 
+/* @data AjPBtload ************************************************************
+**
+** Btree bulk load of keys given in sorted order. Buckets and nodes are
+** filled and written bottom-up as the keys arrive.
+**
+** @attr Cache [AjPBtcache] Index cache
+** @attr Idbucket [AjPIdbucket] Identifier bucket being filled
+** @attr Pribucket [AjPPribucket] Keyword bucket being filled
+** @attr Keys [AjPStr**] First key under each child of the node being
+**                       filled at each level
+** @attr Ptrs [ajulong**] Child page numbers of the node being filled at
+**                        each level
+** @attr Nptrs [ajuint*] Number of children of the node being filled at
+**                       each level
+** @attr Nnodes [ajulong*] Number of nodes written at each level
+** @attr Lastkey [AjPStr] Last key loaded
+** @attr Lastleaf [ajulong] Page number of the last leaf node written
+** @attr Nlevels [ajuint] Number of levels allocated
+** @attr Insert [AjBool] True if the index was not empty, so keys are
+**                       inserted one at a time
+******************************************************************************/
+
+typedef struct AjSBtload
+{
+    AjPBtcache Cache;
+    AjPIdbucket Idbucket;
+    AjPPribucket Pribucket;
+    AjPStr **Keys;
+    ajulong **Ptrs;
+    ajuint *Nptrs;
+    ajulong *Nnodes;
+    AjPStr Lastkey;
+    ajulong Lastleaf;
+    ajuint Nlevels;
+    AjBool Insert;
+} AjOBtload;
+
+#define AjPBtload AjOBtload*
+
+
+
+
 #if 0
 /* #data AjPBtHybrid **********************************************************
 **
@@ -943,6 +1023,7 @@ ajulong      ajBtreeCacheGetTotsize(const AjPBtcache cache);
 
 AjBool       ajBtreeCacheIsCompressed(const AjPBtcache cache);
 AjBool       ajBtreeCacheIsSecondary(const AjPBtcache thys);
+void         ajBtreeCacheSetPagestats(AjPBtcache cache, AjBool dostats);
 
 ajuint       ajBtreePageGetSize(const AjPBtpage page, ajuint refcount);
 const char*  ajBtreePageGetTypename(const AjPBtpage page);
@@ -1066,6 +1147,11 @@ void         ajBtreeIdentFetchwildHit(AjPBtcache cache,
                                    const AjPStr key, AjPList idlist);
 void         ajBtreeIdentFetchHitref(AjPBtcache cache, const AjPStr key,
                                      AjPList idlist);
+void         ajBtreeIdentFetchlistHit(AjPBtcache cache, const AjPList keys,
+                                      AjPList hitlist, AjPList misslist);
+void         ajBtreeIdentFetchlistHitref(AjPBtcache cache,
+                                         const AjPList keys,
+                                         AjPList hitlist, AjPList misslist);
 void         ajBtreeIdentFetchwildHitref(AjPBtcache cache,
                                    const AjPStr key, AjPList idlist);
 
@@ -1101,6 +1187,13 @@ void         ajBtreeIdentIndex(AjPBtcache cache, AjPBtId id);
 AjBool       ajBtreeKeyIndex(AjPBtcache cache, const AjPStr keyword,
                              const AjPStr id);
 
+AjPBtload    ajBtreeLoadNew(AjPBtcache cache);
+void         ajBtreeLoadDel(AjPBtload *Pload);
+void         ajBtreeLoadIdent(AjPBtload load, AjPBtId id);
+AjBool       ajBtreeLoadKey(AjPBtload load, const AjPStr keyword,
+                            const AjPStr id);
+void         ajBtreeLoadEnd(AjPBtload load);
+
 void         ajBtreeDumpIdentifiers(AjPBtcache cache, ajuint dmin, ajuint dmax,
                                     AjPFile outf);
 
@@ -1111,9 +1204,11 @@ ajint        ajBtreeIdCmp(const void *x, const void *y);
 ajulong      ajBtreeIdHash(const void *x, ajulong hashsize);
 
 ajint        ajBtreeHitCmp(const void *x, const void *y);
+ajint        ajBtreeHitCompPos(const void *item1, const void *item2);
 ajulong      ajBtreeHitHash(const void *x, ajulong hashsize);
 
 ajint        ajBtreeHitrefCmp(const void *x, const void *y);
+ajint        ajBtreeHitrefCompPos(const void *item1, const void *item2);
 ajulong      ajBtreeHitrefHash(const void *x, ajulong hashsize);
 
 void         ajBtreeCacheStatsOut(AjPFile outf, const AjPBtcache cache,
@@ -1121,6 +1216,7 @@ void         ajBtreeCacheStatsOut(AjPFile outf, const AjPBtcache cache,
                                   ajulong* Pprireads, ajulong* Psecreads,
                                   ajulong* Ppriwrites, ajulong* Psecwrites,
                                   ajulong *Pprisize, ajulong *Psecsize);
+void         ajBtreeCacheStatsReport(AjPFile outf, const AjPBtcache cache);
 void         ajBtreeStatsOut(AjPFile outf,
                              ajulong* Psplitrootid,  ajulong* Psplitrootnum,
                              ajulong* Psplitrootkey, ajulong* Psplitrootsec,
@@ -5241,9 +5241,9 @@ static AjBool namSvrCacheParse(AjPFile cachefile, AjPTable dbtable,
 {
     AjBool ret = ajTrue;
     AjPStr rdline = NULL;
-    AjPStr word   = NULL;
     const char *ptr;
-    ajint i = 0;
+    const char *end;
+    const char *wordstart;
     ajint len;
     char quote = '\0';
     AjPList listwords;
@@ -5258,7 +5258,6 @@ static AjBool namSvrCacheParse(AjPFile cachefile, AjPTable dbtable,
 
     listwords = ajListstrNew();
     listcount = ajListNew();
-    word      = ajStrNewRes(128);
 
     /* Read in the settings. */
     while(ajReadlineTrim(cachefile, &rdline))
@@ -5273,30 +5272,32 @@ static AjBool namSvrCacheParse(AjPFile cachefile, AjPTable dbtable,
 
 	len = ajStrGetLen(rdline);
 
-	/* now create a linked list of the "words" */
+	/*
+	** now create a linked list of the "words"
+	** each word is copied in one piece from the line buffer
+	*/
 	if(len)
 	{
 	    ptr = ajStrGetPtr(rdline);
-	    i = 0;
+	    end = ptr + len;
+	    wordstart = NULL;
 
-	    while(*ptr && i < len)
+	    for(; *ptr && ptr < end; ptr++)
 	    {
 		if(*ptr == ' ' || *ptr == '\t')
 		{
-		    if(ajStrGetLen(word))
+		    if(wordstart)
 		    {
-			wordptr = ajStrNewS(word);
+			wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+						  ptr-wordstart);
 			ajListstrPushAppend(listwords, wordptr);
-			ajStrAssignClear(&word);
+			wordstart = NULL;
 		    }
-
-		    i++;
-		    ptr++;
-		    continue;
 		}
 		else if(*ptr == '\'' || *ptr == '\"')
 		{
-		    ajStrAppendK(&word,*ptr);
+		    if(!wordstart)
+			wordstart = ptr;
 
 		    if(quote)
 		    {
@@ -5306,29 +5307,25 @@ static AjBool namSvrCacheParse(AjPFile cachefile, AjPTable dbtable,
 		    else
 			quote = *ptr;
 		}
-		else if(!quote && ajStrGetLen(word) && *ptr == ']')
+		else if(!quote && wordstart && *ptr == ']')
 		{
-		    wordptr = ajStrNewS(word);
+		    wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+					      ptr-wordstart);
 		    ajListstrPushAppend(listwords, wordptr);
-		    ajStrAssignClear(&word);
 		    wordptr = ajStrNewC("]");
 		    ajListstrPushAppend(listwords, wordptr);
-		    ajStrAssignClear(&word);
+		    wordstart = NULL;
 		}
-		else
-		    ajStrAppendK(&word,*ptr);
-
-		i++;
-                ptr++;
+		else if(!wordstart)
+		    wordstart = ptr;
 	    }
 
-	    if(ajStrGetLen(word))
+	    if(wordstart)
 	    {
-		wordptr = ajStrNewS(word);
+		wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+					  ptr-wordstart);
 		ajListstrPushAppend(listwords, wordptr);
-		ajStrAssignClear(&word);
 	    }
-	    
 	}
     }
 
@@ -5348,7 +5345,6 @@ static AjBool namSvrCacheParse(AjPFile cachefile, AjPTable dbtable,
 
     ajListFree(&listwords);
     ajListFree(&listcount);
-    ajStrDel(&word);
 
     return ret;
 }
@@ -6303,9 +6299,9 @@ static AjBool namSvrCacheRead(const AjPStr server, const AjPStr cachename)
 static AjBool namProcessFile(AjPFile file, const AjPStr shortname)
 {
     AjPStr rdline = NULL;
-    AjPStr word   = NULL;
     const char *ptr;
-    ajint i = 0;
+    const char *end;
+    const char *wordstart;
     ajint len;
     char quote = '\0';
     AjPList listwords;
@@ -6318,7 +6314,6 @@ static AjBool namProcessFile(AjPFile file, const AjPStr shortname)
     
     listwords = ajListstrNew();
     listcount = ajListNew();
-    word      = ajStrNewRes(128);
     
     ajFmtPrintS(&namFileName, "%F", file);
     namUser("namProcessFile '%F'\n", file);
@@ -6338,30 +6333,32 @@ static AjBool namProcessFile(AjPFile file, const AjPStr shortname)
 	/* namUser("%S\n",rdline); */
 	len = ajStrGetLen(rdline);
 	
-	/* now create a linked list of the "words" */
+	/*
+	** now create a linked list of the "words"
+	** each word is copied in one piece from the line buffer
+	*/
 	if(len)
 	{
 	    ptr = ajStrGetPtr(rdline);
-	    i = 0;
+	    end = ptr + len;
+	    wordstart = NULL;
 
-	    while(*ptr && i < len)
+	    for(; *ptr && ptr < end; ptr++)
 	    {
 		if(*ptr == ' ' || *ptr == '\t')
 		{
-		    if(ajStrGetLen(word))
+		    if(wordstart)
 		    {
-			wordptr = ajStrNewS(word);
+			wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+						  ptr-wordstart);
 			ajListstrPushAppend(listwords, wordptr);
-			ajStrAssignClear(&word);
+			wordstart = NULL;
 		    }
-
-		    i++;
-		    ptr++;
-		    continue;
 		}
 		else if(*ptr == '\'' || *ptr == '\"')
 		{
-		    ajStrAppendK(&word,*ptr);
+		    if(!wordstart)
+			wordstart = ptr;
 
 		    if(quote)
 		    {
@@ -6371,27 +6368,25 @@ static AjBool namProcessFile(AjPFile file, const AjPStr shortname)
 		    else
 			quote = *ptr;
 		}
-		else if(!quote && ajStrGetLen(word) && *ptr == ']')
+		else if(!quote && wordstart && *ptr == ']')
 		{
-		    wordptr = ajStrNewS(word);
+		    wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+					      ptr-wordstart);
 		    ajListstrPushAppend(listwords, wordptr);
-		    ajStrAssignClear(&word);
 		    wordptr = ajStrNewC("]");
 		    ajListstrPushAppend(listwords, wordptr);
-		    ajStrAssignClear(&word);
+		    wordstart = NULL;
 		}
-		else
-		    ajStrAppendK(&word,*ptr);
-		i++;ptr++;
+		else if(!wordstart)
+		    wordstart = ptr;
 	    }
 
-	    if(ajStrGetLen(word))
+	    if(wordstart)
 	    {
-		wordptr = ajStrNewS(word);
+		wordptr = ajStrNewResLenC(wordstart, ptr-wordstart+1,
+					  ptr-wordstart);
 		ajListstrPushAppend(listwords, wordptr);
-		ajStrAssignClear(&word);
 	    }
-	    
 	}
     }
 
@@ -6418,7 +6413,6 @@ static AjBool namProcessFile(AjPFile file, const AjPStr shortname)
     
     namDebugVariables();
     namDebugAliases();
-    ajStrDel(&word);
     
     namUser("namProcessFile done '%F'\n", file);
 
@@ -9285,6 +9279,10 @@ AjBool ajNamResolve(AjPStr* name)
     AjPStr restname = NULL;
     AjBool ret;
 
+    /* most values are plain text: skip the regular expression */
+    if(ajStrGetCharFirst(*name) != '$')
+	return ajFalse;
+
     if(!namNameExp)
 	namNameExp = ajRegCompC("^\\$([A-Za-z0-9_]+)");
 
@@ -1328,6 +1328,9 @@ void ajPatCompDel (AjPPatComp *pthys)
 
         AJFREE(thys->skipm);
     }
+
+    if(thys->wmtable)
+      AJFREE(thys->wmtable);
     
     AJFREE(*pthys);
 
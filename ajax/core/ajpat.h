@@ -111,6 +111,7 @@ typedef struct AjSPatBYPNode
 ** @attr m [ajuint] Real length of pattern (from embPatGetType)
 ** @attr regex [AjPStr] PCRE regexp string
 ** @attr skipm [ajuint**] Skip buffer for Tarhio-Ukkonen
+** @attr wmtable [ajulong*] Character bit masks for Wu-Manber search
 ** @attr amino [AjBool] Must match left begin
 ** @attr carboxyl [AjBool] Must match right
 **
@@ -129,6 +130,7 @@ typedef struct AjSPatComp
     ajuint m;
     AjPStr regex;
     ajuint** skipm;
+    ajulong* wmtable;
     AjBool amino;
     AjBool carboxyl;
 } AjOPatComp;
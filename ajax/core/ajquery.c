@@ -33,6 +33,7 @@
 #include "ajtextread.h"
 #include "ajnam.h"
 #include "ajresource.h"
+#include "ajfileio.h"
 
 static AjBool    queryRegInitDone = AJFALSE;
 
@@ -66,6 +67,7 @@ static AjBool queryDbfind(AjPStr *Pdb, const AjPStr querySvr,
                           AjBool findformat(const AjPStr format,
                                             ajint *iformat),
                           AjPQuery qry, AjBool* dbstat, AjBool* drcatstat);
+static AjBool queryIdlistRead(AjPStr *Pqryfields);
 
 
 static const char* queryDatatypeName[] =
@@ -2332,6 +2334,20 @@ AjBool ajQuerystrParseRead(AjPStr *Pqry, AjPTextin textin,
 
     ajStrTrimWhite(&qry->QryFields);
 
+    /*
+    ** @filename is a list of identifiers to be fetched together
+    */
+
+    if(ajStrGetCharFirst(qry->QryFields) == '@')
+    {
+        if(!queryIdlistRead(&qry->QryFields))
+        {
+            ajStrDel(&qry->QryFields);
+
+            return ajFalse;
+        }
+    }
+
     if(*MAJSTRGETPTR(braceopen))
     {
         if(*MAJSTRGETPTR(braceclose))
@@ -2950,6 +2966,79 @@ static AjBool queryDbfind(AjPStr *Pdb, const AjPStr svr,
 
 
 
+/* @funcstatic queryIdlistRead ************************************************
+**
+** Reads the identifiers for a list query '@filename' and replaces the
+** query fields with the identifiers separated by '|'
+**
+** Identifiers can be separated by white space, commas, semicolons or
+** '|' on any number of lines. Comments start with '#'.
+**
+** @param [u] Pqryfields [AjPStr*] Query fields '@filename', returned as
+**                                 the list of identifiers
+** @return [AjBool] ajTrue if any identifiers were read
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool queryIdlistRead(AjPStr *Pqryfields)
+{
+    AjPFile listfile = NULL;
+    AjPStr filename = NULL;
+    AjPStr line = NULL;
+    AjPStr idstr = NULL;
+    AjPStrTok handle = NULL;
+    AjBool ret = ajFalse;
+
+    ajStrAssignSubS(&filename, *Pqryfields, 1, -1);
+    ajStrTrimWhite(&filename);
+
+    listfile = ajFileNewInNameS(filename);
+
+    if(!listfile)
+    {
+        ajErr("Unable to open identifier list file '%S'", filename);
+        ajStrDel(&filename);
+
+        return ajFalse;
+    }
+
+    ajStrAssignClear(Pqryfields);
+
+    while(ajReadlineTrim(listfile, &line))
+    {
+        ajStrCutComments(&line);
+        ajStrTokenAssignC(&handle, line, " \t\n\r,;|");
+
+        while(ajStrTokenNextParse(handle, &idstr))
+        {
+            if(ret)
+                ajStrAppendK(Pqryfields, '|');
+
+            ajStrAppendS(Pqryfields, idstr);
+            ret = ajTrue;
+        }
+    }
+
+    if(!ret)
+        ajErr("No identifiers found in list file '%S'", filename);
+
+    ajDebug("queryIdlistRead '%S' length %Lu\n",
+            filename, ajStrGetLen(*Pqryfields));
+
+    ajFileClose(&listfile);
+    ajStrTokenDel(&handle);
+    ajStrDel(&filename);
+    ajStrDel(&line);
+    ajStrDel(&idstr);
+
+    return ret;
+}
+
+
+
+
 /* @funcstatic queryRegInit ***************************************************
 **
 ** Initialised regular expressions for parsing queries
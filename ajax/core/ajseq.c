@@ -4379,6 +4379,9 @@ void ajSeqTrace(const AjPSeq seq)
     AjPStr cur;
     ajint i;
 
+    if(!ajDebugOn())                /* skip the counts if nothing is written */
+        return;
+
     ajDebug("Sequence trace\n");
     ajDebug( "==============\n\n");
     ajDebug( "  Name: '%S'\n", seq->Name);
@@ -33,6 +33,7 @@
 #include "ajseqbam.h"
 #include "ajassert.h"
 #include "ajlist.h"
+#include "ajnam.h"
 #include "ajtable.h"
 #include "ajutil.h"
 #include "ajsys.h"
@@ -43,6 +44,10 @@
 #include <errno.h>
 #include <fcntl.h>
 
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif /* HAVE_LIBPTHREAD */
+
 
 #ifndef WIN32
 #include <sys/file.h>
@@ -63,6 +68,7 @@ const char *bam_nt16_rev_table = "=ACMGRSVTWYHKDBN";
 
 static AjBool bamBigendian   = ajFalse;
 static AjBool bamInitialized = ajFalse;
+static ajint  bamThreads     = -1;
 
 const char *o_hd_tags[] = {"SO","GO",NULL};
 const char *r_hd_tags[] = {"VN",NULL};
@@ -148,12 +154,111 @@ typedef struct BamSHeaderLine
 
 #define BamPHeaderLine BamOHeaderLine*
 
+
+
+
+/* @datastatic BamPBgzfSlot ***************************************************
+**
+** One BGZF block passed between the calling thread and the workers
+**
+** @attr uncompressed_block [void*] Uncompressed block data
+** @attr compressed_block [void*] Compressed block data
+** @attr error [const char*] Error description, or NULL
+** @attr block_address [ajlong] File offset of the compressed block
+** @attr end_address [ajlong] File offset after the compressed block
+** @attr length [int] Compressed length when reading,
+**                    uncompressed length when writing
+** @attr result [int] Uncompressed length when reading,
+**                    compressed length when writing, -1 on error
+** @attr remaining [int] Uncompressed data left for another block
+** @attr state [int] Free, queued, busy or done
+******************************************************************************/
+
+typedef struct BamSBgzfSlot
+{
+    void *uncompressed_block;
+    void *compressed_block;
+    const char *error;
+    ajlong block_address;
+    ajlong end_address;
+    int length;
+    int result;
+    int remaining;
+    int state;
+} BamOBgzfSlot;
+
+#define BamPBgzfSlot BamOBgzfSlot*
+
+
+
+
+/* @datastatic BamPBgzfPool ***************************************************
+**
+** Worker threads of a BGZF file, with a ring of blocks read ahead or
+** waiting to be written in file order
+**
+** @attr Slots [BamPBgzfSlot] Ring of blocks
+** @attr End [ajlong] File offset after the last block returned for reading
+** @attr Nslots [ajuint] Number of blocks in the ring
+** @attr Nthreads [ajuint] Number of worker threads
+** @attr Head [ajuint] Oldest block in the ring
+** @attr Count [ajuint] Number of blocks in use
+** @attr Next [ajuint] Next queued block to be taken by a worker
+** @attr Queued [ajuint] Number of blocks waiting for a worker
+** @attr Busy [ajuint] Number of blocks being processed by workers
+** @attr Depth [ajuint] Number of blocks to read ahead, doubled on each
+**                      block read after a seek
+** @attr Eof [AjBool] Read ahead has reached the end of the file or an error
+** @attr Exit [AjBool] Workers are asked to stop
+** @attr Write [AjBool] Workers compress blocks rather than uncompress
+** @attr is_uncompressed [char] Write blocks without compression
+** @attr Padding [char[3]] Padding to alignment boundary
+** @attr Threads [pthread_t*] Worker threads
+** @attr Lock [pthread_mutex_t] Protects the ring counters and block states
+** @attr Work [pthread_cond_t] Signalled when a block is queued or on exit
+** @attr Done [pthread_cond_t] Signalled when a worker finishes a block
+******************************************************************************/
+
+typedef struct BamSBgzfPool
+{
+    BamPBgzfSlot Slots;
+    ajlong End;
+    ajuint Nslots;
+    ajuint Nthreads;
+    ajuint Head;
+    ajuint Count;
+    ajuint Next;
+    ajuint Queued;
+    ajuint Busy;
+    ajuint Depth;
+    AjBool Eof;
+    AjBool Exit;
+    AjBool Write;
+    char is_uncompressed;
+    char Padding[3];
+#ifdef HAVE_LIBPTHREAD
+    pthread_t *Threads;
+    pthread_mutex_t Lock;
+    pthread_cond_t Work;
+    pthread_cond_t Done;
+#endif /* HAVE_LIBPTHREAD */
+} BamOBgzfPool;
+
+#define BamPBgzfPool BamOBgzfPool*
+
 const char *bam_flag2char_table = "pPuUrR12sfd\0\0\0\0\0";
 
+static AjBool         bamBgzfAtEnd(const AjPSeqBamBgzf fp);
 static AjPSeqBamBgzf  bamBgzfNew(void);
+static ajlong         bamBgzfNextAddress(const AjPSeqBamBgzf fp);
 static void           bamCacheFree(AjPSeqBamBgzf fp);
 static int            bamCacheLoadBlock(AjPSeqBamBgzf fp, ajlong block_address);
 static int            bamDeflateBlock(AjPSeqBamBgzf fp, int block_length);
+static int            bamDeflateBuffer(void* uncompressed_block,
+                                       int block_length,
+                                       char* buffer, int buffer_size,
+                                       char is_uncompressed,
+                                       int* Premaining, const char** Perror);
 static void           bamDestroyHeaderHash(AjPSeqBamHeader header);
 static unsigned char *bamGetAux(const AjPSeqBam b, const char tag[2]);
 static int            bamHeaderCheck(const char *header);
@@ -169,6 +274,11 @@ static AjPTable       bamHeaderTotable(const AjPList _dict, const char type[2],
                                       const char key_tag[2],
                                       const char value_tag[2]);
 static int            bamInflateBlock(AjPSeqBamBgzf fp, int block_length);
+static int            bamInflateBuffer(const void* compressed_block,
+                                       int block_length,
+                                       void* uncompressed_block,
+                                       int uncompressed_size,
+                                       const char** Perror);
 static int            bamReadBlock(AjPSeqBamBgzf fp);
 static void           bamSwapEndianData(const AjPSeqBamCore c, int data_len,
                                         unsigned char *data);
@@ -177,6 +287,18 @@ static BamPHeaderTag  bamTagNew(const char *name, const char *value_from,
 
 static const char*    bamNextline(char **lineptr, size_t *n, const char *text);
 static int            bamTagExists(const char *tag, const char **tags);
+static ajuint         bamThreadsDefault(void);
+
+#ifdef HAVE_LIBPTHREAD
+static void           bamPoolDel(AjPSeqBamBgzf fp);
+static void           bamPoolFill(AjPSeqBamBgzf fp);
+static AjBool         bamPoolNew(AjPSeqBamBgzf fp, ajuint nthreads);
+static int            bamPoolReadBlock(AjPSeqBamBgzf fp);
+static void           bamPoolReset(AjPSeqBamBgzf fp, ajlong block_address);
+static void*          bamPoolWork(void* arg);
+static int            bamPoolWriteBlock(AjPSeqBamBgzf fp);
+static int            bamPoolWriteback(AjPSeqBamBgzf fp, AjBool all);
+#endif /* HAVE_LIBPTHREAD */
 
 
 
@@ -927,6 +1049,17 @@ static const int AJSEQBAM_BGZF_XLEN = 6;
 static const int AJSEQBAM_GZIP_WINDOW_BITS = -15;
 static const int AJSEQBAM_Z_DEFAULT_MEM_LEVEL = 8;
 
+static const ajuint AJSEQBAM_MAX_THREADS = 64;
+
+#ifdef HAVE_LIBPTHREAD
+static const ajuint AJSEQBAM_BLOCKS_PER_THREAD = 4;
+
+static const int AJSEQBAM_SLOT_FREE   = 0;
+static const int AJSEQBAM_SLOT_QUEUED = 1;
+static const int AJSEQBAM_SLOT_BUSY   = 2;
+static const int AJSEQBAM_SLOT_DONE   = 3;
+#endif /* HAVE_LIBPTHREAD */
+
 
 
 
@@ -1094,6 +1227,7 @@ static AjPSeqBamBgzf bamBgzfOpenfdRead(int fd)
     fp->cache = ajTableNew(512);
 
     fseek(fp->file, 0L, SEEK_SET);
+    ajSeqBamBgzfSetThreads(fp, bamThreadsDefault());
 
     return fp;
 }
@@ -1137,6 +1271,8 @@ static AjPSeqBamBgzf bamBgzfOpenfdWrite(int fd, char is_uncompressed)
     fp->block_offset = 0;
     fp->block_length = 0;
     fp->error = NULL;
+    fp->pool = NULL;
+    ajSeqBamBgzfSetThreads(fp, bamThreadsDefault());
 
     return fp;
 }
@@ -1255,6 +1391,8 @@ AjBool ajSeqBamBgzfSetInfile(AjPSeqBamBgzf gzfile, AjPFile inf)
     gzfile->block_offset = 0;
     gzfile->block_length = 0;
     gzfile->error = NULL;
+    gzfile->pool = NULL;
+    ajSeqBamBgzfSetThreads(gzfile, bamThreadsDefault());
 
     return ajTrue;
 }
@@ -1290,6 +1428,8 @@ AjBool ajSeqBamBgzfSetOutfile(AjPSeqBamBgzf gzfile, AjPFile outf)
     gzfile->block_offset = 0;
     gzfile->block_length = 0;
     gzfile->error = NULL;
+    gzfile->pool = NULL;
+    ajSeqBamBgzfSetThreads(gzfile, bamThreadsDefault());
 
     return ajTrue;
 }
@@ -1297,6 +1437,64 @@ AjBool ajSeqBamBgzfSetOutfile(AjPSeqBamBgzf gzfile, AjPFile outf)
 
 
 
+/* @func ajSeqBamBgzfSetThreads ***********************************************
+**
+** Sets the number of worker threads for a BGZip BAM file.
+**
+** When reading, blocks are read ahead and uncompressed in parallel. When
+** writing, full blocks are compressed in parallel and written in order.
+** The data and virtual offsets are the same as with a single thread.
+**
+** The default is set by the BAMTHREADS variable. One thread, or a build
+** without thread support, compresses each block on the calling thread.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZip BAM file
+** @param [r] nthreads [ajuint] Number of threads
+** @return [AjBool] True on success
+** @release 6.6.0
+******************************************************************************/
+
+AjBool ajSeqBamBgzfSetThreads(AjPSeqBamBgzf fp, ajuint nthreads)
+{
+#ifdef HAVE_LIBPTHREAD
+    BamPBgzfPool pool;
+#endif /* HAVE_LIBPTHREAD */
+
+    if(!fp)
+        return ajFalse;
+
+    if(nthreads > AJSEQBAM_MAX_THREADS)
+        nthreads = AJSEQBAM_MAX_THREADS;
+
+#ifdef HAVE_LIBPTHREAD
+    pool = fp->pool;
+
+    if(pool)
+    {
+        /* continue reading after the last block returned */
+        if(!pool->Write)
+            fseek(fp->file, pool->End, SEEK_SET);
+
+        bamPoolDel(fp);
+    }
+
+    if(nthreads < 2)
+        return ajTrue;
+
+    return bamPoolNew(fp, nthreads);
+#else /* !HAVE_LIBPTHREAD */
+    if(nthreads < 2)
+        return ajTrue;
+
+    ajDebug("ajSeqBamBgzfSetThreads: threads not supported in this build\n");
+
+    return ajFalse;
+#endif /* HAVE_LIBPTHREAD */
+}
+
+
+
+
 /* @func ajSeqBamBgzfNew *****************************************************
 **
 ** Constructs a BGZip BAM file by file
@@ -1329,6 +1527,7 @@ AjPSeqBamBgzf ajSeqBamBgzfNew(FILE* file, const char*  mode)
 
     fp->file = file;
     fseek(fp->file, 0L, SEEK_SET);
+    ajSeqBamBgzfSetThreads(fp, bamThreadsDefault());
 
     return fp;
 }
@@ -1355,8 +1554,58 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
     ** Also adds an extra field that stores the compressed block length.
     */
 
-    char *buffer = NULL;
-    int buffer_size;
+    int compressed_length;
+    int remaining = 0;
+    const char *error = NULL;
+
+    compressed_length = bamDeflateBuffer(fp->uncompressed_block, block_length,
+                                         fp->compressed_block,
+                                         fp->compressed_block_size,
+                                         fp->is_uncompressed,
+                                         &remaining, &error);
+
+    if(compressed_length < 0)
+    {
+        bamReportError(fp, error);
+        return -1;
+    }
+
+    fp->block_offset = remaining;
+
+    return compressed_length;
+}
+
+
+
+
+/* @funcstatic bamDeflateBuffer ***********************************************
+**
+** Deflate an uncompressed buffer into a BGZF block
+**
+** If the data do not compress enough to fit in one block, the part left
+** over is moved to the start of the uncompressed buffer.
+**
+** Safe to call from a worker thread, as errors are returned rather than
+** reported.
+**
+** @param [u] uncompressed_block [void*] Uncompressed data
+** @param [r] block_length [int] Uncompressed data length
+** @param [w] buffer [char*] Compressed block buffer
+** @param [r] buffer_size [int] Compressed block buffer size
+** @param [r] is_uncompressed [char] If non-zero, store without compression
+** @param [w] Premaining [int*] Length of uncompressed data left over
+** @param [w] Perror [const char**] Error description on failure
+** @return [int] Length of compressed block, -1 on error
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static int bamDeflateBuffer(void* uncompressed_block, int block_length,
+                            char* buffer, int buffer_size,
+                            char is_uncompressed,
+                            int* Premaining, const char** Perror)
+{
     int input_length;
     int compressed_length;
     int compress_level;
@@ -1365,9 +1614,6 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
     ajuint crc;
     int remaining;
 
-    buffer      = fp->compressed_block;
-    buffer_size = fp->compressed_block_size;
-    
     /* Init gzip header */
     buffer[0] = AJSEQBAM_GZIP_ID1;
     buffer[1] = AJSEQBAM_GZIP_ID2;
@@ -1394,11 +1640,11 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
 
     while(1)
     {
-	compress_level = fp->is_uncompressed ? Z_NO_COMPRESSION :
+	compress_level = is_uncompressed ? Z_NO_COMPRESSION :
 		Z_DEFAULT_COMPRESSION;
         zs.zalloc = NULL;
         zs.zfree  = NULL;
-        zs.next_in   = fp->uncompressed_block;
+        zs.next_in   = uncompressed_block;
         zs.avail_in  = input_length;
         zs.next_out  = (void*)&buffer[AJSEQBAM_BLOCK_HEADER_LENGTH];
         zs.avail_out = buffer_size - AJSEQBAM_BLOCK_HEADER_LENGTH -
@@ -1411,7 +1657,7 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
 
         if(status != Z_OK)
         {
-            bamReportError(fp, "deflate init failed");
+            *Perror = "deflate init failed";
             return -1;
         }
 
@@ -1434,14 +1680,14 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
                 if(input_length <= 0)
                 {
                     /* should never happen */
-                    bamReportError(fp, "input reduction failed");
+                    *Perror = "input reduction failed";
                     return -1;
                 }
 
                 continue;
             }
 
-            bamReportError(fp, "deflate failed");
+            *Perror = "deflate failed";
             return -1;
         }
 
@@ -1449,7 +1695,7 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
 
         if(status != Z_OK)
         {
-            bamReportError(fp, "deflate end failed");
+            *Perror = "deflate end failed";
             return -1;
         }
 
@@ -1460,7 +1706,7 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
         if(compressed_length > AJSEQBAM_MAX_BLOCK_SIZE)
         {
             /* should never happen */
-            bamReportError(fp, "deflate overflow");
+            *Perror = "deflate overflow";
             return -1;
         }
 
@@ -1469,7 +1715,7 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
 
     packInt16((unsigned char*)&buffer[16], compressed_length-1);
     crc = crc32(0L, NULL, 0L);
-    crc = crc32(crc, fp->uncompressed_block, input_length);
+    crc = crc32(crc, uncompressed_block, input_length);
     packInt32((unsigned char*)&buffer[compressed_length-8], crc);
     packInt32((unsigned char*)&buffer[compressed_length-4], input_length);
 
@@ -1480,16 +1726,16 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
         if(remaining > input_length)
         {
             /* should never happen (check so we can use memcpy) */
-            bamReportError(fp, "remainder too large");
+            *Perror = "remainder too large";
             return -1;
         }
 
-        memcpy((unsigned char*)fp->uncompressed_block,
-               (unsigned char*)fp->uncompressed_block + input_length,
+        memcpy((unsigned char*)uncompressed_block,
+               (unsigned char*)uncompressed_block + input_length,
                remaining);
     }
 
-    fp->block_offset = remaining;
+    *Premaining = remaining;
 
     return compressed_length;
 }
@@ -1512,21 +1758,59 @@ static int bamDeflateBlock(AjPSeqBamBgzf fp, int block_length)
 static int bamInflateBlock(AjPSeqBamBgzf fp, int block_length)
 {
     /* Inflate the block in fp->compressed_block into fp->uncompressed_block */
+    int count;
+    const char *error = NULL;
+
+    count = bamInflateBuffer(fp->compressed_block, block_length,
+                             fp->uncompressed_block,
+                             fp->uncompressed_block_size, &error);
+
+    if(count < 0)
+        bamReportError(fp, error);
+
+    return count;
+}
+
+
+
+
+/* @funcstatic bamInflateBuffer ***********************************************
+**
+** Uncompress a BGZF block into a buffer
+**
+** Safe to call from a worker thread, as errors are returned rather than
+** reported.
+**
+** @param [r] compressed_block [const void*] Compressed block
+** @param [r] block_length  [int] Compressed block length
+** @param [w] uncompressed_block [void*] Uncompressed data buffer
+** @param [r] uncompressed_size [int] Uncompressed data buffer size
+** @param [w] Perror [const char**] Error description on failure
+** @return [int] Uncompressed block length, -1 on error
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static int bamInflateBuffer(const void* compressed_block, int block_length,
+                            void* uncompressed_block, int uncompressed_size,
+                            const char** Perror)
+{
     int status;
     z_stream zs;
 
     zs.zalloc = NULL;
     zs.zfree = NULL;
-    zs.next_in = (unsigned char*)fp->compressed_block + 18;
+    zs.next_in = (unsigned char*)compressed_block + 18;
     zs.avail_in = block_length - 16;
-    zs.next_out = fp->uncompressed_block;
-    zs.avail_out = fp->uncompressed_block_size;
+    zs.next_out = uncompressed_block;
+    zs.avail_out = uncompressed_size;
 
     status = inflateInit2(&zs, AJSEQBAM_GZIP_WINDOW_BITS);
 
     if(status != Z_OK)
     {
-        bamReportError(fp, "inflate init failed");
+        *Perror = "inflate init failed";
         return -1;
     }
 
@@ -1535,7 +1819,7 @@ static int bamInflateBlock(AjPSeqBamBgzf fp, int block_length)
     if(status != Z_STREAM_END)
     {
         inflateEnd(&zs);
-        bamReportError(fp, "inflate failed");
+        *Perror = "inflate failed";
         return -1;
     }
 
@@ -1543,7 +1827,7 @@ static int bamInflateBlock(AjPSeqBamBgzf fp, int block_length)
 
     if(status != Z_OK)
     {
-        bamReportError(fp, "inflate failed");
+        *Perror = "inflate failed";
         return -1;
     }
 
@@ -1716,6 +2000,11 @@ static int bamReadBlock(AjPSeqBamBgzf fp)
     char *compressed_block;
     int remaining;
 
+#ifdef HAVE_LIBPTHREAD
+    if(fp->pool)
+        return bamPoolReadBlock(fp);
+#endif /* HAVE_LIBPTHREAD */
+
     block_address = ftell(fp->file);
 
     if(bamCacheLoadBlock(fp, block_address)) 
@@ -1778,6 +2067,629 @@ static int bamReadBlock(AjPSeqBamBgzf fp)
 
 
 
+/* @funcstatic bamBgzfAtEnd ***************************************************
+**
+** Tests whether all blocks of a BGZ file open for reading have been read
+**
+** @param [r] fp [const AjPSeqBamBgzf] BGZ file object
+** @return [AjBool] True at end of file
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool bamBgzfAtEnd(const AjPSeqBamBgzf fp)
+{
+#ifdef HAVE_LIBPTHREAD
+    const BamPBgzfPool pool = fp->pool;
+
+    if(pool)
+        return (pool->Eof && !pool->Count);
+#endif /* HAVE_LIBPTHREAD */
+
+    return feof(fp->file) ? ajTrue : ajFalse;
+}
+
+
+
+
+/* @funcstatic bamBgzfNextAddress *********************************************
+**
+** Returns the file offset of the block after the current block of a BGZ
+** file open for reading.
+**
+** With worker threads the file has been read ahead, so the offset is
+** taken from the last block returned rather than from the file position.
+**
+** @param [r] fp [const AjPSeqBamBgzf] BGZ file object
+** @return [ajlong] File offset
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajlong bamBgzfNextAddress(const AjPSeqBamBgzf fp)
+{
+#ifdef HAVE_LIBPTHREAD
+    const BamPBgzfPool pool = fp->pool;
+
+    if(pool)
+        return pool->End;
+#endif /* HAVE_LIBPTHREAD */
+
+    return ftell(fp->file);
+}
+
+
+
+
+#ifdef HAVE_LIBPTHREAD
+/* @funcstatic bamPoolNew *****************************************************
+**
+** Starts worker threads to uncompress blocks read ahead from a BGZ file,
+** or to compress blocks written to a BGZ file.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @param [r] nthreads [ajuint] Number of worker threads
+** @return [AjBool] True if at least one worker thread was started
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool bamPoolNew(AjPSeqBamBgzf fp, ajuint nthreads)
+{
+    BamPBgzfPool pool;
+    ajuint i;
+
+    /* blocks are swapped with the ring, so all have the maximum size */
+    if(!fp->uncompressed_block)
+        fp->uncompressed_block = malloc(AJSEQBAM_MAX_BLOCK_SIZE);
+
+    AJNEW0(pool);
+    pool->Nslots = nthreads * AJSEQBAM_BLOCKS_PER_THREAD;
+    pool->Depth = 1;
+    pool->Write = (fp->open_mode == 'w');
+    pool->is_uncompressed = fp->is_uncompressed;
+
+    if(!pool->Write)
+        pool->End = ftell(fp->file);
+
+    AJCNEW0(pool->Slots, pool->Nslots);
+
+    for(i = 0; i < pool->Nslots; i++)
+    {
+        pool->Slots[i].uncompressed_block = malloc(AJSEQBAM_MAX_BLOCK_SIZE);
+        pool->Slots[i].compressed_block = malloc(AJSEQBAM_MAX_BLOCK_SIZE);
+    }
+
+    pthread_mutex_init(&pool->Lock, NULL);
+    pthread_cond_init(&pool->Work, NULL);
+    pthread_cond_init(&pool->Done, NULL);
+
+    AJCNEW0(pool->Threads, nthreads);
+
+    for(i = 0; i < nthreads; i++)
+    {
+        if(pthread_create(&pool->Threads[i], NULL, bamPoolWork, pool))
+            break;
+
+        pool->Nthreads++;
+    }
+
+    fp->pool = pool;
+
+    if(!pool->Nthreads)
+    {
+        ajDebug("bamPoolNew failed to start threads\n");
+        bamPoolDel(fp);
+
+        return ajFalse;
+    }
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic bamPoolDel *****************************************************
+**
+** Stops the worker threads of a BGZ file.
+**
+** Blocks waiting to be written are written first. Blocks read ahead are
+** dropped, leaving the file where the read ahead stopped, which may
+** already be closed.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @return [void]
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void bamPoolDel(AjPSeqBamBgzf fp)
+{
+    BamPBgzfPool pool = fp->pool;
+    ajuint i;
+
+    if(pool->Write)
+        bamPoolWriteback(fp, ajTrue);
+
+    pthread_mutex_lock(&pool->Lock);
+    pool->Exit = ajTrue;
+    pthread_cond_broadcast(&pool->Work);
+    pthread_mutex_unlock(&pool->Lock);
+
+    for(i = 0; i < pool->Nthreads; i++)
+        pthread_join(pool->Threads[i], NULL);
+
+    pthread_cond_destroy(&pool->Done);
+    pthread_cond_destroy(&pool->Work);
+    pthread_mutex_destroy(&pool->Lock);
+
+    for(i = 0; i < pool->Nslots; i++)
+    {
+        free(pool->Slots[i].uncompressed_block);
+        free(pool->Slots[i].compressed_block);
+    }
+
+    AJFREE(pool->Slots);
+    AJFREE(pool->Threads);
+    AJFREE(pool);
+
+    fp->pool = NULL;
+
+    return;
+}
+
+
+
+
+/* @funcstatic bamPoolWork ****************************************************
+**
+** Worker thread, taking queued blocks in file order and compressing or
+** uncompressing each into its own buffer
+**
+** @param [u] arg [void*] Worker pool
+** @return [void*] NULL
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void* bamPoolWork(void* arg)
+{
+    BamPBgzfPool pool = arg;
+    BamPBgzfSlot slot;
+
+    pthread_mutex_lock(&pool->Lock);
+
+    while(1)
+    {
+        while(!pool->Exit && !pool->Queued)
+            pthread_cond_wait(&pool->Work, &pool->Lock);
+
+        if(pool->Exit)
+            break;
+
+        slot = &pool->Slots[pool->Next];
+        pool->Next = (pool->Next + 1) % pool->Nslots;
+        pool->Queued--;
+        pool->Busy++;
+        slot->state = AJSEQBAM_SLOT_BUSY;
+
+        pthread_mutex_unlock(&pool->Lock);
+
+        if(pool->Write)
+            slot->result = bamDeflateBuffer(slot->uncompressed_block,
+                                            slot->length,
+                                            slot->compressed_block,
+                                            AJSEQBAM_MAX_BLOCK_SIZE,
+                                            pool->is_uncompressed,
+                                            &slot->remaining, &slot->error);
+        else
+            slot->result = bamInflateBuffer(slot->compressed_block,
+                                            slot->length,
+                                            slot->uncompressed_block,
+                                            AJSEQBAM_MAX_BLOCK_SIZE,
+                                            &slot->error);
+
+        pthread_mutex_lock(&pool->Lock);
+
+        slot->state = AJSEQBAM_SLOT_DONE;
+        pool->Busy--;
+        pthread_cond_broadcast(&pool->Done);
+    }
+
+    pthread_mutex_unlock(&pool->Lock);
+
+    return NULL;
+}
+
+
+
+
+/* @funcstatic bamPoolFill ****************************************************
+**
+** Reads compressed blocks ahead from a BGZ file and queues them for the
+** worker threads, up to the current read ahead depth.
+**
+** A block that cannot be read is returned as an error when the caller
+** reaches it, and stops the read ahead.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @return [void]
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void bamPoolFill(AjPSeqBamBgzf fp)
+{
+    BamPBgzfPool pool = fp->pool;
+    BamPBgzfSlot slot;
+    char *compressed_block;
+    int count;
+    int remaining;
+    int state;
+
+    while(!pool->Eof && pool->Count < pool->Depth)
+    {
+        slot = &pool->Slots[(pool->Head + pool->Count) % pool->Nslots];
+        compressed_block = slot->compressed_block;
+        slot->block_address = ftell(fp->file);
+        slot->error = NULL;
+        slot->result = -1;
+        state = AJSEQBAM_SLOT_DONE;
+
+        count = fread(compressed_block, 1, AJSEQBAM_BLOCK_HEADER_LENGTH,
+                      fp->file);
+
+        if(count == 0)
+        {
+            pool->Eof = ajTrue;
+            break;
+        }
+
+        if(count != AJSEQBAM_BLOCK_HEADER_LENGTH)
+            slot->error = "read failed";
+        else if(bamHeaderCheck(compressed_block))
+        {
+            slot->length = unpackInt16((unsigned char*)&compressed_block[16])
+                + 1;
+            remaining = slot->length - AJSEQBAM_BLOCK_HEADER_LENGTH;
+            count = fread(&compressed_block[AJSEQBAM_BLOCK_HEADER_LENGTH], 1,
+                          remaining, fp->file);
+
+            if(count != remaining)
+                slot->error = "read failed";
+            else
+            {
+                slot->end_address = slot->block_address + slot->length;
+                state = AJSEQBAM_SLOT_QUEUED;
+            }
+        }
+
+        pthread_mutex_lock(&pool->Lock);
+
+        slot->state = state;
+        pool->Count++;
+
+        if(state == AJSEQBAM_SLOT_QUEUED)
+        {
+            pool->Queued++;
+            pthread_cond_signal(&pool->Work);
+        }
+        else
+            pool->Eof = ajTrue;
+
+        pthread_mutex_unlock(&pool->Lock);
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic bamPoolReadBlock ***********************************************
+**
+** Returns the next block read ahead from a BGZ file as the current
+** uncompressed block, and reads further ahead.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @return [int] Zero on success
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static int bamPoolReadBlock(AjPSeqBamBgzf fp)
+{
+    BamPBgzfPool pool = fp->pool;
+    BamPBgzfSlot slot;
+    void *block;
+
+    bamPoolFill(fp);
+
+    if(!pool->Count)
+    {
+        fp->block_length = 0;
+        return 0;
+    }
+
+    slot = &pool->Slots[pool->Head];
+
+    pthread_mutex_lock(&pool->Lock);
+
+    while(slot->state != AJSEQBAM_SLOT_DONE)
+        pthread_cond_wait(&pool->Done, &pool->Lock);
+
+    pthread_mutex_unlock(&pool->Lock);
+
+    if(slot->result < 0)
+    {
+        if(slot->error)
+            bamReportError(fp, slot->error);
+
+        return -1;
+    }
+
+    block = fp->uncompressed_block;
+    fp->uncompressed_block = slot->uncompressed_block;
+    slot->uncompressed_block = block;
+
+    if(fp->block_length != 0)
+    {
+        /* Do not reset offset if this read follows a seek. */
+        fp->block_offset = 0;
+    }
+
+    fp->block_address = slot->block_address;
+    fp->block_length = slot->result;
+    pool->End = slot->end_address;
+
+    pthread_mutex_lock(&pool->Lock);
+
+    slot->state = AJSEQBAM_SLOT_FREE;
+    pool->Head = (pool->Head + 1) % pool->Nslots;
+    pool->Count--;
+
+    pthread_mutex_unlock(&pool->Lock);
+
+    /* read further ahead while the blocks are read in order */
+    if(pool->Depth < pool->Nslots)
+    {
+        pool->Depth *= 2;
+
+        if(pool->Depth > pool->Nslots)
+            pool->Depth = pool->Nslots;
+    }
+
+    bamPoolFill(fp);
+
+    return 0;
+}
+
+
+
+
+/* @funcstatic bamPoolReset ***************************************************
+**
+** Drops the blocks read ahead from a BGZ file before a seek, and waits
+** for any worker still uncompressing one.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @param [r] block_address [ajlong] File offset of the next block to read
+** @return [void]
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void bamPoolReset(AjPSeqBamBgzf fp, ajlong block_address)
+{
+    BamPBgzfPool pool = fp->pool;
+    ajuint i;
+
+    pthread_mutex_lock(&pool->Lock);
+
+    pool->Queued = 0;
+
+    while(pool->Busy)
+        pthread_cond_wait(&pool->Done, &pool->Lock);
+
+    for(i = 0; i < pool->Nslots; i++)
+        pool->Slots[i].state = AJSEQBAM_SLOT_FREE;
+
+    pool->Head = 0;
+    pool->Next = 0;
+    pool->Count = 0;
+
+    pthread_mutex_unlock(&pool->Lock);
+
+    pool->Eof = ajFalse;
+    pool->Depth = 1;
+    pool->End = block_address;
+
+    return;
+}
+
+
+
+
+/* @funcstatic bamPoolWriteBlock **********************************************
+**
+** Queues the current uncompressed block of a BGZ file to be compressed
+** by the worker threads, first writing any blocks already compressed.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @return [int] Zero on success, -1 on error
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static int bamPoolWriteBlock(AjPSeqBamBgzf fp)
+{
+    BamPBgzfPool pool = fp->pool;
+    BamPBgzfSlot slot;
+    void *block;
+
+    if(bamPoolWriteback(fp, ajFalse) != 0)
+        return -1;
+
+    slot = &pool->Slots[(pool->Head + pool->Count) % pool->Nslots];
+
+    block = fp->uncompressed_block;
+    fp->uncompressed_block = slot->uncompressed_block;
+    slot->uncompressed_block = block;
+
+    slot->length = fp->block_offset;
+    slot->remaining = 0;
+    slot->error = NULL;
+    fp->block_offset = 0;
+
+    pthread_mutex_lock(&pool->Lock);
+
+    slot->state = AJSEQBAM_SLOT_QUEUED;
+    pool->Count++;
+    pool->Queued++;
+    pthread_cond_signal(&pool->Work);
+
+    pthread_mutex_unlock(&pool->Lock);
+
+    return 0;
+}
+
+
+
+
+/* @funcstatic bamPoolWriteback ***********************************************
+**
+** Writes compressed blocks of a BGZ file in file order.
+**
+** Blocks already compressed are written. If all is set, or if no block
+** is free, waits for the workers to finish the oldest blocks.
+**
+** A block that did not compress enough to fit has the part left over
+** compressed here, so that it follows in the file.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @param [r] all [AjBool] Wait and write all queued blocks
+** @return [int] Zero on success, -1 on error
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static int bamPoolWriteback(AjPSeqBamBgzf fp, AjBool all)
+{
+    BamPBgzfPool pool = fp->pool;
+    BamPBgzfSlot slot;
+    int block_length;
+    int count;
+
+    while(pool->Count)
+    {
+        slot = &pool->Slots[pool->Head];
+
+        pthread_mutex_lock(&pool->Lock);
+
+        if(slot->state != AJSEQBAM_SLOT_DONE && !all &&
+           pool->Count < pool->Nslots)
+        {
+            pthread_mutex_unlock(&pool->Lock);
+            break;
+        }
+
+        while(slot->state != AJSEQBAM_SLOT_DONE)
+            pthread_cond_wait(&pool->Done, &pool->Lock);
+
+        pthread_mutex_unlock(&pool->Lock);
+
+        block_length = slot->result;
+
+        while(1)
+        {
+            if(block_length < 0)
+            {
+                bamReportError(fp, slot->error);
+                return -1;
+            }
+
+            count = fwrite(slot->compressed_block, 1, block_length, fp->file);
+
+            if(count != block_length)
+            {
+                bamReportError(fp, "write failed");
+                return -1;
+            }
+
+            fp->block_address += block_length;
+
+            if(!slot->remaining)
+                break;
+
+            block_length = bamDeflateBuffer(slot->uncompressed_block,
+                                            slot->remaining,
+                                            slot->compressed_block,
+                                            AJSEQBAM_MAX_BLOCK_SIZE,
+                                            pool->is_uncompressed,
+                                            &slot->remaining, &slot->error);
+        }
+
+        pthread_mutex_lock(&pool->Lock);
+
+        slot->state = AJSEQBAM_SLOT_FREE;
+        pool->Head = (pool->Head + 1) % pool->Nslots;
+        pool->Count--;
+
+        pthread_mutex_unlock(&pool->Lock);
+    }
+
+    return 0;
+}
+#endif /* HAVE_LIBPTHREAD */
+
+
+
+
+/* @funcstatic bamThreadsDefault **********************************************
+**
+** Returns the default number of threads for BGZ files, from the
+** BAMTHREADS variable
+**
+** @return [ajuint] Number of threads
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajuint bamThreadsDefault(void)
+{
+    AjPStr value = NULL;
+    ajuint nthreads = 1;
+
+    if(bamThreads < 0)
+    {
+        if(ajNamGetValueC("bamthreads", &value))
+        {
+            if(!ajStrToUint(value, &nthreads))
+                ajErr("Bad value for environment variable 'BAMTHREADS'");
+        }
+
+        bamThreads = (ajint) nthreads;
+        ajStrDel(&value);
+    }
+
+    return (ajuint) bamThreads;
+}
+
+
+
+
 /* @func ajSeqBamBgzfRead *****************************************************
 **
 ** Read a BAM file data record of a given length
@@ -1839,7 +2751,7 @@ int ajSeqBamBgzfRead(AjPSeqBamBgzf fp, void *data, int length)
 
     if(fp->block_offset == fp->block_length)
     {
-        fp->block_address = ftell(fp->file);
+        fp->block_address = bamBgzfNextAddress(fp);
         fp->block_offset = 0;
         fp->block_length = 0;
     }
@@ -1850,6 +2762,75 @@ int ajSeqBamBgzfRead(AjPSeqBamBgzf fp, void *data, int length)
 
 
 
+/* @func ajSeqBamBgzfReadBlock ************************************************
+**
+** Read data from the current block of a BGZ file, loading the next block
+** if the current block is finished.
+**
+** Unlike ajSeqBamBgzfRead the data never crosses a block boundary, so
+** the virtual offset of each byte read is the virtual offset before the
+** read plus its position in the buffer.
+**
+** @param [u] fp [AjPSeqBamBgzf] BGZ file object
+** @param [u] data [void*] Buffer
+** @param [r] length [int] length of buffer
+** @return [int] Number of bytes read, zero at end of file
+**               -1 on error
+**
+** @release 6.6.0
+******************************************************************************/
+
+int ajSeqBamBgzfReadBlock(AjPSeqBamBgzf fp, void *data, int length)
+{
+    int available;
+    int copy_length;
+    char *buffer;
+
+    if(length <= 0)
+        return 0;
+
+    if(fp->open_mode != 'r')
+    {
+        bamReportError(fp, "file not open for reading");
+        return -1;
+    }
+
+    available = fp->block_length - fp->block_offset;
+
+    /* skip any empty blocks, including the end of file marker */
+
+    while(available <= 0)
+    {
+        if(bamReadBlock(fp) != 0)
+        {
+            ajDebug("bamReadBlock failed\n");
+            return -1;
+        }
+
+        if(!fp->block_length && bamBgzfAtEnd(fp))
+            return 0;
+
+        available = fp->block_length - fp->block_offset;
+    }
+
+    copy_length = BAMBGZFMIN(length, available);
+    buffer = fp->uncompressed_block;
+    memcpy(data, buffer + fp->block_offset, copy_length);
+    fp->block_offset += copy_length;
+
+    if(fp->block_offset == fp->block_length)
+    {
+        fp->block_address = bamBgzfNextAddress(fp);
+        fp->block_offset = 0;
+        fp->block_length = 0;
+    }
+
+    return copy_length;
+}
+
+
+
+
 /* @func ajSeqBamBgzfFlush ****************************************************
 **
 ** Flush block to output file
@@ -1865,6 +2846,16 @@ int ajSeqBamBgzfFlush(AjPSeqBamBgzf fp)
     int count;
     int block_length;
 
+#ifdef HAVE_LIBPTHREAD
+    if(fp->pool)
+    {
+        if(fp->block_offset > 0 && bamPoolWriteBlock(fp) != 0)
+            return -1;
+
+        return bamPoolWriteback(fp, ajTrue);
+    }
+#endif /* HAVE_LIBPTHREAD */
+
     while (fp->block_offset > 0)
     {
         block_length = bamDeflateBlock(fp, fp->block_offset);
@@ -1938,6 +2929,17 @@ int ajSeqBamBgzfWrite(AjPSeqBamBgzf fp, const void* data, int length)
 
         if(fp->block_offset == block_length)
         {
+#ifdef HAVE_LIBPTHREAD
+            /* queue the full block, written when compressed */
+            if(fp->pool)
+            {
+                if(bamPoolWriteBlock(fp) != 0)
+                    break;
+
+                continue;
+            }
+#endif /* HAVE_LIBPTHREAD */
+
             if(ajSeqBamBgzfFlush(fp) != 0)
                 break;
         }
@@ -1983,6 +2985,11 @@ int ajSeqBamBgzfClose(AjPSeqBamBgzf fp)
         }
     }
 
+#ifdef HAVE_LIBPTHREAD
+    if(fp->pool)
+        bamPoolDel(fp);
+#endif /* HAVE_LIBPTHREAD */
+
     if(fp->owned_file)
     {
         if(fclose(fp->file) != 0)
@@ -2928,6 +3935,12 @@ ajlong ajSeqBamBgzfSeek(AjPSeqBamBgzf fp, ajlong pos, int where)
     block_offset = pos & 0xFFFF;
     block_address = (pos >> 16) & 0xFFFFFFFFFFFFLL;
 
+#ifdef HAVE_LIBPTHREAD
+    /* blocks read ahead are dropped */
+    if(fp->pool)
+        bamPoolReset(fp, block_address);
+#endif /* HAVE_LIBPTHREAD */
+
     if (fseek(fp->file, block_address, SEEK_SET) != 0)
     {
 	ajErr("seek failed");
@@ -2944,6 +3957,76 @@ ajlong ajSeqBamBgzfSeek(AjPSeqBamBgzf fp, ajlong pos, int where)
 
 
 
+/* @func ajSeqBamBgzfTell *****************************************************
+**
+** Returns the virtual offset of the next read from a BGZ file.
+**
+** The virtual offset is the file offset of the compressed block shifted
+** up by 16 bits and the offset in the uncompressed block in the lower
+** 16 bits, as used by ajSeqBamBgzfSeek.
+**
+** When writing with worker threads, blocks are counted as they are
+** written, so call ajSeqBamBgzfFlush first.
+**
+** @param [r] fp [const AjPSeqBamBgzf] BGZ file object
+** @return [ajlong] Virtual offset
+**
+** @release 6.6.0
+******************************************************************************/
+
+ajlong ajSeqBamBgzfTell(const AjPSeqBamBgzf fp)
+{
+    return (fp->block_address << 16) | (fp->block_offset & 0xFFFF);
+}
+
+
+
+
+/* @func ajSeqBamBgzfTestFile *************************************************
+**
+** Tests whether an open file starts with a BGZ block header.
+**
+** The file is left at its original position.
+**
+** @param [u] file [FILE*] Open file
+** @return [AjBool] True if the file is BGZ compressed
+**
+** @release 6.6.0
+******************************************************************************/
+
+AjBool ajSeqBamBgzfTestFile(FILE* file)
+{
+    char header[AJSEQBAM_BLOCK_HEADER_LENGTH];
+    long pos;
+    size_t count;
+
+    if(!file)
+        return ajFalse;
+
+    pos = ftell(file);
+
+    if(pos < 0)
+        return ajFalse;
+
+    count = fread(header, 1, sizeof(header), file);
+
+    clearerr(file);
+
+    if(fseek(file, pos, SEEK_SET) != 0)
+        return ajFalse;
+
+    if(count != sizeof(header))
+        return ajFalse;
+
+    if(!bamHeaderCheck(header))
+        return ajFalse;
+
+    return ajTrue;
+}
+
+
+
+
 /* @func ajSeqBamValidate *****************************************************
 **
 ** Simple validation of a BAM record
@@ -213,6 +213,8 @@ extern const char* bam_nt16_rev_table;
 ** @attr uncompressed_block [void*] Uncompressed block data
 ** @attr compressed_block [void*] Compressed block data
 ** @attr error [const char*] Error description
+** @attr pool [void*] Worker threads compressing or uncompressing blocks,
+**                    or NULL
 ** @attr block_address [ajlong] Block offset
 ** @attr file_descriptor [int] File descriptor
 ** @attr cache_size [int] Cache size
@@ -234,6 +236,7 @@ typedef struct AjSSeqBamBgzf
     void* uncompressed_block;
     void* compressed_block;
     const char* error;
+    void* pool;
     ajlong block_address;
     int file_descriptor;
     int cache_size;
@@ -471,9 +474,13 @@ int ajSeqBamBgzfClose(AjPSeqBamBgzf fp);
 int ajSeqBamBgzfEof(AjPSeqBamBgzf fp);
 int ajSeqBamBgzfFlush(AjPSeqBamBgzf fp);
 int ajSeqBamBgzfRead(AjPSeqBamBgzf fp, void* data, int length);
+int ajSeqBamBgzfReadBlock(AjPSeqBamBgzf fp, void* data, int length);
 ajlong ajSeqBamBgzfSeek(AjPSeqBamBgzf fp, ajlong pos, int where);
 AjBool ajSeqBamBgzfSetInfile(AjPSeqBamBgzf gzfile, AjPFile outf);
 AjBool ajSeqBamBgzfSetOutfile(AjPSeqBamBgzf gzfile, AjPFile outf);
+AjBool ajSeqBamBgzfSetThreads(AjPSeqBamBgzf fp, ajuint nthreads);
+ajlong ajSeqBamBgzfTell(const AjPSeqBamBgzf fp);
+AjBool ajSeqBamBgzfTestFile(FILE* file);
 int ajSeqBamBgzfWrite(AjPSeqBamBgzf fp, const void* data, int length);
 
 void ajSeqBamDel(AjPSeqBam *Pbam);
@@ -45,6 +45,7 @@
 #include "ajnexus.h"
 #include "ajdom.h"
 #include "ajseqbam.h"
+#include "ajbamindex.h"
 #include "ajreg.h"
 #include "ajtext.h"
 #include "ajtextread.h"
@@ -65,7 +66,6 @@
 
 AjPTable seqDbMethods = NULL;
 
-static AjPStr    seqAppendTmpstr = NULL;
 static AjPStrTok seqHandle  = NULL;
 static AjPStrTok seqHandle2  = NULL;
 static AjPStrTok seqHandleSplit = NULL;
@@ -259,6 +259,57 @@ typedef struct SeqSInFormat
 
 
 
+/* @datastatic SeqPBamData ****************************************************
+**
+** BAM input data, kept between reads of the same file
+**
+** When the query names one or more reference sequences, only the
+** alignments overlapping the query region on those references are
+** returned. With a BAM index the reads are fetched through the index,
+** otherwise the file is scanned and the other reads are skipped.
+**
+** @alias SeqSBamData
+** @alias SeqOBamData
+**
+** @attr Gzfile [AjPSeqBamBgzf] BGZF compressed input file
+** @attr Bam [AjPSeqBam] Current alignment record
+** @attr Header [AjPSeqBamHeader] BAM header
+** @attr Index [AjPBamIndex] BAM index, or NULL if not available
+** @attr Iter [bam_iter_t] Index iterator for the current reference
+** @attr Select [AjBool*] Reference sequences selected by the query,
+**                        NULL to return all alignments
+** @attr Count [ajuint] Number of alignments read
+** @attr Nref [ajuint] Number of reference sequences
+** @attr Tid [ajint] Current reference sequence for indexed reads
+** @attr Begin [ajint] Region start as a sequence begin position,
+**                     zero for the start of the reference
+** @attr End [ajint] Region end as a sequence end position,
+**                   zero for the end of the reference
+** @attr Padding [char[4]] Padding to alignment boundary
+** @@
+******************************************************************************/
+
+typedef struct SeqSBamData
+{
+    AjPSeqBamBgzf Gzfile;
+    AjPSeqBam Bam;
+    AjPSeqBamHeader Header;
+    AjPBamIndex Index;
+    bam_iter_t Iter;
+    AjBool *Select;
+    ajuint Count;
+    ajuint Nref;
+    ajint Tid;
+    ajint Begin;
+    ajint End;
+    char Padding[4];
+} SeqOBamData;
+
+#define SeqPBamData SeqOBamData*
+
+
+
+
 /* @datastatic SeqPMsfData ****************************************************
 **
 ** Sequence alignment data, stored until written when output file is closed
@@ -929,11 +980,21 @@ static AjBool     seqReadAbi(AjPSeq thys, AjPSeqin seqin);
 
 static void       seqAccSave(AjPSeq thys, const AjPStr acc);
 static ajuint     seqAppend(AjPStr* seq, const AjPStr line);
+static ajuint     seqAppendLenC(AjPStr* seq, const char* line, ajuint len);
 static ajuint     seqAppendK(AjPStr* seq, char ch);
+static const AjPStr seqAppendWarnLenC(AjPStr* seq, const char* line,
+                                      ajuint len, ajuint informat);
 static const AjPStr seqAppendWarn(AjPStr* seq, const AjPStr line,
                                   ajuint informat);
 static ajuint     seqAppendCommented(AjPStr* seq, AjBool* incomment,
                                      const AjPStr line);
+static void       seqBamDataDel(SeqPBamData* pthys);
+static ajint      seqBamNext(SeqPBamData bamdata);
+static AjBool     seqBamRegion(const SeqPBamData bamdata, ajint tid,
+                               ajint* pbeg, ajint* pend);
+static void       seqBamSelect(SeqPBamData bamdata, AjPSeqin seqin,
+                               const AjPFile infile);
+static void       seqBamTrace(const AjPSeqBam b);
 static AjBool     seqClustalReadseq(const AjPStr rdLine,
                                     const AjPTable msftable);
 static AjBool     seqDefine(AjPSeq thys, AjPSeqin seqin);
@@ -983,6 +1044,8 @@ static AjBool     seqReadFastqIllumina(AjPSeq thys, AjPSeqin seqin);
 static AjBool     seqReadFastqSanger(AjPSeq thys, AjPSeqin seqin);
 static AjBool     seqReadFastqSolexa(AjPSeq thys, AjPSeqin seqin);
 static AjBool     seqReadFitch(AjPSeq thys, AjPSeqin seqin);
+static ajuint     seqReadStream(AjPSeq thys, AjPSeqin seqin);
+static AjBool     seqReadStreamFormat(const AjPSeqin seqin);
 static ajuint     seqReadFmt(AjPSeq thys, AjPSeqin seqin,
                              ajuint format);
 static AjBool     seqReadGcg(AjPSeq thys, AjPSeqin seqin);
@@ -2886,6 +2949,25 @@ static AjBool seqRead(AjPSeq thys, AjPSeqin seqin)
     if(!textin->Filebuff)
         return ajFalse;
 
+    if(seqin->Minimal && seqReadStreamFormat(seqin))
+    {
+        /* quick FASTA or FASTQ stream, or fall back to the usual reader */
+
+        istat = seqReadStream(thys, seqin);
+
+        if(istat == FMT_OK)
+        {
+            seqDefine(thys, seqin);
+
+            return ajTrue;
+        }
+
+        if(istat != FMT_NOMATCH)
+            return ajFalse;
+
+        ajSeqClear(thys);
+    }
+
     ok = ajFilebuffIsBuffered(textin->Filebuff);
 
     if(!seqinFormatDef[textin->Format].Binary)
@@ -3108,6 +3190,413 @@ static AjBool seqRead(AjPSeq thys, AjPSeqin seqin)
 
 
 
+/* @funcstatic seqReadStreamFormat ********************************************
+**
+** Tests whether the next sequence can be read by the quick stream reader.
+**
+** The input format must be known to be FASTA or FASTQ, and there must be
+** no query, features, stored text or sequence from the access method
+** to process.
+**
+** @param [r] seqin [const AjPSeqin] Sequence input object
+** @return [AjBool] ajTrue if the stream reader can be used
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool seqReadStreamFormat(const AjPSeqin seqin)
+{
+    const AjPTextin textin = seqin->Input;
+    const AjPQuery qry = textin->Query;
+    AjBool (*readfunc)(AjPSeq thys, AjPSeqin seqin);
+
+    if(!textin->Format || textin->Single || textin->Text ||
+       textin->TextData || seqin->SeqData || seqin->Features ||
+       MAJSTRGETLEN(seqin->Inseq))
+        return ajFalse;
+
+    if(qry && !qry->QryDone && ajListGetLength(qry->QueryFields))
+        return ajFalse;
+
+    readfunc = seqinFormatDef[textin->Format].Read;
+
+    if(readfunc == &seqReadNcbi || readfunc == &seqReadFasta ||
+       readfunc == &seqReadFastq || readfunc == &seqReadFastqSanger ||
+       readfunc == &seqReadFastqIllumina)
+        return ajTrue;
+
+    return ajFalse;
+}
+
+
+
+
+/* @funcstatic seqReadStream **************************************************
+**
+** Reads the next sequence from a FASTA or FASTQ stream with minimal
+** processing, for input with the -squick qualifier.
+**
+** Lines are read in place from the input block. Only the ID, the
+** description, the sequence and any quality scores are set. Accession
+** numbers are not parsed from the description, but NCBI-style IDs
+** containing '|' are parsed as usual so that the names are unchanged.
+**
+** If the next line does not start a sequence it is returned to the buffer
+** to be read by the usual format reader.
+**
+** @param [w] thys [AjPSeq] Sequence object
+** @param [u] seqin [AjPSeqin] Sequence input object
+** @return [ajuint] FMT_OK on success, FMT_NOMATCH if the next line is not
+**                  a header line, FMT_EOF at the end of the input,
+**                  FMT_BADTYPE for a bad sequence type and FMT_FAIL for
+**                  missing or bad FASTQ quality data
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajuint seqReadStream(AjPSeq thys, AjPSeqin seqin)
+{
+    AjPTextin textin = seqin->Input;
+    AjPFilebuff buff = textin->Filebuff;
+    AjBool (*readfunc)(AjPSeq thys, AjPSeqin seqin);
+    AjPStr id   = NULL;
+    AjPStr acc  = NULL;
+    AjPStr sv   = NULL;
+    AjPStr gi   = NULL;
+    AjPStr db   = NULL;
+    AjPStr desc = NULL;
+    const AjPStr badstr = NULL;
+    const char* line = NULL;
+    const char* cp;
+    const char* cpend;
+    ajuint linelen = 0;
+    ajuint seqlen;
+    ajuint quallen;
+    ajuint cntseq;
+    ajuint cntqual;
+    ajuint cntnewline;
+    ajint iqual;
+    ajuint i;
+    char* qp;
+    AjBool isfastq;
+    AjBool issanger;
+    AjBool isillumina;
+    AjBool ok;
+
+    readfunc   = seqinFormatDef[textin->Format].Read;
+    isfastq    = (readfunc != &seqReadNcbi && readfunc != &seqReadFasta);
+    issanger   = (readfunc == &seqReadFastqSanger);
+    isillumina = (readfunc == &seqReadFastqIllumina);
+
+    ajFilebuffSetUnbuffered(buff);
+    ajFileSetBlocksize(ajFilebuffGetFile(buff), 0);
+
+    for(;;)
+    {
+        ajTextinClearNewinput(textin);
+        cntseq = cntqual = cntnewline = 0;
+
+        ok = ajTextinStoreReadlineView(textin, &line, &linelen,
+                                       &thys->TextPtr);
+        if(!ok)
+        {
+            ajFilebuffClear(buff, 0);
+
+            return FMT_EOF;
+        }
+
+        if(*line != (isfastq ? '@' : '>') ||
+           (linelen > 3 && line[3] == ';'))
+        {
+            ajTextinStoreClear(textin, 1, NULL, &thys->TextPtr);
+
+            return FMT_NOMATCH;
+        }
+
+        thys->Fpos = ajTextinGetFpos(textin);
+        ajStrAssignLenC(&seqSaveLine, line, linelen);
+
+        /* ID is the first word, the rest is the description */
+
+        cp = line + 1;
+        cpend = line + linelen;
+
+        if(!isfastq)
+            while(cp < cpend && (*cp == ' ' || *cp == '\t'))
+                cp++;
+
+        i = 0;
+        while(cp+i < cpend && !isspace((ajint) cp[i]))
+            i++;
+
+        if(readfunc == &seqReadNcbi && memchr(cp, '|', i))
+        {
+            if(!ajSeqParseNcbi(seqSaveLine, &id, &acc, &sv, &gi, &db, &desc))
+            {
+                ajTextinStoreClear(textin, 1, NULL, &thys->TextPtr);
+                ajStrDel(&id);
+                ajStrDel(&acc);
+                ajStrDel(&sv);
+                ajStrDel(&gi);
+                ajStrDel(&db);
+                ajStrDel(&desc);
+
+                return FMT_NOMATCH;
+            }
+
+            ajStrAssignS(&thys->Setdb, db);
+
+            if(ajStrGetLen(gi))
+                ajStrAssignS(&thys->Gi, gi);
+
+            if(ajStrGetLen(sv))
+                seqSvSave(thys, sv);
+
+            if(ajStrGetLen(acc))
+                seqAccSave(thys, acc);
+
+            ajStrDel(&acc);
+            ajStrDel(&sv);
+            ajStrDel(&gi);
+            ajStrDel(&db);
+        }
+        else
+        {
+            ajStrAssignLenC(&id, cp, i);
+            cp += i;
+
+            while(cp < cpend && isspace((ajint) *cp))
+                cp++;
+
+            if(isfastq)
+            {
+                /* as for ajSeqParseFastq, trim only the newline */
+
+                while(cpend > cp && cpend[-1] == '\n')
+                    cpend--;
+
+                ajStrAssignLenC(&desc, cp, (ajuint) (cpend - cp));
+            }
+            else
+            {
+                /* as for ajSeqParseFasta, one space after the first word */
+
+                while(cpend > cp && (cpend[-1] == '\n' || cpend[-1] == '\r'))
+                    cpend--;
+
+                i = 0;
+                while(cp+i < cpend && !isspace((ajint) cp[i]))
+                    i++;
+
+                ajStrAssignLenC(&desc, cp, i);
+                cp += i;
+
+                while(cp < cpend && isspace((ajint) *cp))
+                    cp++;
+
+                if(cp < cpend)
+                {
+                    ajStrAppendK(&desc, ' ');
+                    ajStrAppendLenC(&desc, cp, (ajuint) (cpend - cp));
+                }
+            }
+        }
+
+        if(readfunc == &seqReadNcbi)
+            seqSetName(thys, id);
+        else
+            seqSetNameNospace(&thys->Name, id);
+
+        ajStrAssignS(&thys->Desc, desc);
+        ajStrDel(&id);
+        ajStrDel(&desc);
+
+        i = linelen;
+        while(i && (line[i-1] == '\n' || line[i-1] == '\r'))
+        {
+            cntnewline++;
+            i--;
+        }
+
+        /* sequence lines, appended in place */
+
+        ok = ajTextinStoreReadlineView(textin, &line, &linelen,
+                                       &thys->TextPtr);
+        while(ok && *line != (isfastq ? '+' : '>'))
+        {
+            cntseq += linelen - cntnewline;
+            badstr = seqAppendWarnLenC(&thys->Seq, line, linelen,
+                                       textin->Format);
+
+            if(badstr)
+                ajWarn("Sequence '%S' has bad character(s) '%S'",
+                       thys->Name, badstr);
+
+            ok = ajTextinStoreReadlineView(textin, &line, &linelen,
+                                           &thys->TextPtr);
+        }
+
+        seqlen = MAJSTRGETLEN(thys->Seq);
+
+        if(isfastq)
+        {
+            if(!ok)
+            {
+                ajDebug("seqReadStream failed to find quality scores\n");
+                ajFilebuffClear(buff, 0);
+
+                return FMT_FAIL;
+            }
+
+            if(issanger)
+            {
+                if(linelen > (cntnewline+1) &&
+                   (linelen != MAJSTRGETLEN(seqSaveLine) ||
+                    memcmp(line+1, MAJSTRGETPTR(seqSaveLine)+1, linelen-1)))
+                    ajWarn("Mismatch in file '%F' + line "
+                           "does not match first line '%.*S' '%.*s'",
+                           ajFilebuffGetFile(buff),
+                           (ajuint)(MAJSTRGETLEN(seqSaveLine) - cntnewline),
+                           seqSaveLine,
+                           (ajuint) (linelen - cntnewline), line);
+
+                if(seqlen < cntseq)
+                    ajWarn("FASTQ format '%F' sequence '%S' "
+                           "sequence skipped %u character(s)",
+                           ajFilebuffGetFile(buff), thys->Name,
+                           cntseq - seqlen);
+            }
+
+            /* quality lines, keeping printable characters */
+
+            ajStrAssignClear(&seqQualStr);
+
+            ok = ajTextinStoreReadlineView(textin, &line, &linelen,
+                                           &thys->TextPtr);
+            while(ok &&
+                  (MAJSTRGETLEN(seqQualStr) < seqlen || *line != '@'))
+            {
+                cntqual += linelen - cntnewline;
+                quallen = MAJSTRGETLEN(seqQualStr);
+                ajStrSetResRound(&seqQualStr, quallen+linelen+1);
+                qp = ajStrGetuniquePtr(&seqQualStr) + quallen;
+
+                for(i=0; i < linelen; i++)
+                    if(line[i] >= 33 && line[i] <= 126)
+                        *qp++ = line[i];
+
+                ajStrSetValidLen(&seqQualStr,
+                                 qp - MAJSTRGETPTR(seqQualStr));
+
+                ok = ajTextinStoreReadlineView(textin, &line, &linelen,
+                                               &thys->TextPtr);
+            }
+
+            quallen = MAJSTRGETLEN(seqQualStr);
+
+            if(quallen != seqlen && !issanger)
+            {
+                ajDebug("seqReadStream length mismatch seq: %u "
+                        "quality: %u\n", seqlen, quallen);
+                ajFilebuffClear(buff, 0);
+
+                return FMT_FAIL;
+            }
+
+            if(quallen != seqlen)
+                ajWarn("FASTQ quality length mismatch '%F' '%S' "
+                       "expected: %u found: %u",
+                       ajFilebuffGetFile(buff), thys->Name,
+                       seqlen, quallen);
+
+            if(issanger && quallen < cntqual)
+                ajWarn("FASTQ format '%F' sequence '%S' "
+                       "quality skipped %u character(s)",
+                       ajFilebuffGetFile(buff), thys->Name,
+                       cntqual - quallen);
+
+            if(issanger || isillumina)
+            {
+                if(seqlen > thys->Qualsize)
+                    AJCRESIZE(thys->Accuracy, seqlen);
+
+                thys->Qualsize = seqlen;
+
+                if(quallen > thys->Qualsize)
+                    AJCRESIZE(thys->Accuracy, quallen);
+
+                cp = MAJSTRGETPTR(seqQualStr);
+                i = 0;
+
+                while(*cp)
+                {
+                    iqual = *cp++;
+
+                    if(issanger)
+                        thys->Accuracy[i++] = seqQualPhred[iqual];
+                    else if(iqual < 64)
+                    {
+                        ajWarn("FASTQ-ILLUMINA quality value too low "
+                               "'%F' '%S' '%c'",
+                               ajFilebuffGetFile(buff), thys->Name,
+                               (char) iqual);
+                        thys->Accuracy[i++] = seqQualIllumina[64];
+                    }
+                    else
+                        thys->Accuracy[i++] = seqQualIllumina[iqual];
+                }
+            }
+        }
+
+        if(ok)
+            ajTextinStoreClear(textin, 1, NULL, &thys->TextPtr);
+        else
+            ajFilebuffClear(buff, 0);
+
+        ajStrAssignC(&thys->Formatstr, seqinFormatDef[textin->Format].Name);
+        ajStrAssignEmptyS(&thys->Db, textin->Db);
+        ajStrAssignS(&thys->Entryname, seqin->Entryname);
+        ajStrAssignS(&thys->Filename, textin->Filename);
+        ajStrAssignEmptyS(&thys->Entryname, thys->Name);
+
+        if(seqlen)
+        {
+            if(!ajSeqTypeCheckIn(thys, seqin))
+                return FMT_BADTYPE;
+
+            if(MAJSTRGETLEN(thys->Seq))
+                break;
+        }
+
+        ajWarn("Sequence '%S' has zero length, ignored",
+               ajSeqGetUsaS(thys));
+        ajSeqClear(thys);
+
+        if(!ok)
+            return FMT_EOF;
+    }
+
+    if(seqin->Upper)
+        ajSeqFmtUpper(thys);
+
+    if(seqin->Lower)
+        ajSeqFmtLower(thys);
+
+    if(seqin->Begin)
+        thys->Begin = seqin->Begin;
+
+    if(seqin->End)
+        thys->End = seqin->End;
+
+    if(seqin->Rev)
+        thys->Rev = seqin->Rev;
+
+    return FMT_OK;
+}
+
+
+
+
 /* @funcstatic seqReadFasta ***************************************************
 **
 ** Given data in a sequence structure, tries to read everything needed
@@ -3135,6 +3624,8 @@ static AjBool seqReadFasta(AjPSeq thys, AjPSeqin seqin)
     AjBool ok       = ajTrue;
     AjPStr tmpline = NULL;
     const AjPStr badstr = NULL;
+    const char* line = NULL;
+    ajuint linelen = 0;
 
     ajDebug("seqReadFasta\n");
 
@@ -3179,6 +3670,7 @@ static AjBool seqReadFasta(AjPSeq thys, AjPSeqin seqin)
     /* we know we will succeed from here ... no way to return ajFalse */
 
     ajFilebuffSetUnbuffered(buff);
+    ajFileSetBlocksize(ajFilebuffGetFile(buff), 0);
 
     seqSetNameNospace(&thys->Name, id);
 
@@ -3205,22 +3697,28 @@ static AjBool seqReadFasta(AjPSeq thys, AjPSeqin seqin)
     }
     else
     {
-        ok = ajTextinStoreReadline(seqin->Input, &seqReadLine, &thys->TextPtr);
-        while(ok && !ajStrPrefixC(seqReadLine, ">"))
+        /* sequence lines are appended in place from the read block */
+
+        ok = ajTextinStoreReadlineView(seqin->Input, &line, &linelen,
+                                       &thys->TextPtr);
+        while(ok && *line != '>')
         {
-            badstr = seqAppendWarn(&thys->Seq, seqReadLine,
-                                   seqin->Input->Format);
+            badstr = seqAppendWarnLenC(&thys->Seq, line, linelen,
+                                       seqin->Input->Format);
 
             if(badstr)
                 ajWarn("Sequence '%S' has bad character(s) '%S'",
                        thys->Name, badstr);
 
-            ajDebug("++fasta append line '%S'\n", seqReadLine);
-            ok = ajTextinStoreReadline(seqin->Input, &seqReadLine, &thys->TextPtr);
+            ok = ajTextinStoreReadlineView(seqin->Input, &line, &linelen,
+                                           &thys->TextPtr);
         }
 
         if(ok)
+        {
+            ajStrAssignLenC(&seqReadLine, line, linelen);
             ajTextinStoreClear(seqin->Input, 1, seqReadLine, &thys->TextPtr);
+        }
         else
             ajFilebuffClear(buff, 0);
     }
@@ -4924,6 +5422,8 @@ static AjBool seqReadNcbi(AjPSeq thys, AjPSeqin seqin)
 
     AjBool ok;
     const AjPStr badstr = NULL;
+    const char* line = NULL;
+    ajuint linelen = 0;
 
     buff = seqin->Input->Filebuff;
 
@@ -4984,22 +5484,28 @@ static AjBool seqReadNcbi(AjPSeq thys, AjPSeqin seqin)
         /* we know we will succeed from here ... no way to return ajFalse */
 
         ajFilebuffSetUnbuffered(buff);
+        ajFileSetBlocksize(ajFilebuffGetFile(buff), 0);
 
-        ok = ajTextinStoreReadline(seqin->Input, &seqReadLine, &thys->TextPtr);
-        while(ok && !ajStrPrefixC(seqReadLine, ">"))
+        ok = ajTextinStoreReadlineView(seqin->Input, &line, &linelen,
+                                       &thys->TextPtr);
+        while(ok && *line != '>')
         {
-            badstr = seqAppendWarn(&thys->Seq, seqReadLine,
-                                   seqin->Input->Format);
+            badstr = seqAppendWarnLenC(&thys->Seq, line, linelen,
+                                       seqin->Input->Format);
 
             if(badstr)
                 ajWarn("Sequence '%S' has bad character(s) '%S'",
                        thys->Name, badstr);
 
-            ok = ajTextinStoreReadline(seqin->Input, &seqReadLine, &thys->TextPtr);
+            ok = ajTextinStoreReadlineView(seqin->Input, &line, &linelen,
+                                           &thys->TextPtr);
         }
 
         if(ok)
+        {
+            ajStrAssignLenC(&seqReadLine, line, linelen);
             ajTextinStoreClear(seqin->Input, 1, seqReadLine, &thys->TextPtr);
+        }
         else
             ajFilebuffClear(buff, 0);
     }
@@ -10085,133 +10591,264 @@ static AjBool seqReadMase(AjPSeq thys, AjPSeqin seqin)
 
 
 
-/* @funcstatic seqReadBam *****************************************************
+/* @funcstatic seqBamSelect ***************************************************
 **
-** Given data in a sequence structure, tries to read everything needed
-** using binary alignment/map (BAM) format.
+** Selects the reference sequences named by the query of a BAM input.
 **
-** @param [w] thys [AjPSeq] Sequence object
+** If any reference name matches the query, the query region (from the
+** query range or the begin and end positions of the sequence input) is
+** kept in the BAM data and removed from the sequence input so that the
+** alignments are returned untrimmed. The BAM index is loaded if it can
+** be found.
+**
+** @param [u] bamdata [SeqPBamData] BAM input data
 ** @param [u] seqin [AjPSeqin] Sequence input object
-** @return [AjBool] ajTrue on success
+** @param [r] infile [const AjPFile] BAM input file
+** @return [void]
 **
-** @release 6.3.0
+** @release 6.6.0
 ** @@
 ******************************************************************************/
 
-static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
+static void seqBamSelect(SeqPBamData bamdata, AjPSeqin seqin,
+                         const AjPFile infile)
 {
-    AjPFilebuff buff;
-    AjPFile infile;
-    ajuint i;
-    AjPSeqBam b = NULL;
-    AjPSeqBamCore c;
-    ajint ret = 0;
-    struct bamdata
+    AjPQuery qry;
+    AjIList iterfield = NULL;
+    const AjPQueryField field = NULL;
+    const char* targetname;
+    ajuint tid;
+    ajuint nsel = 0;
+    AjBool ok;
+
+    qry = seqin->Input->Query;
+
+    if(!qry || qry->QryDone || !ajListGetLength(qry->QueryFields))
+        return;
+
+    if(!bamdata->Nref)
+        return;
+
+    AJCNEW0(bamdata->Select, bamdata->Nref);
+
+    for(tid=0; tid < bamdata->Nref; tid++)
     {
-        ajuint Count;
-        ajuint Nref;
-        AjPSeqBamBgzf gzfile;
-        AjPSeqBam bam;
-    } *bamdata = NULL;
-    static AjBool called = ajFalse;
-    static AjBool bigendian = ajFalse;
-    unsigned char* d;
-    ajuint dpos;
-    int cigop;
-    ajuint cigend;
-    ajuint cigint;
-    AjPStr cigarstr = NULL;
-    AjPStr namestr = NULL;
-    AjPStr seqstr = NULL;
-    AjPStr qualstr = NULL;
-    AjPStr tagstr = NULL;
-    unsigned char dp;
-    AjPSeqBamHeader header = NULL;
-    ajint filestat;
+        targetname = bamdata->Header->target_name[tid];
+        ok = ajFalse;
 
+        iterfield = ajListIterNewread(qry->QueryFields);
 
-    if(!called)
+        while(!ok && !ajListIterDone(iterfield))
+        {
+            field = ajListIterGet(iterfield);
+
+            if(!ajStrMatchC(field->Field, "id"))
+                continue;
+
+            if(qry->CaseId)
+                ok = ajCharMatchWildS(targetname, field->Wildquery);
+            else
+                ok = ajCharMatchWildCaseS(targetname, field->Wildquery);
+        }
+
+        ajListIterDel(&iterfield);
+
+        if(ok)
+        {
+            bamdata->Select[tid] = ajTrue;
+            nsel++;
+        }
+    }
+
+    if(!nsel)
     {
-        called = ajTrue;
-        bigendian = ajUtilGetBigendian();
-        ajDebug("seqReadBam bam bigendian: %B\n", bigendian);
+        /* no reference matched, the query is tested on the read names */
+        AJFREE(bamdata->Select);
+        return;
     }
 
-    buff = seqin->Input->Filebuff;
-    infile = ajFilebuffGetFile(buff);
+    bamdata->Begin = seqin->Begin;
+    bamdata->End   = seqin->End;
+    seqin->Begin   = 0;
+    seqin->End     = 0;
+    qry->QryDone   = ajTrue;
 
-    if(!seqin->SeqData)
-    {
-        ajFileTrace(infile);
-        ajFilebuffTrace(buff);
+    bamdata->Index = ajBamIndexLoad(ajFileGetNameC(infile));
 
-        /* reset to beginning of file -
-        ** has at least been tested for blank lines */
-        filestat = ajFileSeek(infile, 0L, SEEK_SET);
-        if(filestat != 0)
+    ajDebug("seqBamSelect %u/%u references begin:%d end:%d index:%B\n",
+            nsel, bamdata->Nref, bamdata->Begin, bamdata->End,
+            (bamdata->Index != NULL));
+
+    return;
+}
+
+
+
+
+/* @funcstatic seqBamRegion ***************************************************
+**
+** Converts the selected region of a BAM input to a 0-based half-open
+** interval on one reference sequence.
+**
+** @param [r] bamdata [const SeqPBamData] BAM input data
+** @param [r] tid [ajint] Reference sequence id
+** @param [w] pbeg [ajint*] 0-based region start, inclusive
+** @param [w] pend [ajint*] 0-based region end, exclusive
+** @return [AjBool] ajTrue if the region is not empty
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool seqBamRegion(const SeqPBamData bamdata, ajint tid,
+                           ajint* pbeg, ajint* pend)
+{
+    ajint len;
+    ajint beg;
+    ajint end;
+
+    len = (ajint) bamdata->Header->target_len[tid];
+
+    if(!len)
+        len = 1 << 29;
+
+    beg = bamdata->Begin;
+    end = bamdata->End;
+
+    if(beg < 0)
+        beg += len + 1;
+
+    if(beg < 1)
+        beg = 1;
+
+    if(end < 0)
+        end += len + 1;
+    else if(!end)
+        end = len;
+
+    *pbeg = beg - 1;
+    *pend = end;
+
+    return (end >= beg);
+}
+
+
+
+
+/* @funcstatic seqBamNext *****************************************************
+**
+** Reads the next alignment record of a BAM input, restricted to the
+** selected reference sequences and region if any.
+**
+** With a BAM index only the file chunks overlapping the region are read.
+** Without an index the whole file is scanned.
+**
+** @param [u] bamdata [SeqPBamData] BAM input data
+** @return [ajint] Record length on success, -1 at end of input
+**                 and less than -1 on error
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajint seqBamNext(SeqPBamData bamdata)
+{
+    AjPSeqBam b;
+    AjPSeqBamCore c;
+    ajint ret;
+    ajint beg;
+    ajint end;
+    ajint rend;
+
+    b = bamdata->Bam;
+
+    if(!bamdata->Select)
+        return ajSeqBamRead(bamdata->Gzfile, b);
+
+    if(!bamdata->Index)
+    {
+        while((ret = ajSeqBamRead(bamdata->Gzfile, b)) >= 0)
         {
-            ajDebug("seqReadBam rewind failed errno %d: %s\n",
-                    errno, strerror(errno));
-            return ajFalse;
-        }
-        
-        AJNEW0(bamdata);
+            c = &b->core;
 
-        bamdata->gzfile = ajSeqBamBgzfNew(ajFilebuffGetFileptr(buff),"r");
+            if(c->tid < 0 || (ajuint) c->tid >= bamdata->Nref ||
+               !bamdata->Select[c->tid])
+                continue;
 
-        ajDebug("gzfile %x  fd:%d file:%x ubs:%d cbs:%d blen:%d boff:%d "
-                "cache:%d open:'%c'\n",
-                bamdata->gzfile, bamdata->gzfile->file_descriptor,
-                bamdata->gzfile->file,
-                bamdata->gzfile->uncompressed_block_size,
-                bamdata->gzfile->compressed_block_size,
-                bamdata->gzfile->block_length, bamdata->gzfile->block_offset,
-                bamdata->gzfile->cache_size,
-                bamdata->gzfile->open_mode);
+            if(!seqBamRegion(bamdata, c->tid, &beg, &end))
+                continue;
 
+            if(c->n_cigar)
+                rend = (ajint) ajSeqBamCalend(c, MAJSEQBAMCIGAR(b));
+            else
+                rend = c->pos + 1;
 
-        /* BAM header */
+            if(rend > beg && c->pos < end)
+                return ret;
+        }
 
-        /* read plain text and the number of reference sequences */
-        header = ajSeqBamHeaderRead(bamdata->gzfile);
-        if (!header)
+        return ret;
+    }
+
+    for(;;)
+    {
+        if(bamdata->Iter)
         {
-            ajDebug("failed ajSeqBamHeaderRead, seqReadBam returns ajFalse\n");
-            ajSeqBamBgzfClose(bamdata->gzfile);
-            AJFREE(bamdata);
-            ajFileSeek(infile,filestat,0);
-            ajFilebuffResetPos(buff);
-            ajFileTrace(infile);
-            ajFilebuffTrace(buff);
-            return ajFalse;
+            ret = ajBamIterRead(bamdata->Gzfile, bamdata->Iter, b);
+
+            if(ret != -1)
+                return ret;
+
+            ajBamIterDel(&bamdata->Iter);
         }
 
-        ajSeqBamHeaderDel(&header);
+        do
+        {
+            bamdata->Tid++;
+        } while(bamdata->Tid < (ajint) bamdata->Nref &&
+                !bamdata->Select[bamdata->Tid]);
+
+        if(bamdata->Tid >= (ajint) bamdata->Nref ||
+           bamdata->Tid >= bamdata->Index->n)
+            return -1;
 
-        bamdata->bam = (AjPSeqBam)calloc(1, sizeof(AjOSeqBam));
-        seqin->SeqData = bamdata;
+        if(seqBamRegion(bamdata, bamdata->Tid, &beg, &end))
+            bamdata->Iter = ajBamIterQuery(bamdata->Index, bamdata->Tid,
+                                           beg, end);
     }
+}
 
-    /* next BAM record */
 
-    bamdata = seqin->SeqData;
-    b = bamdata->bam;
-    ret = ajSeqBamRead(bamdata->gzfile, b);
-    if(ret < -1)
-        ajErr("seqReadBam truncated file return %d\n", ret);
 
-    if(ret == -1)
-    {
-        ajSeqBamBgzfClose(bamdata->gzfile);
-        ajFilebuffClear(seqin->Input->Filebuff, 0);
-        /*seqMsfDataDel((SeqPMsfData*)&seqin->SeqData);*/
-        free(bamdata->bam->data); free(bamdata->bam);
 
-        AJFREE(seqin->SeqData);
-        return ajFalse;
-    }
+/* @funcstatic seqBamTrace ****************************************************
+**
+** Reports the fields of a BAM alignment record to the debug file.
+**
+** @param [r] b [const AjPSeqBam] BAM alignment record
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void seqBamTrace(const AjPSeqBam b)
+{
+    const AjOSeqBamCore* c;
+    const unsigned char* d;
+    ajuint dpos;
+    ajuint i;
+    int cigop;
+    ajuint cigend;
+    ajuint cigint;
+    unsigned char dp;
+    AjPStr cigarstr = NULL;
+    AjPStr seqstr = NULL;
+    AjPStr qualstr = NULL;
+    AjPStr tagstr = NULL;
 
     c = &b->core;
+
     ajDebug("rID: %d pos: %d bin: %hd mapQual: %d read_name_len: %d"
             " flag_nc: %hd cigar_len: %hd read_len: %d"
             " mate_rID: %d mate_pos: %d ins_size: %d\n",
@@ -10222,9 +10859,6 @@ static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
             b->l_aux, b->data_len, b->m_data);
     d = b->data;
     dpos = 0;
-    ajStrAssignC(&namestr, (const char*) &d[dpos]);
-    ajSeqSetName(thys, namestr);
-    ajStrDel(&namestr);
     ajDebug("read name: %p '%s'\n", dpos, &d[dpos]);
     dpos += (c->l_qname); /* l_qname includes trailing null */
     ajStrAssignC(&cigarstr, "");
@@ -10252,14 +10886,10 @@ static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
     }
     dpos += (c->l_qseq+1)/2;
     ajDebug("seq: %p '%S'\n", dpos, seqstr);
-
-    ajStrAssignRef(&thys->Seq, seqstr);
     ajStrDel(&seqstr);
 
     if(d[dpos] == 0xFF)
     {
-        AJFREE(thys->Accuracy);
-        thys->Qualsize = 0;
         ajDebug("qual: MISSING\n");
         dpos += c->l_qseq;
     }
@@ -10267,17 +10897,8 @@ static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
     {
         ajStrAssignC(&qualstr, "");
 
-        if(thys->Qualsize < (ajuint) c->l_qseq)
-        {
-            AJCRESIZE(thys->Accuracy, c->l_qseq);
-            thys->Qualsize = c->l_qseq;
-        }
-
         for(i=0; i < (ajuint) c->l_qseq; i++)
-        {
-            ajFmtPrintAppS(&qualstr, " %02x", 33 + d[dpos]);
-            thys->Accuracy[i] = (float) d[dpos++];
-        }
+            ajFmtPrintAppS(&qualstr, " %02x", 33 + d[dpos++]);
 
         ajDebug("qual: %p %S\n", dpos, qualstr);
         ajStrDel(&qualstr);
@@ -10361,6 +10982,168 @@ static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
     ajDebug("tags: %p '%S'\n", dpos, tagstr);
     ajStrDel(&tagstr);
 
+    return;
+}
+
+
+
+
+/* @funcstatic seqReadBam *****************************************************
+**
+** Given data in a sequence structure, tries to read everything needed
+** using binary alignment/map (BAM) format.
+**
+** @param [w] thys [AjPSeq] Sequence object
+** @param [u] seqin [AjPSeqin] Sequence input object
+** @return [AjBool] ajTrue on success
+**
+** @release 6.3.0
+** @@
+******************************************************************************/
+
+static AjBool seqReadBam(AjPSeq thys, AjPSeqin seqin)
+{
+    AjPFilebuff buff;
+    AjPFile infile;
+    ajuint i;
+    AjPSeqBam b = NULL;
+    AjPSeqBamCore c;
+    ajint ret = 0;
+    SeqPBamData bamdata = NULL;
+    static AjBool called = ajFalse;
+    static AjBool bigendian = ajFalse;
+    const unsigned char* d;
+    ajuint dpos;
+    char* cp;
+    AjPSeqBamHeader header = NULL;
+    ajint filestat;
+
+
+    if(!called)
+    {
+        called = ajTrue;
+        bigendian = ajUtilGetBigendian();
+        ajDebug("seqReadBam bam bigendian: %B\n", bigendian);
+    }
+
+    buff = seqin->Input->Filebuff;
+    infile = ajFilebuffGetFile(buff);
+
+    if(!seqin->SeqData)
+    {
+        ajFileTrace(infile);
+        ajFilebuffTrace(buff);
+
+        /* reset to beginning of file -
+        ** has at least been tested for blank lines */
+        filestat = ajFileSeek(infile, 0L, SEEK_SET);
+        if(filestat != 0)
+        {
+            ajDebug("seqReadBam rewind failed errno %d: %s\n",
+                    errno, strerror(errno));
+            return ajFalse;
+        }
+        
+        AJNEW0(bamdata);
+
+        bamdata->Gzfile = ajSeqBamBgzfNew(ajFilebuffGetFileptr(buff),"r");
+
+        ajDebug("gzfile %x  fd:%d file:%x ubs:%d cbs:%d blen:%d boff:%d "
+                "cache:%d open:'%c'\n",
+                bamdata->Gzfile, bamdata->Gzfile->file_descriptor,
+                bamdata->Gzfile->file,
+                bamdata->Gzfile->uncompressed_block_size,
+                bamdata->Gzfile->compressed_block_size,
+                bamdata->Gzfile->block_length, bamdata->Gzfile->block_offset,
+                bamdata->Gzfile->cache_size,
+                bamdata->Gzfile->open_mode);
+
+
+        /* BAM header */
+
+        /* read plain text and the number of reference sequences */
+        header = ajSeqBamHeaderRead(bamdata->Gzfile);
+        if (!header)
+        {
+            ajDebug("failed ajSeqBamHeaderRead, seqReadBam returns ajFalse\n");
+            ajSeqBamBgzfClose(bamdata->Gzfile);
+            AJFREE(bamdata);
+            ajFileSeek(infile,filestat,0);
+            ajFilebuffResetPos(buff);
+            ajFileTrace(infile);
+            ajFilebuffTrace(buff);
+            return ajFalse;
+        }
+
+        bamdata->Header = header;
+        bamdata->Nref = header->n_targets;
+        bamdata->Tid = -1;
+        bamdata->Bam = (AjPSeqBam)calloc(1, sizeof(AjOSeqBam));
+
+        /* reference region query */
+
+        seqBamSelect(bamdata, seqin, infile);
+
+        seqin->SeqData = bamdata;
+    }
+
+    /* next BAM record */
+
+    bamdata = seqin->SeqData;
+    b = bamdata->Bam;
+    ret = seqBamNext(bamdata);
+    if(ret < -1)
+        ajErr("seqReadBam truncated file return %d\n", ret);
+
+    if(ret == -1)
+    {
+        ajFilebuffClear(seqin->Input->Filebuff, 0);
+        seqBamDataDel((SeqPBamData*)&seqin->SeqData);
+
+        return ajFalse;
+    }
+
+    c = &b->core;
+
+    if(ajDebugOn())
+        seqBamTrace(b);
+
+    d = b->data;
+    dpos = 0;
+    ajStrAssignC(&seqToken, (const char*) &d[dpos]);
+    ajSeqSetName(thys, seqToken);
+    dpos += (c->l_qname); /* l_qname includes trailing null */
+    dpos += 4 * c->n_cigar;
+
+    /* decode the 4-bit bases straight into the sequence buffer */
+
+    ajStrSetRes(&thys->Seq, c->l_qseq + 1);
+    cp = ajStrGetuniquePtr(&thys->Seq);
+
+    for(i=0; i < (ajuint) c->l_qseq; i++)
+        cp[i] = bam_nt16_rev_table[MAJSEQBAMSEQI(&d[dpos], i)];
+
+    cp[i] = '\0';
+    ajStrSetValidLen(&thys->Seq, c->l_qseq);
+    dpos += (c->l_qseq+1)/2;
+
+    if(!c->l_qseq || d[dpos] == 0xFF)
+    {
+        AJFREE(thys->Accuracy);
+        thys->Qualsize = 0;
+    }
+    else
+    {
+        if(thys->Qualsize < (ajuint) c->l_qseq)
+        {
+            AJCRESIZE(thys->Accuracy, c->l_qseq);
+            thys->Qualsize = c->l_qseq;
+        }
+
+        for(i=0; i < (ajuint) c->l_qseq; i++)
+            thys->Accuracy[i] = (float) d[dpos++];
+    }
+
     bamdata->Count++;
 
     return ajTrue;
@@ -11130,6 +11913,49 @@ static AjBool seqGcgMsfReadseq(const AjPStr rdline, const AjPTable msftable)
 
 
 
+/* @funcstatic seqBamDataDel **************************************************
+**
+** Destructor for SeqPBamData objects. Closes the BGZF input file.
+**
+** @param [d] pthys [SeqPBamData*] BAM data object
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void seqBamDataDel(SeqPBamData* pthys)
+{
+    SeqPBamData thys;
+
+    if(!pthys)
+        return;
+
+    if(!*pthys)
+        return;
+
+    thys = *pthys;
+
+    ajDebug("seqBamDataDel Count:%u Nref:%u\n", thys->Count, thys->Nref);
+
+    ajBamIterDel(&thys->Iter);
+    ajBamIndexDel(&thys->Index);
+    ajSeqBamHeaderDel(&thys->Header);
+    AJFREE(thys->Select);
+
+    ajSeqBamBgzfClose(thys->Gzfile);
+
+    free(thys->Bam->data);
+    free(thys->Bam);
+
+    AJFREE(*pthys);
+
+    return;
+}
+
+
+
+
 /* @funcstatic seqMsfDataDel **************************************************
 **
 ** Destructor for SeqPMsfData objects
@@ -16880,17 +17706,56 @@ static AjBool seqSetInFormat(const AjPStr format)
 
 static ajuint seqAppend(AjPStr* pseq, const AjPStr line)
 {
-    ajuint ret = 0;
+    return seqAppendLenC(pseq, MAJSTRGETPTR(line), MAJSTRGETLEN(line));
+}
 
-    ajStrAssignS(&seqAppendTmpstr, line);
-    ajStrKeepSetAlphaC(&seqAppendTmpstr, "*.~?#+-");
-    ajStrAppendS(pseq, seqAppendTmpstr);
 
-    ret = ajStrGetLen(*pseq);
 
-    ajStrDelStatic(&seqAppendTmpstr);
 
-    return ret;
+/* @funcstatic seqAppendLenC **************************************************
+**
+** Appends sequence characters in a line of known length to a growing
+** sequence, filtering them directly into the end of the sequence.
+** Non sequence characters are simply ignored.
+**
+** @param [u] pseq [AjPStr*] Sequence as a string
+** @param [r] line [const char*] Input line, not necessarily null-terminated
+** @param [r] len [ajuint] Input line length
+** @return [ajuint] Sequence length to date.
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajuint seqAppendLenC(AjPStr* pseq, const char* line, ajuint len)
+{
+    const unsigned char* cp;
+    const unsigned char* cpend;
+    char* cq;
+    size_t seqlen;
+
+    if(!seqAppendFilter)
+        seqAppendFilter = ajCharGetfilter( "*.~?#+-"
+                                           "abcdefghijklmnopqrstuvwxyz"
+                                           "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+    seqlen = ajStrGetLen(*pseq);
+    ajStrSetResRound(pseq, seqlen+len+1);
+
+    cq = ajStrGetuniquePtr(pseq) + seqlen;
+    cp = (const unsigned char*) line;
+    cpend = cp + len;
+
+    while(cp < cpend)
+    {
+        if(seqAppendFilter[*cp])
+            *cq++ = (char) *cp;
+
+        cp++;
+    }
+
+    ajStrSetValidLen(pseq, cq - MAJSTRGETPTR(*pseq));
+
+    return ajStrGetLen(*pseq);
 }
 
 
@@ -17035,29 +17900,57 @@ static ajuint seqAppendCommented(AjPStr* pseq, AjBool* incomment,
 
 static const AjPStr seqAppendWarn(AjPStr* pseq, const AjPStr line,
                                   ajuint informat)
+{
+    return seqAppendWarnLenC(pseq, MAJSTRGETPTR(line), MAJSTRGETLEN(line),
+                             informat);
+}
+
+
+
+
+/* @funcstatic seqAppendWarnLenC **********************************************
+**
+** Appends sequence characters in a line of known length to a growing
+** sequence.
+**
+** The characters are filtered directly into the end of the sequence so
+** that a line view from the input block buffer is never copied into a
+** temporary string.
+**
+** Non sequence characters are reported in the return value
+** if EMBOSS_SEQWARN is set
+**
+** @param [u] pseq [AjPStr*] Sequence as a string
+** @param [r] line [const char*] Input line, not necessarily null-terminated
+** @param [r] len [ajuint] Input line length
+** @param [r] informat [ajuint] Input format, zero for unknown
+** @return [const AjPStr] Any rejected non-space characters
+**
+** @release 6.6.0
+******************************************************************************/
+
+static const AjPStr seqAppendWarnLenC(AjPStr* pseq, const char* line,
+                                      ajuint len, ajuint informat)
 {
     AjPStr tmpstr = NULL;
+    const unsigned char* cp;
+    const unsigned char* cpend;
+    char* cq;
+    size_t seqlen;
 
     if(!seqAppendRestStr)
     {
         if(ajNamGetValueC("seqwarn", &tmpstr))
             ajStrToBool(tmpstr, &seqDoWarnAppend);
         seqAppendRestStr = ajStrNew();
+        ajStrDel(&tmpstr);
     }
 
-    ajStrAssignS(&seqAppendTmpSeq, line);
-
-    if(seqDoWarnAppend || informat)
+    if(!seqDoWarnAppend && !informat)
     {
-        ajStrKeepSetAlphaRestC(&seqAppendTmpSeq, "*.~?#+-", &seqAppendRestStr);
-        ajStrAppendS(pseq, seqAppendTmpSeq);
+        seqAppendLenC(pseq, line, len);
 
-        ajStrDelStatic(&seqAppendTmpSeq);
-
-        if(!ajStrGetLen(seqAppendRestStr))
-            return NULL;
-
-        return seqAppendRestStr;
+        return NULL;
     }
 
     if(!seqAppendFilter)
@@ -17065,13 +17958,31 @@ static const AjPStr seqAppendWarn(AjPStr* pseq, const AjPStr line,
                                            "abcdefghijklmnopqrstuvwxyz"
                                            "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
 
-    ajStrKeepSetFilter(&seqAppendTmpSeq, seqAppendFilter);
-    
-    ajStrAppendS(pseq, seqAppendTmpSeq);
+    ajStrAssignClear(&seqAppendRestStr);
 
-    ajStrDelStatic(&seqAppendTmpSeq);
+    seqlen = ajStrGetLen(*pseq);
+    ajStrSetResRound(pseq, seqlen+len+1);
+
+    cq = ajStrGetuniquePtr(pseq) + seqlen;
+    cp = (const unsigned char*) line;
+    cpend = cp + len;
+
+    while(cp < cpend)
+    {
+        if(seqAppendFilter[*cp])
+            *cq++ = (char) *cp;
+        else if(*cp && !isspace((ajint)*cp))
+            ajStrAppendK(&seqAppendRestStr, (char) *cp);
+
+        cp++;
+    }
+
+    ajStrSetValidLen(pseq, cq - MAJSTRGETPTR(*pseq));
+
+    if(!ajStrGetLen(seqAppendRestStr))
+        return NULL;
 
-    return NULL;
+    return seqAppendRestStr;
 }
 
 
@@ -19418,7 +20329,6 @@ void ajSeqReadExit(void)
     ajStrDel(&seqToken);
     ajStrDel(&seqToken2);
     ajStrDel(&seqTokenSplit);
-    ajStrDel(&seqAppendTmpstr);
 
     return;
 }
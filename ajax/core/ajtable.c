@@ -65,6 +65,15 @@
 /* =========================== private constants =========================== */
 /* ========================================================================= */
 
+/* open addressing slot states, hash values are stored plus 2 */
+
+#define TABLE_OPEN_EMPTY   0UL
+#define TABLE_OPEN_DELETED 1UL
+
+/* largest prime below 2**32, to give the full hash value of a key */
+
+#define TABLE_OPEN_HASHMAX 4294967291UL
+
 
 
 
@@ -97,6 +106,16 @@ static void   tableDel(void** Pkey, void** Pvalue, void* cl);
 static void   tableDelKey(void** Pkey, void** Pvalue, void* cl);
 static void   tableFreeSetExpand (void);
 static ajulong tableHashAtom(const void* key, ajulong hashsize);
+static AjBool tableMergeOpen(AjPTable thys, AjPTable table,
+                             AjBool keepmatch, AjBool keepother,
+                             AjBool addother);
+static AjPTableSlot tableOpenFind(const AjPTable table, const void* key);
+static ajulong tableOpenHash(const AjPTable table, const void* key);
+static AjPTableSlot tableOpenInsert(AjPTable table, void* key,
+                                    AjBool* Pfound);
+static void   tableOpenRemove(AjPTable table, AjPTableSlot slot);
+static void   tableOpenResize(AjPTable table, ajulong count);
+static ajulong tableOpenStart(ajulong hash, ajulong size);
 static void   tableStrDel(void** Pkey, void** Pvalue, void* cl);
 static void   tableStrDelKey(void** Pkey, void** Pvalue, void* cl);
 
@@ -151,6 +170,7 @@ static void   tableStrFromKey(const AjPTable table, const void* key,
 **
 ** @nam3rule New Constructor
 ** @nam4rule Function Functions defined by caller
+** @nam5rule Open Open addressing storage
 **
 ** @argrule New size [ajulong] Number of key values
 ** @argrule Function cmp [ajint function] Comparison function returning
@@ -292,6 +312,332 @@ AjPTable ajTableNewFunctionLen(ajulong size,
 
 
 
+/* @func ajTableNewFunctionOpen ***********************************************
+**
+** creates, initialises, and returns a new, empty table that expects
+** a specified number of key-value pairs, using open addressing.
+**
+** Keys and values are held in a single array of slots with the full hash
+** value of each key, which avoids allocating a node for each entry.
+** The array size is a power of 2 that keeps the table at most half full
+** for the expected number of key-value pairs.
+**
+** @param [r] size [ajulong] number of key-value pairs
+** @param [fN] cmp  [ajint function] function for comparing
+** @param [fN] hash [ajulong function] function for hashing keys
+** @param [fN] keydel [void function] key destructor function
+** @param [fN] valdel [void function] value destructor function
+**
+** @return [AjPTable] new table.
+**
+**
+** @release 6.6.0
+** @@
+**
+******************************************************************************/
+
+AjPTable ajTableNewFunctionOpen(ajulong size,
+                                ajint (*cmp)(const void* key1,
+                                             const void* key2),
+                                ajulong (*hash)(const void* key,
+                                                ajulong hashsize),
+                                void (*keydel)(void** Pkey),
+                                void (*valdel)(void** Pvalue))
+{
+    AjPTable table = NULL;
+
+    AJNEW0(table);
+    table->Fcmp    = cmp;
+    table->Fhash   = hash;
+    table->Fkeydel = keydel;
+    table->Fvaldel = valdel;
+
+    tableOpenResize(table, size);
+
+    table->Length    = 0UL;
+    table->Timestamp = 0U;
+
+#ifdef AJ_SAVESTATS
+    tableNewCnt++;
+
+    if(table->Size > tableMaxNum)
+        tableMaxNum = (ajuint) table->Size;
+
+    if(sizeof(*table) > tableMaxMem)
+        tableMaxMem = sizeof(*table);
+#endif
+
+    table->Use = 1;
+    table->Type = ajETableTypeUser;
+
+    return table;
+}
+
+
+
+
+/* @funcstatic tableOpenHash **************************************************
+**
+** Returns the value stored in an open addressing slot for a key:
+** the full hash value plus 2 so that it cannot be confused with
+** an empty or deleted slot.
+**
+** @param [r] table [const AjPTable] Table
+** @param [r] key [const void*] Key
+** @return [ajulong] Hash value for the slot
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajulong tableOpenHash(const AjPTable table, const void* key)
+{
+    return (*table->Fhash)(key, TABLE_OPEN_HASHMAX) + 2UL;
+}
+
+
+
+
+/* @funcstatic tableOpenStart *************************************************
+**
+** Returns the first slot to probe for a hash value. The table hash
+** functions are simple, so the bits are mixed before masking to the
+** power of 2 table size.
+**
+** @param [r] hash [ajulong] Slot hash value
+** @param [r] size [ajulong] Number of slots
+** @return [ajulong] First slot to probe
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajulong tableOpenStart(ajulong hash, ajulong size)
+{
+    ajuint h = (ajuint) hash;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+
+    return (ajulong) h & (size - 1UL);
+}
+
+
+
+
+/* @funcstatic tableOpenFind **************************************************
+**
+** Returns the open addressing slot holding a key, or NULL if the key
+** is not in the table.
+**
+** @param [r] table [const AjPTable] Table
+** @param [r] key [const void*] Key
+** @return [AjPTableSlot] Slot for key, or NULL if not found
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjPTableSlot tableOpenFind(const AjPTable table, const void* key)
+{
+    ajulong hash = 0UL;
+    ajulong mask = 0UL;
+    ajulong i    = 0UL;
+
+    AjPTableSlot slot = NULL;
+
+    hash = tableOpenHash(table, key);
+    mask = table->Size - 1UL;
+
+    for(i = tableOpenStart(hash, table->Size); ; i = (i + 1UL) & mask)
+    {
+        slot = &table->Slots[i];
+
+        if(slot->Hash == TABLE_OPEN_EMPTY)
+            return NULL;
+
+        if(slot->Hash == hash && (*table->Fcmp)(key, slot->Key) == 0)
+            return slot;
+    }
+
+    return NULL;
+}
+
+
+
+
+/* @funcstatic tableOpenInsert ************************************************
+**
+** Returns the open addressing slot holding a key, adding the key if it is
+** not already in the table. The value of a new slot is NULL.
+**
+** The table is resized first if adding a key would leave it more than
+** two thirds full, counting deleted slots.
+**
+** @param [u] table [AjPTable] Table
+** @param [u] key [void*] Key
+** @param [w] Pfound [AjBool*] True if the key was already in the table
+** @return [AjPTableSlot] Slot for key
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjPTableSlot tableOpenInsert(AjPTable table, void* key,
+                                    AjBool* Pfound)
+{
+    ajulong hash = 0UL;
+    ajulong mask = 0UL;
+    ajulong i    = 0UL;
+
+    AjPTableSlot slot    = NULL;
+    AjPTableSlot deleted = NULL;
+
+    if(3UL * (table->Length + table->Deleted + 1UL) > 2UL * table->Size)
+        tableOpenResize(table, table->Length + 1UL);
+
+    hash = tableOpenHash(table, key);
+    mask = table->Size - 1UL;
+
+    for(i = tableOpenStart(hash, table->Size); ; i = (i + 1UL) & mask)
+    {
+        slot = &table->Slots[i];
+
+        if(slot->Hash == TABLE_OPEN_EMPTY)
+            break;
+
+        if(slot->Hash == TABLE_OPEN_DELETED)
+        {
+            if(!deleted)
+                deleted = slot;
+        }
+        else if(slot->Hash == hash && (*table->Fcmp)(key, slot->Key) == 0)
+        {
+            *Pfound = ajTrue;
+
+            return slot;
+        }
+    }
+
+    if(deleted)
+    {
+        slot = deleted;
+        table->Deleted--;
+    }
+
+    slot->Hash  = hash;
+    slot->Key   = key;
+    slot->Value = NULL;
+    table->Length++;
+
+    *Pfound = ajFalse;
+
+    return slot;
+}
+
+
+
+
+/* @funcstatic tableOpenRemove ************************************************
+**
+** Marks an open addressing slot as deleted. The key and value are not
+** freed.
+**
+** @param [u] table [AjPTable] Table
+** @param [u] slot [AjPTableSlot] Slot in table
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void tableOpenRemove(AjPTable table, AjPTableSlot slot)
+{
+    ajulong next = 0UL;
+
+    next = ((ajulong) (slot - table->Slots) + 1UL) & (table->Size - 1UL);
+
+    /* no probe continues past an empty slot, so this one can also be empty */
+
+    if(table->Slots[next].Hash == TABLE_OPEN_EMPTY)
+        slot->Hash = TABLE_OPEN_EMPTY;
+    else
+    {
+        slot->Hash = TABLE_OPEN_DELETED;
+        table->Deleted++;
+    }
+
+    slot->Key   = NULL;
+    slot->Value = NULL;
+    table->Length--;
+
+    return;
+}
+
+
+
+
+/* @funcstatic tableOpenResize ************************************************
+**
+** Resizes the slot array of an open addressing table to hold a number of
+** key-value pairs, or the current number if larger, at most half full.
+**
+** All entries are moved to the new array in one pass using their stored
+** hash values, without calling the table hash or comparison functions.
+** Deleted slots are dropped.
+**
+** @param [u] table [AjPTable] Table
+** @param [r] count [ajulong] Expected number of key-value pairs
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void tableOpenResize(AjPTable table, ajulong count)
+{
+    ajulong newsize = 8UL;
+    ajulong mask    = 0UL;
+    ajulong i       = 0UL;
+    ajulong j       = 0UL;
+
+    AjPTableSlot oldslots = NULL;
+
+    if(count < table->Length)
+        count = table->Length;
+
+    while(newsize < 2UL * count)
+        newsize += newsize;
+
+    if(newsize == table->Size && !table->Deleted)
+        return;
+
+    oldslots = table->Slots;
+    AJCNEW0(table->Slots, newsize);
+    mask = newsize - 1UL;
+
+    for(i = 0UL; i < table->Size; i++)
+    {
+        if(oldslots[i].Hash <= TABLE_OPEN_DELETED)
+            continue;
+
+        for(j = tableOpenStart(oldslots[i].Hash, newsize);
+            table->Slots[j].Hash != TABLE_OPEN_EMPTY;
+            j = (j + 1UL) & mask)
+            continue;
+
+        table->Slots[j] = oldslots[i];
+    }
+
+    AJFREE(oldslots);
+
+    table->Size    = newsize;
+    table->Deleted = 0UL;
+    table->Timestamp++;
+
+    return;
+}
+
+
+
+
 /* @section Destructors *******************************************************
 **
 ** @fdata [AjPTable]
@@ -350,6 +696,7 @@ void ajTableDel(AjPTable* Ptable)
         ajTableClearDelete(thys);
 
         AJFREE(thys->Buckets);
+        AJFREE(thys->Slots);
         AJFREE(*Ptable);
     }
 
@@ -400,6 +747,7 @@ void ajTableDelKeydelValdel(AjPTable* Ptable,
         ajTableClearDelete(thys);
 
         AJFREE(thys->Buckets);
+        AJFREE(thys->Slots);
         AJFREE(*Ptable);
     }
 
@@ -447,6 +795,7 @@ void ajTableDelValdel(AjPTable* Ptable,
         ajTableClearDelete(thys);
 
         AJFREE(thys->Buckets);
+        AJFREE(thys->Slots);
         AJFREE(*Ptable);
     }
 
@@ -490,6 +839,7 @@ void ajTableFree(AjPTable* Ptable)
         ajTableClear(thys);
 
         AJFREE(thys->Buckets);
+        AJFREE(thys->Slots);
         AJFREE(*Ptable);
     }
 
@@ -648,6 +998,7 @@ const void* ajTableFetchC(const AjPTable table, const char* txtkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -664,6 +1015,13 @@ const void* ajTableFetchC(const AjPTable table, const char* txtkey)
     if(table->Type != ajETableTypeChar)
         ajFatal("ajTableFetchC called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, txtkey);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(txtkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -695,6 +1053,7 @@ const void* ajTableFetchS(const AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -708,6 +1067,13 @@ const void* ajTableFetchS(const AjPTable table, const AjPStr key)
     if(table->Type != ajETableTypeStr)
         ajFatal("ajTableFetchS called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -739,6 +1105,7 @@ const void* ajTableFetchV(const AjPTable table, const void* key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -746,6 +1113,13 @@ const void* ajTableFetchV(const AjPTable table, const void* key)
     if(!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -777,6 +1151,7 @@ void* ajTableFetchmodC(const AjPTable table, const char* txtkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -793,6 +1168,13 @@ void* ajTableFetchmodC(const AjPTable table, const char* txtkey)
     if(table->Type != ajETableTypeChar)
         ajFatal("ajTableFetchmodC called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, txtkey);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(txtkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -824,6 +1206,7 @@ void* ajTableFetchmodS(const AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -837,6 +1220,13 @@ void* ajTableFetchmodS(const AjPTable table, const AjPStr key)
     if(table->Type != ajETableTypeStr)
         ajFatal("ajTableFetchmodS called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -868,6 +1258,7 @@ void* ajTableFetchmodV(const AjPTable table, const void* key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -875,6 +1266,13 @@ void* ajTableFetchmodV(const AjPTable table, const void* key)
     if(!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -909,6 +1307,7 @@ void* ajTableFetchmodTraceV(const AjPTable table, const void* key)
     ajulong j = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -919,6 +1318,19 @@ void* ajTableFetchmodTraceV(const AjPTable table, const void* key)
     ajDebug("ajTableFetchmodTraceV length %Lu key %x (%Lu)\n",
             table->Length, key, key);
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        if(slot)
+            ajDebug("...open addressing found %x (%Lu)\n",
+                    slot->Value, slot->Value);
+        else
+            ajDebug("...open addressing no match\n");
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     ajDebug("...hash to bucket %Lu\n", i);
@@ -1007,6 +1419,7 @@ AjBool ajTableMatchC(const AjPTable table, const char* txtkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return ajFalse;
@@ -1023,6 +1436,13 @@ AjBool ajTableMatchC(const AjPTable table, const char* txtkey)
     if(table->Type != ajETableTypeChar)
         ajFatal("ajTableMatchC called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, txtkey);
+
+        return slot ? ajTrue : ajFalse;
+    }
+
     i = (*table->Fhash)(txtkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -1054,6 +1474,7 @@ AjBool ajTableMatchS(const AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return ajFalse;
@@ -1067,6 +1488,13 @@ AjBool ajTableMatchS(const AjPTable table, const AjPStr key)
     if(table->Type != ajETableTypeStr)
         ajFatal("ajTableMatchS called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? ajTrue : ajFalse;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -1098,6 +1526,7 @@ AjBool ajTableMatchV(const AjPTable table, const void* key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return ajFalse;
@@ -1105,6 +1534,13 @@ AjBool ajTableMatchV(const AjPTable table, const void* key)
     if(!key)
         return ajFalse;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? ajTrue : ajFalse;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -1147,9 +1583,18 @@ ajulong ajTableToarrayKeys(const AjPTable table,
 
     *keyarray = AJALLOC((size_t)(table->Length + 1) * sizeof(keyarray));
 
-    for(i = 0UL; i < table->Size; i++)
-        for(node = table->Buckets[i]; node; node = node->Link)
-            (*keyarray)[j++] = node->Key;
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+                (*keyarray)[j++] = table->Slots[i].Key;
+    }
+    else
+    {
+        for(i = 0UL; i < table->Size; i++)
+            for(node = table->Buckets[i]; node; node = node->Link)
+                (*keyarray)[j++] = node->Key;
+    }
 
     (*keyarray)[j] = NULL;
 
@@ -1194,12 +1639,24 @@ ajulong ajTableToarrayKeysValues(const AjPTable table,
     *keyarray = AJALLOC((size_t)(table->Length + 1) * sizeof(keyarray));
     *valarray = AJALLOC((size_t)(table->Length + 1) * sizeof(valarray));
 
-    for(i = 0UL; i < table->Size; i++)
-        for(node = table->Buckets[i]; node; node = node->Link)
-        {
-            (*keyarray)[j]   = node->Key;
-            (*valarray)[j++] = node->Value;
-        }
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                (*keyarray)[j]   = table->Slots[i].Key;
+                (*valarray)[j++] = table->Slots[i].Value;
+            }
+    }
+    else
+    {
+        for(i = 0UL; i < table->Size; i++)
+            for(node = table->Buckets[i]; node; node = node->Link)
+            {
+                (*keyarray)[j]   = node->Key;
+                (*valarray)[j++] = node->Value;
+            }
+    }
 
     (*keyarray)[j] = NULL;
     (*valarray)[j] = NULL;
@@ -1240,11 +1697,20 @@ ajulong ajTableToarrayValues(const AjPTable table,
 
     *valarray = AJALLOC((size_t)(table->Length + 1) * sizeof(valarray));
 
-    for(i = 0UL; i < table->Size; i++)
-        for(node = table->Buckets[i]; node; node = node->Link)
-        {
-            (*valarray)[j++] = node->Value;
-        }
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+                (*valarray)[j++] = table->Slots[i].Value;
+    }
+    else
+    {
+        for(i = 0UL; i < table->Size; i++)
+            for(node = table->Buckets[i]; node; node = node->Link)
+            {
+                (*valarray)[j++] = node->Value;
+            }
+    }
 
     (*valarray)[j] = NULL;
 
@@ -1296,6 +1762,21 @@ void ajTableTrace(const AjPTable table)
     ajDebug(" size: %Lu", table->Size);
     ajDebug(" timestamp: %u", table->Timestamp);
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                j = tableOpenStart(table->Slots[i].Hash, table->Size);
+                k += (i - j) & (table->Size - 1UL);
+            }
+
+        ajDebug(" deleted: %Lu", table->Deleted);
+        ajDebug(" probes: %Lu\n", k);
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
         if(table->Buckets[i])
         {
@@ -1364,6 +1845,10 @@ void* ajTablePut(AjPTable table, void* key, void* value)
 
     AjPTableNode node = NULL;
 
+    AjPTableSlot slot = NULL;
+
+    AjBool found = ajFalse;
+
     void* prev = NULL;
 
     if(!table)
@@ -1372,6 +1857,26 @@ void* ajTablePut(AjPTable table, void* key, void* value)
     if(!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenInsert(table, key, &found);
+
+        if(found)
+        {
+            if(table->Fkeydel)
+            {
+                (*table->Fkeydel)(&slot->Key);
+                slot->Key = key;
+            }
+            prev = slot->Value;
+        }
+
+        slot->Value = value;
+        table->Timestamp++;
+
+        return prev;
+    }
+
     minsize = table->Length / 8UL;
     if(table->Size < minsize)
         ajTableResizeCount(table, 6*minsize);
@@ -1442,13 +1947,43 @@ AjBool ajTablePutClean(AjPTable table, void* key, void* value,
 
     AjPTableNode node = NULL;
 
+    AjPTableSlot slot = NULL;
+
+    AjBool found  = ajFalse;
     AjBool result = ajFalse;
 
     if(!table)
         return ajFalse;
 
-    if(!key)
-        return ajFalse;
+    if(!key)
+        return ajFalse;
+
+    if(table->Slots)
+    {
+        slot = tableOpenInsert(table, key, &found);
+
+        if(found)
+        {
+            if (keydel)
+                (*keydel) (&slot->Key);
+            else if (table->Fkeydel)
+                (*table->Fkeydel) (&slot->Key);
+
+            slot->Key = key;
+
+            if (valdel)
+                (*valdel) (&slot->Value);
+            else if (table->Fvaldel)
+                (*table->Fvaldel) (&slot->Value);
+
+            result = ajTrue;
+        }
+
+        slot->Value = value;
+        table->Timestamp++;
+
+        return result;
+    }
 
     minsize = table->Length / 8UL;
     if(table->Size < minsize)
@@ -1593,6 +2128,9 @@ void* ajTablePutTrace(AjPTable table, void* key, void* value)
     ajulong minsize = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
+
+    AjBool found = ajFalse;
 
     void* prev = NULL;
 
@@ -1605,6 +2143,28 @@ void* ajTablePutTrace(AjPTable table, void* key, void* value)
     if(!value)
         return NULL;
 
+    if(table->Slots)
+    {
+        ajDebug("ajTablePut length %Lu key %x (%Lu) value %x (%Lu)\n",
+                table->Length, key, key, value, value);
+
+        slot = tableOpenInsert(table, key, &found);
+
+        if(found)
+        {
+            ajDebug("...existing value %x %Lu\n", slot->Value, slot->Value);
+            prev = slot->Value;
+        }
+        else
+            ajDebug("...new slot %Lu of %Lu\n",
+                    (ajulong) (slot - table->Slots), table->Size);
+
+        slot->Value = value;
+        table->Timestamp++;
+
+        return prev;
+    }
+
     minsize = table->Length / 6UL;
     if(table->Size < minsize)
         ajTableResizeCount(table, 4 * table->Length);
@@ -1673,6 +2233,9 @@ void* ajTableRemove(AjPTable table, const void* key)
     ajulong i = 0UL;
 
     AjPTableNode* Pnode = NULL;
+    AjPTableSlot slot   = NULL;
+
+    void* oldvalue = NULL;
 
     if(!table)
         return NULL;
@@ -1688,6 +2251,24 @@ void* ajTableRemove(AjPTable table, const void* key)
     }
 
     table->Timestamp++;
+
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        if(!slot)
+            return NULL;
+
+        oldvalue = slot->Value;
+
+        if(table->Fkeydel)
+            (*table->Fkeydel)(&slot->Key);
+
+        tableOpenRemove(table, slot);
+
+        return oldvalue;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(Pnode = &table->Buckets[i]; *Pnode; Pnode = &(*Pnode)->Link)
@@ -1747,6 +2328,9 @@ void* ajTableRemoveKey(AjPTable table, const void* key, void** truekey)
     ajulong i = 0UL;
 
     AjPTableNode* Pnode = NULL;
+    AjPTableSlot slot   = NULL;
+
+    void* oldvalue = NULL;
 
     if(!table)
         return NULL;
@@ -1755,6 +2339,22 @@ void* ajTableRemoveKey(AjPTable table, const void* key, void** truekey)
         return NULL;
 
     table->Timestamp++;
+
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        if(!slot)
+            return NULL;
+
+        oldvalue = slot->Value;
+        *truekey = slot->Key;
+
+        tableOpenRemove(table, slot);
+
+        return oldvalue;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(Pnode = &table->Buckets[i]; *Pnode; Pnode = &(*Pnode)->Link)
@@ -1835,6 +2435,18 @@ void ajTableMap(AjPTable table,
 
     stamp = table->Timestamp;
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                (*apply)(table->Slots[i].Key, &table->Slots[i].Value, cl);
+                assert(table->Timestamp == stamp);
+            }
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
         for(node = table->Buckets[i]; node; node = node->Link)
         {
@@ -1880,6 +2492,22 @@ void ajTableMapDel(AjPTable table,
 
     stamp = table->Timestamp;
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                (*apply)(&table->Slots[i].Key, &table->Slots[i].Value, cl);
+                assert(table->Timestamp == stamp);
+            }
+
+        memset(table->Slots, 0, (size_t) table->Size * sizeof(AjOTableSlot));
+        table->Length  = 0UL;
+        table->Deleted = 0UL;
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
     {
         for(node1 = table->Buckets[i]; node1; node1 = node2)
@@ -1973,7 +2601,15 @@ void ajTableClear(AjPTable table)
     /*ajDebug("ajTableClear length: %Lu size: %Lu type: %u\n",
       table->Length, table->Size, table->Type);*/
 
-    if(table->Length > 0)
+    if(table->Slots)
+    {
+        if(table->Length || table->Deleted)
+            memset(table->Slots, 0,
+                   (size_t) table->Size * sizeof(AjOTableSlot));
+
+        table->Deleted = 0UL;
+    }
+    else if(table->Length > 0)
     {
         AjPTableNode node1 = NULL;
         AjPTableNode node2 = NULL;
@@ -2027,7 +2663,22 @@ void ajTableClearDelete(AjPTable table)
     if(!table)
         return;
 
-    if(table->Length > 0)
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                if(table->Fkeydel)
+                    (*table->Fkeydel)(&table->Slots[i].Key);
+
+                if(table->Fvaldel)
+                    (*table->Fvaldel)(&table->Slots[i].Value);
+            }
+
+        memset(table->Slots, 0, (size_t) table->Size * sizeof(AjOTableSlot));
+        table->Deleted = 0UL;
+    }
+    else if(table->Length > 0)
     {
 
         for(i = 0UL; i < table->Size; i++)
@@ -2075,6 +2726,13 @@ void ajTableClearDelete(AjPTable table)
 
 void ajTableResizeCount(AjPTable table, ajulong size)
 {
+    if(table && table->Slots)
+    {
+        tableOpenResize(table, size);
+
+        return;
+    }
+
     ajTableResizeHashsize(table, size/4);
 
     return;
@@ -2147,6 +2805,15 @@ void ajTableResizeHashsize(AjPTable table, ajulong hashsize)
     if(!table)
         return;
 
+    /* open addressing tables use a power of 2 number of slots */
+
+    if(table->Slots)
+    {
+        tableOpenResize(table, hashsize/2);
+
+        return;
+    }
+
     /* check the size required */
 
     hint = hashsize;
@@ -2801,6 +3468,12 @@ AjBool ajTableMergeAnd(AjPTable thys, AjPTable table)
     AjPTableNode pfirst  = NULL;
     AjPTableNode qfirst  = NULL;
 
+    /* open addressing tables are merged through the table functions */
+
+    if(thys->Slots || table->Slots)
+        return tableMergeOpen(thys, table, ajTrue, ajFalse,
+                              ajFalse);
+
     /* first we make both tables have the same hashsize */
 
     if(table->Size > thys->Size)
@@ -2919,6 +3592,12 @@ AjBool ajTableMergeEor(AjPTable thys, AjPTable table)
     AjPTableNode qfirst  = NULL;
     AjPTableNode qtmp    = NULL;
 
+    /* open addressing tables are merged through the table functions */
+
+    if(thys->Slots || table->Slots)
+        return tableMergeOpen(thys, table, ajFalse, ajTrue,
+                              ajTrue);
+
     /* first we make both tables have the same hashsize */
 
     if(table->Size > thys->Size)
@@ -3050,6 +3729,12 @@ AjBool ajTableMergeNot(AjPTable thys, AjPTable table)
     AjPTableNode pfirst  = NULL;
     AjPTableNode qfirst  = NULL;
 
+    /* open addressing tables are merged through the table functions */
+
+    if(thys->Slots || table->Slots)
+        return tableMergeOpen(thys, table, ajFalse, ajTrue,
+                              ajFalse);
+
     /* first we make both tables have the same hashsize */
 
     if(table->Size > thys->Size)
@@ -3166,6 +3851,12 @@ AjBool ajTableMergeOr(AjPTable thys, AjPTable table)
     AjPTableNode qfirst  = NULL;
     AjPTableNode qtmp    = NULL;
 
+    /* open addressing tables are merged through the table functions */
+
+    if(thys->Slots || table->Slots)
+        return tableMergeOpen(thys, table, ajTrue, ajTrue,
+                              ajTrue);
+
     /* first we make both tables have the same hashsize */
 
     if(table->Size > thys->Size)
@@ -3245,6 +3936,109 @@ AjBool ajTableMergeOr(AjPTable thys, AjPTable table)
 
 
 
+/* @funcstatic tableMergeOpen *************************************************
+**
+** Merge two tables where either uses open addressing, using the general
+** table functions rather than walking matching buckets.
+**
+** Keys in the current table are kept or deleted depending on whether they
+** are also in the table to be merged. Keys only in the table to be merged
+** are moved to the current table or deleted. The table to be merged is
+** left empty.
+**
+** @param [u] thys [AjPTable] Current table
+** @param [u] table [AjPTable] Table to be merged
+** @param [r] keepmatch [AjBool] Keep current keys found in both tables
+** @param [r] keepother [AjBool] Keep current keys not in the merged table
+** @param [r] addother [AjBool] Add merged table keys not in current table
+**
+** @return [AjBool] True on success
+**
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool tableMergeOpen(AjPTable thys, AjPTable table,
+                             AjBool keepmatch, AjBool keepother,
+                             AjBool addother)
+{
+    ajulong i = 0UL;
+    ajulong n = 0UL;
+
+    void** keyarray = NULL;
+    void** valarray = NULL;
+    void* truekey   = NULL;
+    void* value     = NULL;
+
+    AjBool ismatch  = ajFalse;
+    AjBool* matched = NULL;
+
+    /* note which new keys are in the current table before changing it */
+
+    n = ajTableToarrayKeysValues(table, &keyarray, &valarray);
+
+    if(n)
+        AJCNEW0(matched, n);
+
+    for(i = 0UL; i < n; i++)
+        matched[i] = ajTableMatchV(thys, keyarray[i]);
+
+    /* delete current keys that are not to be kept */
+
+    if(!keepmatch || !keepother)
+    {
+        void** thyskeys = NULL;
+        ajulong nthys   = 0UL;
+
+        nthys = ajTableToarrayKeys(thys, &thyskeys);
+
+        for(i = 0UL; i < nthys; i++)
+        {
+            ismatch = ajTableMatchV(table, thyskeys[i]);
+
+            if(ismatch ? keepmatch : keepother)
+                continue;
+
+            value = ajTableRemoveKey(thys, thyskeys[i], &truekey);
+
+            if(thys->Fkeydel)
+                (*thys->Fkeydel)(&truekey);
+
+            if(thys->Fvaldel)
+                (*thys->Fvaldel)(&value);
+        }
+
+        AJFREE(thyskeys);
+    }
+
+    /* move or delete the new keys */
+
+    for(i = 0UL; i < n; i++)
+    {
+        if(addother && !matched[i])
+            ajTablePut(thys, keyarray[i], valarray[i]);
+        else
+        {
+            if(table->Fkeydel)
+                (*table->Fkeydel)(&keyarray[i]);
+
+            if(table->Fvaldel)
+                (*table->Fvaldel)(&valarray[i]);
+        }
+    }
+
+    ajTableClear(table);
+
+    AJFREE(matched);
+    AJFREE(keyarray);
+    AJFREE(valarray);
+
+    return ajTrue;
+}
+
+
+
+
 /* @section Comparison functions **********************************************
 **
 ** @fdata [AjPTable]
@@ -3536,6 +4330,17 @@ void ajTablecharPrint(const AjPTable table)
     if(!table)
         return;
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+                ajUser("key '%s' value '%s'",
+                       (const char*) table->Slots[i].Key,
+                       (char*) table->Slots[i].Value);
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
         for(node = table->Buckets[i]; node; node = node->Link)
         {
@@ -3884,6 +4689,7 @@ const ajint* ajTableintFetch(const AjPTable table, const ajint* intkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -3891,6 +4697,13 @@ const ajint* ajTableintFetch(const AjPTable table, const ajint* intkey)
     if(!intkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, intkey);
+
+        return slot ? (const ajint*) slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(intkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -3942,6 +4755,7 @@ ajint* ajTableintFetchmod(AjPTable table, const ajint* intkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -3949,6 +4763,13 @@ ajint* ajTableintFetchmod(AjPTable table, const ajint* intkey)
     if(!intkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, intkey);
+
+        return slot ? (ajint*) (&slot->Value) : NULL;
+    }
+
     i = (*table->Fhash)(intkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4247,6 +5068,7 @@ const ajlong* ajTablelongFetch(const AjPTable table, const ajlong* longkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4254,6 +5076,13 @@ const ajlong* ajTablelongFetch(const AjPTable table, const ajlong* longkey)
     if(!longkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, longkey);
+
+        return slot ? (const ajlong*) slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(longkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4305,6 +5134,7 @@ ajlong* ajTablelongFetchmod(AjPTable table, const ajlong* longkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4312,6 +5142,13 @@ ajlong* ajTablelongFetchmod(AjPTable table, const ajlong* longkey)
     if(!longkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, longkey);
+
+        return slot ? (ajlong*) (&slot->Value) : NULL;
+    }
+
     i = (*table->Fhash)(longkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4423,6 +5260,7 @@ ajulong ajTablelongHash(const void* key, ajulong hashsize)
 **
 ** @nam3rule New Constructor
 ** @nam4rule Case Case-sensitive keys
+** @nam4rule Open Open addressing storage
 ** @suffix Const Constant keys with no destructor
 **
 ** @argrule New size [ajulong] Number of key values
@@ -4546,6 +5384,34 @@ AjPTable ajTablestrNewConst(ajulong size)
 
 
 
+/* @func ajTablestrNewOpen ****************************************************
+**
+** Creates, initialises, and returns a new, empty table that can hold a
+** specified number of key-value pairs, using open addressing.
+**
+** @param [r] size [ajulong] estimate of number of unique keys
+**
+** @return [AjPTable] new table.
+**
+** @release 6.6.0
+** @@
+**
+******************************************************************************/
+
+AjPTable ajTablestrNewOpen(ajulong size)
+{
+    AjPTable table = NULL;
+
+    table = ajTableNewFunctionOpen(size, &ajTablestrCmp, &ajTablestrHash,
+                                   &tableDelStr, NULL);
+    table->Type = ajETableTypeStr;
+
+    return table;
+}
+
+
+
+
 /* @section Destructors *******************************************************
 **
 ** @fdata [AjPTable]
@@ -4729,6 +5595,7 @@ void* ajTablestrFetchC(const AjPTable table, const char* txtkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     ajStrAssignC(&tableTmpkeyStr, txtkey);
 
@@ -4738,6 +5605,13 @@ void* ajTablestrFetchC(const AjPTable table, const char* txtkey)
     if(!txtkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, tableTmpkeyStr);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(tableTmpkeyStr, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4769,6 +5643,7 @@ void* ajTablestrFetchS(const AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4776,6 +5651,13 @@ void* ajTablestrFetchS(const AjPTable table, const AjPStr key)
     if(!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4809,6 +5691,7 @@ const AjPStr ajTablestrFetchkeyC(const AjPTable table, const char* txtkey)
     ajulong i = 0UL;
 
     const AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4825,6 +5708,13 @@ const AjPStr ajTablestrFetchkeyC(const AjPTable table, const char* txtkey)
     if(table->Type != ajETableTypeChar)
         ajFatal("ajTablestrFetchkeyC called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, txtkey);
+
+        return slot ? (const void*) slot->Key : NULL;
+    }
+
     i = (*table->Fhash)(txtkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4858,6 +5748,7 @@ const AjPStr ajTablestrFetchkeyS(const AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     const AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4873,6 +5764,13 @@ const AjPStr ajTablestrFetchkeyS(const AjPTable table, const AjPStr key)
     if(table->Type != ajETableTypeStr)
         ajFatal("ajTablestrFetchkeyS called for %s table", tableType(table));
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? (const void*) slot->Key : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -4950,6 +5848,7 @@ AjPStr* ajTablestrFetchmod(AjPTable table, const AjPStr key)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -4957,6 +5856,13 @@ AjPStr* ajTablestrFetchmod(AjPTable table, const AjPStr key)
     if(!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? (AjPStr*) (&slot->Value) : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -5159,6 +6065,17 @@ void ajTablestrPrint(const AjPTable table)
     if(!table)
         return;
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+                ajUser("key '%S' value '%S'",
+                       (const AjPStr) table->Slots[i].Key,
+                       (AjPStr) table->Slots[i].Value);
+
+        return;
+    }
+
     for(i = 0; i < table->Size; i++)
         for(node = table->Buckets[i]; node; node = node->Link)
             ajUser("key '%S' value '%S'",
@@ -5198,6 +6115,22 @@ void ajTablestrTrace(const AjPTable table)
     ajDebug(" size: %Lu", table->Size);
     ajDebug(" timestamp: %u\n", table->Timestamp);
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                ajDebug("slots[%Lu]\n", i);
+                ajDebug("   '%S' => '%S'\n",
+                        (const AjPStr) table->Slots[i].Key,
+                        (AjPStr) table->Slots[i].Value);
+            }
+
+        ajDebug(" deleted: %Lu\n", table->Deleted);
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
         if(table->Buckets[i])
         {
@@ -5250,6 +6183,22 @@ void ajTablestrTracekeys(const AjPTable table)
     ajDebug(" size: %Lu", table->Size);
     ajDebug(" timestamp: %u\n", table->Timestamp);
 
+    if(table->Slots)
+    {
+        for(i = 0UL; i < table->Size; i++)
+            if(table->Slots[i].Hash > TABLE_OPEN_DELETED)
+            {
+                ajDebug("slots[%Lu]\n", i);
+                ajDebug("   '%S' => '%xS\n",
+                        (const AjPStr) table->Slots[i].Key,
+                        table->Slots[i].Value);
+            }
+
+        ajDebug(" deleted: %Lu\n", table->Deleted);
+
+        return;
+    }
+
     for(i = 0UL; i < table->Size; i++)
         if(table->Buckets[i])
         {
@@ -5482,6 +6431,7 @@ const ajuint* ajTableuintFetch(const AjPTable table, const ajuint* uintkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -5489,6 +6439,13 @@ const ajuint* ajTableuintFetch(const AjPTable table, const ajuint* uintkey)
     if(!uintkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, uintkey);
+
+        return slot ? (const ajuint*) slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(uintkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -5540,6 +6497,7 @@ ajuint* ajTableuintFetchmod(AjPTable table, const ajuint* uintkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -5547,6 +6505,13 @@ ajuint* ajTableuintFetchmod(AjPTable table, const ajuint* uintkey)
     if(!uintkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, uintkey);
+
+        return slot ? (ajuint*) (&slot->Value) : NULL;
+    }
+
     i = (*table->Fhash)(uintkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -5848,6 +6813,7 @@ const ajulong* ajTableulongFetch(const AjPTable table, const ajulong* ulongkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -5855,6 +6821,13 @@ const ajulong* ajTableulongFetch(const AjPTable table, const ajulong* ulongkey)
     if(!ulongkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, ulongkey);
+
+        return slot ? (const ajulong*) slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(ulongkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -5906,6 +6879,7 @@ ajulong* ajTableulongFetchmod(AjPTable table, const ajulong* ulongkey)
     ajulong i = 0UL;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -5913,6 +6887,13 @@ ajulong* ajTableulongFetchmod(AjPTable table, const ajulong* ulongkey)
     if(!ulongkey)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, ulongkey);
+
+        return slot ? (ajulong*) (&slot->Value) : NULL;
+    }
+
     i = (*table->Fhash)(ulongkey, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -6086,6 +7067,7 @@ __deprecated void* ajTableFetch(const AjPTable table, const void* key)
     ajuint i = 0U;
 
     AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if(!table)
         return NULL;
@@ -6093,6 +7075,13 @@ __deprecated void* ajTableFetch(const AjPTable table, const void* key)
     if (!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? slot->Value : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
@@ -6139,6 +7128,7 @@ __deprecated const void* ajTableFetchKey(const AjPTable table,
     ajuint i = 0U;
 
     const AjPTableNode node = NULL;
+    AjPTableSlot slot = NULL;
 
     if (!table)
         return NULL;
@@ -6146,6 +7136,13 @@ __deprecated const void* ajTableFetchKey(const AjPTable table,
     if (!key)
         return NULL;
 
+    if(table->Slots)
+    {
+        slot = tableOpenFind(table, key);
+
+        return slot ? (const void*) slot->Key : NULL;
+    }
+
     i = (*table->Fhash)(key, table->Size);
 
     for(node = table->Buckets[i]; node; node = node->Link)
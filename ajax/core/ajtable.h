@@ -109,6 +109,32 @@ typedef struct AjSTableNode {
 
 
 
+/* @data AjPTableSlot *********************************************************
+**
+** AJAX Table Slot object, used by tables with open addressing.
+**
+** The full hash value of the key is stored with the key and value so that
+** probing and resizing rarely need to call the table hash and comparison
+** functions.
+**
+** @attr Key [void*] Key data
+** @attr Value [void*] Value data
+** @attr Hash [ajulong] Key hash value plus 2, or 0 for an empty slot
+**                      and 1 for a deleted slot
+** @@
+******************************************************************************/
+
+typedef struct AjSTableSlot {
+    void* Key;
+    void* Value;
+    ajulong Hash;
+} AjOTableSlot;
+
+#define AjPTableSlot AjOTableSlot*
+
+
+
+
 /* @data AjPTable *************************************************************
 **
 ** Hash table object. Tables are key/value pairs with a simple hash function
@@ -123,6 +149,12 @@ typedef struct AjSTableNode {
 ** function names are provided in all cases to save remembering which
 ** calls need special cases.
 **
+** Tables created with ajTableNewFunctionOpen or ajTablestrNewOpen keep
+** their keys and values in one array of slots using open addressing with
+** linear probing, rather than in chained buckets of nodes. They are used
+** through the same functions. Pointers to values returned by the Fetchmod
+** functions are only valid until the next key is added to such a table.
+**
 ** @new ajTableNew Creates a table.
 ** @delete ajTableFree Deallocates and clears a table.
 ** @modify ajTablePut Adds or updates a value for a given key.
@@ -141,8 +173,11 @@ typedef struct AjSTableNode {
 ** @attr Fkeydel [void function] Key destructor, or NULL if not an object
 ** @attr Fvaldel [void function] Value destructor, or NULL if not an object
 ** @attr Buckets [AjPTableNode*] Buckets of AJAX Table Node objects
-** @attr Size [ajulong] Size - number of hash buckets
+** @attr Slots [AjPTableSlot] Open addressing slots, or NULL if the
+**                            table uses buckets
+** @attr Size [ajulong] Size - number of hash buckets or slots
 ** @attr Length [ajulong] Number of entries
+** @attr Deleted [ajulong] Number of deleted open addressing slots
 ** @attr Timestamp [ajuint] Time stamp
 ** @attr Use [ajuint] Reference count
 ** @attr Padding [ajuint] Padding to alignment boundary
@@ -157,8 +192,10 @@ typedef struct AjSTable
     void (*Fkeydel)(void** Pkey);
     void (*Fvaldel)(void** Pvalue);
     AjPTableNode* Buckets;
+    AjPTableSlot Slots;
     ajulong Size;
     ajulong Length;
+    ajulong Deleted;
     ajuint Timestamp;
     ajuint Use;
     ajuint Padding;
@@ -300,6 +337,7 @@ void           ajTableulongFreeKey(AjPTable* ptable);
 AjPTable       ajTablestrNew(ajulong size);
 AjPTable       ajTablestrNewCase(ajulong size);
 AjPTable       ajTablestrNewConst(ajulong size);
+AjPTable       ajTablestrNewOpen(ajulong size);
 AjPTable       ajTablestrNewCaseConst(ajulong size);
 
 void           ajTablestrFree(AjPTable* ptable);
@@ -313,6 +351,13 @@ AjPTable       ajTableNewFunctionLen(ajulong size,
                                                     ajulong hashsize),
                                      void (*keydel)(void** Pkey),
                                      void (*valdel)(void** Pvalue));
+AjPTable       ajTableNewFunctionOpen(ajulong size,
+                                      ajint (*cmp)(const void* key1,
+                                                   const void* key2),
+                                      ajulong (*hash)(const void* key,
+                                                      ajulong hashsize),
+                                      void (*keydel)(void** Pkey),
+                                      void (*valdel)(void** Pvalue));
 const AjPStr   ajTablestrFetchkeyC(const AjPTable table, const char* key);
 const AjPStr   ajTablestrFetchkeyS(const AjPTable table, const AjPStr key);
 
@@ -718,6 +718,7 @@ void ajTextinQryS(AjPTextin thys, const AjPStr str)
 ** @nam4rule Clear Reset the text buffer to the end if the last text input
 ** @nam4rule Readline Read the next line of input
 **           and store in buffer if required
+** @nam5rule View Return the line in place without copying
 ** @nam4rule Reset Reset the file buffer and any buffered text.
 **
 ** @argrule * thys [AjPTextin] Text input object
@@ -725,10 +726,13 @@ void ajTextinQryS(AjPTextin thys, const AjPStr str)
 ** @argrule Clear rdline [const AjPStr] Most recent input line to trim
 **                                      from buffer
 ** @argrule Readline pdest [AjPStr*] Latest input line
+** @argrule View pline [const char**] Start of latest input line
+** @argrule View plen [ajuint*] Length of latest input line
 ** @argrule Store astr [AjPStr*] Buffered text data
 **
 ** @valrule * [void]
 ** @valrule *Readline [AjBool] True on success
+** @valrule *View [AjBool] True on success
 **
 ** @fcategory cast
 **
@@ -812,6 +816,41 @@ AjBool ajTextinStoreReadline(AjPTextin thys,
 
 
 
+/* @func ajTextinStoreReadlineView ********************************************
+**
+** Read the next line of input without copying it and if required store in
+** buffer. The line is valid only until the next read.
+**
+** @param [u] thys [AjPTextin] Text input object
+** @param [w] pline [const char**] Start of next input record
+** @param [w] plen [ajuint*] Length of next input record
+** @param [u] astr [AjPStr*] Current text buffer
+** @return [AjBool] True on success
+******************************************************************************/
+
+AjBool ajTextinStoreReadlineView(AjPTextin thys,
+                                 const char** pline, ajuint* plen,
+                                 AjPStr* astr)
+{
+    AjBool ret;
+
+    ret = ajBuffreadLineView(thys->Filebuff, pline, plen, &thys->Curpos);
+
+    if(ret)
+    {
+        thys->Records++;
+        thys->TotRecords++;
+
+        if(thys->Text)
+            ajStrAppendLenC(astr, *pline, *plen);
+    }
+
+    return ret;
+}
+
+
+
+
 /* @func ajTextinStoreReset ***************************************************
 **
 ** Reset a text input object buffer and any saved buffered text
@@ -89,6 +89,9 @@ void         ajTextinStoreClear(AjPTextin thys,
                            AjPStr *astr);
 AjBool       ajTextinStoreReadline(AjPTextin thys,
                                    AjPStr* pdest, AjPStr *astr);
+AjBool       ajTextinStoreReadlineView(AjPTextin thys,
+                                       const char** pline, ajuint* plen,
+                                       AjPStr *astr);
 void         ajTextinStoreReset(AjPTextin thys, AjPStr *astr);
 void         ajTextinTrace(const AjPTextin thys);
 const char*  ajTextinTypeGetFields(void);
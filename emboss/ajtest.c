@@ -4,6 +4,10 @@
 
 
 static void ajtest_kim (const AjPStr seqout_name, const AjPSeq subseq);
+static void ajtest_tablebench(AjPFile outf, ajuint nkeys);
+static void ajtest_tablebenchrun(AjPFile outf, const char* name,
+                                 AjPTable table, AjPStr const* keys,
+                                 AjPStr const* misses, ajuint nkeys);
 
 
 
@@ -22,12 +26,16 @@ int main(int argc, char **argv)
     ajint i = 0;
     AjPStr kimout = NULL;
     AjPStr dir = NULL;
+    AjPFile outf = NULL;
+    ajuint tablekeys = 0;
 
     embInit("ajtest", argc, argv);
 
     seqall = ajAcdGetSeqall ("sequence");
     seqset = ajAcdGetSeqset ("bsequence");
     dir = ajAcdGetOutdirName("outdir");
+    outf = ajAcdGetOutfile("outfile");
+    tablekeys = ajAcdGetInt("tablekeys");
 
     while(ajSeqallNext (seqall, &seq))
     {
@@ -35,11 +43,15 @@ int main(int argc, char **argv)
 	ajtest_kim (kimout, seq);
     }
 
+    if(tablekeys)
+        ajtest_tablebench(outf, tablekeys);
+
     ajSeqDel(&seq);
     ajSeqallDel(&seqall);
     ajSeqsetDel(&seqset);
     ajStrDel(&kimout);
     ajStrDel(&dir);
+    ajFileClose(&outf);
 
     embExit();
 
@@ -78,3 +90,121 @@ static void ajtest_kim (const AjPStr seqout_name, const AjPSeq subseq)
 
     return;
 }
+
+
+
+
+/* @funcstatic ajtest_tablebench **********************************************
+**
+** Compare insert and lookup times for string keys in hash tables using
+** chained buckets and open addressing
+**
+** @param [u] outf [AjPFile] Output file, or NULL to report to the user
+** @param [r] nkeys [ajuint] Number of keys
+** @return [void]
+** @@
+******************************************************************************/
+
+static void ajtest_tablebench(AjPFile outf, ajuint nkeys)
+{
+    AjPStr* keys = NULL;
+    AjPStr* misses = NULL;
+    AjPTable table = NULL;
+    ajuint i;
+
+    AJCNEW0(keys, nkeys);
+    AJCNEW0(misses, nkeys);
+
+    for(i = 0; i < nkeys; i++)
+    {
+        ajFmtPrintS(&keys[i], "KEY%08x_%u", i * 2654435761U, i);
+        ajFmtPrintS(&misses[i], "MISS%08x_%u", i * 2654435761U, i);
+    }
+
+    table = ajTablestrNewConst(0);
+    ajtest_tablebenchrun(outf, "chained", table, keys, misses, nkeys);
+    ajTableFree(&table);
+
+    table = ajTablestrNewOpen(0);
+    ajTableSetDestroykey(table, NULL);
+    ajtest_tablebenchrun(outf, "open", table, keys, misses, nkeys);
+    ajTableFree(&table);
+
+    for(i = 0; i < nkeys; i++)
+    {
+        ajStrDel(&keys[i]);
+        ajStrDel(&misses[i]);
+    }
+
+    AJFREE(keys);
+    AJFREE(misses);
+
+    return;
+}
+
+
+
+
+/* @funcstatic ajtest_tablebenchrun *******************************************
+**
+** Time inserting keys into an empty table, then looking up each key
+** and a key that is not in the table, ten times over
+**
+** @param [u] outf [AjPFile] Output file, or NULL to report to the user
+** @param [r] name [const char*] Table type name for the report
+** @param [u] table [AjPTable] Empty table
+** @param [r] keys [AjPStr const*] Keys to insert
+** @param [r] misses [AjPStr const*] Keys not in the table
+** @param [r] nkeys [ajuint] Number of keys
+** @return [void]
+** @@
+******************************************************************************/
+
+static void ajtest_tablebenchrun(AjPFile outf, const char* name,
+                                 AjPTable table, AjPStr const* keys,
+                                 AjPStr const* misses, ajuint nkeys)
+{
+    ajlong start;
+    double tput;
+    double tfetch;
+    ajuint i;
+    ajuint j;
+    ajuint nfound = 0;
+    AjPStr report = NULL;
+
+    start = ajClockNow();
+
+    for(i = 0; i < nkeys; i++)
+        ajTablePut(table, keys[i], keys[i]);
+
+    tput = ajClockDiff(start, ajClockNow());
+
+    start = ajClockNow();
+
+    for(j = 0; j < 10; j++)
+        for(i = 0; i < nkeys; i++)
+        {
+            if(ajTableFetchS(table, keys[i]))
+                nfound++;
+
+            if(ajTableFetchS(table, misses[i]))
+                nfound++;
+        }
+
+    tfetch = ajClockDiff(start, ajClockNow());
+
+    ajFmtPrintS(&report,
+                "Table %-7s %u keys size %Lu "
+                "insert %.3f sec lookup %.3f sec found %u/%u",
+                name, nkeys, ajTableGetSize(table),
+                tput, tfetch, nfound, 20 * nkeys);
+
+    if(outf)
+        ajFmtPrintF(outf, "%S\n", report);
+    else
+        ajUser("%S", report);
+
+    ajStrDel(&report);
+
+    return;
+}
@@ -75,6 +75,8 @@ int main(int argc, char **argv)
     AjPStr datestr  = NULL;
     AjBool statistics;
     AjBool compressed;
+    AjBool bulk;
+    ajint threads;
 
     AjPStr directory;
     AjPStr indexdir;
@@ -144,10 +146,15 @@ int main(int argc, char **argv)
     datestr    = ajAcdGetString("date");
     statistics = ajAcdGetBoolean("statistics");
     compressed = ajAcdGetBoolean("compressed");
+    bulk       = ajAcdGetBoolean("bulk");
+    threads    = ajAcdGetInt("threads");
 
     entry = embBtreeEntryNew(0);
     if(compressed)
         embBtreeEntrySetCompressed(entry);
+    if(bulk)
+        embBtreeEntrySetBulk(entry);
+    embBtreeEntrySetThreads(entry, (ajuint) threads);
     tmpstr = ajStrNew();
     
     nfields = embBtreeSetFields(entry,fieldarray);
@@ -204,16 +211,25 @@ int main(int argc, char **argv)
 
 	ajListPop(entry->files,(void **)&thysfile);
 	ajListPushAppend(entry->files,(void *)thysfile);
+
+        if(embBtreeWorkerSkip(entry, i))
+            continue;
+
 	ajFmtPrintS(&tmpstr,"%S%S",entry->directory,thysfile);
-	if(!(inf=ajFileNewInNameS(tmpstr)))
+	if(!embBtreeWorkerIsSpooled(entry) &&
+           !(inf=ajFileNewInBgzfS(tmpstr)))
 	    ajFatal("Cannot open input file %S\n",tmpstr);
 	
 	ajFilenameTrimPath(&tmpstr);
-	ajFmtPrintF(outf,"Processing file: %S\n",tmpstr);
+
+        if(!embBtreeWorkerIsChild(entry))
+            ajFmtPrintF(outf,"Processing file: %S\n",tmpstr);
 
 	ientries = 0L;
 
-	while(dbxfasta_NextEntry(entry,inf,typeexp,idtype))
+	while(embBtreeWorkerNext(entry,
+                                 inf && dbxfasta_NextEntry(entry,inf,
+                                                           typeexp,idtype)))
 	{
 	    ++ientries;
 
@@ -238,7 +254,8 @@ int main(int argc, char **argv)
                 destot += embBtreeIndexSecondary(desfield, entry);
 	    }
 
-            if(statistics && !(ientries % 10000))
+            if(statistics && !(ientries % 10000) &&
+               !embBtreeWorkerIsChild(entry))
             {
                 nowtime = ajTimeNewToday();
                 nowclock = ajClockNow();
@@ -292,6 +309,10 @@ int main(int argc, char **argv)
 	}
 	
 	ajFileClose(&inf);
+
+        if(embBtreeWorkerDone(entry, i))
+            continue;
+
 	nentries += ientries;
 	nowtime = ajTimeNewToday();
 	ajFmtPrintF(outf, "entries: %Lu (%Lu) time: %.1f/%.1fs (%.1f/%.1f)\n",
@@ -343,6 +364,7 @@ int main(int argc, char **argv)
     }
     
 
+    embBtreeFlushCaches(entry);
     embBtreeDumpParameters(entry);
     embBtreeCloseCaches(entry);
     
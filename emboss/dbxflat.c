@@ -107,6 +107,8 @@ int main(int argc, char **argv)
     AjPStr datestr  = NULL;
     AjBool statistics;
     AjBool compressed;
+    AjBool bulk;
+    ajint threads;
 
     AjPStr directory;
     AjPStr indexdir;
@@ -175,10 +177,15 @@ int main(int argc, char **argv)
     datestr    = ajAcdGetString("date");
     statistics = ajAcdGetBoolean("statistics");
     compressed = ajAcdGetBoolean("compressed");
+    bulk       = ajAcdGetBoolean("bulk");
+    threads    = ajAcdGetInt("threads");
 
     entry = embBtreeEntryNew(0);
     if(compressed)
         embBtreeEntrySetCompressed(entry);
+    if(bulk)
+        embBtreeEntrySetBulk(entry);
+    embBtreeEntrySetThreads(entry, (ajuint) threads);
 
     tmpstr = ajStrNew();
     
@@ -244,15 +251,23 @@ int main(int argc, char **argv)
 
 	ajListPop(entry->files,(void **)&thysfile);
 	ajListPushAppend(entry->files,(void *)thysfile);
+
+        if(embBtreeWorkerSkip(entry, i))
+            continue;
+
 	ajFmtPrintS(&tmpstr,"%S%S",entry->directory,thysfile);
-	if(!(inf=ajFileNewInNameS(tmpstr)))
+	if(!embBtreeWorkerIsSpooled(entry) &&
+           !(inf=ajFileNewInBgzfS(tmpstr)))
 	    ajFatal("Cannot open input file %S\n",tmpstr);
 	ajFilenameTrimPath(&tmpstr);
-	ajFmtPrintF(outf,"Processing file: %S\n",tmpstr);
+
+        if(!embBtreeWorkerIsChild(entry))
+            ajFmtPrintF(outf,"Processing file: %S\n",tmpstr);
 
 	ientries = 0L;
 
-	while(dbxflat_NextEntry(entry,inf))
+	while(embBtreeWorkerNext(entry,
+                                 inf && dbxflat_NextEntry(entry,inf)))
 	{
 	    ++ientries;
 
@@ -289,6 +304,10 @@ int main(int argc, char **argv)
 	}
 	
 	ajFileClose(&inf);
+
+        if(embBtreeWorkerDone(entry, i))
+            continue;
+
 	nentries += ientries;
 	nowtime = ajTimeNewToday();
         nowclock = ajClockNow();
@@ -353,6 +372,7 @@ int main(int argc, char **argv)
     
 
 
+    embBtreeFlushCaches(entry);
     embBtreeDumpParameters(entry);
     embBtreeCloseCaches(entry);
     
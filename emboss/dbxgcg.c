@@ -153,6 +153,7 @@ int main(int argc, char **argv)
     AjPStr datestr  = NULL;
     AjBool statistics;
     AjBool compressed;
+    ajint threads;
 
     AjPStr directory;
     AjPStr indexdir;
@@ -208,10 +209,12 @@ int main(int argc, char **argv)
     datestr    = ajAcdGetString("date");
     statistics = ajAcdGetBoolean("statistics");
     compressed = ajAcdGetBoolean("compressed");
+    threads    = ajAcdGetInt("threads");
 
     entry = embBtreeEntryNew(1);
     if(compressed)
         embBtreeEntrySetCompressed(entry);
+    embBtreeEntrySetThreads(entry, (ajuint) threads);
     
     nfields = embBtreeSetFields(entry,fieldarray);
     embBtreeSetDbInfo(entry,dbname,dbrs,datestr,release,dbtype,directory,
@@ -288,21 +291,31 @@ int main(int argc, char **argv)
 	ajListPop(entry->reffiles[0],(void **)&thysfile);
 	ajListstrPushAppend(entry->files, thysfile);
 	ajFmtPrintS(&dbxgcgTmpstr,"%S%S",entry->directory,thysfile);
-	if(!(infr=ajFileNewInNameS(dbxgcgTmpstr)))
-	    ajFatal("Cannot open input file %S\n",dbxgcgTmpstr);
-	
 	ajListPop(entry->files,(void **)&thysfile);
 	ajListstrPushAppend(entry->files, thysfile);
+
+        if(embBtreeWorkerSkip(entry, i))
+            continue;
+
+	if(!embBtreeWorkerIsSpooled(entry) &&
+           !(infr=ajFileNewInBgzfS(dbxgcgTmpstr)))
+	    ajFatal("Cannot open input file %S\n",dbxgcgTmpstr);
+	
 	ajFmtPrintS(&dbxgcgTmpstr,"%S%S",entry->directory,thysfile);
-	if(!(infs=ajFileNewInNameS(dbxgcgTmpstr)))
+	if(!embBtreeWorkerIsSpooled(entry) &&
+           !(infs=ajFileNewInBgzfS(dbxgcgTmpstr)))
 	    ajFatal("Cannot open input file %S\n",dbxgcgTmpstr);
 
 	ajFilenameTrimPath(&dbxgcgTmpstr);
-	ajFmtPrintF(outf,"Processing file: %S\n",dbxgcgTmpstr);
+
+        if(!embBtreeWorkerIsChild(entry))
+            ajFmtPrintF(outf,"Processing file: %S\n",dbxgcgTmpstr);
 
 	ientries = 0L;
 
-	while(dbxgcg_NextEntry(entry,infs,infr,dbtype))
+	while(embBtreeWorkerNext(entry,
+                                 infs && dbxgcg_NextEntry(entry,infs,infr,
+                                                          dbtype)))
 	{
 	    ++ientries;
 
@@ -327,6 +340,10 @@ int main(int argc, char **argv)
 	
 	ajFileClose(&infs);
 	ajFileClose(&infr);
+
+        if(embBtreeWorkerDone(entry, i))
+            continue;
+
 	nentries += ientries;
 	nowtime = ajTimeNewToday();
 	ajFmtPrintF(outf, "entries: %Lu (%Lu) time: %.1fs (%.1fs)\n",
@@ -38,6 +38,7 @@ int main(int argc, char **argv)
     AjPStr   fieldname  = NULL;
     ajint    imin;
     ajint    imax;
+    AjBool   cachestats;
     AjPFile  outf = NULL;
     AjPStr   dbfilename = NULL;
 
@@ -51,6 +52,7 @@ int main(int argc, char **argv)
     fieldname  = ajAcdGetString("field");
     imin   = ajAcdGetInt("minimum");
     imax   = ajAcdGetInt("maximum");
+    cachestats = ajAcdGetBoolean("cachestats");
     outf   = ajAcdGetOutfile("outfile");
     
     if(!ajNamDbGetDbaliasTest(dbname, &dbfilename))
@@ -70,9 +72,14 @@ int main(int argc, char **argv)
 	ajFatal("Cannot open index file '%S' for reading",
                 fieldname);
     
+    if(cachestats)
+        ajBtreeCacheSetPagestats(cache, ajTrue);
 
     ajBtreeDumpKeywords(cache,imin,imax,outf);
 
+    if(cachestats)
+        ajBtreeCacheStatsReport(outf, cache);
+
     ajStrDel(&dbfilename);
 
     ajStrDel(&dbname);
@@ -62,6 +62,7 @@ int main(int argc, char **argv)
     float gapextend;
     float endgapopen;
     float endgapextend;
+    ajint band;
     size_t maxarr = 1000; 	/* arbitrary. realloc'd if needed */
     size_t len;
 
@@ -69,6 +70,7 @@ int main(int argc, char **argv)
 
     AjBool dobrief = ajTrue;
     AjBool endweight = ajFalse; /* should end gap penalties be applied */
+    AjBool adaptive = ajFalse;
 
     float id   = 0.;
     float sim  = 0.;
@@ -89,6 +91,8 @@ int main(int argc, char **argv)
     endgapextend = ajAcdGetFloat("endextend");
     dobrief   = ajAcdGetBoolean("brief");
     endweight   = ajAcdGetBoolean("endweight");
+    band      = ajAcdGetInt("band");
+    adaptive  = ajAcdGetBoolean("adaptive");
 
     align     = ajAcdGetAlign("outfile");
 
@@ -114,46 +118,63 @@ int main(int argc, char **argv)
 	ajSeqTrim(b);
 	lenb = ajSeqGetLen(b);
 
-	if(lenb > (LONG_MAX/(size_t)(lena+1)))
-	   ajDie("Sequences too big. Try 'stretcher'");
-
-	len = (size_t)lena*(size_t)lenb;
-
-	if(len>maxarr)
-	{
-	    AJCRESIZETRY0(compass,(size_t)maxarr,len);
-	    if(!compass)
-		ajDie("Sequences too big. Try 'stretcher'");
-	    AJCRESIZETRY0(m,(size_t)maxarr,len);
-	    if(!m)
-		ajDie("Sequences too big. Try 'stretcher'");
-	    AJCRESIZETRY0(ix,(size_t)maxarr,len);
-	    if(!ix)
-		ajDie("Sequences too big. Try 'stretcher'");
-	    AJCRESIZETRY0(iy,(size_t)maxarr,len);
-	    if(!iy)
-		ajDie("Sequences too big. Try 'stretcher'");
-	    maxarr=len;
-	}
-
-
 	p = ajSeqGetSeqC(a);
 	q = ajSeqGetSeqC(b);
 
 	ajStrAssignC(&alga,"");
 	ajStrAssignC(&algb,"");
 
-	score = embAlignPathCalcWithEndGapPenalties(p, q, lena, lenb,
-	        gapopen, gapextend, endgapopen, endgapextend,
-	        &start1, &start2, sub, cvt,
-	        m, ix, iy, compass, ajFalse, endweight);
-
-
+	if(band && lena > 1 && lenb > 1)
+	{
+	    /* near-identical sequences: only the cells near the diagonal */
+	    score = embAlignBandCalcNW(p, q, lena, lenb,
+	            gapopen, gapextend, endgapopen, endgapextend,
+	            &start1, &start2, sub, cvt,
+	            &alga, &algb, endweight, band, adaptive);
+	}
+	else if(lena > 1 && lenb > 1 &&
+	   (size_t)lena*(size_t)lenb > embAlignLinearGetCells())
+	{
+	    /* too big for the full matrices: use linear memory */
+	    score = embAlignLinearCalcNW(p, q, lena, lenb,
+	            gapopen, gapextend, endgapopen, endgapextend,
+	            &start1, &start2, sub, cvt,
+	            &alga, &algb, endweight);
+	}
+	else
+	{
+	    if(lenb > (LONG_MAX/(size_t)(lena+1)))
+	       ajDie("Sequences too big. Try 'stretcher'");
+
+	    len = (size_t)lena*(size_t)lenb;
+
+	    if(len>maxarr)
+	    {
+		AJCRESIZETRY0(compass,(size_t)maxarr,len);
+		if(!compass)
+		    ajDie("Sequences too big. Try 'stretcher'");
+		AJCRESIZETRY0(m,(size_t)maxarr,len);
+		if(!m)
+		    ajDie("Sequences too big. Try 'stretcher'");
+		AJCRESIZETRY0(ix,(size_t)maxarr,len);
+		if(!ix)
+		    ajDie("Sequences too big. Try 'stretcher'");
+		AJCRESIZETRY0(iy,(size_t)maxarr,len);
+		if(!iy)
+		    ajDie("Sequences too big. Try 'stretcher'");
+		maxarr=len;
+	    }
+
+	    score = embAlignPathCalcWithEndGapPenalties(p, q, lena, lenb,
+	            gapopen, gapextend, endgapopen, endgapextend,
+	            &start1, &start2, sub, cvt,
+	            m, ix, iy, compass, ajFalse, endweight);
+
+	    embAlignWalkNWMatrixUsingCompass(p, q, &alga, &algb,
+	            lena, lenb, &start1, &start2,
+	            compass);
+	}
 
-	embAlignWalkNWMatrixUsingCompass(p, q, &alga, &algb,
-	        lena, lenb, &start1, &start2,
-	        compass);
-		
 	embAlignReportGlobal(align, a, b, alga, algb,
 			     start1, start2,
 			     gapopen, gapextend,
@@ -25,6 +25,139 @@
 #include <limits.h>
 #include <math.h>
 
+#ifdef HAVE_LIBPTHREAD
+#include <pthread.h>
+#endif /* HAVE_LIBPTHREAD */
+
+
+
+
+#define NEEDLEALL_PAIRSPERTHREAD 16
+
+#define NEEDLEALL_OK       0
+#define NEEDLEALL_TOOBIG   1
+#define NEEDLEALL_NOMEMORY 2
+
+
+
+
+/* @datastatic PNeedleallPair *************************************************
+**
+** One alignment of the pair matrix, filled in by a worker and reported
+** in input order by the main thread
+**
+** @alias SNeedleallPair
+** @alias ONeedleallPair
+**
+** @attr Seqa [const AjPSeq] First sequence, owned by the sequence set
+** @attr Seqb [const AjPSeq] Second sequence, owned by the batch
+** @attr Alga [AjPStr] First sequence with gaps inserted
+** @attr Algb [AjPStr] Second sequence with gaps inserted
+** @attr Score [float] Alignment score
+** @attr Start1 [ajint] Start of alignment in first sequence
+** @attr Start2 [ajint] Start of alignment in second sequence
+** @attr Status [ajint] NEEDLEALL_OK or the reason the alignment failed
+******************************************************************************/
+
+typedef struct SNeedleallPair
+{
+    const AjPSeq Seqa;
+    const AjPSeq Seqb;
+    AjPStr Alga;
+    AjPStr Algb;
+    float Score;
+    ajint Start1;
+    ajint Start2;
+    ajint Status;
+} ONeedleallPair;
+
+#define PNeedleallPair ONeedleallPair*
+
+
+
+
+/* @datastatic PNeedleallQueue ************************************************
+**
+** Pairs waiting to be aligned, shared by all workers
+**
+** @alias SNeedleallQueue
+** @alias ONeedleallQueue
+**
+** @attr Pairs [PNeedleallPair] Pairs in the current batch
+** @attr Npairs [ajulong] Number of pairs in the current batch
+** @attr Next [ajulong] Next pair to be taken by a worker
+** @attr Sub [float* const *] Substitution matrix
+** @attr Cvt [AjPSeqCvt] Conversion table for the substitution matrix
+** @attr Gapopen [float] Gap opening penalty
+** @attr Gapextend [float] Gap extension penalty
+** @attr Endgapopen [float] End gap opening penalty
+** @attr Endgapextend [float] End gap extension penalty
+** @attr Endweight [AjBool] Apply end gap penalties
+** @attr Band [ajint] Band width, or zero for the full matrix
+** @attr Adaptive [AjBool] Widen the band until the score is stable
+** @attr Padding [char[4]] Padding to alignment boundary
+** @attr Lock [pthread_mutex_t] Protects Next
+******************************************************************************/
+
+typedef struct SNeedleallQueue
+{
+    PNeedleallPair Pairs;
+    ajulong Npairs;
+    ajulong Next;
+    float * const *Sub;
+    AjPSeqCvt Cvt;
+    float Gapopen;
+    float Gapextend;
+    float Endgapopen;
+    float Endgapextend;
+    AjBool Endweight;
+    ajint Band;
+    AjBool Adaptive;
+    char Padding[4];
+#ifdef HAVE_LIBPTHREAD
+    pthread_mutex_t Lock;
+#endif /* HAVE_LIBPTHREAD */
+} ONeedleallQueue;
+
+#define PNeedleallQueue ONeedleallQueue*
+
+
+
+
+/* @datastatic PNeedleallWorker ***********************************************
+**
+** Scratch matrices of one worker, kept between batches
+**
+** @alias SNeedleallWorker
+** @alias ONeedleallWorker
+**
+** @attr Queue [PNeedleallQueue] Shared queue of pairs
+** @attr Compass [ajint*] Path direction matrix
+** @attr M [float*] Match score matrix
+** @attr Ix [float*] Gap in first sequence score matrix
+** @attr Iy [float*] Gap in second sequence score matrix
+** @attr Maxarr [size_t] Allocated size of the matrices
+******************************************************************************/
+
+typedef struct SNeedleallWorker
+{
+    PNeedleallQueue Queue;
+    ajint *Compass;
+    float *M;
+    float *Ix;
+    float *Iy;
+    size_t Maxarr;
+} ONeedleallWorker;
+
+#define PNeedleallWorker ONeedleallWorker*
+
+
+
+
+static void needleallAlignPair(PNeedleallWorker worker, PNeedleallPair pair);
+static void* needleallWork(void *arg);
+static void needleallRun(PNeedleallWorker workers, ajuint nthreads);
+
 
 
 
@@ -40,41 +173,31 @@ int main(int argc, char **argv)
     AjPSeqall seqall;
     AjPSeqset seqset;
     const AjPSeq seqa;
-    AjPSeq seqb;
-    AjPStr alga;
-    AjPStr algb;
-    AjPStr ss;
+    AjPSeq seqb = NULL;
+    AjPSeq *batch = NULL;
     AjPFile errorf;
 
-    ajuint lena;
-    ajuint lenb;
+    ajuint nseqa;
+    ajuint nb;
+    ajuint maxb;
+    ajuint i;
     ajuint k;
+    ajint nthreads;
+    ajulong npairs;
+    ajulong ipair;
 
-    const char *p;
-    const char *q;
-
-    ajint start1 = 0;
-    ajint start2 = 0;
-
-    ajint *compass;
-    float* ix;
-    float* iy;
-    float* m;
+    ONeedleallQueue queue;
+    PNeedleallPair pairs = NULL;
+    PNeedleallPair pair;
+    PNeedleallWorker workers = NULL;
 
     AjPMatrixf matrix;
     AjPSeqCvt cvt = 0;
     float **sub;
 
-    float gapopen;
-    float gapextend;
-    float endgapopen;
-    float endgapextend;
     float minscore;
-    size_t maxarr = 1000;  /* arbitrary. realloc'd if needed */
-    size_t len;
-
-    float score;
 
+    AjBool more = ajTrue;
     AjBool dobrief = ajTrue;
     AjBool endweight = ajFalse; /*whether end gap penalties should be applied*/
 
@@ -91,100 +214,145 @@ int main(int argc, char **argv)
     seqset    = ajAcdGetSeqset("asequence");
     ajSeqsetTrim(seqset);
     seqall    = ajAcdGetSeqall("bsequence");
-    gapopen   = ajAcdGetFloat("gapopen");
-    gapextend = ajAcdGetFloat("gapextend");
-    endgapopen   = ajAcdGetFloat("endopen");
-    endgapextend = ajAcdGetFloat("endextend");
+    queue.Gapopen   = ajAcdGetFloat("gapopen");
+    queue.Gapextend = ajAcdGetFloat("gapextend");
+    queue.Endgapopen   = ajAcdGetFloat("endopen");
+    queue.Endgapextend = ajAcdGetFloat("endextend");
     minscore = ajAcdGetFloat("minscore");
     dobrief   = ajAcdGetBoolean("brief");
     endweight   = ajAcdGetBoolean("endweight");
+    queue.Band = ajAcdGetInt("band");
+    queue.Adaptive = ajAcdGetBoolean("adaptive");
+    nthreads  = ajAcdGetInt("threads");
     align     = ajAcdGetAlign("outfile");
     errorf    = ajAcdGetOutfile("errfile");
 
-    gapopen = ajRoundFloat(gapopen, 8);
-    gapextend = ajRoundFloat(gapextend, 8);
+    queue.Gapopen = ajRoundFloat(queue.Gapopen, 8);
+    queue.Gapextend = ajRoundFloat(queue.Gapextend, 8);
 
-    AJCNEW0(compass, maxarr);
-    AJCNEW0(m, maxarr);
-    AJCNEW0(ix, maxarr);
-    AJCNEW0(iy, maxarr);
+#ifndef HAVE_LIBPTHREAD
+    if(nthreads > 1)
+        ajWarn("Threads are not supported in this build, using one thread");
 
-    alga  = ajStrNew();
-    algb  = ajStrNew();
-    ss = ajStrNew();
+    nthreads = 1;
+#endif /* !HAVE_LIBPTHREAD */
+
+    /* the debug file is not protected against concurrent writes */
+    if(nthreads > 1 && ajDebugOn())
+    {
+        ajWarn("Debug output requested, using one thread");
+        nthreads = 1;
+    }
 
     sub = ajMatrixfGetMatrix(matrix);
     cvt = ajMatrixfGetCvt(matrix);
 
-    while(ajSeqallNext(seqall,&seqb))
+    queue.Sub = sub;
+    queue.Cvt = cvt;
+    queue.Endweight = endweight;
+    queue.Pairs = NULL;
+    queue.Npairs = 0;
+    queue.Next = 0;
+
+    /*
+    ** Second sequences are read in batches large enough to give each
+    ** thread several alignments. The results are reported in the
+    ** original order once the whole batch is done.
+    */
+
+    nseqa = ajSeqsetGetSize(seqset);
+    maxb = (NEEDLEALL_PAIRSPERTHREAD * (ajuint) nthreads + nseqa - 1) / nseqa;
+
+    AJCNEW0(batch, maxb);
+    AJCNEW0(pairs, (size_t) maxb * nseqa);
+
+    for(ipair = 0; ipair < (ajulong) maxb * nseqa; ipair++)
     {
-        ajSeqTrim(seqb);
-        lenb = ajSeqGetLen(seqb);
+        pairs[ipair].Alga = ajStrNewRes(1024);
+        pairs[ipair].Algb = ajStrNewRes(1024);
+    }
 
-        for(k=0;k<ajSeqsetGetSize(seqset);k++)
-        {
-            seqa = ajSeqsetGetseqSeq(seqset, k);
-            lena = ajSeqGetLen(seqa);
+    AJCNEW0(workers, nthreads);
 
+    for(i = 0; i < (ajuint) nthreads; i++)
+    {
+        workers[i].Queue = &queue;
+        workers[i].Maxarr = 1000;  /* arbitrary. realloc'd if needed */
+        AJCNEW0(workers[i].Compass, workers[i].Maxarr);
+        AJCNEW0(workers[i].M, workers[i].Maxarr);
+        AJCNEW0(workers[i].Ix, workers[i].Maxarr);
+        AJCNEW0(workers[i].Iy, workers[i].Maxarr);
+    }
 
-            if(lenb > (LONG_MAX/(size_t)(lena+1)))
-                ajDie("Sequences too big.");
+    queue.Pairs = pairs;
 
-            len = (size_t)lena*(size_t)lenb;
+#ifdef HAVE_LIBPTHREAD
+    pthread_mutex_init(&queue.Lock, NULL);
+#endif /* HAVE_LIBPTHREAD */
 
-            if(len>maxarr)
+    while(more)
+    {
+        for(nb = 0; nb < maxb; nb++)
+        {
+            if(!ajSeqallNext(seqall, &seqb))
             {
-                AJCRESIZETRY0(compass,(size_t)maxarr,len);
-                if(!compass)
-                    ajDie("Sequences too big, memory allocation failed");
-                AJCRESIZETRY0(m,(size_t)maxarr,len);
-                if(!m)
-                    ajDie("Sequences too big, memory allocation failed");
-                AJCRESIZETRY0(ix,(size_t)maxarr,len);
-                if(!ix)
-                    ajDie("Sequences too big, memory allocation failed");
-                AJCRESIZETRY0(iy,(size_t)maxarr,len);
-                if(!iy)
-                    ajDie("Sequences too big, memory allocation failed");
-                maxarr=len;
+                more = ajFalse;
+                break;
             }
 
+            ajSeqTrim(seqb);
+            batch[nb] = ajSeqNewSeq(seqb);
+        }
+
+        npairs = (ajulong) nb * nseqa;
+
+        for(i = 0; i < nb; i++)
+            for(k = 0; k < nseqa; k++)
+            {
+                pair = &pairs[(ajulong) i * nseqa + k];
+                pair->Seqa = ajSeqsetGetseqSeq(seqset, k);
+                pair->Seqb = batch[i];
+                pair->Status = NEEDLEALL_OK;
+            }
 
-            p = ajSeqGetSeqC(seqa);
-            q = ajSeqGetSeqC(seqb);
+        queue.Npairs = npairs;
+        queue.Next = 0;
 
-            ajStrAssignC(&alga,"");
-            ajStrAssignC(&algb,"");
+        needleallRun(workers, (ajuint) nthreads);
 
-            score = embAlignPathCalcWithEndGapPenalties(p, q, lena, lenb,
-                    gapopen, gapextend, endgapopen, endgapextend,
-                    &start1, &start2, sub, cvt, m, ix, iy,
-                    compass, ajFalse, endweight);
+        for(ipair = 0; ipair < npairs; ipair++)
+        {
+            pair = &pairs[ipair];
+            seqa = pair->Seqa;
 
-            embAlignWalkNWMatrixUsingCompass(p, q, &alga, &algb,
-                    lena, lenb, &start1, &start2, compass);
+            if(pair->Status == NEEDLEALL_TOOBIG)
+                ajDie("Sequences too big.");
+            else if(pair->Status == NEEDLEALL_NOMEMORY)
+                ajDie("Sequences too big, memory allocation failed");
 
-            if (score > minscore){
+            if (pair->Score > minscore){
                 if(!ajAlignFormatShowsSequences(align))
                 {
-                    ajAlignDefineCC(align, ajStrGetPtr(alga),
-                            ajStrGetPtr(algb), ajSeqGetNameC(seqa),
-                            ajSeqGetNameC(seqb));
-                    ajAlignSetScoreR(align, score);
+                    ajAlignDefineCC(align, ajStrGetPtr(pair->Alga),
+                            ajStrGetPtr(pair->Algb), ajSeqGetNameC(seqa),
+                            ajSeqGetNameC(pair->Seqb));
+                    ajAlignSetScoreR(align, pair->Score);
                 }
                 else
                 {
-                    embAlignReportGlobal(align, seqa, seqb, alga, algb,
-                            start1, start2,
-                            gapopen, gapextend,
-                            score, matrix,
-                            ajSeqGetOffset(seqa), ajSeqGetOffset(seqb));
+                    embAlignReportGlobal(align, seqa, pair->Seqb,
+                            pair->Alga, pair->Algb,
+                            pair->Start1, pair->Start2,
+                            queue.Gapopen, queue.Gapextend,
+                            pair->Score, matrix,
+                            ajSeqGetOffset(seqa), ajSeqGetOffset(pair->Seqb));
                 }
 
                 if(!dobrief)
                 {
-                    embAlignCalcSimilarity(alga,algb,sub,cvt,lena,lenb,&id,
-                            &sim, &idx, &simx);
+                    embAlignCalcSimilarity(pair->Alga, pair->Algb, sub, cvt,
+                            ajSeqGetLen(seqa), ajSeqGetLen(pair->Seqb),
+                            &id, &sim, &idx, &simx);
                     ajFmtPrintS(&tmpstr,"Longest_Identity = %5.2f%%\n",
                             id);
                     ajFmtPrintAppS(&tmpstr,"Longest_Similarity = %5.2f%%\n",
@@ -202,11 +370,14 @@ int main(int argc, char **argv)
                 ajFmtPrintF(errorf,
                         "Alignment score (%.1f) is less than minimum score"
                         "(%.1f) for sequences %s vs %s\n",
-                        score, minscore, ajSeqGetNameC(seqa),
-                        ajSeqGetNameC(seqb));
+                        pair->Score, minscore, ajSeqGetNameC(seqa),
+                        ajSeqGetNameC(pair->Seqb));
         }
+
+        for(i = 0; i < nb; i++)
+            ajSeqDel(&batch[i]);
     }
-    
+
 
     if(!ajAlignFormatShowsSequences(align))
     {
@@ -222,17 +393,222 @@ int main(int argc, char **argv)
     ajSeqsetDel(&seqset);
     ajSeqDel(&seqb);
 
-    AJFREE(compass);
-    AJFREE(ix);
-    AJFREE(iy);
-    AJFREE(m);
-    
-    ajStrDel(&alga);
-    ajStrDel(&algb);
-    ajStrDel(&ss);
+#ifdef HAVE_LIBPTHREAD
+    pthread_mutex_destroy(&queue.Lock);
+#endif /* HAVE_LIBPTHREAD */
+
+    for(i = 0; i < (ajuint) nthreads; i++)
+    {
+        AJFREE(workers[i].Compass);
+        AJFREE(workers[i].Ix);
+        AJFREE(workers[i].Iy);
+        AJFREE(workers[i].M);
+    }
+
+    for(ipair = 0; ipair < (ajulong) maxb * nseqa; ipair++)
+    {
+        ajStrDel(&pairs[ipair].Alga);
+        ajStrDel(&pairs[ipair].Algb);
+    }
+
+    AJFREE(workers);
+    AJFREE(pairs);
+    AJFREE(batch);
+
     ajStrDel(&tmpstr);
 
     embExit();
 
     return 0;
 }
+
+
+
+
+/* @funcstatic needleallAlignPair *********************************************
+**
+** Align one pair using the scratch matrices of a worker
+**
+** @param [u] worker [PNeedleallWorker] Worker
+** @param [u] pair [PNeedleallPair] Pair to align
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void needleallAlignPair(PNeedleallWorker worker, PNeedleallPair pair)
+{
+    PNeedleallQueue queue = worker->Queue;
+    ajuint lena;
+    ajuint lenb;
+    size_t len;
+    const char *p;
+    const char *q;
+
+    lena = ajSeqGetLen(pair->Seqa);
+    lenb = ajSeqGetLen(pair->Seqb);
+
+    p = ajSeqGetSeqC(pair->Seqa);
+    q = ajSeqGetSeqC(pair->Seqb);
+
+    if(queue->Band && lena > 1 && lenb > 1)
+    {
+        pair->Score = embAlignBandCalcNW(p, q, lena, lenb,
+                queue->Gapopen, queue->Gapextend,
+                queue->Endgapopen, queue->Endgapextend,
+                &pair->Start1, &pair->Start2, queue->Sub, queue->Cvt,
+                &pair->Alga, &pair->Algb, queue->Endweight,
+                queue->Band, queue->Adaptive);
+
+        return;
+    }
+
+    if(lenb > (LONG_MAX/(size_t)(lena+1)))
+    {
+        pair->Status = NEEDLEALL_TOOBIG;
+        return;
+    }
+
+    len = (size_t)lena*(size_t)lenb;
+
+    if(len>worker->Maxarr)
+    {
+        AJCRESIZETRY0(worker->Compass,(size_t)worker->Maxarr,len);
+        if(!worker->Compass)
+        {
+            pair->Status = NEEDLEALL_NOMEMORY;
+            return;
+        }
+        AJCRESIZETRY0(worker->M,(size_t)worker->Maxarr,len);
+        if(!worker->M)
+        {
+            pair->Status = NEEDLEALL_NOMEMORY;
+            return;
+        }
+        AJCRESIZETRY0(worker->Ix,(size_t)worker->Maxarr,len);
+        if(!worker->Ix)
+        {
+            pair->Status = NEEDLEALL_NOMEMORY;
+            return;
+        }
+        AJCRESIZETRY0(worker->Iy,(size_t)worker->Maxarr,len);
+        if(!worker->Iy)
+        {
+            pair->Status = NEEDLEALL_NOMEMORY;
+            return;
+        }
+
+        worker->Maxarr=len;
+    }
+
+    pair->Start1 = 0;
+    pair->Start2 = 0;
+
+    pair->Score = embAlignPathCalcWithEndGapPenalties(p, q, lena, lenb,
+            queue->Gapopen, queue->Gapextend,
+            queue->Endgapopen, queue->Endgapextend,
+            &pair->Start1, &pair->Start2, queue->Sub, queue->Cvt,
+            worker->M, worker->Ix, worker->Iy,
+            worker->Compass, ajFalse, queue->Endweight);
+
+    embAlignWalkNWMatrixUsingCompass(p, q, &pair->Alga, &pair->Algb,
+            lena, lenb, &pair->Start1, &pair->Start2, worker->Compass);
+
+    return;
+}
+
+
+
+
+/* @funcstatic needleallWork **************************************************
+**
+** Worker loop: take pairs from the shared queue until it is empty
+**
+** @param [u] arg [void*] Worker
+** @return [void*] NULL
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void* needleallWork(void *arg)
+{
+    PNeedleallWorker worker = (PNeedleallWorker) arg;
+    PNeedleallQueue queue = worker->Queue;
+    ajulong ipair;
+
+    for(;;)
+    {
+#ifdef HAVE_LIBPTHREAD
+        pthread_mutex_lock(&queue->Lock);
+#endif /* HAVE_LIBPTHREAD */
+        ipair = queue->Next;
+
+        if(ipair < queue->Npairs)
+            queue->Next++;
+#ifdef HAVE_LIBPTHREAD
+        pthread_mutex_unlock(&queue->Lock);
+#endif /* HAVE_LIBPTHREAD */
+
+        if(ipair >= queue->Npairs)
+            break;
+
+        needleallAlignPair(worker, &queue->Pairs[ipair]);
+    }
+
+    return NULL;
+}
+
+
+
+
+/* @funcstatic needleallRun ***************************************************
+**
+** Align all pairs in the queue, using the main thread as the first worker
+**
+** @param [u] workers [PNeedleallWorker] Workers
+** @param [r] nthreads [ajuint] Number of workers
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void needleallRun(PNeedleallWorker workers, ajuint nthreads)
+{
+#ifdef HAVE_LIBPTHREAD
+    pthread_t *tids = NULL;
+    ajuint nstarted = 0;
+    ajuint i;
+
+    if(nthreads > 1)
+    {
+        AJCNEW0(tids, nthreads);
+
+        for(i = 1; i < nthreads; i++)
+        {
+            if(pthread_create(&tids[i], NULL, needleallWork, &workers[i]))
+            {
+                ajWarn("Failed to start thread %u, continuing with %u",
+                       i, i);
+                break;
+            }
+
+            nstarted++;
+        }
+    }
+
+    needleallWork(&workers[0]);
+
+    for(i = 1; i <= nstarted; i++)
+        pthread_join(tids[i], NULL);
+
+    AJFREE(tids);
+#else /* !HAVE_LIBPTHREAD */
+    (void) nthreads;
+    needleallWork(&workers[0]);
+#endif /* !HAVE_LIBPTHREAD */
+
+    return;
+}
@@ -46,6 +46,8 @@ ajuint statwordlen;
 int main(int argc, char **argv)
 {
     AjPTable seq1MatchTable = 0;
+    EmbPWordIndex seq1Index = NULL;
+    EmbPWordSuffix seqsetSuffix = NULL;
     AjPList matchlist;
     AjPSeqset seqset;
     AjPAlign align = NULL;
@@ -53,33 +55,54 @@ int main(int argc, char **argv)
     ajuint i;
     ajuint j;
     ajuint nseqs;
+    AjBool suffixarray;
 
     embInit("seqmatchall", argc, argv);
 
     seqset      = ajAcdGetSeqset("sequence1");
     statwordlen = ajAcdGetInt("wordsize");
     align    = ajAcdGetAlign("outfile");
+    suffixarray = ajAcdGetBoolean("suffixarray");
 
     ajAlignSetExternal(align, ajTrue);
     embWordLength(statwordlen);
     seqs = ajSeqsetGetSeqarray(seqset);
     nseqs = ajSeqsetGetSize(seqset);
 
+    /* one suffix array finds the matches between all the sequences */
+    if(suffixarray)
+        seqsetSuffix = embWordSuffixNewSeqset(seqset);
+
     for(i=0;i<nseqs;i++)
     {
         iseq1 = i;
 	seq1MatchTable = 0;
 	if(ajSeqGetLen(seqs[iseq1]) > statwordlen)
 	{
-	    if(embWordGetTable(&seq1MatchTable, seqs[i])) /* get word table */
+            /* packed index if the words fit, else the word table */
+            if(!seqsetSuffix)
+                seq1Index = embWordIndexNewSeq(seqs[i]);
+
+	    if(seqsetSuffix || seq1Index ||
+               embWordGetTable(&seq1MatchTable, seqs[i])) /* get word table */
 	    {
 		for(j=i+1;j<ajSeqsetGetSize(seqset);j++)
 		{
 		    iseq2 = j;
 		    if(ajSeqGetLen(seqs[j]) >= statwordlen)
 		    {
-			matchlist = embWordBuildMatchTable(seq1MatchTable,
-							   seqs[j], ajTrue);
+                        if(seqsetSuffix)
+                            matchlist =
+                                embWordSuffixBuildMatchTable(seqsetSuffix,
+                                                             i, j);
+                        else if(seq1Index)
+                            matchlist =
+                                embWordIndexBuildMatchTable(seq1Index,
+                                                            seqs[j], ajTrue);
+                        else
+                            matchlist =
+                                embWordBuildMatchTable(seq1MatchTable,
+                                                       seqs[j], ajTrue);
 			if (ajListGetLength(matchlist))
 			{
 			    seqmatchall_listPrint(align, matchlist);
@@ -91,10 +114,13 @@ int main(int argc, char **argv)
 		    }
 		}
 	    }
+	    embWordIndexDel(&seq1Index);
 	    embWordFreeTable(&seq1MatchTable); /* free table of words */
 	}
     }
 
+    embWordSuffixDel(&seqsetSuffix);
+
     ajAlignClose(align);
     ajAlignDel(&align);
     ajSeqsetDel(&seqset);
@@ -23,6 +23,7 @@
 ******************************************************************************/
 
 #include "emboss.h"
+#include <limits.h>
 
 
 
@@ -37,6 +38,8 @@
 
 #define stretchergap(k)  ((k) <= 0 ? 0 : g+hh*(k)) /* k-symbol indel score */
 
+#define STRETCHERNONE (INT_MIN/4)	/* Score of a cell outside the band */
+
 
 
 
@@ -129,6 +132,12 @@ static AjPSeqCvt cvt = NULL;
 static char *seqc0;
 static char *seqc1;   /* aligned sequences */
 
+static AjBool banded = AJFALSE;		/* Only align inside a band */
+static ajint bandlo;			/* Lowest diagonal (j-i) in the band */
+static ajint bandhi;			/* Highest diagonal (j-i) in the band */
+static const char *banda;		/* Start of sequences A and B */
+static const char *bandb;
+
 
 
 
@@ -148,6 +157,12 @@ int main(int argc, char **argv)
     ajint ggapval;
     ajuint i;
     ajint gscore;
+    ajint oldscore = 0;
+    ajint width;
+    ajint lena;
+    ajint lenb;
+    AjBool adaptive;
+    AjBool first = ajTrue;
     /* float percent; */
     AjPAlign align   = NULL;
     AjPSeqset seqset = NULL;
@@ -166,6 +181,8 @@ int main(int argc, char **argv)
     matrix  = ajAcdGetMatrix("datafile");
     gdelval = ajAcdGetInt("gapopen");
     ggapval = ajAcdGetInt("gapextend");
+    width   = ajAcdGetInt("band");
+    adaptive = ajAcdGetBoolean("adaptive");
     align   = ajAcdGetAlign("outfile");
 
     /* obsolete. Can be uncommented in acd file and here to reuse */
@@ -212,9 +229,41 @@ int main(int argc, char **argv)
     AJCNEW(seqc0, ajSeqGetLen(glseq0)+ajSeqGetLen(glseq1));
     AJCNEW(seqc1, ajSeqGetLen(glseq0)+ajSeqGetLen(glseq1));
 
-    gscore = stretcher_Ealign(ajStrGetPtr(aa0str),ajStrGetPtr(aa1str),
-			      glseq0, glseq1,
-			      (gdelval-ggapval),ggapval,glres,&nres);
+    lena = ajSeqGetLen(glseq0);
+    lenb = ajSeqGetLen(glseq1);
+    banded = (width > 0);
+
+    for(;;)
+    {
+        if(banded)
+        {
+            bandlo = ((lenb < lena) ? lenb-lena : 0) - width;
+            bandhi = ((lenb > lena) ? lenb-lena : 0) + width;
+        }
+
+        gscore = stretcher_Ealign(ajStrGetPtr(aa0str),ajStrGetPtr(aa1str),
+                                  glseq0, glseq1,
+                                  (gdelval-ggapval),ggapval,glres,&nres);
+
+        if(!banded || !adaptive)
+            break;
+
+        ajDebug("band %d..%d score %d\n", bandlo, bandhi, gscore);
+
+        if(bandlo <= -lena && bandhi >= lenb)
+            break;
+
+        if(!first && gscore == oldscore)
+            break;
+
+        first = ajFalse;
+        oldscore = gscore;
+
+        if(width > (lena+lenb)/2)
+            width = lena+lenb;
+        else
+            width *= 2;
+    }
 
     glnc = stretcher_Calcons(ajSeqGetLen(glseq0),ajSeqGetLen(glseq1),glres);
     /* percent = (double)nd*100.0/(double)glnc; */
@@ -353,6 +402,9 @@ static ajint stretcher_Ealign(const char *A,const char *B,
 	embExitBad();
     }
 
+    banda = A;
+    bandb = B;
+
     c  = stretcher_Align(A,B,M,N,-g,-g);	/* OK, do it */
     ck = stretcher_CheckScore((unsigned const char *)A,(unsigned const char *)B,
                               seq0, seq1,S,NC);
@@ -372,6 +424,9 @@ static ajint stretcher_Ealign(const char *A,const char *B,
 ** A[1..M] and B[1..N] that begins(ends) with a delete if tb(te) is zero
 ** and appends such a conversion to the current script.
 **
+** When banded is set, only cells whose diagonal in the full matrix lies
+** from bandlo to bandhi are computed. The others score STRETCHERNONE.
+**
 ** @param [r] A [const char*] Undocumented
 ** @param [r] B [const char*] Undocumented
 ** @param [r] M [ajint] Undocumented
@@ -400,6 +455,10 @@ static ajint stretcher_Align(const char *A,const char *B,
     register ajint s;
     ajint t;
     ajint *wa;
+    ajint lo;
+    ajint hi;
+    ajint jlo;
+    ajint jhi;
 
     /* Boundary cases: M <= 1 or N == 0 */
 
@@ -422,10 +481,25 @@ static ajint stretcher_Align(const char *A,const char *B,
 	if(tb < te)
 	    tb = te;
 
+	jlo = 1;
+	jhi = N;
+
+	if(banded)
+	{
+	    jlo = 1 + bandlo - (ajint)((B - bandb) - (A - banda));
+	    jhi = 1 + bandhi - (ajint)((B - bandb) - (A - banda));
+
+	    if(jlo < 1)
+		jlo = 1;
+
+	    if(jhi > N)
+		jhi = N;
+	}
+
 	midc = (tb-hh) - stretchergap(N);
 	midj = 0;
 	wa = sub[(ajint)A[1]];
-	for(j = 1; j <= N; j++)
+	for(j = jlo; j <= jhi; j++)
         {
 	    c = -stretchergap(j-1) + wa[(ajint)B[j]] - stretchergap(N-j);
 
@@ -452,6 +526,19 @@ static ajint stretcher_Align(const char *A,const char *B,
 	return midc;
     }
 
+    /* Row i of this block covers columns i+lo to i+hi */
+
+    if(banded)
+    {
+	lo = bandlo - (ajint)((B - bandb) - (A - banda));
+	hi = bandhi - (ajint)((B - bandb) - (A - banda));
+    }
+    else
+    {
+	lo = -M;
+	hi = N;
+    }
+
     /* Divide: Find optimum midpoint (midi,midj) of cost midc */
 
     midi  = M/2;	 /* Forward phase:                          */
@@ -461,16 +548,38 @@ static ajint stretcher_Align(const char *A,const char *B,
     {
 	CC[j] = t = t-hh;
 	DD[j] = t-g;
+
+	if(j > hi)
+	    CC[j] = DD[j] = STRETCHERNONE;
     }
     t = tb;
 
     for(i = 1; i <= midi; i++)
     {
-	s = CC[0];
-	CC[0] = c = t = t-hh;
-	e = t-g;
+	jlo = i+lo;
+	jhi = i+hi;
+
+	if(jhi > N)
+	    jhi = N;
+
+	if(jlo <= 0)
+	{
+	    s = CC[0];
+	    CC[0] = c = t = t-hh;
+	    e = t-g;
+	    j = 1;
+	}
+	else
+	{
+	    /* column jlo-1 has left the band */
+	    s = CC[jlo-1];
+	    CC[jlo-1] = DD[jlo-1] = STRETCHERNONE;
+	    c = e = STRETCHERNONE;
+	    j = jlo;
+	}
+
 	wa = sub[(ajint)A[i]];
-	for(j = 1; j <= N; j++)
+	for(; j <= jhi; j++)
         {
 	    if((c =   c   - m) > (e =   e   - hh))
 		e = c;
@@ -497,16 +606,38 @@ static ajint stretcher_Align(const char *A,const char *B,
     {
 	RR[j] = t = t-hh;
 	SS[j] = t-g;
+
+	if(j < M+lo)
+	    RR[j] = SS[j] = STRETCHERNONE;
     }
     t = te;
 
     for(i = M-1; i >= midi; i--)
     {
-	s = RR[N];
-	RR[N] = c = t = t-hh;
-	e = t-g;
+	jlo = i+lo;
+	jhi = i+hi;
+
+	if(jlo < 0)
+	    jlo = 0;
+
+	if(jhi >= N)
+	{
+	    s = RR[N];
+	    RR[N] = c = t = t-hh;
+	    e = t-g;
+	    j = N-1;
+	}
+	else
+	{
+	    /* column jhi+1 has left the band */
+	    s = RR[jhi+1];
+	    RR[jhi+1] = SS[jhi+1] = STRETCHERNONE;
+	    c = e = STRETCHERNONE;
+	    j = jhi;
+	}
+
 	wa = sub[(ajint)A[i+1]];
-	for(j = N-1; j >= 0; j--)
+	for(; j >= jlo; j--)
         {
 	    if((c =   c   - m) > (e =   e   - hh))
 		e = c;
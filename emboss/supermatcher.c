@@ -38,13 +38,131 @@
 
 #include "emboss.h"
 
+#include <errno.h>
 
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif /* !WIN32 */
 
+/* queries for each worker process in a batch */
+#define SUPERMATCHER_BATCH 500
 
+
+
+
+/* @datastatic SupermatcherPResult ********************************************
+**
+** Alignment of a query sequence with one target sequence
+**
+** @alias SupermatcherSResult
+** @alias SupermatcherOResult
+**
+** @attr Queryaln [AjPStr] Aligned query sequence
+** @attr Targetaln [AjPStr] Aligned target sequence
+** @attr Score [float] Alignment score
+** @attr Querystart [ajint] Alignment start in the query sequence
+** @attr Targetstart [ajint] Alignment start in the target sequence
+** @attr Seeded [AjBool] True if a word match was found
+** @attr Reported [AjBool] True if the score is over the minimum
+** @attr Padding [char[4]] Padding to alignment boundary
+** @@
+******************************************************************************/
+
+typedef struct SupermatcherSResult
+{
+    AjPStr Queryaln;
+    AjPStr Targetaln;
+    float Score;
+    ajint Querystart;
+    ajint Targetstart;
+    AjBool Seeded;
+    AjBool Reported;
+    char Padding[4];
+} SupermatcherOResult;
+
+#define SupermatcherPResult SupermatcherOResult*
+
+
+
+
+/* @datastatic SupermatcherPSearch ********************************************
+**
+** Target word table and alignment parameters, shared by all queries
+**
+** @alias SupermatcherSSearch
+** @alias SupermatcherOSearch
+**
+** @attr Targetseqs [const AjPSeqset] Target sequences
+** @attr Kmerindex [EmbPWordIndex] Packed index of target words
+** @attr Wordsw [EmbPWordRK*] Target words if there is no packed index
+** @attr Matchlist [AjPList*] Word matches for each target sequence
+** @attr Lastlocation [ajuint*] Search position for each target sequence
+** @attr Sub [float**] Substitution matrix
+** @attr Cvt [AjPSeqCvt] Conversion table for the substitution matrix
+** @attr Path [float*] Path matrix
+** @attr Compass [ajint*] Path direction matrix
+** @attr Results [SupermatcherPResult] Alignment for each target sequence
+** @attr Gapopen [float] Gap opening penalty
+** @attr Gapextend [float] Gap extension penalty
+** @attr Minscore [float] Minimum score to report an alignment
+** @attr Width [ajint] Alignment band width
+** @attr Wordlen [ajint] Word length
+** @attr Oldmax [ajint] Allocated size of the path matrices
+** @attr Nkmers [ajuint] Number of target words
+** @attr Ntargets [ajuint] Number of target sequences
+** @attr Padding [char[4]] Padding to alignment boundary
+** @@
+******************************************************************************/
+
+typedef struct SupermatcherSSearch
+{
+    const AjPSeqset Targetseqs;
+    EmbPWordIndex Kmerindex;
+    EmbPWordRK* Wordsw;
+    AjPList* Matchlist;
+    ajuint* Lastlocation;
+    float** Sub;
+    AjPSeqCvt Cvt;
+    float* Path;
+    ajint* Compass;
+    SupermatcherPResult Results;
+    float Gapopen;
+    float Gapextend;
+    float Minscore;
+    ajint Width;
+    ajint Wordlen;
+    ajint Oldmax;
+    ajuint Nkmers;
+    ajuint Ntargets;
+    char Padding[4];
+} SupermatcherOSearch;
+
+#define SupermatcherPSearch SupermatcherOSearch*
+
+
+
+
+static void supermatcher_batch(SupermatcherPSearch search,
+                               AjPSeq const *batch, ajuint nbatch,
+                               ajuint threads,
+                               AjPAlign align, AjPFile errorf,
+                               AjPMatrixf matrix);
 static void supermatcher_findendpoints(const EmbPWordMatch max,
 	const AjPSeq trgseq, const AjPSeq qryseq,
 	ajint *trgstart, ajint *qrystart,
 	ajint *trgend, ajint *qryend);
+static void supermatcher_search(SupermatcherPSearch search,
+                                AjPSeq queryseq);
+static void supermatcher_spoolread(AjPFile spool,
+                                   const SupermatcherPSearch search);
+static void supermatcher_spoolwrite(AjPFile spool,
+                                    const SupermatcherPSearch search);
+static void supermatcher_write(const SupermatcherPSearch search,
+                               const AjPSeq queryseq,
+                               AjPAlign align, AjPFile errorf,
+                               AjPMatrixf matrix);
 
 
 
@@ -60,266 +178,180 @@ static void supermatcher_findendpoints(const EmbPWordMatch max,
 ** This gives us the start (offset) for the smith-waterman match by finding
 ** the biggest match and calculating start and ends for both sequences.
 **
+** With more than one thread, the queries are read in batches and
+** aligned by worker processes sharing the target word table. The
+** alignments are written in query order.
+**
 ******************************************************************************/
 
 int main(int argc, char **argv)
 {
     AjPSeqall queryseqs;
     AjPSeqset targetseqs;
-    AjPSeq queryseq;
+    AjPSeq queryseq = NULL;
     const AjPSeq targetseq;
-    AjPStr queryaln = 0;
-    AjPStr targetaln = 0;
 
     AjPFile errorf;
-    AjBool show = ajFalse;
-
-    const char   *queryseqc;
-    const char   *targetseqc;
 
     AjPMatrixf matrix;
-    AjPSeqCvt cvt = 0;
-    float **sub;
-    ajint *compass = NULL;
-    float *path = NULL;
-
-    float gapopen;
-    float gapextend;
-    float score;
-    float minscore;
 
     ajuint j, k;
-    ajint querystart = 0;
-    ajint targetstart = 0;
-    ajint queryend   = 0;
-    ajint targetend   = 0;
-    ajint width  = 0;
     AjPTable kmers = 0;
-    ajint wordlen = 6;
-    ajint oldmax = 0;
-    ajint newmax = 0;
-
-    ajuint ntargetseqs;
-    ajuint nkmers;
+    ajint threads;
 
     AjPAlign align = NULL;
-    EmbPWordMatch maxmatch; /* match with maximum score */
 
-    /* Cursors for the current sequence being scanned,
-    ** i.e., until which location it was scanned.
-    ** Separate cursor/location entries for each sequence in the seqset.
-    */
-    ajuint* lastlocation;
-
-    EmbPWordRK* wordsw = NULL;
-    AjPList* matchlist = NULL;
+    SupermatcherOSearch search;
+    AjPSeq* batch = NULL;
+    ajuint nbatch = 0;
 
     embInit("supermatcher", argc, argv);
 
+    memset(&search, 0, sizeof(search));
+
     matrix    = ajAcdGetMatrixf("datafile");
     queryseqs = ajAcdGetSeqall("asequence");
     targetseqs= ajAcdGetSeqset("bsequence");
-    gapopen   = ajAcdGetFloat("gapopen");
-    gapextend = ajAcdGetFloat("gapextend");
-    wordlen   = ajAcdGetInt("wordlen");
+    search.Gapopen   = ajAcdGetFloat("gapopen");
+    search.Gapextend = ajAcdGetFloat("gapextend");
+    search.Wordlen   = ajAcdGetInt("wordlen");
     align     = ajAcdGetAlign("outfile");
     errorf    = ajAcdGetOutfile("errfile");
-    width     = ajAcdGetInt("width");	/* width for banded Smith-Waterman */
-    minscore  = ajAcdGetFloat("minscore");
+    search.Width = ajAcdGetInt("width"); /* width for banded Smith-Waterman */
+    search.Minscore  = ajAcdGetFloat("minscore");
+    threads   = ajAcdGetInt("threads");
+
+    search.Gapopen   = ajRoundFloat(search.Gapopen, 8);
+    search.Gapextend = ajRoundFloat(search.Gapextend, 8);
 
-    gapopen   = ajRoundFloat(gapopen, 8);
-    gapextend = ajRoundFloat(gapextend, 8);
+    search.Sub = ajMatrixfGetMatrix(matrix);
+    search.Cvt = ajMatrixfGetCvt(matrix);
 
-    sub = ajMatrixfGetMatrix(matrix);
-    cvt = ajMatrixfGetCvt(matrix);
+#ifdef WIN32
+    if(threads > 1)
+        ajWarn("Worker processes are not supported in this build, "
+               "using one thread");
 
-    embWordLength(wordlen);
+    threads = 1;
+#endif /* WIN32 */
+
+    /* the debug file is not protected against concurrent writes */
+    if(threads > 1 && ajDebugOn())
+    {
+        ajWarn("Debug output requested, using one thread");
+        threads = 1;
+    }
+
+    embWordLength(search.Wordlen);
 
     /* seqset sequence is the reference sequence for SAM format */
     ajAlignSetRefSeqIndx(align, 1);
 
     ajSeqsetTrim(targetseqs);
 
-    ntargetseqs = ajSeqsetGetSize(targetseqs);
+    search.Targetseqs = targetseqs;
+    search.Ntargets = ajSeqsetGetSize(targetseqs);
+
+    AJCNEW0(search.Matchlist, search.Ntargets);
+    AJCNEW0(search.Results, search.Ntargets);
+
+    for(k=0;k<search.Ntargets;k++)
+    {
+        search.Results[k].Queryaln = ajStrNew();
+        search.Results[k].Targetaln = ajStrNew();
+    }
 
-    AJCNEW0(matchlist, ntargetseqs);
+    /* packed index if the words fit, else get tables of words */
+    search.Kmerindex = embWordIndexNewSeqset(targetseqs);
 
-    /* get tables of words */
-    for(k=0;k<ntargetseqs;k++)
+    if(search.Kmerindex)
     {
-	targetseq = ajSeqsetGetseqSeq(targetseqs, k);
-	embWordGetTable(&kmers, targetseq);
-	ajDebug("Number of distinct kmers found so far: %Lu\n",
-		ajTableGetLength(kmers));
+        search.Nkmers = search.Kmerindex->Nwords;
+	ajDebug("Number of distinct kmers found: %u\n", search.Nkmers);
+    }
+    else
+    {
+        for(k=0;k<search.Ntargets;k++)
+        {
+            targetseq = ajSeqsetGetseqSeq(targetseqs, k);
+            embWordGetTable(&kmers, targetseq);
+            ajDebug("Number of distinct kmers found so far: %Lu\n",
+                    ajTableGetLength(kmers));
+        }
+
+        search.Nkmers = embWordRabinKarpInit(kmers, &search.Wordsw,
+                                             search.Wordlen, targetseqs);
     }
-    AJCNEW0(lastlocation, ntargetseqs);
 
-    if(ajTableGetLength(kmers)<1)
-	ajErr("no kmers found");
+    if(search.Nkmers<1)
+        ajErr("no kmers found");
 
-    nkmers = embWordRabinKarpInit(kmers, &wordsw, wordlen, targetseqs);
+    AJCNEW0(search.Lastlocation, search.Ntargets);
+
+    if(threads > 1)
+        AJCNEW0(batch, threads * SUPERMATCHER_BATCH);
 
     while(ajSeqallNext(queryseqs,&queryseq))
     {
 	ajSeqTrim(queryseq);
 
-	queryaln = ajStrNewRes(1+ajSeqGetLen(queryseq));
-
 	ajDebug("Read '%S'\n", ajSeqGetNameS(queryseq));
 
-	for(k=0;k<ntargetseqs;k++)
-	{
-	    lastlocation[k]=0;
-	    matchlist[k] = ajListstrNew();
-	}
-
-	embWordRabinKarpSearch(ajSeqGetSeqS(queryseq), targetseqs,
-		(EmbPWordRK const *)wordsw, wordlen, nkmers,
-		matchlist, lastlocation, ajFalse);
-
-
-	for(k=0;k<ajSeqsetGetSize(targetseqs);k++)
-	{
-	    targetseq      = ajSeqsetGetseqSeq(targetseqs, k);
-
-	    ajDebug("Processing '%S'\n", ajSeqGetNameS(targetseq));
-
-	    if(ajListGetLength(matchlist[k])==0)
-	    {
-		ajFmtPrintF(errorf,
-		            "No wordmatch start points for "
-		            "%s vs %s. No alignment\n",
-		            ajSeqGetNameC(queryseq),ajSeqGetNameC(targetseq));
-		embWordMatchListDelete(&matchlist[k]);
-		continue;
-	    }
-
-
-	    /* only the maximum match is used as seed
-	     * (if there is more than one location with the maximum match
-	     * only the first one is used)
-	     * TODO: we should add a new option to make above limit optional
-	     */
-	    maxmatch = embWordMatchFirstMax(matchlist[k]);
-
-	    supermatcher_findendpoints(maxmatch,targetseq, queryseq,
-		    &targetstart, &querystart,
-		    &targetend, &queryend);
-
-	    targetaln=ajStrNewRes(1+ajSeqGetLen(targetseq));
-	    queryseqc = ajSeqGetSeqC(queryseq);
-	    targetseqc = ajSeqGetSeqC(targetseq);
-
-	    ajStrAssignC(&queryaln,"");
-	    ajStrAssignC(&targetaln,"");
-
-	    ajDebug("++ %S v %S start:%d %d end:%d %d\n",
-		    ajSeqGetNameS(targetseq), ajSeqGetNameS(queryseq),
-		    targetstart, querystart, targetend, queryend);
-
-	    newmax = (targetend-targetstart+2)*width;
-
-	    if(newmax > oldmax)
-	    {
-		AJFREE(path);
-		AJCNEW0(path,newmax);
-		AJFREE(compass);
-		AJCNEW0(compass,newmax);
-		oldmax=newmax;
-		ajDebug("++ memory re/allocation for path/compass arrays"
-			" to size: %d\n", newmax);
-	    }
-	    else
-	    {
-		AJCSET0(path,newmax);
-		AJCSET0(compass,newmax);
-	    }
-
-	    ajDebug("Calling embAlignPathCalcSWFast "
-		    "%d..%d [%d/%d] %d..%d [%d/%d] width:%d\n",
-		    querystart, queryend, (queryend - querystart + 1),
-		    ajSeqGetLen(queryseq),
-		    targetstart, targetend, (targetend - targetstart + 1),
-		    ajSeqGetLen(targetseq),
-		    width);
-
-	    score = embAlignPathCalcSWFast(&targetseqc[targetstart],
-	                                   &queryseqc[querystart],
-	                                   targetend-targetstart+1,
-	                                   queryend-querystart+1,
-	                                   0,width,
-	                                   gapopen,gapextend,
-	                                   path,sub,cvt,
-	                                   compass,show);
-	    if(score>minscore)
-	    {
-		embAlignWalkSWMatrixFast(path,compass,gapopen,gapextend,
-		                         targetseq,queryseq,
-		                         &targetaln,&queryaln,
-		                         targetend-targetstart+1,
-		                         queryend-querystart+1,
-		                         0,width,
-		                         &targetstart,&querystart);
-
-		if(!ajAlignFormatShowsSequences(align))
-		{
-		    ajAlignDefineCC(align, ajStrGetPtr(targetaln),
-		                    ajStrGetPtr(queryaln),
-		                    ajSeqGetNameC(targetseq),
-		                    ajSeqGetNameC(queryseq));
-		    ajAlignSetScoreR(align, score);
-		}
-		else
-		{
-		    ajDebug(" queryaln:%S \ntargetaln:%S\n",
-		            queryaln,targetaln);
-		    embAlignReportLocal(align,
-			    queryseq, targetseq,
-			    queryaln, targetaln,
-			    querystart, targetstart,
-			    gapopen, gapextend,
-			    score, matrix,
-			    1 + ajSeqGetOffset(queryseq),
-			    1 + ajSeqGetOffset(targetseq)
-		    );
-		}
-		ajAlignWrite(align);
-		ajAlignReset(align);
-	    }
-	    ajStrDel(&targetaln);
-
-	    embWordMatchListDelete(&matchlist[k]);
-	}
-
-	ajStrDel(&queryaln);
+        if(threads > 1)
+        {
+            batch[nbatch++] = ajSeqNewSeq(queryseq);
+
+            if(nbatch == (ajuint) threads * SUPERMATCHER_BATCH)
+            {
+                supermatcher_batch(&search, batch, nbatch, threads,
+                                   align, errorf, matrix);
+                nbatch = 0;
+            }
+
+            continue;
+        }
+
+        supermatcher_search(&search, queryseq);
+        supermatcher_write(&search, queryseq, align, errorf, matrix);
     }
 
+    if(nbatch)
+        supermatcher_batch(&search, batch, nbatch, threads,
+                           align, errorf, matrix);
 
-    for(k=0;k<nkmers;k++)
+    for(k=0;search.Wordsw && k<search.Nkmers;k++)
     {
-	AJFREE(wordsw[k]->seqindxs);
-	AJFREE(wordsw[k]->nSeqMatches);
+	AJFREE(search.Wordsw[k]->seqindxs);
+	AJFREE(search.Wordsw[k]->nSeqMatches);
+
+	for(j=0;j<search.Wordsw[k]->nseqs;j++)
+	    AJFREE(search.Wordsw[k]->locs[j]);
 
-	for(j=0;j<wordsw[k]->nseqs;j++)
-	    AJFREE(wordsw[k]->locs[j]);
+	AJFREE(search.Wordsw[k]->nnseqlocs);
+	AJFREE(search.Wordsw[k]->locs);
+	AJFREE(search.Wordsw[k]);
+    }
 
-	AJFREE(wordsw[k]->nnseqlocs);
-	AJFREE(wordsw[k]->locs);
-	AJFREE(wordsw[k]);
+    for(k=0;k<search.Ntargets;k++)
+    {
+        ajStrDel(&search.Results[k].Queryaln);
+        ajStrDel(&search.Results[k].Targetaln);
     }
 
     embWordFreeTable(&kmers);
+    embWordIndexDel(&search.Kmerindex);
 
     if(!ajAlignFormatShowsSequences(align))
 	ajMatrixfDel(&matrix);
     
-    AJFREE(path);
-    AJFREE(compass);
-    AJFREE(kmers);
-    AJFREE(wordsw);
+    AJFREE(search.Path);
+    AJFREE(search.Compass);
+    AJFREE(search.Wordsw);
+    AJFREE(search.Results);
+    AJFREE(batch);
 
-    AJFREE(matchlist);
-    AJFREE(lastlocation);
+    AJFREE(search.Matchlist);
+    AJFREE(search.Lastlocation);
 
     ajAlignClose(align);
     ajAlignDel(&align);
@@ -336,6 +368,437 @@ int main(int argc, char **argv)
 
 
 
+/* @funcstatic supermatcher_search ********************************************
+**
+** Find the word matches of a query sequence with each target sequence
+** and align the query with the best match in a band.
+**
+** @param [u] search [SupermatcherPSearch] Target words and results
+** @param [u] queryseq [AjPSeq] Query sequence
+** @return [void]
+** @@
+******************************************************************************/
+
+static void supermatcher_search(SupermatcherPSearch search,
+                                AjPSeq queryseq)
+{
+    const AjPSeq targetseq;
+    SupermatcherPResult result;
+    EmbPWordMatch maxmatch; /* match with maximum score */
+    AjBool show = ajFalse;
+
+    const char   *queryseqc;
+    const char   *targetseqc;
+
+    ajuint k;
+    ajint querystart = 0;
+    ajint targetstart = 0;
+    ajint queryend   = 0;
+    ajint targetend   = 0;
+    ajint newmax = 0;
+
+    for(k=0;k<search->Ntargets;k++)
+    {
+        search->Lastlocation[k]=0;
+        search->Matchlist[k] = ajListstrNew();
+    }
+
+    if(search->Kmerindex)
+        embWordIndexSearch(search->Kmerindex, ajSeqGetSeqS(queryseq),
+                           search->Matchlist, search->Lastlocation,
+                           ajFalse);
+    else
+        embWordRabinKarpSearch(ajSeqGetSeqS(queryseq), search->Targetseqs,
+                               (EmbPWordRK const *)search->Wordsw,
+                               search->Wordlen, search->Nkmers,
+                               search->Matchlist, search->Lastlocation,
+                               ajFalse);
+
+    for(k=0;k<search->Ntargets;k++)
+    {
+        targetseq = ajSeqsetGetseqSeq(search->Targetseqs, k);
+        result = &search->Results[k];
+        result->Seeded = ajFalse;
+        result->Reported = ajFalse;
+
+        ajDebug("Processing '%S'\n", ajSeqGetNameS(targetseq));
+
+        if(ajListGetLength(search->Matchlist[k])==0)
+        {
+            embWordMatchListDelete(&search->Matchlist[k]);
+            continue;
+        }
+
+        result->Seeded = ajTrue;
+
+        /* only the maximum match is used as seed
+         * (if there is more than one location with the maximum match
+         * only the first one is used)
+         * TODO: we should add a new option to make above limit optional
+         */
+        maxmatch = embWordMatchFirstMax(search->Matchlist[k]);
+
+        supermatcher_findendpoints(maxmatch,targetseq, queryseq,
+                                   &targetstart, &querystart,
+                                   &targetend, &queryend);
+
+        queryseqc = ajSeqGetSeqC(queryseq);
+        targetseqc = ajSeqGetSeqC(targetseq);
+
+        ajStrAssignC(&result->Queryaln,"");
+        ajStrAssignC(&result->Targetaln,"");
+
+        ajDebug("++ %S v %S start:%d %d end:%d %d\n",
+                ajSeqGetNameS(targetseq), ajSeqGetNameS(queryseq),
+                targetstart, querystart, targetend, queryend);
+
+        newmax = (targetend-targetstart+2)*search->Width;
+
+        if(newmax > search->Oldmax)
+        {
+            AJFREE(search->Path);
+            AJCNEW0(search->Path,newmax);
+            AJFREE(search->Compass);
+            AJCNEW0(search->Compass,newmax);
+            search->Oldmax=newmax;
+            ajDebug("++ memory re/allocation for path/compass arrays"
+                    " to size: %d\n", newmax);
+        }
+        else
+        {
+            AJCSET0(search->Path,newmax);
+            AJCSET0(search->Compass,newmax);
+        }
+
+        ajDebug("Calling embAlignPathCalcSWFast "
+                "%d..%d [%d/%d] %d..%d [%d/%d] width:%d\n",
+                querystart, queryend, (queryend - querystart + 1),
+                ajSeqGetLen(queryseq),
+                targetstart, targetend, (targetend - targetstart + 1),
+                ajSeqGetLen(targetseq),
+                search->Width);
+
+        result->Score = embAlignPathCalcSWFast(&targetseqc[targetstart],
+                                               &queryseqc[querystart],
+                                               targetend-targetstart+1,
+                                               queryend-querystart+1,
+                                               0,search->Width,
+                                               search->Gapopen,
+                                               search->Gapextend,
+                                               search->Path,search->Sub,
+                                               search->Cvt,
+                                               search->Compass,show);
+        if(result->Score>search->Minscore)
+        {
+            embAlignWalkSWMatrixFast(search->Path,search->Compass,
+                                     search->Gapopen,search->Gapextend,
+                                     targetseq,queryseq,
+                                     &result->Targetaln,&result->Queryaln,
+                                     targetend-targetstart+1,
+                                     queryend-querystart+1,
+                                     0,search->Width,
+                                     &targetstart,&querystart);
+
+            result->Reported = ajTrue;
+            result->Querystart = querystart;
+            result->Targetstart = targetstart;
+        }
+
+        embWordMatchListDelete(&search->Matchlist[k]);
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic supermatcher_write *********************************************
+**
+** Write the alignments of a query sequence with each target sequence
+**
+** @param [r] search [const SupermatcherPSearch] Target words and results
+** @param [r] queryseq [const AjPSeq] Query sequence
+** @param [u] align [AjPAlign] Alignment output
+** @param [u] errorf [AjPFile] Error file
+** @param [u] matrix [AjPMatrixf] Substitution matrix
+** @return [void]
+** @@
+******************************************************************************/
+
+static void supermatcher_write(const SupermatcherPSearch search,
+                               const AjPSeq queryseq,
+                               AjPAlign align, AjPFile errorf,
+                               AjPMatrixf matrix)
+{
+    const AjPSeq targetseq;
+    const SupermatcherPResult result;
+    ajuint k;
+
+    for(k=0;k<search->Ntargets;k++)
+    {
+        targetseq = ajSeqsetGetseqSeq(search->Targetseqs, k);
+        result = &search->Results[k];
+
+        if(!result->Seeded)
+        {
+            ajFmtPrintF(errorf,
+                        "No wordmatch start points for "
+                        "%s vs %s. No alignment\n",
+                        ajSeqGetNameC(queryseq),ajSeqGetNameC(targetseq));
+            continue;
+        }
+
+        if(!result->Reported)
+            continue;
+
+        if(!ajAlignFormatShowsSequences(align))
+        {
+            ajAlignDefineCC(align, ajStrGetPtr(result->Targetaln),
+                            ajStrGetPtr(result->Queryaln),
+                            ajSeqGetNameC(targetseq),
+                            ajSeqGetNameC(queryseq));
+            ajAlignSetScoreR(align, result->Score);
+        }
+        else
+        {
+            ajDebug(" queryaln:%S \ntargetaln:%S\n",
+                    result->Queryaln,result->Targetaln);
+            embAlignReportLocal(align,
+                                queryseq, targetseq,
+                                result->Queryaln, result->Targetaln,
+                                result->Querystart, result->Targetstart,
+                                search->Gapopen, search->Gapextend,
+                                result->Score, matrix,
+                                1 + ajSeqGetOffset(queryseq),
+                                1 + ajSeqGetOffset(targetseq)
+                );
+        }
+        ajAlignWrite(align);
+        ajAlignReset(align);
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic supermatcher_batch *********************************************
+**
+** Align a batch of query sequences in worker processes, each taking
+** every Nth query and spooling its results to a temporary file.
+** The alignments are then written in query order.
+**
+** The workers are processes rather than threads because the word searches
+** add to the match counts stored with each word in the shared target word
+** index or Rabin-Karp table. Forked workers each update their own copy
+** without locking. supermatcher does not report the counts.
+**
+** The spool files are anonymous temporary files, in the system temporary
+** directory, so nothing is left behind if a worker or the parent dies.
+**
+** @param [u] search [SupermatcherPSearch] Target words and results
+** @param [r] batch [AjPSeq const *] Query sequences, deleted on return
+** @param [r] nbatch [ajuint] Number of query sequences
+** @param [r] threads [ajuint] Number of worker processes
+** @param [u] align [AjPAlign] Alignment output
+** @param [u] errorf [AjPFile] Error file
+** @param [u] matrix [AjPMatrixf] Substitution matrix
+** @return [void]
+** @@
+******************************************************************************/
+
+static void supermatcher_batch(SupermatcherPSearch search,
+                               AjPSeq const *batch, ajuint nbatch,
+                               ajuint threads,
+                               AjPAlign align, AjPFile errorf,
+                               AjPMatrixf matrix)
+{
+    AjPFile* spools = NULL;
+    FILE* spoolfp = NULL;
+    AjPSeq queryseq = NULL;
+    ajuint nworkers;
+    ajuint i;
+    ajuint j;
+#ifndef WIN32
+    pid_t* pids = NULL;
+    pid_t retval;
+    int status = 0;
+#endif /* !WIN32 */
+
+    nworkers = threads;
+
+    if(nworkers > nbatch)
+        nworkers = nbatch;
+
+    AJCNEW0(spools, nworkers);
+
+    for(i=0; i < nworkers; i++)
+    {
+        if(!(spoolfp = tmpfile()))
+            ajFatal("Cannot open temporary file: %s", strerror(errno));
+
+        spools[i] = ajFileNewFromCfile(spoolfp);
+    }
+
+#ifndef WIN32
+    AJCNEW0(pids, nworkers);
+
+    /* the workers must not write out buffers inherited from the parent */
+    fflush(NULL);
+
+    for(i=0; i < nworkers; i++)
+    {
+        pids[i] = fork();
+
+        if(pids[i] == -1)
+            ajFatal("System fork failed");
+
+        if(pids[i])
+            continue;
+
+        /* worker process: spool every nworkers-th query from i */
+
+        for(j=i; j < nbatch; j += nworkers)
+        {
+            supermatcher_search(search, batch[j]);
+            supermatcher_spoolwrite(spools[i], search);
+        }
+
+        ajFileClose(&spools[i]);
+
+        _exit(EXIT_SUCCESS);
+    }
+
+    for(i=0; i < nworkers; i++)
+    {
+        while((retval=waitpid(pids[i], &status, 0)) != pids[i])
+        {
+            if(retval == -1)
+                if(errno != EINTR)
+                    break;
+        }
+
+        if(retval == -1 || !WIFEXITED(status) || WEXITSTATUS(status))
+            ajDie("Worker process %u failed", i + 1);
+    }
+
+    AJFREE(pids);
+#else
+    ajFatal("Worker processes are not supported in this build");
+#endif /* !WIN32 */
+
+    /* the workers have written through the shared file offsets */
+    for(i=0; i < nworkers; i++)
+        if(ajFileSeek(spools[i], 0L, SEEK_SET))
+            ajFatal("Cannot rewind temporary file: %s", strerror(errno));
+
+    for(j=0; j < nbatch; j++)
+    {
+        supermatcher_spoolread(spools[j % nworkers], search);
+        supermatcher_write(search, batch[j], align, errorf, matrix);
+
+        queryseq = batch[j];
+        ajSeqDel(&queryseq);
+    }
+
+    for(i=0; i < nworkers; i++)
+        ajFileClose(&spools[i]);
+
+    AJFREE(spools);
+
+    return;
+}
+
+
+
+
+/* @funcstatic supermatcher_spoolwrite ****************************************
+**
+** Write the results for one query sequence to a worker's spool file
+**
+** @param [u] spool [AjPFile] Spool file
+** @param [r] search [const SupermatcherPSearch] Target words and results
+** @return [void]
+** @@
+******************************************************************************/
+
+static void supermatcher_spoolwrite(AjPFile spool,
+                                    const SupermatcherPSearch search)
+{
+    const SupermatcherPResult result;
+    ajuint k;
+
+    for(k=0;k<search->Ntargets;k++)
+    {
+        result = &search->Results[k];
+
+        ajWritebinInt4(spool, result->Seeded);
+        ajWritebinInt4(spool, result->Reported);
+
+        if(!result->Reported)
+            continue;
+
+        ajWritebinBinary(spool, 1, sizeof(result->Score), &result->Score);
+        ajWritebinInt4(spool, result->Querystart);
+        ajWritebinInt4(spool, result->Targetstart);
+        ajWritebinUint4(spool, ajStrGetLen(result->Queryaln));
+        ajWritebinStr(spool, result->Queryaln, ajStrGetLen(result->Queryaln));
+        ajWritebinUint4(spool, ajStrGetLen(result->Targetaln));
+        ajWritebinStr(spool, result->Targetaln,
+                      ajStrGetLen(result->Targetaln));
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic supermatcher_spoolread *****************************************
+**
+** Read the results for one query sequence from a worker's spool file
+**
+** @param [u] spool [AjPFile] Spool file
+** @param [r] search [const SupermatcherPSearch] Target words and results
+** @return [void]
+** @@
+******************************************************************************/
+
+static void supermatcher_spoolread(AjPFile spool,
+                                   const SupermatcherPSearch search)
+{
+    SupermatcherPResult result;
+    ajuint len;
+    ajuint k;
+
+    for(k=0;k<search->Ntargets;k++)
+    {
+        result = &search->Results[k];
+
+        if(!ajReadbinInt4(spool, &result->Seeded) ||
+           !ajReadbinInt4(spool, &result->Reported))
+            ajFatal("Unexpected end of temporary file %F", spool);
+
+        if(!result->Reported)
+            continue;
+
+        ajReadbinBinary(spool, 1, sizeof(result->Score), &result->Score);
+        ajReadbinInt4(spool, &result->Querystart);
+        ajReadbinInt4(spool, &result->Targetstart);
+        ajReadbinUint4(spool, &len);
+        ajReadbinStr(spool, len, &result->Queryaln);
+        ajReadbinUint4(spool, &len);
+        ajReadbinStr(spool, len, &result->Targetaln);
+    }
+
+    return;
+}
+
+
+
+
 /* @funcstatic supermatcher_findendpoints ***********************************
 **
 ** Calculate end points for banded Smith-Waterman alignment.
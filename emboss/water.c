@@ -113,22 +113,6 @@ int main(int argc, char **argv)
 	ajSeqTrim(b);
 	lenb = ajSeqGetLen(b);
 
-	if(lenb > (LONG_MAX/(size_t)(lena+1)))
-            ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
-
-	len = (size_t)lena*(size_t)lenb;
-
-	if(len>maxarr)
-	{
-	    AJCRESIZETRY0(path,maxarr,len);
-	    if(!path)
-		ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
-	    AJCRESIZETRY0(compass,maxarr,len);
-	    if(!compass)
-		ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
-	    maxarr=len;
-	}
-
 	beginb=ajSeqGetBegin(b)+ajSeqGetOffset(b);
 
 	p = ajSeqGetSeqC(a);
@@ -137,14 +121,40 @@ int main(int argc, char **argv)
 	ajStrAssignC(&m,"");
 	ajStrAssignC(&n,"");
 
-	score = embAlignPathCalcSW(p,q,lena,lenb,gapopen,gapextend,path,sub,cvt,
-			   compass,show);
+	if(!show && lena > 1 && lenb > 1 &&
+	   (size_t)lena*(size_t)lenb > embAlignLinearGetCells())
+	{
+	    /* too big for the full matrices: use linear memory */
+	    score = embAlignLinearCalcSW(p,q,lena,lenb,gapopen,gapextend,
+					 sub,cvt,&m,&n,&start1,&start2);
+	}
+	else
+	{
+	    if(lenb > (LONG_MAX/(size_t)(lena+1)))
+		ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
+
+	    len = (size_t)lena*(size_t)lenb;
 
-	/*score=embAlignScoreSWMatrix(path,compass,gapopen,gapextend,a,b,lena,
-          lenb,sub,cvt,&start1,&start2);*/
+	    if(len>maxarr)
+	    {
+		AJCRESIZETRY0(path,maxarr,len);
+		if(!path)
+		    ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
+		AJCRESIZETRY0(compass,maxarr,len);
+		if(!compass)
+		    ajDie("Sequences too big. Try 'matcher' or 'supermatcher'");
+		maxarr=len;
+	    }
 
-	embAlignWalkSWMatrix(path,compass,gapopen,gapextend,a,b,&m,&n,
-			     lena,lenb,&start1,&start2);
+	    score = embAlignPathCalcSW(p,q,lena,lenb,gapopen,gapextend,path,
+				       sub,cvt,compass,show);
+
+	    /*score=embAlignScoreSWMatrix(path,compass,gapopen,gapextend,a,b,
+              lena,lenb,sub,cvt,&start1,&start2);*/
+
+	    embAlignWalkSWMatrix(path,compass,gapopen,gapextend,a,b,&m,&n,
+				 lena,lenb,&start1,&start2);
+	}
 
 	ajDebug("ReportLocal call start1:%d begina:%d start2:%d beginb:%d\n",
 		start1, begina, start2, beginb);
@@ -47,6 +47,9 @@ int main(int argc, char **argv)
     const AjPSeq targetseq;
     ajint wordlen;
     AjPTable wordsTable = NULL;
+    EmbPWordIndex wordsIndex = NULL;
+    EmbPWordSuffix wordsSuffix = NULL;
+    AjPStr word = NULL;
     AjPList* matchlist = NULL;
     AjPFile logfile;
     AjPFeattable* seqsetftables = NULL;
@@ -58,18 +61,20 @@ int main(int argc, char **argv)
     ajint targetstart;
     ajint querystart;
     ajint len;
-    ajuint i, j;
+    ajuint i, j, k;
     ajulong nAllMatches = 0;
     ajulong sumAllScore = 0;
     AjBool dumpAlign = ajTrue;
     AjBool dumpFeature = ajTrue;
     AjBool checkmode = ajFalse;
+    AjBool suffixarray = ajFalse;
     EmbPWordRK* wordsw = NULL;
     ajuint npatterns = 0;
     ajuint seqsetsize;
     ajuint nmatches;
     ajuint* nmatchesseqset;
     ajuint* lastlocation; /* Cursors for Rabin-Karp search. */
+    ajuint* wordorder = NULL;
                           /* Shows until what point the query sequence was
                            *  scanned for a pattern sequences in the seqset.
                           */
@@ -88,6 +93,7 @@ int main(int argc, char **argv)
     logfile = ajAcdGetOutfile("logfile");
     dumpAlign = ajAcdGetToggle("dumpalign");
     dumpFeature = ajAcdGetToggle("dumpfeat");
+    suffixarray = ajAcdGetBoolean("suffixarray");
 
     if(dumpAlign)
     {
@@ -118,18 +124,36 @@ int main(int argc, char **argv)
             seqsetsize);
     ajFmtPrintF(logfile, "Pattern/word length: %u\n", wordlen);
 
-    for(i=0;i<seqsetsize;i++)
+    /*
+    ** suffix array if requested, else packed index if the words fit,
+    ** else the word table
+    */
+    if(suffixarray)
+        wordsSuffix = embWordSuffixNewSeqset(seqset);
+
+    if(!wordsSuffix)
+        wordsIndex = embWordIndexNewSeqset(seqset);
+
+    if(!wordsSuffix && !wordsIndex)
     {
-        targetseq = ajSeqsetGetseqSeq(seqset, i);
-        embWordGetTable(&wordsTable, targetseq);
+        for(i=0;i<seqsetsize;i++)
+        {
+            targetseq = ajSeqsetGetseqSeq(seqset, i);
+            embWordGetTable(&wordsTable, targetseq);
+        }
     }
 
     AJCNEW0(lastlocation, seqsetsize);
 
-    if(ajTableGetLength(wordsTable)>0)
+    if(wordsSuffix || wordsIndex || ajTableGetLength(wordsTable)>0)
     {
-        npatterns = embWordRabinKarpInit(wordsTable,
-                                       &wordsw, wordlen, seqset);
+        if(wordsSuffix)
+            npatterns = wordsSuffix->Nwords;
+        else if(wordsIndex)
+            npatterns = wordsIndex->Nwords;
+        else
+            npatterns = embWordRabinKarpInit(wordsTable,
+                                             &wordsw, wordlen, seqset);
         ajFmtPrintF(logfile, "Number of patterns/words found: %u\n", npatterns);
 
         while(ajSeqallNext(seqall,&queryseq))
@@ -142,7 +166,16 @@ int main(int argc, char **argv)
                     matchlist[i] = ajListstrNew();
             }
 
-            nmatches = embWordRabinKarpSearch(
+            if(wordsSuffix)
+                nmatches = embWordSuffixSearch(
+                    wordsSuffix, ajSeqGetSeqS(queryseq),
+                    matchlist, lastlocation, checkmode);
+            else if(wordsIndex)
+                nmatches = embWordIndexSearch(
+                    wordsIndex, ajSeqGetSeqS(queryseq),
+                    matchlist, lastlocation, checkmode);
+            else
+                nmatches = embWordRabinKarpSearch(
                     ajSeqGetSeqS(queryseq), seqset,
                     (EmbPWordRK const *)wordsw, wordlen, npatterns,
                     matchlist, lastlocation, checkmode);
@@ -201,13 +234,32 @@ int main(int argc, char **argv)
         }
 
         /* search completed, now report statistics */
-        for(i=0;i<npatterns;i++)
+        if(wordsSuffix)
+        {
+            for(i=0;i<npatterns;i++)
+                sumAllScore += wordsSuffix->Lenmatches[i];
+
+            for(i=0;i<seqsetsize;i++)
+                nmatchesseqset[i] = wordsSuffix->Seqmatches[i];
+        }
+        else if(wordsIndex)
+        {
+            for(i=0;i<npatterns;i++)
+                sumAllScore += wordsIndex->Lenmatches[i];
+
+            for(i=0;i<seqsetsize;i++)
+                nmatchesseqset[i] = wordsIndex->Seqmatches[i];
+        }
+        else
         {
-            sumAllScore += wordsw[i]->lenMatches;
+            for(i=0;i<npatterns;i++)
+            {
+                sumAllScore += wordsw[i]->lenMatches;
 
-            for(j=0;j<wordsw[i]->nseqs;j++)
-        	nmatchesseqset[wordsw[i]->seqindxs[j]] +=
-        		wordsw[i]->nSeqMatches[j];
+                for(j=0;j<wordsw[i]->nseqs;j++)
+                    nmatchesseqset[wordsw[i]->seqindxs[j]] +=
+                        wordsw[i]->nSeqMatches[j];
+            }
         }
 
         ajFmtPrintF(logfile, "Number of sequences in the file scanned "
@@ -244,17 +296,53 @@ int main(int argc, char **argv)
             paddedheader = ajFmtString(header,padding);
             ajFmtPrintF(logfile, paddedheader);
 
+            /* report words in the order of the word table search */
+            if(wordsSuffix)
+                embWordSuffixGetOrder(wordsSuffix, &wordorder);
+            else if(wordsIndex)
+                embWordIndexGetOrder(wordsIndex, &wordorder);
+
             for(i=0;i<npatterns;i++)
-        	if (wordsw[i]->nMatches>0)
+            {
+                if(wordsSuffix)
+                {
+                    k = wordorder[i];
+
+                    if(wordsSuffix->Nmatches[k]>0)
+                    {
+                        embWordSuffixGetWord(wordsSuffix, k, &word);
+                        ajFmtPrintF(logfile, "%-7S: %12u  %12u %17.2f\n",
+                                    word, wordsSuffix->Wordseqs[k],
+                                    wordsSuffix->Nmatches[k],
+                                    wordsSuffix->Lenmatches[k]*1.0/
+                                    wordsSuffix->Nmatches[k]);
+                    }
+                }
+                else if(wordsIndex)
+                {
+                    k = wordorder[i];
+
+                    if(wordsIndex->Nmatches[k]>0)
+                    {
+                        embWordIndexGetWord(wordsIndex, k, &word);
+                        ajFmtPrintF(logfile, "%-7S: %12u  %12u %17.2f\n",
+                                    word, wordsIndex->Wordseqs[k],
+                                    wordsIndex->Nmatches[k],
+                                    wordsIndex->Lenmatches[k]*1.0/
+                                    wordsIndex->Nmatches[k]);
+                    }
+                }
+        	else if (wordsw[i]->nMatches>0)
         	    ajFmtPrintF(logfile, "%-7s: %12u  %12u %17.2f\n",
         	                wordsw[i]->word->fword, wordsw[i]->nseqs,
         	                wordsw[i]->nMatches,
         	                wordsw[i]->lenMatches*1.0/wordsw[i]->nMatches);
+            }
         }
 
     }
 
-    for(i=0;i<npatterns;i++)
+    for(i=0;wordsw && i<npatterns;i++)
     {
         for(j=0;j<wordsw[i]->nseqs;j++)
             AJFREE(wordsw[i]->locs[j]);
@@ -267,8 +355,12 @@ int main(int argc, char **argv)
     }
 
     embWordFreeTable(&wordsTable);
+    embWordIndexDel(&wordsIndex);
+    embWordSuffixDel(&wordsSuffix);
+    ajStrDel(&word);
 
     AJFREE(wordsw);
+    AJFREE(wordorder);
     AJFREE(matchlist);
     AJFREE(lastlocation);
     AJFREE(nmatchesseqset);
@@ -33,6 +33,7 @@
 #include "ajfile.h"
 #include "ajutil.h"
 #include "ajbase.h"
+#include "ajnam.h"
 
 #include <string.h>
 #include <limits.h>
@@ -51,6 +52,299 @@
 
 
 
+/*
+** Vectorised Smith-Waterman scoring uses GCC/clang generic vectors of
+** four doubles. The kernel must reproduce the scalar arithmetic exactly,
+** so it is only built where floating point is evaluated at its declared
+** precision (not on x87).
+*/
+
+#if defined(__GNUC__) && (__GNUC__ >= 9 || defined(__clang__)) && \
+    defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+#define ALIGN_SWVEC 1
+#if defined(__x86_64__) || defined(__i386__)
+#define ALIGN_SWVEC_AVX2 1
+#endif
+#endif
+
+#define ALIGN_SWLANES 4
+#define ALIGN_SWTILE 32
+
+
+
+
+#ifdef ALIGN_SWVEC
+
+typedef double AlignVd __attribute__((vector_size(ALIGN_SWLANES*8)));
+typedef long long AlignVl __attribute__((vector_size(ALIGN_SWLANES*8)));
+typedef float AlignVf __attribute__((vector_size(ALIGN_SWLANES*4)));
+
+
+
+
+/* @datastatic AlignPSWBand ***************************************************
+**
+** Checkpoints saved by the vectorised Smith-Waterman score pass, used to
+** recompute exactly the tiles of the path and compass matrices visited by
+** the traceback.
+**
+** Row checkpoints are every ALIGN_SWTILE rows, column checkpoints are at
+** the end of every ALIGN_SWTILE segments of each lane of the striped
+** query profile, and at the end of each lane.
+**
+** @alias AlignSSWBand
+** @alias AlignOSWBand
+**
+** @attr A [const char*] First sequence
+** @attr B [const char*] Second sequence
+** @attr Sub [float* const*] Substitution matrix from AjPMatrixf
+** @attr Cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @attr Path [float*] Path matrix
+** @attr Compass [ajint*] Path direction pointer array
+** @attr Rowh [float*] Path scores at checkpoint rows
+** @attr Rowf [double*] Vertical gap scores at checkpoint rows
+** @attr Colh [float*] Path scores at checkpoint columns
+** @attr Cole [double*] Horizontal gap scores at checkpoint columns
+** @attr Colslot [ajint*] Column checkpoint slot for each segment or -1
+** @attr Tiledone [AjBool*] Tiles already recomputed
+** @attr Rowbest [float*] Maximum path value in each row
+** @attr Gapopen [float] Gap opening penalty
+** @attr Gapextend [float] Gap extension penalty
+** @attr Lena [ajint] Length of first sequence
+** @attr Lenb [ajint] Length of second sequence
+** @attr Seglen [ajint] Striped segment length
+** @attr Ncolcp [ajint] Number of column checkpoints per lane
+** @attr Ntilecol [ajint] Number of tiles per lane
+** @attr Padding [char[4]] Padding to alignment boundary
+** @@
+******************************************************************************/
+
+typedef struct AlignSSWBand
+{
+    const char *A;
+    const char *B;
+    float * const *Sub;
+    const AjPSeqCvt Cvt;
+    float *Path;
+    ajint *Compass;
+    float *Rowh;
+    double *Rowf;
+    float *Colh;
+    double *Cole;
+    ajint *Colslot;
+    AjBool *Tiledone;
+    float *Rowbest;
+    float Gapopen;
+    float Gapextend;
+    ajint Lena;
+    ajint Lenb;
+    ajint Seglen;
+    ajint Ncolcp;
+    ajint Ntilecol;
+    char Padding[4];
+} AlignOSWBand;
+
+#define AlignPSWBand AlignOSWBand*
+
+#endif /* ALIGN_SWVEC */
+
+
+
+
+/*
+** Above this number of cells needle and water switch to the linear-memory
+** alignment functions. Overridden by the EMBOSS_ALIGNLINEAR variable.
+*/
+
+#define ALIGN_LINEARCELLS 100000000
+#define ALIGN_LINEARNONE (-DBL_MAX)
+
+
+
+
+/*
+** Cells outside the band of a banded Needleman-Wunsch alignment, and the
+** position of cell (ypos,xpos) in the banded path matrices
+*/
+
+#define ALIGN_NWBANDNONE (-FLT_MAX)
+#define ALIGN_NWBANDIDX(band,ypos,xpos)                                  \
+    ((size_t)(ypos) * (size_t)(band)->Rowlen +                           \
+     (size_t)((xpos) - (ypos) - (band)->Dlo + 1))
+
+
+
+
+/* @datastatic AlignPLinear ***************************************************
+**
+** Workspace for linear-memory (Myers-Miller) alignment.
+**
+** Scores are kept for two rows at a time. Column -1 and row -1 of a global
+** alignment hold the leading end gaps, with the top left corner as the
+** start of every path.
+**
+** @alias AlignSLinear
+** @alias AlignOLinear
+**
+** @attr A [const char*] First sequence
+** @attr B [const char*] Second sequence
+** @attr Sub [float* const*] Substitution matrix from AjPMatrixf
+** @attr Acode [ajint*] Matrix codes for the first sequence
+** @attr Bcode [ajint*] Matrix codes for the second sequence
+** @attr Fprev [double*] Forward scores for the previous row
+** @attr Fcur [double*] Forward scores for the current row
+** @attr Bnext [double*] Backward scores for the next row
+** @attr Bcur [double*] Backward scores for the current row
+** @attr M [AjPStr*] Alignment for first sequence
+** @attr N [AjPStr*] Alignment for second sequence
+** @attr Gapopen [double] Gap opening penalty
+** @attr Gapextend [double] Gap extension penalty
+** @attr Endgapopen [double] End gap opening penalty
+** @attr Endgapextend [double] End gap extension penalty
+** @attr Lena [ajint] Length of first sequence
+** @attr Lenb [ajint] Length of second sequence
+** @attr Global [AjBool] Needleman-Wunsch end gap rules if true,
+**                       Smith-Waterman gaps if false
+** @attr Padding [char[4]] Padding to alignment boundary
+** @@
+******************************************************************************/
+
+typedef struct AlignSLinear
+{
+    const char *A;
+    const char *B;
+    float * const *Sub;
+    ajint *Acode;
+    ajint *Bcode;
+    double *Fprev;
+    double *Fcur;
+    double *Bnext;
+    double *Bcur;
+    AjPStr *M;
+    AjPStr *N;
+    double Gapopen;
+    double Gapextend;
+    double Endgapopen;
+    double Endgapextend;
+    ajint Lena;
+    ajint Lenb;
+    AjBool Global;
+    char Padding[4];
+} AlignOLinear;
+
+#define AlignPLinear AlignOLinear*
+
+
+
+
+/* @datastatic AlignPNWBand ***************************************************
+**
+** Path matrices for banded Needleman-Wunsch alignment.
+**
+** Row ypos holds the cells with xpos-ypos from Dlo to Dhi, with an extra
+** unreachable cell at each end so the neighbours of the edge cells can
+** be read without testing.
+**
+** @alias AlignSNWBand
+** @alias AlignONWBand
+**
+** @attr Sub [float* const*] Substitution matrix from AjPMatrixf
+** @attr Acode [ajint*] Matrix codes for the first sequence
+** @attr Bcode [ajint*] Matrix codes for the second sequence
+** @attr M [float*] Match scores
+** @attr Ix [float*] Scores ending with a gap in the first sequence
+** @attr Iy [float*] Scores ending with a gap in the second sequence
+** @attr Size [size_t] Allocated cells in M, Ix and Iy
+** @attr Gapopen [float] Gap opening penalty
+** @attr Gapextend [float] Gap extension penalty
+** @attr Endgapopen [float] End gap opening penalty
+** @attr Endgapextend [float] End gap extension penalty
+** @attr Lena [ajint] Length of first sequence
+** @attr Lenb [ajint] Length of second sequence
+** @attr Dlo [ajint] Lowest diagonal in the band
+** @attr Dhi [ajint] Highest diagonal in the band
+** @attr Rowlen [ajint] Cells stored for each row
+** @@
+******************************************************************************/
+
+typedef struct AlignSNWBand
+{
+    float * const *Sub;
+    ajint *Acode;
+    ajint *Bcode;
+    float *M;
+    float *Ix;
+    float *Iy;
+    size_t Size;
+    float Gapopen;
+    float Gapextend;
+    float Endgapopen;
+    float Endgapextend;
+    ajint Lena;
+    ajint Lenb;
+    ajint Dlo;
+    ajint Dhi;
+    ajint Rowlen;
+} AlignONWBand;
+
+#define AlignPNWBand AlignONWBand*
+
+
+
+
+static void alignPathCalcSWEdges(const char *a, const char *b,
+                                 ajint lena, ajint lenb,
+                                 float gapopen, float gapextend,
+                                 float *path, float * const *sub,
+                                 const AjPSeqCvt cvt, ajint *compass);
+
+#ifdef ALIGN_SWVEC
+static AjBool alignPathCalcSWBand(const char *a, const char *b,
+                                  ajint lena, ajint lenb,
+                                  float gapopen, float gapextend,
+                                  float *path, float * const *sub,
+                                  const AjPSeqCvt cvt, ajint *compass,
+                                  float *score);
+static float alignSWBandScore(AlignPSWBand band, float *best);
+static inline float alignSWBandScoreVec(AlignPSWBand band, float *best)
+    __attribute__((always_inline));
+static float alignSWBandScoreDefault(AlignPSWBand band, float *best);
+#ifdef ALIGN_SWVEC_AVX2
+static float alignSWBandScoreAvx2(AlignPSWBand band, float *best)
+    __attribute__((target("avx2")));
+#endif
+static void alignSWBandEnsure(AlignPSWBand band, ajlong ypos, ajlong xpos);
+static void alignSWBandStart(AlignPSWBand band, float best,
+                             ajlong *Pxpos, ajlong *Pypos);
+static void alignSWBandTile(AlignPSWBand band, ajint r, ajint k, ajint t);
+static void alignSWBandWalk(AlignPSWBand band, ajlong xpos, ajlong ypos);
+#endif
+
+static AlignPLinear alignLinearNew(const char *a, const char *b,
+                                   ajint lena, ajint lenb,
+                                   float * const *sub, const AjPSeqCvt cvt,
+                                   AjPStr *m, AjPStr *n);
+static void alignLinearDel(AlignPLinear *Plin);
+static double alignLinearGapX(const AlignPLinear lin, ajint i, ajint j,
+                              ajint s);
+static double alignLinearGapY(const AlignPLinear lin, ajint i, ajint j,
+                              ajint s);
+static void alignLinearForward(AlignPLinear lin,
+                               ajint ui, ajint uj, ajint us,
+                               ajint mid, ajint vj);
+static void alignLinearBackward(AlignPLinear lin,
+                                ajint vi, ajint vj, ajint vs,
+                                ajint mid, ajint uj);
+static void alignLinearSolve(AlignPLinear lin,
+                             ajint ui, ajint uj, ajint us,
+                             ajint vi, ajint vj, ajint vs);
+static void alignLinearEmit(AlignPLinear lin, ajint i, ajint j, ajint s);
+
+static float alignNWBandFill(AlignPNWBand band, ajint dlo, ajint dhi);
+static void alignNWBandWalk(const AlignPNWBand band,
+                            const char *a, const char *b,
+                            AjPStr *m, AjPStr *n);
+
 static void printPathMatrix(const float* path, const ajint* compass,
 	const char *a, const char *b, ajuint lena, ajuint lenb);
 
@@ -559,6 +853,14 @@ float embAlignPathCalcWithEndGapPenalties(const char *a, const char *b,
 ** @@
 ** Optimised to keep a maximum value to avoid looping down or left
 ** to find the maximum. (il 29/07/99)
+**
+** Where the compiler supports it, a vectorised score-only pass finds the
+** maximum and the path and compass values are then recomputed only for
+** the tiles that embAlignWalkSWMatrix visits: every row that could hold
+** its start cell and the tiles along the traceback. All other path cells
+** are left as zero and their compass values are not set, so the matrices
+** are only for embAlignWalkSWMatrix. Scores and alignments are identical
+** to the full matrix. Setting show uses the full matrix.
 ******************************************************************************/
 
 float embAlignPathCalcSW(const char *a, const char *b, ajint lena, ajint lenb,
@@ -584,6 +886,13 @@ float embAlignPathCalcSW(const char *a, const char *b, ajint lena, ajint lenb,
 
     ajDebug("embAlignPathCalcSW\n");
 
+#ifdef ALIGN_SWVEC
+    if(!show && lena > 1 && lenb > ALIGN_SWLANES &&
+       alignPathCalcSWBand(a, b, lena, lenb, gapopen, gapextend,
+                           path, sub, cvt, compass, &ret))
+        return ret;
+#endif
+
     ret= -FLT_MAX;
 
     /* Create stores for the maximum values in a row or column */
@@ -592,58 +901,12 @@ float embAlignPathCalcSW(const char *a, const char *b, ajint lena, ajint lenb,
 
 
     /* First initialise the first column and row */
-    for(i=0;i<lena;++i)
-    {
-	result = sub[ajSeqcvtGetCodeK(cvt,a[i])][ajSeqcvtGetCodeK(cvt,b[0])];
-
-	fnew = i==0 ? 0. :
-		path[(i-1)*lenb] -(compass[(i-1)*lenb]==DOWN ?
-			gapextend : gapopen);
-
-	if (result > fnew && result>0)
-	{
-	  path[i*lenb] = (float) result;
-	    compass[i*lenb] = 0;
-	}
-	else if (fnew>0)
-	{
-	  path[i*lenb] = (float) fnew;
-	    compass[i*lenb] = DOWN;
-	}
-	else
-	{
-	    path[i*lenb] = 0.;
-	    compass[i*lenb] = 0;
-	}
+    alignPathCalcSWEdges(a, b, lena, lenb, gapopen, gapextend,
+                         path, sub, cvt, compass);
 
+    for(i=0;i<lena;++i)
 	maxa[i] = i==0 ? path[i*lenb]-gapopen :
 	path[i*lenb] - (compass[(i-1)*lenb]==DOWN ? gapextend : gapopen);
-    }
-
-    for(j=0;j<lenb;++j)
-    {
-	result = sub[ajSeqcvtGetCodeK(cvt,a[0])][ajSeqcvtGetCodeK(cvt,b[j])];
-
-	fnew = j==0 ? 0. :
-		path[j-1] -(compass[j-1]==LEFT ? gapextend : gapopen);
-
-	if (result > fnew && result > 0)
-	{
-	  path[j] = (float) result;
-	    compass[j] = 0;
-	}
-	else if (fnew >0)
-	{
-	  path[j] = (float) fnew;
-	    compass[j] = LEFT;
-	}
-	else
-	{
-	    path[j] = 0.;
-	    compass[j] = 0;
-	}
-
-    }
 
 
     /* xpos and ypos are the diagonal steps so start at 1 */
@@ -756,417 +1019,3087 @@ float embAlignPathCalcSW(const char *a, const char *b, ajint lena, ajint lenb,
 
 
 
-/* @func embAlignWalkSWMatrix *************************************************
+/* @funcstatic alignPathCalcSWEdges *******************************************
 **
-** Walk down a matrix for Smith Waterman. Form aligned strings.
-** Nucleotides or proteins as needed.
+** Initialise the first column and row of a Smith-Waterman path matrix
 **
-** @param [r] path [const float*] path matrix
-** @param [r] compass [const ajint*] Path direction pointer array
-** @param [r] gapopen [float] gap opening penalty
-** @param [r] gapextend [float] gap extension penalty
-** @param [r] a [const AjPSeq] first sequence
-** @param [r] b [const AjPSeq] second sequence
-** @param [w] m [AjPStr *] alignment for first sequence
-** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
 ** @param [r] lena [ajint] length of first sequence
 ** @param [r] lenb [ajint] length of second sequence
-** @param [w] start1 [ajint *] start of alignment in first sequence
-** @param [w] start2 [ajint *] start of alignment in second sequence
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [w] path [float *] path matrix
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [w] compass [ajint *] Path direction pointer array
 **
 ** @return [void]
 **
-** @release 1.0.0
+** @release 6.6.0
 ******************************************************************************/
 
-void embAlignWalkSWMatrix(const float *path, const ajint *compass,
-			  float gapopen, float gapextend,
-                          const AjPSeq a, const AjPSeq b,
-			  AjPStr *m, AjPStr *n,
-                          ajint lena, ajint lenb,
-			  ajint *start1, ajint *start2)
+static void alignPathCalcSWEdges(const char *a, const char *b,
+                                 ajint lena, ajint lenb,
+                                 float gapopen, float gapextend,
+                                 float *path, float * const *sub,
+                                 const AjPSeqCvt cvt, ajint *compass)
 {
     ajlong i;
     ajlong j;
-    ajlong k;
-    ajlong gapcnt;
-    double pmax;
-    double score;
-    double bimble;
-
-    ajlong ix;
-    ajlong iy;
-
-    ajlong xpos = 0;
-    ajlong ypos = 0;
-    const char *p;
-    const char *q;
-
-    ajint ic;
-    double errbounds;
-
-    ajDebug("embAlignWalkSWMatrix\n");
 
-    /* errbounds = gapextend; */
-    errbounds = (double) 0.01;
-
-    /* Get maximum path score and save position */
-    pmax = -FLT_MAX;
-    k = (ajlong)lena*(ajlong)lenb-1;
+    double result;
+    double fnew;
 
-    for(i=lena-1; i>=0; --i)
-	for(j=lenb-1; j>=0; --j)
-	    if((path[k--] > pmax) || E_FPEQ(path[k+1],pmax,U_FEPS))
-	    {
-		pmax = path[k+1];
-		xpos = j;
-		ypos = i;
-	    }
+    for(i=0;i<lena;++i)
+    {
+	result = sub[ajSeqcvtGetCodeK(cvt,a[i])][ajSeqcvtGetCodeK(cvt,b[0])];
 
-    ajStrAssignClear(m);
-    ajStrAssignClear(n);
+	fnew = i==0 ? 0. :
+		path[(i-1)*lenb] -(compass[(i-1)*lenb]==DOWN ?
+			gapextend : gapopen);
 
-    p = ajSeqGetSeqC(a);
-    q = ajSeqGetSeqC(b);
+	if (result > fnew && result>0)
+	{
+	  path[i*lenb] = (float) result;
+	    compass[i*lenb] = 0;
+	}
+	else if (fnew>0)
+	{
+	  path[i*lenb] = (float) fnew;
+	    compass[i*lenb] = DOWN;
+	}
+	else
+	{
+	    path[i*lenb] = 0.;
+	    compass[i*lenb] = 0;
+	}
+    }
 
-    while(xpos>=0 && ypos>=0)
+    for(j=0;j<lenb;++j)
     {
-	if(!compass[ypos*lenb+xpos])	/* diagonal */
-	{
-	    ajStrAppendK(m,p[ypos--]);
-	    ajStrAppendK(n,q[xpos--]);
+	result = sub[ajSeqcvtGetCodeK(cvt,a[0])][ajSeqcvtGetCodeK(cvt,b[j])];
 
-	    if(ypos >= 0 && xpos>=0 && path[(ypos)*lenb+xpos]<=0.)
-		break;
+	fnew = j==0 ? 0. :
+		path[j-1] -(compass[j-1]==LEFT ? gapextend : gapopen);
 
-	    continue;
+	if (result > fnew && result > 0)
+	{
+	  path[j] = (float) result;
+	    compass[j] = 0;
 	}
-	else if(compass[ypos*lenb+xpos]==LEFT) /* Left, gap(s) in vertical */
+	else if (fnew >0)
 	{
-	    score  = path[ypos*lenb+xpos];
-	    gapcnt = 0;
-	    ix     = xpos-1;
+	  path[j] = (float) fnew;
+	    compass[j] = LEFT;
+	}
+	else
+	{
+	    path[j] = 0.;
+	    compass[j] = 0;
+	}
 
-	    while(1)
-	    {
-		bimble = path[ypos*lenb+ix]-gapopen-(gapcnt*gapextend);
+    }
 
-		if(!ix || fabs((double)score-(double)bimble)<errbounds)
-		    break;
+    return;
+}
 
-		--ix;
-		++gapcnt;
-	    }
 
-	    if(bimble<=0.0)
-		break;
 
-	    for(ic=0;ic<=gapcnt;++ic)
-	    {
-		ajStrAppendK(m,'.');
-		ajStrAppendK(n,q[xpos--]);
-	    }
 
-	    continue;
-	}
-	else if(compass[ypos*lenb+xpos]==DOWN) /* Down, gap(s) in horizontal */
-	{
-	    score  = path[ypos*lenb+xpos];
-	    gapcnt = 0;
-	    iy = ypos-1;
+#ifdef ALIGN_SWVEC
+
+/* @funcstatic alignPathCalcSWBand ********************************************
+**
+** Smith-Waterman path matrix using a vectorised score-only pass, then
+** recomputing only the tiles needed for the traceback by
+** embAlignWalkSWMatrix.
+**
+** Path cells outside those tiles are set to zero, so the maximum found by
+** embAlignWalkSWMatrix is the same cell as for the full matrix.
+**
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [w] path [float *] path matrix
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [w] compass [ajint *] Path direction pointer array
+** @param [w] score [float*] Maximum score
+**
+** @return [AjBool] True on success. False if there is no positive score
+**                  and the full matrix is needed.
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool alignPathCalcSWBand(const char *a, const char *b,
+                                  ajint lena, ajint lenb,
+                                  float gapopen, float gapextend,
+                                  float *path, float * const *sub,
+                                  const AjPSeqCvt cvt, ajint *compass,
+                                  float *score)
+{
+    AlignOSWBand band;
+    ajint n;
+    ajint j;
+    ajint nrowcp;
+    ajlong xpos = 0;
+    ajlong ypos = 0;
+    float best = 0.;
+    AjBool ret = ajFalse;
+
+    n = lenb - 1;
+
+    band.A         = a;
+    band.B         = b;
+    band.Sub       = sub;
+    band.Cvt       = cvt;
+    band.Path      = path;
+    band.Compass   = compass;
+    band.Gapopen   = gapopen;
+    band.Gapextend = gapextend;
+    band.Lena      = lena;
+    band.Lenb      = lenb;
+    band.Seglen    = (n + ALIGN_SWLANES - 1) / ALIGN_SWLANES;
+    band.Ntilecol  = (band.Seglen + ALIGN_SWTILE - 1) / ALIGN_SWTILE;
+    band.Ncolcp    = 0;
+
+    AJCNEW(band.Colslot, band.Seglen);
+
+    for(j=0; j < band.Seglen; j++)
+    {
+        if(j % ALIGN_SWTILE == ALIGN_SWTILE - 1 || j == band.Seglen - 1)
+            band.Colslot[j] = band.Ncolcp++;
+        else
+            band.Colslot[j] = -1;
+    }
+
+    nrowcp = (lena - 1) / ALIGN_SWTILE + 1;
+
+    AJCNEW(band.Rowh, (size_t) nrowcp * lenb);
+    AJCNEW(band.Rowf, (size_t) nrowcp * lenb);
+    AJCNEW(band.Colh, (size_t) lena * band.Ncolcp * ALIGN_SWLANES);
+    AJCNEW(band.Cole, (size_t) lena * band.Ncolcp * ALIGN_SWLANES);
+    AJCNEW0(band.Tiledone, (size_t) ((lena - 2) / ALIGN_SWTILE + 1) *
+            ALIGN_SWLANES * band.Ntilecol);
+    AJCNEW(band.Rowbest, lena);
+
+    AJCSET0(path, (size_t) lena * lenb);
+
+    alignPathCalcSWEdges(a, b, lena, lenb, gapopen, gapextend,
+                         path, sub, cvt, compass);
+
+    *score = alignSWBandScore(&band, &best);
+
+    if(best > 0.)
+    {
+        alignSWBandStart(&band, best, &xpos, &ypos);
+        alignSWBandWalk(&band, xpos, ypos);
+        ret = ajTrue;
+    }
+
+    AJFREE(band.Colslot);
+    AJFREE(band.Rowh);
+    AJFREE(band.Rowf);
+    AJFREE(band.Colh);
+    AJFREE(band.Cole);
+    AJFREE(band.Tiledone);
+    AJFREE(band.Rowbest);
+
+    return ret;
+}
+
+
+
+
+/*
+** Vector operations for the score pass. Maximum and minimum are written
+** as comparisons so the result is exactly one of the operands, as in the
+** scalar code.
+*/
+
+#define ALIGN_VMAX(x,y)                                                  \
+    ((AlignVd) (((AlignVl) (x) & ((x) > (y))) |                          \
+                ((AlignVl) (y) & ~((x) > (y)))))
+#define ALIGN_VMIN(x,y)                                                  \
+    ((AlignVd) (((AlignVl) (x) & ((x) < (y))) |                          \
+                ((AlignVl) (y) & ~((x) < (y)))))
+#define ALIGN_VROUND(x)                                                  \
+    __builtin_convertvector(__builtin_convertvector((x), AlignVf), AlignVd)
+#define ALIGN_VSHIFT(x,fill)                                             \
+    ((AlignVd) {(fill), (x)[0], (x)[1], (x)[2]})
+#define ALIGN_VALIGN(p)                                                  \
+    ((AlignVd*) (((size_t) (p) + sizeof(AlignVd) - 1) &                 \
+                 ~(sizeof(AlignVd) - 1)))
+
+
+
+
+/* @funcstatic alignSWBandScoreVec ********************************************
+**
+** Striped (Farrar) score-only Smith-Waterman pass over the interior of the
+** path matrix, with the second sequence as the striped query.
+**
+** The arithmetic is the same as embAlignPathCalcSW, in double precision
+** with path values rounded to float, so the scores are identical.
+** Path and gap scores are saved at checkpoint rows and columns for
+** alignSWBandTile.
+**
+** The first row and column must already be in the path matrix.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [w] best [float*] Maximum path value
+**
+** @return [float] Maximum score
+**
+** @release 6.6.0
+******************************************************************************/
+
+static inline float alignSWBandScoreVec(AlignPSWBand band, float *best)
+{
+    const char *a = band->A;
+    const char *b = band->B;
+    const float *path = band->Path;
+    const ajint *compass = band->Compass;
+    float gapopen = band->Gapopen;
+    float gapextend = band->Gapextend;
+    ajint lena = band->Lena;
+    ajint lenb = band->Lenb;
+    ajint seglen = band->Seglen;
+    ajint n = lenb - 1;
+
+    void *rowstore;
+    void *profstore[256];
+    AlignVd *prof[256];
+    AlignVd *vp;
+    AlignVd *hprev;
+    AlignVd *hcur;
+    AlignVd *hswap;
+    AlignVd *fcur;
+    AlignVd *ecur;
+    AlignVd *cap;
+
+    AlignVd vzero = {0.0, 0.0, 0.0, 0.0};
+    AlignVd vmin;
+    AlignVd vopen;
+    AlignVd vext;
+    AlignVd vdiag;
+    AlignVd vhleft;
+    AlignVd ve;
+    AlignVd vf;
+    AlignVd v;
+    AlignVd vrow;
+    AlignVd vmiss;
+    AlignVd vtmp;
+    AlignVl vmask;
+
+    float *rowh;
+    double *rowf;
+    float *colh;
+    double *cole;
+
+    double retv = -DBL_MAX;
+    double rowpre;
+    float rowbest;
+    ajlong i;
+    ajlong cursor;
+    ajint j;
+    ajint k;
+    ajint p;
+    ajint s;
+    ajint code;
+
+    vmin  = vzero - DBL_MAX;
+    vopen = vzero + gapopen;
+    vext  = vzero + gapextend;
+
+    for(code=0; code < 256; code++)
+        prof[code] = NULL;
+
+    rowstore = AJALLOC((5 * (size_t) seglen + 1) * sizeof(AlignVd));
+    hprev = ALIGN_VALIGN(rowstore);
+    hcur  = hprev + seglen;
+    fcur  = hcur + seglen;
+    ecur  = fcur + seglen;
+    cap   = ecur + seglen;
+
+    /* Row 0 and its vertical gap scores, as set up in embAlignPathCalcSW */
+
+    for(j=0; j < seglen; j++)
+        for(k=0; k < ALIGN_SWLANES; k++)
+        {
+            p = j + k * seglen;
+
+            if(p < n)
+            {
+                hprev[j][k] = path[p+1];
+                fcur[j][k] = path[p+1]-gapopen-gapextend;
+                cap[j][k] = DBL_MAX;
+            }
+            else
+            {
+                hprev[j][k] = 0.;
+                fcur[j][k] = -DBL_MAX;
+                cap[j][k] = -DBL_MAX;
+            }
+        }
+
+    band->Rowh[0] = path[0];
+    band->Rowf[0] = 0.;
+
+    *best = path[0];
+
+    for(p=1; p < lenb; p++)
+    {
+        band->Rowh[p] = path[p];
+        band->Rowf[p] = path[p]-gapopen-gapextend;
+
+        if(path[p] > *best)
+            *best = path[p];
+    }
+
+    band->Rowbest[0] = *best;
+
+    for(i=1; i < lena; i++)
+    {
+        code = ajSeqcvtGetCodeK(band->Cvt, a[i]) & 0xff;
+
+        if(!prof[code])
+        {
+            profstore[code] = AJALLOC((size_t) (seglen + 1) *
+                                      sizeof(AlignVd));
+            prof[code] = ALIGN_VALIGN(profstore[code]);
+
+            for(j=0; j < seglen; j++)
+                for(k=0; k < ALIGN_SWLANES; k++)
+                {
+                    p = j + k * seglen;
+                    prof[code][j][k] = (p < n) ?
+                        band->Sub[code][ajSeqcvtGetCodeK(band->Cvt, b[p+1])] :
+                        0.;
+                }
+        }
+
+        vp = prof[code];
+        cursor = i * lenb;
+
+        /* diagonal of the first segment: shift the last segment of the
+        ** previous row along one lane, column 0 into lane 0 */
+
+        vtmp = hprev[seglen-1];
+        vdiag = ALIGN_VSHIFT(vtmp, path[cursor-lenb]);
+
+        /* horizontal gap starts from column 0 in lane 0 only */
+
+        ve = vmin;
+        ve[0] = path[cursor] - (compass[cursor-lenb]==DOWN ?
+                                gapextend : gapopen);
+        vhleft = vmin;
+        vhleft[0] = path[cursor];
+        vrow = vmin;
+
+        for(j=0; j < seglen; j++)
+        {
+            ve = ALIGN_VMAX(ve - vext, vhleft - vopen);
+            vf = ALIGN_VMAX(fcur[j] - vext, hprev[j] - vopen);
+            v = vdiag + vp[j];
+            v = ALIGN_VMAX(v, ve);
+            v = ALIGN_VMAX(v, vf);
+
+            vrow = ALIGN_VMAX(vrow, ALIGN_VMIN(v, cap[j]));
+            v = ALIGN_VROUND(v);
+            v = ALIGN_VMAX(v, vzero);
+
+            vdiag = hprev[j];
+            hcur[j] = v;
+            ecur[j] = ve;
+            fcur[j] = vf;
+            vhleft = v;
+        }
+
+        /* Lazy horizontal gap correction across lanes */
+
+        vtmp = ALIGN_VMAX(ve - vext, vhleft - vopen);
+        vmiss = ALIGN_VSHIFT(vtmp, -DBL_MAX);
+        j = 0;
+
+        for(;;)
+        {
+            vmask = vmiss > ecur[j];
+
+            for(k=0; k < ALIGN_SWLANES; k++)
+                if(vmask[k])
+                    break;
+
+            if(k == ALIGN_SWLANES)
+                break;
+
+            ecur[j] = ALIGN_VMAX(ecur[j], vmiss);
+            vrow = ALIGN_VMAX(vrow, ALIGN_VMIN(vmiss, cap[j]));
+            v = ALIGN_VROUND(vmiss);
+            hcur[j] = ALIGN_VMAX(hcur[j], v);
+            vmiss = ALIGN_VMAX(vmiss - vext, hcur[j] - vopen);
+
+            if(++j == seglen)
+            {
+                j = 0;
+                vtmp = vmiss;
+                vmiss = ALIGN_VSHIFT(vtmp, -DBL_MAX);
+            }
+        }
+
+        /* Row maximum: the score is taken before clearing negative cells,
+        ** the traceback starts from the highest path value */
+
+        rowpre = vrow[0];
+
+        for(k=1; k < ALIGN_SWLANES; k++)
+            if(vrow[k] > rowpre)
+                rowpre = vrow[k];
+
+        if(rowpre > retv)
+            retv = rowpre;
+
+        rowbest = (float) rowpre;
+
+        if(rowbest < 0.)
+            rowbest = 0.;
+
+        if(path[cursor] > rowbest)
+            rowbest = path[cursor];
+
+        band->Rowbest[i] = rowbest;
+
+        if(rowbest > *best)
+            *best = rowbest;
+
+        /* Checkpoints */
+
+        if(!(i % ALIGN_SWTILE))
+        {
+            rowh = band->Rowh + (i / ALIGN_SWTILE) * lenb;
+            rowf = band->Rowf + (i / ALIGN_SWTILE) * lenb;
+            rowh[0] = path[cursor];
+            rowf[0] = 0.;
+
+            for(j=0; j < seglen; j++)
+                for(k=0; k < ALIGN_SWLANES; k++)
+                {
+                    p = j + k * seglen;
+
+                    if(p < n)
+                    {
+                        rowh[p+1] = (float) hcur[j][k];
+                        rowf[p+1] = fcur[j][k];
+                    }
+                }
+        }
+
+        colh = band->Colh + i * band->Ncolcp * ALIGN_SWLANES;
+        cole = band->Cole + i * band->Ncolcp * ALIGN_SWLANES;
+        s = 0;
+
+        for(j=ALIGN_SWTILE-1; ; j += ALIGN_SWTILE)
+        {
+            if(j >= seglen)
+                j = seglen - 1;
+
+            for(k=0; k < ALIGN_SWLANES; k++)
+            {
+                colh[s*ALIGN_SWLANES + k] = (float) hcur[j][k];
+                cole[s*ALIGN_SWLANES + k] = ecur[j][k];
+            }
+
+            ++s;
+
+            if(j == seglen - 1)
+                break;
+        }
+
+        hswap = hprev;
+        hprev = hcur;
+        hcur  = hswap;
+    }
+
+    for(code=0; code < 256; code++)
+        if(prof[code])
+            AJFREE(profstore[code]);
+
+    AJFREE(rowstore);
+
+    return (float) retv;
+}
+
+
+
+
+/* @funcstatic alignSWBandScore ***********************************************
+**
+** Score-only Smith-Waterman pass, choosing the widest vector unit
+** available at run time.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [w] best [float*] Maximum path value
+**
+** @return [float] Maximum score, as returned by embAlignPathCalcSW
+**
+** @release 6.6.0
+******************************************************************************/
+
+static float alignSWBandScore(AlignPSWBand band, float *best)
+{
+#ifdef ALIGN_SWVEC_AVX2
+    if(__builtin_cpu_supports("avx2"))
+        return alignSWBandScoreAvx2(band, best);
+#endif
+
+    return alignSWBandScoreDefault(band, best);
+}
+
+
+
+
+/* @funcstatic alignSWBandScoreDefault ****************************************
+**
+** Score-only Smith-Waterman pass for the default instruction set (SSE2 on
+** x86_64)
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [w] best [float*] Maximum path value
+**
+** @return [float] Maximum score
+**
+** @release 6.6.0
+******************************************************************************/
+
+static float alignSWBandScoreDefault(AlignPSWBand band, float *best)
+{
+    return alignSWBandScoreVec(band, best);
+}
+
+
+
+
+#ifdef ALIGN_SWVEC_AVX2
+
+/* @funcstatic alignSWBandScoreAvx2 *******************************************
+**
+** Score-only Smith-Waterman pass for AVX2
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [w] best [float*] Maximum path value
+**
+** @return [float] Maximum score
+**
+** @release 6.6.0
+******************************************************************************/
+
+static float alignSWBandScoreAvx2(AlignPSWBand band, float *best)
+{
+    return alignSWBandScoreVec(band, best);
+}
+
+#endif
+
+
+
+
+/* @funcstatic alignSWBandEnsure **********************************************
+**
+** Make sure the path and compass values for a cell are available,
+** recomputing its tile if needed.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [r] ypos [ajlong] Row (first sequence position)
+** @param [r] xpos [ajlong] Column (second sequence position)
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignSWBandEnsure(AlignPSWBand band, ajlong ypos, ajlong xpos)
+{
+    ajint r;
+    ajint k;
+    ajint t;
+
+    /* the first row and column are always set */
+    if(ypos < 1 || xpos < 1)
+        return;
+
+    r = (ajint) ((ypos - 1) / ALIGN_SWTILE);
+    k = (ajint) ((xpos - 1) / band->Seglen);
+    t = (ajint) (((xpos - 1) % band->Seglen) / ALIGN_SWTILE);
+
+    if(!band->Tiledone[(r * ALIGN_SWLANES + k) * band->Ntilecol + t])
+        alignSWBandTile(band, r, k, t);
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignSWBandStart ***********************************************
+**
+** Find the cell where embAlignWalkSWMatrix starts its traceback, with the
+** same scan and the same U_FEPS tolerance, recomputing only the rows whose
+** maximum could pass its test.
+**
+** The scan runs from the last cell back to the first. Cells after the
+** last cell holding the maximum are never kept, so the scan starts in its
+** row.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [r] best [float] Maximum path value
+** @param [w] Pxpos [ajlong*] Column of the start cell
+** @param [w] Pypos [ajlong*] Row of the start cell
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignSWBandStart(AlignPSWBand band, float best,
+                             ajlong *Pxpos, ajlong *Pypos)
+{
+    const float *path = band->Path;
+    ajlong lenb = band->Lenb;
+    ajlong cursor;
+    ajlong i;
+    ajlong j;
+    double pmax = -FLT_MAX;
+    float rowbest;
+    AjBool found = ajFalse;
+
+    for(i=band->Lena-1; i>=0; --i)
+    {
+        rowbest = band->Rowbest[i];
+
+        if(!found)
+        {
+            if(rowbest != best)
+                continue;
+
+            found = ajTrue;
+        }
+        else if(!(rowbest > pmax || E_FPEQ(rowbest,pmax,U_FEPS)))
+            continue;
+
+        cursor = i*lenb;
+
+        for(j=lenb-1; j>=0; --j)
+        {
+            alignSWBandEnsure(band, i, j);
+
+            if((path[cursor+j] > pmax) || E_FPEQ(path[cursor+j],pmax,U_FEPS))
+            {
+                pmax = path[cursor+j];
+                *Pxpos = j;
+                *Pypos = i;
+            }
+        }
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignSWBandTile ************************************************
+**
+** Recompute the path and compass values for one tile from the nearest row
+** and column checkpoints, with exactly the arithmetic of
+** embAlignPathCalcSW.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [r] r [ajint] Tile row
+** @param [r] k [ajint] Striped lane
+** @param [r] t [ajint] Tile number within the lane
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignSWBandTile(AlignPSWBand band, ajint r, ajint k, ajint t)
+{
+    float *path = band->Path;
+    ajint *compass = band->Compass;
+    float gapopen = band->Gapopen;
+    float gapextend = band->Gapextend;
+    ajlong lenb = band->Lenb;
+    ajint seglen = band->Seglen;
+    const float *rowh;
+    const double *rowf;
+
+    double bx[ALIGN_SWTILE];
+    double match;
+    double mscore;
+    double fnew;
+    double maxa;
+    float hdiag;
+    float hup;
+    float hleft;
+    float hleftprev = 0.;
+
+    ajlong y0;
+    ajlong y1;
+    ajlong x0;
+    ajlong x1;
+    ajlong xpos;
+    ajlong ypos;
+    ajlong cursor;
+    ajlong cp;
+    ajint pl;
+    ajint acode;
+
+    band->Tiledone[(r * ALIGN_SWLANES + k) * band->Ntilecol + t] = ajTrue;
+
+    y0 = (ajlong) r * ALIGN_SWTILE + 1;
+    y1 = y0 + ALIGN_SWTILE - 1;
+
+    if(y1 > band->Lena - 1)
+        y1 = band->Lena - 1;
+
+    x0 = (ajlong) k * seglen + (ajlong) t * ALIGN_SWTILE + 1;
+    x1 = (ajlong) k * seglen + ((t + 1) * ALIGN_SWTILE < seglen ?
+                                (t + 1) * ALIGN_SWTILE : seglen);
+
+    if(x1 > lenb - 1)
+        x1 = lenb - 1;
+
+    rowh = band->Rowh + (ajlong) r * lenb;
+    rowf = band->Rowf + (ajlong) r * lenb;
+
+    for(xpos=x0; xpos <= x1; xpos++)
+        bx[xpos-x0] = rowf[xpos];
+
+    for(ypos=y0; ypos <= y1; ypos++)
+    {
+        cursor = ypos * lenb;
+        acode = ajSeqcvtGetCodeK(band->Cvt, band->A[ypos]);
+
+        /* path and horizontal gap scores in the column to the left */
+
+        if(x0 == 1)
+        {
+            hleft = path[cursor];
+            maxa = path[cursor] - (compass[cursor-lenb]==DOWN ?
+                                   gapextend : gapopen);
+        }
+        else
+        {
+            pl = (ajint) (x0 - 2);
+            cp = ((ajlong) ypos * band->Ncolcp +
+                  band->Colslot[pl % seglen]) * ALIGN_SWLANES + pl / seglen;
+            hleft = band->Colh[cp];
+            maxa = band->Cole[cp];
+        }
+
+        for(xpos=x0; xpos <= x1; xpos++)
+        {
+            if(ypos == y0)
+            {
+                hdiag = rowh[xpos-1];
+                hup = rowh[xpos];
+            }
+            else
+            {
+                hdiag = (xpos == x0) ? hleftprev : path[cursor-lenb+xpos-1];
+                hup = path[cursor-lenb+xpos];
+            }
+
+            match = band->Sub[acode][ajSeqcvtGetCodeK(band->Cvt,
+                                                      band->B[xpos])];
+
+            mscore = hdiag + match;
+            compass[cursor+xpos] = 0;
+            path[cursor+xpos] = (float) mscore;
+
+            maxa -= gapextend;
+            fnew = (xpos == x0) ? hleft : path[cursor+xpos-1];
+            fnew -= gapopen;
+
+            if(fnew > maxa)
+                maxa = fnew;
+
+            if(maxa > mscore)
+            {
+                mscore = maxa;
+                path[cursor+xpos] = (float) mscore;
+                compass[cursor+xpos] = LEFT;
+            }
+
+            bx[xpos-x0] -= gapextend;
+            fnew = hup;
+            fnew -= gapopen;
+
+            if(fnew > bx[xpos-x0])
+                bx[xpos-x0] = fnew;
+
+            if(bx[xpos-x0] > mscore)
+            {
+                mscore = bx[xpos-x0];
+                path[cursor+xpos] = (float) mscore;
+                compass[cursor+xpos] = DOWN;
+            }
+
+            if(path[cursor+xpos] < 0.)
+                path[cursor+xpos] = 0.;
+        }
+
+        hleftprev = hleft;
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignSWBandWalk ************************************************
+**
+** Follow the traceback of embAlignWalkSWMatrix from the maximum cell,
+** recomputing each tile it visits.
+**
+** @param [u] band [AlignPSWBand] Checkpoint store
+** @param [r] xpos [ajlong] Column of the maximum
+** @param [r] ypos [ajlong] Row of the maximum
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignSWBandWalk(AlignPSWBand band, ajlong xpos, ajlong ypos)
+{
+    const float *path = band->Path;
+    const ajint *compass = band->Compass;
+    float gapopen = band->Gapopen;
+    float gapextend = band->Gapextend;
+    ajlong lenb = band->Lenb;
+    ajlong gapcnt;
+    double score;
+    double bimble = 0.;
+    double errbounds;
+    ajlong ix;
+    ajlong iy;
+
+    errbounds = (double) 0.01;
+
+    while(xpos>=0 && ypos>=0)
+    {
+        alignSWBandEnsure(band, ypos, xpos);
+
+	if(!compass[ypos*lenb+xpos])	/* diagonal */
+	{
+	    ypos--;
+	    xpos--;
+
+	    if(ypos >= 0 && xpos>=0)
+            {
+                alignSWBandEnsure(band, ypos, xpos);
+
+                if(path[(ypos)*lenb+xpos]<=0.)
+                    break;
+            }
+
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==LEFT) /* Left, gap(s) in vertical */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    ix     = xpos-1;
+
+	    while(1)
+	    {
+                alignSWBandEnsure(band, ypos, ix);
+		bimble = path[ypos*lenb+ix]-gapopen-(gapcnt*gapextend);
+
+		if(!ix || fabs((double)score-(double)bimble)<errbounds)
+		    break;
+
+		--ix;
+		++gapcnt;
+	    }
+
+	    if(bimble<=0.0)
+		break;
+
+	    xpos -= gapcnt+1;
+
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==DOWN) /* Down, gap(s) in horizontal */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    iy = ypos-1;
+
+	    while(1)
+	    {
+                alignSWBandEnsure(band, iy, xpos);
+		bimble=path[iy*lenb+xpos]-gapopen-(gapcnt*gapextend);
+
+		if(!iy || fabs((double)score-(double)bimble)<errbounds)
+		    break;
+
+		--iy;
+		++gapcnt;
+	    }
+
+	    if(bimble<=0.0)
+		break;
+
+	    ypos -= gapcnt+1;
+
+	    continue;
+	}
+	else
+	    break;
+    }
+
+    return;
+}
+
+#endif /* ALIGN_SWVEC */
+
+
+
+
+/* @func embAlignWalkSWMatrix *************************************************
+**
+** Walk down a matrix for Smith Waterman. Form aligned strings.
+** Nucleotides or proteins as needed.
+**
+** @param [r] path [const float*] path matrix
+** @param [r] compass [const ajint*] Path direction pointer array
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [r] a [const AjPSeq] first sequence
+** @param [r] b [const AjPSeq] second sequence
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+**
+** @return [void]
+**
+** @release 1.0.0
+******************************************************************************/
+
+void embAlignWalkSWMatrix(const float *path, const ajint *compass,
+			  float gapopen, float gapextend,
+                          const AjPSeq a, const AjPSeq b,
+			  AjPStr *m, AjPStr *n,
+                          ajint lena, ajint lenb,
+			  ajint *start1, ajint *start2)
+{
+    ajlong i;
+    ajlong j;
+    ajlong k;
+    ajlong gapcnt;
+    double pmax;
+    double score;
+    double bimble;
+
+    ajlong ix;
+    ajlong iy;
+
+    ajlong xpos = 0;
+    ajlong ypos = 0;
+    const char *p;
+    const char *q;
+
+    ajint ic;
+    double errbounds;
+
+    ajDebug("embAlignWalkSWMatrix\n");
+
+    /* errbounds = gapextend; */
+    errbounds = (double) 0.01;
+
+    /* Get maximum path score and save position */
+    pmax = -FLT_MAX;
+    k = (ajlong)lena*(ajlong)lenb-1;
+
+    for(i=lena-1; i>=0; --i)
+	for(j=lenb-1; j>=0; --j)
+	    if((path[k--] > pmax) || E_FPEQ(path[k+1],pmax,U_FEPS))
+	    {
+		pmax = path[k+1];
+		xpos = j;
+		ypos = i;
+	    }
+
+    ajStrAssignClear(m);
+    ajStrAssignClear(n);
+
+    p = ajSeqGetSeqC(a);
+    q = ajSeqGetSeqC(b);
+
+    while(xpos>=0 && ypos>=0)
+    {
+	if(!compass[ypos*lenb+xpos])	/* diagonal */
+	{
+	    ajStrAppendK(m,p[ypos--]);
+	    ajStrAppendK(n,q[xpos--]);
+
+	    if(ypos >= 0 && xpos>=0 && path[(ypos)*lenb+xpos]<=0.)
+		break;
+
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==LEFT) /* Left, gap(s) in vertical */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    ix     = xpos-1;
+
+	    while(1)
+	    {
+		bimble = path[ypos*lenb+ix]-gapopen-(gapcnt*gapextend);
+
+		if(!ix || fabs((double)score-(double)bimble)<errbounds)
+		    break;
+
+		--ix;
+		++gapcnt;
+	    }
+
+	    if(bimble<=0.0)
+		break;
+
+	    for(ic=0;ic<=gapcnt;++ic)
+	    {
+		ajStrAppendK(m,'.');
+		ajStrAppendK(n,q[xpos--]);
+	    }
+
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==DOWN) /* Down, gap(s) in horizontal */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    iy = ypos-1;
+
+	    while(1)
+	    {
+		bimble=path[iy*lenb+xpos]-gapopen-(gapcnt*gapextend);
+
+		if(!iy || fabs((double)score-(double)bimble)<errbounds)
+		    break;
+
+		--iy;
+
+		if(iy<0)
+		    ajFatal("SW: Error walking down");
+
+		++gapcnt;
+	    }
+
+	    if(bimble<=0.0)
+		break;
+
+	    for(ic=0;ic<=gapcnt;++ic)
+	    {
+		ajStrAppendK(m,p[ypos--]);
+		ajStrAppendK(n,'.');
+	    }
+	    continue;
+	}
+	else
+	    ajFatal("Walk Error in SW");
+    }
+
+    *start1 = (ajint) (ypos + 1); /* Potential lossy cast */
+    *start2 = (ajint) (xpos + 1); /* Potential lossy cast */
+
+    ajStrReverse(m);            /* written with append, need to reverse */
+    ajStrReverse(n);
+
+    ajDebug("embAlignWalkSWMatrix done\n");
+
+    return;
+}
+
+
+
+
+/* @func embAlignWalkNWMatrix *************************************************
+**
+** Walk down a matrix for Needleman Wunsch. Form aligned strings.
+** Nucleotides or proteins as needed.
+**
+** @param [r] path [const float*] path matrix
+** @param [r] a [const AjPSeq] first sequence
+** @param [r] b [const AjPSeq] second sequence
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+** @param [r] gapopen [float] gap open penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [r] compass [const ajint*] Path direction pointer array
+**
+** @return [void]
+**
+** @release 1.0.0
+******************************************************************************/
+
+void embAlignWalkNWMatrix(const float *path, const AjPSeq a, const AjPSeq b,
+			  AjPStr *m,
+			  AjPStr *n, ajint lena, ajint lenb, ajint *start1,
+			  ajint *start2, float gapopen,
+			  float gapextend,
+			  const ajint *compass)
+{
+    ajint i;
+    ajint j;
+    ajint gapcnt;
+    double pmax;
+    double score;
+    double bimble;
+
+    ajint ix;
+    ajint iy;
+
+    ajint xpos = 0;
+    ajint ypos = 0;
+    const char *p;
+    const char *q;
+
+    ajint ic;
+    double errbounds;
+
+    ajDebug("embAlignWalkNWMatrix\n");
+
+    /*errbounds=gapextend;*/
+    errbounds = (double) 0.01;
+
+    /* Get maximum path axis score and save position */
+    pmax = (double) (-1*INT_MAX);
+
+    for(i=0;i<lenb;++i)
+	if(path[(lena-1)*lenb+i]>=pmax)
+	{
+	    pmax = path[(lena-1)*lenb+i];
+	    xpos = i;
+	    ypos = lena-1;
+	}
+
+    for(j=0;j<lena;++j)
+	if(path[j*lenb+lenb-1]>pmax)
+	{
+	    pmax = path[j*lenb+lenb-1];
+	    xpos = lenb-1;
+	    ypos = j;
+	}
+
+    ajStrAssignClear(m);
+    ajStrAssignClear(n);
+
+    p = ajSeqGetSeqC(a);
+    q = ajSeqGetSeqC(b);
+
+    while(xpos>=0 && ypos>=0)
+    {
+	if(!compass[ypos*lenb+xpos])	/* diagonal */
+	{
+	    ajStrAppendK(m,p[ypos--]);
+	    ajStrAppendK(n,q[xpos--]);
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==LEFT) /* Left, gap(s) in vertical */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    ix     = xpos-1;
+
+	    while(1)
+	    {
+		bimble = path[ypos*lenb+ix]-gapopen-(gapcnt*gapextend);
+
+		if(!ix || fabs((double)score-(double)bimble)< errbounds)
+		    break;
+
+		--ix;
+		++gapcnt;
+	    }
+
+	    for(ic=0;ic<=gapcnt;++ic)
+	    {
+		ajStrAppendK(m,'.');
+		ajStrAppendK(n,q[xpos--]);
+	    }
+	    continue;
+	}
+	else if(compass[ypos*lenb+xpos]==DOWN) /* Down, gap(s) in horizontal */
+	{
+	    score  = path[ypos*lenb+xpos];
+	    gapcnt = 0;
+	    iy = ypos-1;
 
 	    while(1)
 	    {
-		bimble=path[iy*lenb+xpos]-gapopen-(gapcnt*gapextend);
+		bimble = path[iy*lenb+xpos]-gapopen-(gapcnt*gapextend);
+
+		if(!iy || fabs((double)score-(double)bimble)< errbounds)
+		    break;
+
+		--iy;
+		++gapcnt;
+	    }
+
+	    for(ic=0;ic<=gapcnt;++ic)
+	    {
+		ajStrAppendK(m,p[ypos--]);
+		ajStrAppendK(n,'.');
+	    }
+
+	    continue;
+	}
+	else
+	    ajFatal("Walk Error in NW");
+
+    }
+
+    *start2 = xpos+1;
+    *start1 = ypos+1;
+
+    ajStrReverse(m);            /* written with append, need to reverse */
+    ajStrReverse(n);
+
+    return;
+}
+
+
+
+
+/* @func embAlignWalkNWMatrixUsingCompass *************************************
+**
+** Walk down a matrix for Needleman Wunsch which was constructed using end gap
+** penalties. Form aligned strings. Nucleotides or proteins as needed.
+**
+** @param [r] p [const char*] first sequence
+** @param [r] q [const char*] second sequence
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] lena [ajuint] length of first sequence
+** @param [r] lenb [ajuint] length of second sequence
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+** @param [r] compass [ajint const *] Path direction pointer array
+**
+** @return [void]
+**
+** @release 6.2.0
+** @@
+**
+******************************************************************************/
+
+void embAlignWalkNWMatrixUsingCompass(const char* p, const char* q,
+                                 AjPStr *m, AjPStr *n,
+                                 ajuint lena, ajuint lenb,
+                                 ajint *start1, ajint *start2,
+                                 ajint const *compass)
+{
+    ajint xpos = *start2;
+    ajint ypos = *start1;
+    ajint i;
+    ajint j;
+    ajuint cursor;
+
+    ajDebug("embAlignWalkNWMatrixUsingCompass\n");
+
+    ajStrAssignClear(m);
+    ajStrAssignClear(n);
+    
+    for (i=lenb-1; i>xpos;)
+    {
+        ajStrAppendK(n, q[i--]);
+        ajStrAppendK(m, '.');
+    }
+
+    for (j=lena-1; j>ypos; )
+    {
+        ajStrAppendK(m, p[j--]);
+        ajStrAppendK(n, '.');
+    }
+
+    while (xpos >= 0 && ypos >= 0)
+    {
+        cursor = ypos * lenb + xpos;
+        if(!compass[cursor]) /* diagonal */
+        {
+            ajStrAppendK(m, p[ypos--]);
+            ajStrAppendK(n, q[xpos--]);
+            continue;
+        }
+        else if(compass[cursor] == LEFT) /* Left, gap(s) in vertical */
+        {
+            ajStrAppendK(m, '.');
+            ajStrAppendK(n, q[xpos--]);
+            continue;
+        }
+        else if(compass[cursor] == DOWN) /* Down, gap(s) in horizontal */
+        {
+            ajStrAppendK(m, p[ypos--]);
+            ajStrAppendK(n, '.');
+
+            continue;
+        } else
+            ajFatal("Walk Error in NW");
+    }
+
+    for (;xpos>=0;xpos--)
+    {
+        ajStrAppendK(n, q[xpos]);
+        ajStrAppendK(m, '.');
+    }
+
+    for (;ypos>=0;ypos--)
+    {
+        ajStrAppendK(m, p[ypos]);
+        ajStrAppendK(n, '.');
+    }
+
+    *start2 = xpos+1;
+    *start1 = ypos+1;
+
+    ajStrReverse(m); /* written with append, need to reverse */
+    ajStrReverse(n);
+
+    ajDebug("first sequence extended with gaps  (m): %S\n", *m);
+    ajDebug("second sequence extended with gaps (n): %S\n", *n);
+    
+    return;
+}
+
+
+
+
+/* @func embAlignLinearGetCells ***********************************************
+**
+** Returns the number of path matrix cells above which applications should
+** use the linear-memory alignment functions embAlignLinearCalcNW and
+** embAlignLinearCalcSW.
+**
+** The default can be changed with the EMBOSS_ALIGNLINEAR variable.
+**
+** @return [size_t] Maximum number of cells for a full path matrix
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+size_t embAlignLinearGetCells(void)
+{
+    static size_t cells = 0;
+    AjPStr value = NULL;
+    ajulong n = 0;
+
+    if(cells)
+        return cells;
+
+    cells = ALIGN_LINEARCELLS;
+
+    if(ajNamGetValueC("alignlinear", &value))
+    {
+        if(ajStrToUlong(value, &n) && n)
+            cells = (size_t) n;
+        else
+            ajErr("Bad value for environment variable 'ALIGNLINEAR'");
+    }
+
+    ajDebug("embAlignLinearGetCells %Lu\n", (ajulong) cells);
+
+    ajStrDel(&value);
+
+    return cells;
+}
+
+
+
+
+/* @func embAlignLinearCalcNW *************************************************
+**
+** Needleman-Wunsch alignment with end gap penalties using memory linear
+** in the sequence lengths.
+**
+** The score is calculated exactly as by embAlignPathCalcWithEndGapPenalties.
+** The alignment is then found by Myers-Miller divide and conquer. It is an
+** optimal alignment with the same score, but where there are several
+** optimal alignments a different one may be reported. Usually this is a
+** gap that could shift past residues of equal score: the compass traceback
+** puts it before them, but here it may come after them.
+**
+** Both sequences must be at least 2 residues long.
+**
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [r] endgapopen [float] end gap opening penalty
+** @param [r] endgapextend [float] end gap extension penalty
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] endweight [AjBool] Use end gap weights
+**
+** @return [float] Score
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+float embAlignLinearCalcNW(const char *a, const char *b,
+                           ajint lena, ajint lenb,
+                           float gapopen, float gapextend,
+                           float endgapopen, float endgapextend,
+                           ajint *start1, ajint *start2,
+                           float * const *sub, const AjPSeqCvt cvt,
+                           AjPStr *m, AjPStr *n,
+                           AjBool endweight)
+{
+    AlignPLinear lin = NULL;
+    float *rows;
+    float *mp;
+    float *ixp;
+    float *iyp;
+    float *mc;
+    float *ixc;
+    float *iyc;
+    float *tmp;
+    float match;
+    float testog;
+    float testeg;
+    float score;
+    ajint i;
+    ajint j;
+    ajint last;
+
+    ajDebug("embAlignLinearCalcNW lena:%d lenb:%d\n", lena, lenb);
+
+    if(lena < 2 || lenb < 2)
+        ajFatal("embAlignLinearCalcNW: sequences must have 2 or more "
+                "residues");
+
+    if(!endweight)
+    {
+	endgapopen=0;
+	endgapextend=0;
+    }
+
+    lin = alignLinearNew(a, b, lena, lenb, sub, cvt, m, n);
+
+    /*
+    ** Score pass. Two rows of the m, ix and iy matrices, computed with
+    ** the same float arithmetic as embAlignPathCalcWithEndGapPenalties
+    */
+
+    rows = AJALLOC(6*(size_t)lenb*sizeof(float));
+    mp  = rows;
+    ixp = rows + lenb;
+    iyp = rows + 2*(size_t)lenb;
+    mc  = rows + 3*(size_t)lenb;
+    ixc = rows + 4*(size_t)lenb;
+    iyc = rows + 5*(size_t)lenb;
+
+    mc[0] = lin->Sub[lin->Acode[0]][lin->Bcode[0]];
+    ixc[0] = -endgapopen-gapopen;
+    iyc[0] = -endgapopen-gapopen;
+
+    for(j = 1; j < lenb; ++j)
+    {
+	match = lin->Sub[lin->Acode[0]][lin->Bcode[j]];
+
+	testog = mc[j-1] - gapopen;
+	testeg = ixc[j-1] - gapextend;
+
+	if(testog >= testeg)
+	    ixc[j] = testog;
+	else
+	    ixc[j] = testeg;
+
+	mc[j] = match - (endgapopen + (j - 1) * endgapextend);
+	iyc[j] = -endgapopen - j * endgapextend - gapopen;
+    }
+
+    iyc[lenb-1] -= endgapopen;
+    iyc[lenb-1] += gapopen;
+
+    for(i = 1; i < lena; ++i)
+    {
+        tmp = mp;
+        mp = mc;
+        mc = tmp;
+        tmp = ixp;
+        ixp = ixc;
+        ixc = tmp;
+        tmp = iyp;
+        iyp = iyc;
+        iyc = tmp;
+
+        last = (i == lena-1);
+
+	match = lin->Sub[lin->Acode[i]][lin->Bcode[0]];
+
+	testog = mp[0] - gapopen;
+	testeg = iyp[0] - gapextend;
+
+	if(testog >= testeg)
+	    iyc[0] = testog;
+	else
+	    iyc[0] = testeg;
+
+	mc[0] = match - (endgapopen + (i - 1) * endgapextend);
+	ixc[0] = -endgapopen - i * endgapextend - gapopen;
+
+        if(last)
+        {
+            ixc[0] -= endgapopen;
+            ixc[0] += gapopen;
+        }
+
+        for(j = 1; j < lenb; ++j)
+        {
+            match = lin->Sub[lin->Acode[i]][lin->Bcode[j]];
+
+            if(mp[j-1] > ixp[j-1] && mp[j-1] > iyp[j-1])
+                mc[j] = mp[j-1]+match;
+            else if(ixp[j-1] > iyp[j-1])
+                mc[j] = ixp[j-1]+match;
+            else
+                mc[j] = iyp[j-1]+match;
+
+            if(j == lenb-1)
+            {
+                testog = mp[j] - endgapopen;
+                testeg = iyp[j] - endgapextend;
+            }
+            else
+            {
+                testog = mp[j];
+
+                if(testog < ixp[j])
+                    testog = ixp[j];
+
+                testog -= gapopen;
+                testeg = iyp[j] - gapextend;
+            }
+
+            if(testog > testeg)
+                iyc[j] = testog;
+            else
+                iyc[j] = testeg;
+
+            if(last)
+            {
+                testog = mc[j-1] - endgapopen;
+                testeg = ixc[j-1] - endgapextend;
+            }
+            else
+            {
+                testog = mc[j-1];
+
+                if(testog < iyc[j-1])
+                    testog = iyc[j-1];
+
+                testog -= gapopen;
+                testeg = ixc[j-1] - gapextend;
+            }
+
+            if(testog > testeg)
+                ixc[j] = testog;
+            else
+                ixc[j] = testeg;
+        }
+    }
+
+    j = lenb-1;
+
+    if(mc[j] > ixc[j] && mc[j] > iyc[j])
+        score = mc[j];
+    else if(ixc[j] > iyc[j])
+        score = ixc[j];
+    else
+        score = iyc[j];
+
+    /* the traceback starts in the state chosen by the compass walk */
+    if(mc[j] >= ixc[j] && mc[j] >= iyc[j])
+        i = DIAG;
+    else if(ixc[j] >= iyc[j])
+        i = LEFT;
+    else
+        i = DOWN;
+
+    AJFREE(rows);
+
+    lin->Global       = ajTrue;
+    lin->Gapopen      = gapopen;
+    lin->Gapextend    = gapextend;
+    lin->Endgapopen   = endgapopen;
+    lin->Endgapextend = endgapextend;
+
+    ajStrAssignClear(m);
+    ajStrAssignClear(n);
+
+    alignLinearSolve(lin, -1, -1, DIAG, lena-1, lenb-1, i);
+
+    alignLinearDel(&lin);
+
+    *start1 = 0;
+    *start2 = 0;
+
+    ajDebug("first sequence extended with gaps  (m): %S\n", *m);
+    ajDebug("second sequence extended with gaps (n): %S\n", *n);
+
+    return score;
+}
+
+
+
+
+/* @func embAlignLinearCalcSW *************************************************
+**
+** Smith-Waterman local alignment using memory linear in the sequence
+** lengths.
+**
+** The score and the end of the alignment are calculated exactly as by
+** embAlignPathCalcSW and embAlignWalkSWMatrix. The start of the alignment
+** is tracked through the score pass, and the path between the two is found
+** by Myers-Miller divide and conquer. Where there are several optimal
+** alignments a different one may be reported. Usually this is a gap that
+** could shift past residues of equal score: the compass traceback puts it
+** before them, but here it may come after them.
+**
+** Both sequences must be at least 2 residues long.
+**
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+**
+** @return [float] Maximum score
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+float embAlignLinearCalcSW(const char *a, const char *b,
+                           ajint lena, ajint lenb,
+                           float gapopen, float gapextend,
+                           float * const *sub, const AjPSeqCvt cvt,
+                           AjPStr *m, AjPStr *n,
+                           ajint *start1, ajint *start2)
+{
+    AlignPLinear lin = NULL;
+    float ret;
+    float *pcol;
+    float *ccol;
+    float *ftmp;
+    ajlong *porig;
+    ajlong *corig;
+    ajlong *ltmp;
+    ajint *ccomp;
+    double *maxa;
+    ajlong *maxaorig;
+
+    ajlong xpos;
+    ajlong ypos;
+    ajlong idx;
+    ajlong orig;
+    ajlong bxorig;
+    ajint comp;
+
+    double match;
+    double mscore;
+    double result;
+    double fnew;
+    double bx;
+    float val;
+
+    float r0val = 0.;
+    ajint r0comp = 0;
+    ajlong r0orig = 0;
+
+    float pmax = -FLT_MAX;
+    ajlong pidx = -1;
+    ajlong porigin = 0;
+    ajint pcomp = 0;
+
+    ajDebug("embAlignLinearCalcSW lena:%d lenb:%d\n", lena, lenb);
+
+    if(lena < 2 || lenb < 2)
+        ajFatal("embAlignLinearCalcSW: sequences must have 2 or more "
+                "residues");
+
+    lin = alignLinearNew(a, b, lena, lenb, sub, cvt, m, n);
+
+    pcol = AJALLOC(lena*sizeof(float));
+    ccol = AJALLOC(lena*sizeof(float));
+    porig = AJALLOC(lena*sizeof(ajlong));
+    corig = AJALLOC(lena*sizeof(ajlong));
+    ccomp = AJALLOC(lena*sizeof(ajint));
+    maxa = AJALLOC(lena*sizeof(double));
+    maxaorig = AJALLOC(lena*sizeof(ajlong));
+
+    ret = -FLT_MAX;
+
+    /*
+    ** Score pass, one column at a time as in embAlignPathCalcSW.
+    ** Each cell also records the cell where its best local alignment
+    ** starts. The end cell is chosen as in embAlignWalkSWMatrix.
+    */
+
+#define ALIGN_LINEARMAX(cellval,cellidx,cellcomp,cellorig)               \
+    if(((cellval) > pmax && !E_FPEQ((cellval),pmax,U_FEPS)) ||          \
+       (E_FPEQ((cellval),pmax,U_FEPS) && (cellidx) < pidx))              \
+    {                                                                   \
+        pmax = (cellval);                                               \
+        pidx = (cellidx);                                               \
+        pcomp = (cellcomp);                                             \
+        porigin = (cellorig);                                           \
+    }
+
+    for(ypos=0; ypos<lena; ++ypos)
+    {
+	result = lin->Sub[lin->Acode[ypos]][lin->Bcode[0]];
+
+	fnew = ypos==0 ? 0. :
+		ccol[ypos-1] -(ccomp[ypos-1]==DOWN ?
+			gapextend : gapopen);
+
+        idx = ypos*(ajlong)lenb;
+
+	if(result > fnew && result>0)
+	{
+            ccol[ypos] = (float) result;
+	    ccomp[ypos] = 0;
+            corig[ypos] = idx;
+	}
+	else if(fnew>0)
+	{
+            ccol[ypos] = (float) fnew;
+	    ccomp[ypos] = DOWN;
+            corig[ypos] = corig[ypos-1];
+	}
+	else
+	{
+	    ccol[ypos] = 0.;
+	    ccomp[ypos] = 0;
+            corig[ypos] = idx;
+	}
+
+        ALIGN_LINEARMAX(ccol[ypos], idx, ccomp[ypos], corig[ypos]);
+    }
+
+    for(ypos=0; ypos<lena; ++ypos)
+    {
+	maxa[ypos] = ypos==0 ? ccol[ypos]-gapopen :
+	ccol[ypos] - (ccomp[ypos-1]==DOWN ? gapextend : gapopen);
+        maxaorig[ypos] = corig[ypos];
+    }
+
+    r0val = ccol[0];
+    r0comp = ccomp[0];
+    r0orig = corig[0];
+
+    for(xpos=1; xpos<lenb; ++xpos)
+    {
+        ftmp = pcol;
+        pcol = ccol;
+        ccol = ftmp;
+        ltmp = porig;
+        porig = corig;
+        corig = ltmp;
+
+        /* first row, as in alignPathCalcSWEdges */
+	result = lin->Sub[lin->Acode[0]][lin->Bcode[xpos]];
+	fnew = r0val -(r0comp==LEFT ? gapextend : gapopen);
+
+	if(result > fnew && result > 0)
+	{
+            r0val = (float) result;
+	    r0comp = 0;
+            r0orig = xpos;
+	}
+	else if(fnew >0)
+	{
+            r0val = (float) fnew;
+	    r0comp = LEFT;
+	}
+	else
+	{
+	    r0val = 0.;
+	    r0comp = 0;
+            r0orig = xpos;
+	}
+
+        ccol[0] = r0val;
+        corig[0] = r0orig;
+
+        ALIGN_LINEARMAX(r0val, xpos, r0comp, r0orig);
+
+	bx = ccol[0]-gapopen-gapextend;
+        bxorig = corig[0];
+
+	for(ypos=1; ypos<lena; ++ypos)
+	{
+	    match = lin->Sub[lin->Acode[ypos]][lin->Bcode[xpos]];
+
+	    mscore = pcol[ypos-1] + match;
+            comp = 0;
+
+            if(pcol[ypos-1] <= 0.)
+                orig = ypos*(ajlong)lenb + xpos;
+            else
+                orig = porig[ypos-1];
+
+            maxa[ypos] -= gapextend;
+            fnew=pcol[ypos];
+            fnew-=gapopen;
+
+            if(fnew > maxa[ypos])
+            {
+                maxa[ypos] = fnew;
+                maxaorig[ypos] = porig[ypos];
+            }
+
+            if(maxa[ypos] > mscore)
+            {
+                mscore = maxa[ypos];
+                comp = LEFT;
+                orig = maxaorig[ypos];
+            }
+
+            bx -= gapextend;
+            fnew = ccol[ypos-1];
+            fnew-=gapopen;
+
+            if(fnew > bx)
+            {
+                bx = fnew;
+                bxorig = corig[ypos-1];
+            }
+
+            if(bx > mscore)
+            {
+                mscore = bx;
+                comp = DOWN;
+                orig = bxorig;
+            }
+
+            if(mscore > ret)
+                ret = (float) mscore;
+
+            val = (float) mscore;
+	    result = val;
+
+	    if(result < 0.)
+		val = 0.;
+
+            ccol[ypos] = val;
+            corig[ypos] = orig;
+
+            ALIGN_LINEARMAX(val, ypos*(ajlong)lenb + xpos, comp, orig);
+	}
+    }
+
+#undef ALIGN_LINEARMAX
+
+    AJFREE(pcol);
+    AJFREE(ccol);
+    AJFREE(porig);
+    AJFREE(corig);
+    AJFREE(ccomp);
+    AJFREE(maxa);
+    AJFREE(maxaorig);
+
+    lin->Global    = ajFalse;
+    lin->Gapopen   = gapopen;
+    lin->Gapextend = gapextend;
+
+    ajStrAssignClear(m);
+    ajStrAssignClear(n);
+
+    *start1 = (ajint) (porigin / lenb);
+    *start2 = (ajint) (porigin % lenb);
+
+    alignLinearEmit(lin, *start1, *start2, DIAG);
+    alignLinearSolve(lin, *start1, *start2, DIAG,
+                     (ajint) (pidx / lenb), (ajint) (pidx % lenb), pcomp);
+
+    alignLinearDel(&lin);
+
+    ajDebug("embAlignLinearCalcSW score %.3f start %d,%d end %Ld,%Ld\n",
+            ret, *start1, *start2, pidx / lenb, pidx % lenb);
+
+    return ret;
+}
+
+
+
+
+#define ALIGN_LINEARIDX(j,s) ((((ajlong)(j))+1)*3+(s))
+
+
+
+
+/* @funcstatic alignLinearNew *************************************************
+**
+** Constructor for a linear-memory alignment workspace
+**
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [u] m [AjPStr *] alignment for first sequence
+** @param [u] n [AjPStr *] alignment for second sequence
+**
+** @return [AlignPLinear] New workspace
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AlignPLinear alignLinearNew(const char *a, const char *b,
+                                   ajint lena, ajint lenb,
+                                   float * const *sub, const AjPSeqCvt cvt,
+                                   AjPStr *m, AjPStr *n)
+{
+    AlignPLinear lin;
+    size_t width;
+    ajint i;
+
+    AJNEW0(lin);
+
+    lin->A    = a;
+    lin->B    = b;
+    lin->Sub  = sub;
+    lin->Lena = lena;
+    lin->Lenb = lenb;
+    lin->M    = m;
+    lin->N    = n;
+
+    AJCNEW(lin->Acode, lena);
+    AJCNEW(lin->Bcode, lenb);
+
+    for(i=0; i<lena; i++)
+        lin->Acode[i] = ajSeqcvtGetCodeK(cvt, a[i]);
+
+    for(i=0; i<lenb; i++)
+        lin->Bcode[i] = ajSeqcvtGetCodeK(cvt, b[i]);
+
+    width = 3*((size_t)lenb+1);
+
+    AJCNEW(lin->Fprev, width);
+    AJCNEW(lin->Fcur, width);
+    AJCNEW(lin->Bnext, width);
+    AJCNEW(lin->Bcur, width);
+
+    return lin;
+}
+
+
+
+
+/* @funcstatic alignLinearDel *************************************************
+**
+** Destructor for a linear-memory alignment workspace
+**
+** @param [d] Plin [AlignPLinear*] Workspace
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignLinearDel(AlignPLinear *Plin)
+{
+    AlignPLinear lin = *Plin;
+
+    if(!lin)
+        return;
+
+    AJFREE(lin->Acode);
+    AJFREE(lin->Bcode);
+    AJFREE(lin->Fprev);
+    AJFREE(lin->Fcur);
+    AJFREE(lin->Bnext);
+    AJFREE(lin->Bcur);
+
+    AJFREE(*Plin);
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignLinearGapX ************************************************
+**
+** Penalty to reach the horizontal gap state at (i,j) from state s at
+** (i,j-1), using the same rules as the path matrix calculations.
+**
+** @param [r] lin [const AlignPLinear] Workspace
+** @param [r] i [ajint] Row in first sequence
+** @param [r] j [ajint] Column in second sequence
+** @param [r] s [ajint] Previous state DIAG, LEFT or DOWN
+**
+** @return [double] Score to add, or ALIGN_LINEARNONE if not allowed
+**
+** @release 6.6.0
+******************************************************************************/
+
+static double alignLinearGapX(const AlignPLinear lin, ajint i, ajint j,
+                              ajint s)
+{
+    if(!lin->Global)
+    {
+        if(s == LEFT && lin->Gapextend < lin->Gapopen)
+            return -lin->Gapextend;
+
+        return -lin->Gapopen;
+    }
+
+    if(!j)                      /* from the leading gap column */
+    {
+        if(s != DIAG)
+            return ALIGN_LINEARNONE;
+
+        return (i == lin->Lena-1) ? -lin->Endgapopen : -lin->Gapopen;
+    }
+
+    if(!i)
+        return (s == DIAG) ? -lin->Gapopen :
+            (s == LEFT) ? -lin->Gapextend : ALIGN_LINEARNONE;
+
+    if(i == lin->Lena-1)
+        return (s == DIAG) ? -lin->Endgapopen :
+            (s == LEFT) ? -lin->Endgapextend : ALIGN_LINEARNONE;
+
+    return (s == LEFT) ? -lin->Gapextend : -lin->Gapopen;
+}
+
+
+
+
+/* @funcstatic alignLinearGapY ************************************************
+**
+** Penalty to reach the vertical gap state at (i,j) from state s at
+** (i-1,j), using the same rules as the path matrix calculations.
+**
+** @param [r] lin [const AlignPLinear] Workspace
+** @param [r] i [ajint] Row in first sequence
+** @param [r] j [ajint] Column in second sequence
+** @param [r] s [ajint] Previous state DIAG, LEFT or DOWN
+**
+** @return [double] Score to add, or ALIGN_LINEARNONE if not allowed
+**
+** @release 6.6.0
+******************************************************************************/
+
+static double alignLinearGapY(const AlignPLinear lin, ajint i, ajint j,
+                              ajint s)
+{
+    if(!lin->Global)
+    {
+        if(s == DOWN && lin->Gapextend < lin->Gapopen)
+            return -lin->Gapextend;
+
+        return -lin->Gapopen;
+    }
+
+    if(!i)                      /* from the leading gap row */
+    {
+        if(s != DIAG)
+            return ALIGN_LINEARNONE;
+
+        return (j == lin->Lenb-1) ? -lin->Endgapopen : -lin->Gapopen;
+    }
+
+    if(!j)
+        return (s == DIAG) ? -lin->Gapopen :
+            (s == DOWN) ? -lin->Gapextend : ALIGN_LINEARNONE;
+
+    if(j == lin->Lenb-1)
+        return (s == DIAG) ? -lin->Endgapopen :
+            (s == DOWN) ? -lin->Endgapextend : ALIGN_LINEARNONE;
+
+    return (s == DOWN) ? -lin->Gapextend : -lin->Gapopen;
+}
+
+
+
+
+/* @funcstatic alignLinearForward *********************************************
+**
+** Best scores from node (ui,uj,us) to each node of row mid, for columns
+** uj to vj. The result is left in lin->Fcur.
+**
+** @param [u] lin [AlignPLinear] Workspace
+** @param [r] ui [ajint] Start row
+** @param [r] uj [ajint] Start column
+** @param [r] us [ajint] Start state
+** @param [r] mid [ajint] Last row to calculate
+** @param [r] vj [ajint] Last column to calculate
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignLinearForward(AlignPLinear lin,
+                               ajint ui, ajint uj, ajint us,
+                               ajint mid, ajint vj)
+{
+    double *prev = lin->Fprev;
+    double *cur  = lin->Fcur;
+    double *tmp;
+    double best;
+    double t;
+    double w;
+    ajint i;
+    ajint j;
+    ajint s;
 
-		if(!iy || fabs((double)score-(double)bimble)<errbounds)
-		    break;
+    for(j=uj; j<=vj; j++)
+        for(s=0; s<3; s++)
+            cur[ALIGN_LINEARIDX(j,s)] = ALIGN_LINEARNONE;
 
-		--iy;
+    cur[ALIGN_LINEARIDX(uj,us)] = 0.0;
 
-		if(iy<0)
-		    ajFatal("SW: Error walking down");
+    for(j=uj+1; j<=vj; j++)
+    {
+        if(ui < 0)
+        {
+            cur[ALIGN_LINEARIDX(j,DIAG)] = cur[ALIGN_LINEARIDX(j-1,DIAG)] -
+                (j ? lin->Endgapextend : lin->Endgapopen);
+            continue;
+        }
 
-		++gapcnt;
-	    }
+        best = ALIGN_LINEARNONE;
 
-	    if(bimble<=0.0)
-		break;
+        for(s=0; s<3; s++)
+        {
+            t = cur[ALIGN_LINEARIDX(j-1,s)];
+            w = alignLinearGapX(lin, ui, j, s);
 
-	    for(ic=0;ic<=gapcnt;++ic)
-	    {
-		ajStrAppendK(m,p[ypos--]);
-		ajStrAppendK(n,'.');
-	    }
-	    continue;
-	}
-	else
-	    ajFatal("Walk Error in SW");
+            if(t != ALIGN_LINEARNONE && w != ALIGN_LINEARNONE &&
+               t + w > best)
+                best = t + w;
+        }
+
+        cur[ALIGN_LINEARIDX(j,LEFT)] = best;
+    }
+
+    for(i=ui+1; i<=mid; i++)
+    {
+        tmp  = prev;
+        prev = cur;
+        cur  = tmp;
+
+        for(j=uj; j<=vj; j++)
+        {
+            cur[ALIGN_LINEARIDX(j,LEFT)] = ALIGN_LINEARNONE;
+            cur[ALIGN_LINEARIDX(j,DOWN)] = ALIGN_LINEARNONE;
+
+            if(j < 0)                   /* leading gap column */
+            {
+                t = prev[ALIGN_LINEARIDX(j,DIAG)];
+
+                if(t != ALIGN_LINEARNONE)
+                    t -= i ? lin->Endgapextend : lin->Endgapopen;
+
+                cur[ALIGN_LINEARIDX(j,DIAG)] = t;
+                continue;
+            }
+
+            best = ALIGN_LINEARNONE;
+
+            if(j > uj)
+                for(s=0; s<3; s++)
+                    if(prev[ALIGN_LINEARIDX(j-1,s)] > best)
+                        best = prev[ALIGN_LINEARIDX(j-1,s)];
+
+            if(best != ALIGN_LINEARNONE)
+                best += lin->Sub[lin->Acode[i]][lin->Bcode[j]];
+
+            cur[ALIGN_LINEARIDX(j,DIAG)] = best;
+
+            best = ALIGN_LINEARNONE;
+
+            for(s=0; s<3; s++)
+            {
+                t = prev[ALIGN_LINEARIDX(j,s)];
+
+                if(t == ALIGN_LINEARNONE)
+                    continue;
+
+                w = alignLinearGapY(lin, i, j, s);
+
+                if(w != ALIGN_LINEARNONE && t + w > best)
+                    best = t + w;
+            }
+
+            cur[ALIGN_LINEARIDX(j,DOWN)] = best;
+
+            if(j == uj)
+                continue;
+
+            best = ALIGN_LINEARNONE;
+
+            for(s=0; s<3; s++)
+            {
+                t = cur[ALIGN_LINEARIDX(j-1,s)];
+
+                if(t == ALIGN_LINEARNONE)
+                    continue;
+
+                w = alignLinearGapX(lin, i, j, s);
+
+                if(w != ALIGN_LINEARNONE && t + w > best)
+                    best = t + w;
+            }
+
+            cur[ALIGN_LINEARIDX(j,LEFT)] = best;
+        }
+    }
+
+    lin->Fprev = prev;
+    lin->Fcur  = cur;
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignLinearBackward ********************************************
+**
+** Best scores from each node of row lo to node (vi,vj,vs), for columns
+** uj to vj. The result is left in lin->Bcur.
+**
+** @param [u] lin [AlignPLinear] Workspace
+** @param [r] vi [ajint] End row
+** @param [r] vj [ajint] End column
+** @param [r] vs [ajint] End state
+** @param [r] lo [ajint] Last row to calculate
+** @param [r] uj [ajint] First column to calculate
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignLinearBackward(AlignPLinear lin,
+                                ajint vi, ajint vj, ajint vs,
+                                ajint lo, ajint uj)
+{
+    double *next = lin->Bnext;
+    double *cur  = lin->Bcur;
+    double *tmp;
+    double best;
+    double tdiag;
+    double tleft;
+    double tdown;
+    double w;
+    ajint i;
+    ajint j;
+    ajint s;
+
+    for(j=uj; j<=vj; j++)
+        for(s=0; s<3; s++)
+            cur[ALIGN_LINEARIDX(j,s)] = ALIGN_LINEARNONE;
+
+    cur[ALIGN_LINEARIDX(vj,vs)] = 0.0;
+
+    for(j=vj-1; j>=uj; j--)
+    {
+        tleft = cur[ALIGN_LINEARIDX(j+1,LEFT)];
+
+        if(tleft == ALIGN_LINEARNONE)
+            continue;
+
+        for(s=0; s<3; s++)
+        {
+            if(j < 0 && s != DIAG)
+                continue;
+
+            w = alignLinearGapX(lin, vi, j+1, s);
+
+            if(w != ALIGN_LINEARNONE)
+                cur[ALIGN_LINEARIDX(j,s)] = tleft + w;
+        }
+    }
+
+    for(i=vi-1; i>=lo; i--)
+    {
+        tmp  = next;
+        next = cur;
+        cur  = tmp;
+
+        for(j=vj; j>=uj; j--)
+        {
+            tdiag = (j < vj) ? next[ALIGN_LINEARIDX(j+1,DIAG)] :
+                ALIGN_LINEARNONE;
+
+            if(tdiag != ALIGN_LINEARNONE)
+                tdiag += lin->Sub[lin->Acode[i+1]][lin->Bcode[j+1]];
+
+            tleft = (j < vj) ? cur[ALIGN_LINEARIDX(j+1,LEFT)] :
+                ALIGN_LINEARNONE;
+
+            if(j < 0)                   /* leading gap column */
+            {
+                best = tdiag;
+                tdown = next[ALIGN_LINEARIDX(j,DIAG)];
+
+                if(tdown != ALIGN_LINEARNONE &&
+                   tdown - lin->Endgapextend > best)
+                    best = tdown - lin->Endgapextend;
+
+                w = alignLinearGapX(lin, i, 0, DIAG);
+
+                if(tleft != ALIGN_LINEARNONE && tleft + w > best)
+                    best = tleft + w;
+
+                cur[ALIGN_LINEARIDX(j,DIAG)] = best;
+                cur[ALIGN_LINEARIDX(j,LEFT)] = ALIGN_LINEARNONE;
+                cur[ALIGN_LINEARIDX(j,DOWN)] = ALIGN_LINEARNONE;
+                continue;
+            }
+
+            tdown = next[ALIGN_LINEARIDX(j,DOWN)];
+
+            for(s=0; s<3; s++)
+            {
+                best = tdiag;
+
+                if(tleft != ALIGN_LINEARNONE)
+                {
+                    w = alignLinearGapX(lin, i, j+1, s);
+
+                    if(w != ALIGN_LINEARNONE && tleft + w > best)
+                        best = tleft + w;
+                }
+
+                if(tdown != ALIGN_LINEARNONE)
+                {
+                    w = alignLinearGapY(lin, i+1, j, s);
+
+                    if(w != ALIGN_LINEARNONE && tdown + w > best)
+                        best = tdown + w;
+                }
+
+                cur[ALIGN_LINEARIDX(j,s)] = best;
+            }
+        }
+    }
+
+    lin->Bnext = next;
+    lin->Bcur  = cur;
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignLinearSolve ***********************************************
+**
+** Myers-Miller divide and conquer. Appends the alignment of the best path
+** from node (ui,uj,us) to node (vi,vj,vs), excluding the start node.
+**
+** The path is split where it leaves the middle row, found from forward
+** scores for the middle row and backward scores for the row below.
+**
+** @param [u] lin [AlignPLinear] Workspace
+** @param [r] ui [ajint] Start row
+** @param [r] uj [ajint] Start column
+** @param [r] us [ajint] Start state
+** @param [r] vi [ajint] End row
+** @param [r] vj [ajint] End column
+** @param [r] vs [ajint] End state
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignLinearSolve(AlignPLinear lin,
+                             ajint ui, ajint uj, ajint us,
+                             ajint vi, ajint vj, ajint vs)
+{
+    const double *fwd;
+    const double *bwd;
+    double best = ALIGN_LINEARNONE;
+    double f;
+    double t;
+    double w;
+    ajint mid;
+    ajint i;
+    ajint j;
+    ajint s;
+    ajint pj = 0;
+    ajint ps = 0;
+    ajint qj = 0;
+    ajint qs = 0;
+
+    if(vj < 0)                          /* down the leading gap column */
+    {
+        for(i=ui+1; i<=vi; i++)
+            alignLinearEmit(lin, i, -1, DIAG);
+
+        return;
+    }
+
+    if(ui == vi)                        /* along a single row */
+    {
+        for(j=uj+1; j<=vj; j++)
+            alignLinearEmit(lin, ui, j, LEFT);
+
+        return;
+    }
+
+    mid = ui + (vi-ui)/2;
+
+    alignLinearForward(lin, ui, uj, us, mid, vj);
+    alignLinearBackward(lin, vi, vj, vs, mid+1, uj);
+
+    fwd = lin->Fcur;
+    bwd = lin->Bcur;
+
+    /*
+    ** Ties go to the crossing furthest right, and then to a match. They are
+    ** only broken here, at the middle row, so a gap that can shift past
+    ** residues of equal score is not always placed where the compass
+    ** traceback would put it
+    */
+
+    for(j=vj; j>=uj; j--)
+    {
+        t = bwd[ALIGN_LINEARIDX(j,DIAG)];
+
+        if(j > uj && t != ALIGN_LINEARNONE)
+        {
+            t += lin->Sub[lin->Acode[mid+1]][lin->Bcode[j]];
+
+            for(s=0; s<3; s++)
+            {
+                f = fwd[ALIGN_LINEARIDX(j-1,s)];
+
+                if(f != ALIGN_LINEARNONE && f + t > best)
+                {
+                    best = f + t;
+                    pj = j-1;
+                    ps = s;
+                    qj = j;
+                    qs = DIAG;
+                }
+            }
+        }
+
+        if(j < 0)                       /* down the leading gap column */
+        {
+            f = fwd[ALIGN_LINEARIDX(j,DIAG)];
+            t = bwd[ALIGN_LINEARIDX(j,DIAG)];
+            w = mid+1 ? -lin->Endgapextend : -lin->Endgapopen;
+
+            if(f != ALIGN_LINEARNONE && t != ALIGN_LINEARNONE &&
+               f + w + t > best)
+            {
+                best = f + w + t;
+                pj = j;
+                ps = DIAG;
+                qj = j;
+                qs = DIAG;
+            }
+
+            continue;
+        }
+
+        t = bwd[ALIGN_LINEARIDX(j,DOWN)];
+
+        if(t == ALIGN_LINEARNONE)
+            continue;
+
+        for(s=0; s<3; s++)
+        {
+            f = fwd[ALIGN_LINEARIDX(j,s)];
+            w = alignLinearGapY(lin, mid+1, j, s);
+
+            if(f != ALIGN_LINEARNONE && w != ALIGN_LINEARNONE &&
+               f + w + t > best)
+            {
+                best = f + w + t;
+                pj = j;
+                ps = s;
+                qj = j;
+                qs = DOWN;
+            }
+        }
+    }
+
+    if(best == ALIGN_LINEARNONE)
+        ajFatal("alignLinearSolve: no path from %d,%d to %d,%d",
+                ui, uj, vi, vj);
+
+    alignLinearSolve(lin, ui, uj, us, mid, pj, ps);
+    alignLinearEmit(lin, mid+1, qj, qs);
+    alignLinearSolve(lin, mid+1, qj, qs, vi, vj, vs);
+
+    return;
+}
+
+
+
+
+/* @funcstatic alignLinearEmit ************************************************
+**
+** Append the alignment column for a node to the aligned sequences
+**
+** @param [u] lin [AlignPLinear] Workspace
+** @param [r] i [ajint] Row in first sequence, -1 for the leading gap row
+** @param [r] j [ajint] Column in second sequence, -1 for the leading
+**                      gap column
+** @param [r] s [ajint] State DIAG, LEFT or DOWN
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void alignLinearEmit(AlignPLinear lin, ajint i, ajint j, ajint s)
+{
+    if(i < 0 && j < 0)
+        return;
+
+    if(j < 0 || (i >= 0 && s == DOWN))
+    {
+        ajStrAppendK(lin->M, lin->A[i]);
+        ajStrAppendK(lin->N, '.');
+    }
+    else if(i < 0 || s == LEFT)
+    {
+        ajStrAppendK(lin->M, '.');
+        ajStrAppendK(lin->N, lin->B[j]);
+    }
+    else
+    {
+        ajStrAppendK(lin->M, lin->A[i]);
+        ajStrAppendK(lin->N, lin->B[j]);
+    }
+
+    return;
+}
+
+
+
+
+/* @func embAlignBandCalcNW ***************************************************
+**
+** Needleman-Wunsch alignment with end gap penalties, restricted to a band
+** of diagonals around the path from the start to the end of both
+** sequences.
+**
+** The band includes every diagonal between the top left and bottom right
+** corners of the path matrix, widened by width diagonals on each side.
+** Only cells inside the band are stored and computed, so time and memory
+** grow with the sequence length times the band width.
+**
+** Cells are scored as by embAlignPathCalcWithEndGapPenalties, and the
+** alignment is walked as by embAlignWalkNWMatrixUsingCompass, so the
+** result is the same as the full matrix when the optimal path lies inside
+** the band.
+**
+** With adaptive set the band is doubled until the score no longer
+** changes, or until the band covers the whole matrix.
+**
+** Both sequences must be at least 2 residues long.
+**
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
+** @param [r] lena [ajint] length of first sequence
+** @param [r] lenb [ajint] length of second sequence
+** @param [r] gapopen [float] gap opening penalty
+** @param [r] gapextend [float] gap extension penalty
+** @param [r] endgapopen [float] end gap opening penalty
+** @param [r] endgapextend [float] end gap extension penalty
+** @param [w] start1 [ajint *] start of alignment in first sequence
+** @param [w] start2 [ajint *] start of alignment in second sequence
+** @param [r] sub [float * const *] substitution matrix from AjPMatrixf
+** @param [r] cvt [const AjPSeqCvt] Conversion array for AjPMatrixf
+** @param [w] m [AjPStr *] alignment for first sequence
+** @param [w] n [AjPStr *] alignment for second sequence
+** @param [r] endweight [AjBool] Use end gap weights
+** @param [r] width [ajint] Extra diagonals on each side of the band
+** @param [r] adaptive [AjBool] Widen the band until the score is stable
+**
+** @return [float] Score
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+float embAlignBandCalcNW(const char *a, const char *b,
+                         ajint lena, ajint lenb,
+                         float gapopen, float gapextend,
+                         float endgapopen, float endgapextend,
+                         ajint *start1, ajint *start2,
+                         float * const *sub, const AjPSeqCvt cvt,
+                         AjPStr *m, AjPStr *n,
+                         AjBool endweight, ajint width, AjBool adaptive)
+{
+    AlignONWBand band;
+    ajlong dlo;
+    ajlong dhi;
+    ajint i;
+    float score;
+    float oldscore = 0.0F;
+    float eps;
+    AjBool full;
+    AjBool first = ajTrue;
+
+    ajDebug("embAlignBandCalcNW lena:%d lenb:%d width:%d adaptive:%B\n",
+            lena, lenb, width, adaptive);
+
+    if(lena < 2 || lenb < 2)
+        ajFatal("embAlignBandCalcNW: sequences must have 2 or more "
+                "residues");
+
+    if(width < 0)
+        width = 0;
+
+    if(!endweight)
+    {
+	endgapopen=0;
+	endgapextend=0;
+    }
+
+    band.Sub          = sub;
+    band.M            = NULL;
+    band.Ix           = NULL;
+    band.Iy           = NULL;
+    band.Size         = 0;
+    band.Gapopen      = gapopen;
+    band.Gapextend    = gapextend;
+    band.Endgapopen   = endgapopen;
+    band.Endgapextend = endgapextend;
+    band.Lena         = lena;
+    band.Lenb         = lenb;
+
+    AJCNEW(band.Acode, lena);
+    AJCNEW(band.Bcode, lenb);
+
+    for(i=0; i<lena; i++)
+        band.Acode[i] = ajSeqcvtGetCodeK(cvt, a[i]);
+
+    for(i=0; i<lenb; i++)
+        band.Bcode[i] = ajSeqcvtGetCodeK(cvt, b[i]);
+
+    for(;;)
+    {
+        dlo = (ajlong) ((lenb < lena) ? lenb - lena : 0) - width;
+        dhi = (ajlong) ((lenb > lena) ? lenb - lena : 0) + width;
+
+        if(dlo < 1 - lena)
+            dlo = 1 - lena;
+
+        if(dhi > lenb - 1)
+            dhi = lenb - 1;
+
+        full = (dlo == 1 - lena && dhi == lenb - 1);
+
+        score = alignNWBandFill(&band, (ajint) dlo, (ajint) dhi);
+
+        ajDebug("embAlignBandCalcNW diagonals %Ld..%Ld score %.3f\n",
+                dlo, dhi, score);
+
+        if(!adaptive || full)
+            break;
+
+        /* scores are large, so compare relative to their size */
+        eps = U_FEPS * (1.0F + (float) fabs(oldscore));
+
+        if(!first && E_FPEQ(score, oldscore, eps))
+            break;
+
+        first = ajFalse;
+        oldscore = score;
+
+        if(width > (lena + lenb) / 2)
+            width = lena + lenb;
+        else if(width)
+            width *= 2;
+        else
+            width = 1;
     }
 
-    *start1 = (ajint) (ypos + 1); /* Potential lossy cast */
-    *start2 = (ajint) (xpos + 1); /* Potential lossy cast */
+    alignNWBandWalk(&band, a, b, m, n);
 
-    ajStrReverse(m);            /* written with append, need to reverse */
-    ajStrReverse(n);
+    AJFREE(band.Acode);
+    AJFREE(band.Bcode);
+    AJFREE(band.M);
+    AJFREE(band.Ix);
+    AJFREE(band.Iy);
 
-    ajDebug("embAlignWalkSWMatrix done\n");
+    *start1 = 0;
+    *start2 = 0;
 
-    return;
+    ajDebug("first sequence extended with gaps  (m): %S\n", *m);
+    ajDebug("second sequence extended with gaps (n): %S\n", *n);
+
+    return score;
 }
 
 
 
 
-/* @func embAlignWalkNWMatrix *************************************************
+/* @funcstatic alignNWBandFill ************************************************
 **
-** Walk down a matrix for Needleman Wunsch. Form aligned strings.
-** Nucleotides or proteins as needed.
+** Fills the banded path matrices using the same float arithmetic as
+** embAlignPathCalcWithEndGapPenalties
 **
-** @param [r] path [const float*] path matrix
-** @param [r] a [const AjPSeq] first sequence
-** @param [r] b [const AjPSeq] second sequence
-** @param [w] m [AjPStr *] alignment for first sequence
-** @param [w] n [AjPStr *] alignment for second sequence
-** @param [r] lena [ajint] length of first sequence
-** @param [r] lenb [ajint] length of second sequence
-** @param [w] start1 [ajint *] start of alignment in first sequence
-** @param [w] start2 [ajint *] start of alignment in second sequence
-** @param [r] gapopen [float] gap open penalty
-** @param [r] gapextend [float] gap extension penalty
-** @param [r] compass [const ajint*] Path direction pointer array
+** @param [u] band [AlignPNWBand] Banded path matrices
+** @param [r] dlo [ajint] Lowest diagonal (xpos-ypos) in the band
+** @param [r] dhi [ajint] Highest diagonal (xpos-ypos) in the band
 **
-** @return [void]
+** @return [float] Score of the global alignment
 **
-** @release 1.0.0
+** @release 6.6.0
 ******************************************************************************/
 
-void embAlignWalkNWMatrix(const float *path, const AjPSeq a, const AjPSeq b,
-			  AjPStr *m,
-			  AjPStr *n, ajint lena, ajint lenb, ajint *start1,
-			  ajint *start2, float gapopen,
-			  float gapextend,
-			  const ajint *compass)
+static float alignNWBandFill(AlignPNWBand band, ajint dlo, ajint dhi)
 {
-    ajint i;
-    ajint j;
-    ajint gapcnt;
-    double pmax;
-    double score;
-    double bimble;
+    float * const *sub = band->Sub;
+    const ajint *acode = band->Acode;
+    const ajint *bcode = band->Bcode;
+    float *m;
+    float *ix;
+    float *iy;
+    float gapopen      = band->Gapopen;
+    float gapextend    = band->Gapextend;
+    float endgapopen   = band->Endgapopen;
+    float endgapextend = band->Endgapextend;
+    ajint lena = band->Lena;
+    ajint lenb = band->Lenb;
+    ajint xpos;
+    ajint ypos;
+    ajint xhi;
+    size_t rowlen;
+    size_t size;
+    size_t cursor;
+    size_t diag;
+    size_t up;
+    size_t left;
+    float match;
+    float testog;
+    float testeg;
+    AjBool last;
 
-    ajint ix;
-    ajint iy;
+    band->Dlo = dlo;
+    band->Dhi = dhi;
+    band->Rowlen = dhi - dlo + 3;
 
-    ajint xpos = 0;
-    ajint ypos = 0;
-    const char *p;
-    const char *q;
+    rowlen = band->Rowlen;
+    size = (size_t) lena * rowlen;
 
-    ajint ic;
-    double errbounds;
+    if(size > band->Size)
+    {
+        AJCRESIZE(band->M, size);
+        AJCRESIZE(band->Ix, size);
+        AJCRESIZE(band->Iy, size);
+        band->Size = size;
+    }
 
-    ajDebug("embAlignWalkNWMatrix\n");
+    m  = band->M;
+    ix = band->Ix;
+    iy = band->Iy;
 
-    /*errbounds=gapextend;*/
-    errbounds = (double) 0.01;
+    /* the cells just outside the band can never be reached */
 
-    /* Get maximum path axis score and save position */
-    pmax = (double) (-1*INT_MAX);
+    for(ypos = 0; ypos < lena; ++ypos)
+    {
+        cursor = ypos * rowlen;
+        m[cursor] = ix[cursor] = iy[cursor] = ALIGN_NWBANDNONE;
+        cursor += rowlen - 1;
+        m[cursor] = ix[cursor] = iy[cursor] = ALIGN_NWBANDNONE;
+    }
 
-    for(i=0;i<lenb;++i)
-	if(path[(lena-1)*lenb+i]>=pmax)
-	{
-	    pmax = path[(lena-1)*lenb+i];
-	    xpos = i;
-	    ypos = lena-1;
-	}
+    /* first row */
 
-    for(j=0;j<lena;++j)
-	if(path[j*lenb+lenb-1]>pmax)
-	{
-	    pmax = path[j*lenb+lenb-1];
-	    xpos = lenb-1;
-	    ypos = j;
-	}
+    cursor = ALIGN_NWBANDIDX(band, 0, 0);
+    m[cursor] = sub[acode[0]][bcode[0]];
+    ix[cursor] = -endgapopen-gapopen;
+    iy[cursor] = -endgapopen-gapopen;
 
-    ajStrAssignClear(m);
-    ajStrAssignClear(n);
+    xhi = (dhi < lenb - 1) ? dhi : lenb - 1;
 
-    p = ajSeqGetSeqC(a);
-    q = ajSeqGetSeqC(b);
+    for(xpos = 1; xpos <= xhi; ++xpos)
+    {
+        cursor = ALIGN_NWBANDIDX(band, 0, xpos);
+	match = sub[acode[0]][bcode[xpos]];
 
-    while(xpos>=0 && ypos>=0)
+	testog = m[cursor-1] - gapopen;
+	testeg = ix[cursor-1] - gapextend;
+
+	if(testog >= testeg)
+	    ix[cursor] = testog;
+	else
+	    ix[cursor] = testeg;
+
+	m[cursor] = match - (endgapopen + (xpos - 1) * endgapextend);
+	iy[cursor] = -endgapopen - xpos * endgapextend - gapopen;
+    }
+
+    if(xhi == lenb - 1)
     {
-	if(!compass[ypos*lenb+xpos])	/* diagonal */
-	{
-	    ajStrAppendK(m,p[ypos--]);
-	    ajStrAppendK(n,q[xpos--]);
-	    continue;
-	}
-	else if(compass[ypos*lenb+xpos]==LEFT) /* Left, gap(s) in vertical */
-	{
-	    score  = path[ypos*lenb+xpos];
-	    gapcnt = 0;
-	    ix     = xpos-1;
+        cursor = ALIGN_NWBANDIDX(band, 0, xhi);
+        iy[cursor] -= endgapopen;
+        iy[cursor] += gapopen;
+    }
 
-	    while(1)
-	    {
-		bimble = path[ypos*lenb+ix]-gapopen-(gapcnt*gapextend);
+    for(ypos = 1; ypos < lena; ++ypos)
+    {
+        last = (ypos == lena-1);
 
-		if(!ix || fabs((double)score-(double)bimble)< errbounds)
-		    break;
+        xpos = ypos + dlo;
+        xhi  = ypos + dhi;
 
-		--ix;
-		++gapcnt;
-	    }
+        if(xhi > lenb - 1)
+            xhi = lenb - 1;
 
-	    for(ic=0;ic<=gapcnt;++ic)
-	    {
-		ajStrAppendK(m,'.');
-		ajStrAppendK(n,q[xpos--]);
-	    }
-	    continue;
-	}
-	else if(compass[ypos*lenb+xpos]==DOWN) /* Down, gap(s) in horizontal */
-	{
-	    score  = path[ypos*lenb+xpos];
-	    gapcnt = 0;
-	    iy = ypos-1;
+        if(xpos <= 0)
+        {
+            /* first column */
+            cursor = ALIGN_NWBANDIDX(band, ypos, 0);
+            up = cursor - rowlen + 1;
+            match = sub[acode[ypos]][bcode[0]];
 
-	    while(1)
-	    {
-		bimble = path[iy*lenb+xpos]-gapopen-(gapcnt*gapextend);
+            testog = m[up] - gapopen;
+            testeg = iy[up] - gapextend;
 
-		if(!iy || fabs((double)score-(double)bimble)< errbounds)
-		    break;
+            if(testog >= testeg)
+                iy[cursor] = testog;
+            else
+                iy[cursor] = testeg;
 
-		--iy;
-		++gapcnt;
-	    }
+            m[cursor] = match - (endgapopen + (ypos - 1) * endgapextend);
+            ix[cursor] = -endgapopen - ypos * endgapextend - gapopen;
 
-	    for(ic=0;ic<=gapcnt;++ic)
-	    {
-		ajStrAppendK(m,p[ypos--]);
-		ajStrAppendK(n,'.');
-	    }
+            if(last)
+            {
+                ix[cursor] -= endgapopen;
+                ix[cursor] += gapopen;
+            }
 
-	    continue;
-	}
-	else
-	    ajFatal("Walk Error in NW");
+            xpos = 1;
+        }
+
+        for(; xpos <= xhi; ++xpos)
+        {
+            cursor = ALIGN_NWBANDIDX(band, ypos, xpos);
+            diag = cursor - rowlen;
+            up   = diag + 1;
+            left = cursor - 1;
+
+            match = sub[acode[ypos]][bcode[xpos]];
+
+            if(m[diag] > ix[diag] && m[diag] > iy[diag])
+                m[cursor] = m[diag]+match;
+            else if(ix[diag] > iy[diag])
+                m[cursor] = ix[diag]+match;
+            else
+                m[cursor] = iy[diag]+match;
+
+            if(xpos == lenb-1)
+            {
+                testog = m[up] - endgapopen;
+                testeg = iy[up] - endgapextend;
+            }
+            else
+            {
+                testog = m[up];
+
+                if(testog < ix[up])
+                    testog = ix[up];
+
+                testog -= gapopen;
+                testeg = iy[up] - gapextend;
+            }
+
+            if(testog > testeg)
+                iy[cursor] = testog;
+            else
+                iy[cursor] = testeg;
+
+            if(last)
+            {
+                testog = m[left] - endgapopen;
+                testeg = ix[left] - endgapextend;
+            }
+            else
+            {
+                testog = m[left];
+
+                if(testog < iy[left])
+                    testog = iy[left];
+
+                testog -= gapopen;
+                testeg = ix[left] - gapextend;
+            }
 
+            if(testog > testeg)
+                ix[cursor] = testog;
+            else
+                ix[cursor] = testeg;
+        }
     }
 
-    *start2 = xpos+1;
-    *start1 = ypos+1;
+    cursor = ALIGN_NWBANDIDX(band, lena-1, lenb-1);
 
-    ajStrReverse(m);            /* written with append, need to reverse */
-    ajStrReverse(n);
+    if(m[cursor] > ix[cursor] && m[cursor] > iy[cursor])
+        return m[cursor];
 
-    return;
+    if(ix[cursor] > iy[cursor])
+        return ix[cursor];
+
+    return iy[cursor];
 }
 
 
 
 
-/* @func embAlignWalkNWMatrixUsingCompass *************************************
+/* @funcstatic alignNWBandWalk ************************************************
 **
-** Walk down a matrix for Needleman Wunsch which was constructed using end gap
-** penalties. Form aligned strings. Nucleotides or proteins as needed.
+** Traces back through the banded path matrices, making the same choices
+** as embAlignPathCalcWithEndGapPenalties, and forms the aligned strings
+** as embAlignWalkNWMatrixUsingCompass does.
 **
-** @param [r] p [const char*] first sequence
-** @param [r] q [const char*] second sequence
+** @param [r] band [const AlignPNWBand] Banded path matrices
+** @param [r] a [const char *] first sequence
+** @param [r] b [const char *] second sequence
 ** @param [w] m [AjPStr *] alignment for first sequence
 ** @param [w] n [AjPStr *] alignment for second sequence
-** @param [r] lena [ajuint] length of first sequence
-** @param [r] lenb [ajuint] length of second sequence
-** @param [w] start1 [ajint *] start of alignment in first sequence
-** @param [w] start2 [ajint *] start of alignment in second sequence
-** @param [r] compass [ajint const *] Path direction pointer array
 **
 ** @return [void]
 **
-** @release 6.2.0
-** @@
-**
+** @release 6.6.0
 ******************************************************************************/
 
-void embAlignWalkNWMatrixUsingCompass(const char* p, const char* q,
-                                 AjPStr *m, AjPStr *n,
-                                 ajuint lena, ajuint lenb,
-                                 ajint *start1, ajint *start2,
-                                 ajint const *compass)
+static void alignNWBandWalk(const AlignPNWBand band,
+                            const char *a, const char *b,
+                            AjPStr *m, AjPStr *n)
 {
-    ajint xpos = *start2;
-    ajint ypos = *start1;
-    ajint i;
-    ajint j;
-    ajuint cursor;
-
-    ajDebug("embAlignWalkNWMatrixUsingCompass\n");
+    const float *mm = band->M;
+    const float *ix = band->Ix;
+    const float *iy = band->Iy;
+    ajint lena = band->Lena;
+    ajint lenb = band->Lenb;
+    ajint xpos = lenb-1;
+    ajint ypos = lena-1;
+    ajint dir;
+    ajint cursorp = DIAG;
+    size_t rowlen = band->Rowlen;
+    size_t cursor;
+    float mp;
 
     ajStrAssignClear(m);
     ajStrAssignClear(n);
-    
-    for (i=lenb-1; i>xpos;)
-    {
-        ajStrAppendK(n, q[i--]);
-        ajStrAppendK(m, '.');
-    }
 
-    for (j=lena-1; j>ypos; )
+    while(xpos >= 0 && ypos >= 0)
     {
-        ajStrAppendK(m, p[j--]);
-        ajStrAppendK(n, '.');
-    }
+        cursor = ALIGN_NWBANDIDX(band, ypos, xpos);
+        mp = mm[cursor];
+
+	if(cursorp == LEFT &&
+           E_FPEQ(((ypos==0 || ypos==lena-1) ?
+                   band->Endgapextend : band->Gapextend),
+                  (ix[cursor]-ix[cursor+1]), U_FEPS))
+	    dir = LEFT;
+	else if(cursorp == DOWN &&
+                E_FPEQ(((xpos==0 || xpos==lenb-1) ?
+                        band->Endgapextend : band->Gapextend),
+                       (iy[cursor]-iy[cursor+rowlen-1]), U_FEPS))
+	    dir = DOWN;
+	else if(mp >= ix[cursor] && mp >= iy[cursor])
+	{
+	    if(cursorp == LEFT && E_FPEQ(mp, ix[cursor], U_FEPS))
+		dir = LEFT;
+	    else if(cursorp == DOWN && E_FPEQ(mp, iy[cursor], U_FEPS))
+		dir = DOWN;
+	    else
+		dir = DIAG;
+	}
+	else if(ix[cursor] >= iy[cursor])
+	    dir = LEFT;
+	else
+	    dir = DOWN;
 
-    while (xpos >= 0 && ypos >= 0)
-    {
-        cursor = ypos * lenb + xpos;
-        if(!compass[cursor]) /* diagonal */
+        if(dir == DIAG)
         {
-            ajStrAppendK(m, p[ypos--]);
-            ajStrAppendK(n, q[xpos--]);
-            continue;
+            ajStrAppendK(m, a[ypos--]);
+            ajStrAppendK(n, b[xpos--]);
         }
-        else if(compass[cursor] == LEFT) /* Left, gap(s) in vertical */
+        else if(dir == LEFT)
         {
             ajStrAppendK(m, '.');
-            ajStrAppendK(n, q[xpos--]);
-            continue;
+            ajStrAppendK(n, b[xpos--]);
         }
-        else if(compass[cursor] == DOWN) /* Down, gap(s) in horizontal */
+        else
         {
-            ajStrAppendK(m, p[ypos--]);
+            ajStrAppendK(m, a[ypos--]);
             ajStrAppendK(n, '.');
+        }
 
-            continue;
-        } else
-            ajFatal("Walk Error in NW");
+        cursorp = dir;
     }
 
-    for (;xpos>=0;xpos--)
+    for(; xpos >= 0; xpos--)
     {
-        ajStrAppendK(n, q[xpos]);
+        ajStrAppendK(n, b[xpos]);
         ajStrAppendK(m, '.');
     }
 
-    for (;ypos>=0;ypos--)
+    for(; ypos >= 0; ypos--)
     {
-        ajStrAppendK(m, p[ypos]);
+        ajStrAppendK(m, a[ypos]);
         ajStrAppendK(n, '.');
     }
 
-    *start2 = xpos+1;
-    *start1 = ypos+1;
-
-    ajStrReverse(m); /* written with append, need to reverse */
+    ajStrReverse(m);
     ajStrReverse(n);
 
-    ajDebug("first sequence extended with gaps  (m): %S\n", *m);
-    ajDebug("second sequence extended with gaps (n): %S\n", *n);
-    
     return;
 }
 
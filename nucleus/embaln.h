@@ -72,11 +72,38 @@ AJ_BEGIN_DECLS
 ** Prototype definitions
 */
 
+float embAlignBandCalcNW(const char *a, const char *b,
+                         ajint lena, ajint lenb,
+                         float gapopen, float gapextend,
+                         float endgapopen, float endgapextend,
+                         ajint *start1, ajint *start2,
+                         float * const *sub, const AjPSeqCvt cvt,
+                         AjPStr *m, AjPStr *n,
+                         AjBool endweight, ajint width, AjBool adaptive);
+
 void embAlignCalcSimilarity(const AjPStr m, const AjPStr n,
 			    const AjFloatArray *sub, const AjPSeqCvt cvt,
 			    ajint lenm, ajint lenn, float *id, float *sim,
 			    float *idx, float *simx);
 
+float embAlignLinearCalcNW(const char *a, const char *b,
+                           ajint lena, ajint lenb,
+                           float gapopen, float gapextend,
+                           float endgapopen, float endgapextend,
+                           ajint *start1, ajint *start2,
+                           float * const *sub, const AjPSeqCvt cvt,
+                           AjPStr *m, AjPStr *n,
+                           AjBool endweight);
+
+float embAlignLinearCalcSW(const char *a, const char *b,
+                           ajint lena, ajint lenb,
+                           float gapopen, float gapextend,
+                           float * const *sub, const AjPSeqCvt cvt,
+                           AjPStr *m, AjPStr *n,
+                           ajint *start1, ajint *start2);
+
+size_t embAlignLinearGetCells(void);
+
 float embAlignPathCalc(const char *a, const char *b,
                        ajint lena, ajint lenb, float gapopen,
                        float gapextend, float *path,
@@ -33,11 +33,186 @@
 #include "ajreg.h"
 #include "ajarr.h"
 #include "ajnam.h"
+#include "ajfileio.h"
+#include "ajsys.h"
+#include "ajutil.h"
 
 #include <errno.h>
 
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif /* !WIN32 */
+
 #define BTENTRYFILE     ".ent"
 #define KWLIMIT 12
+#define BTREEBULKMEMORY 256
+
+
+
+
+/* @datastatic BtreePBulkrec **************************************************
+**
+** Index term held in a bulk load buffer
+**
+** @alias BtreeSBulkrec
+** @alias BtreeOBulkrec
+**
+** @attr Seq [ajulong] Order in which the term was parsed
+** @attr Offset [ajulong] Entry offset in the data file
+** @attr Text [size_t] Start of the key, followed by any identifier,
+**                     in the buffer text
+** @attr Ref [size_t] Start of the reference file offsets in the buffer
+** @attr Dbno [ajuint] Data file number
+** @attr Keylen [ajuint] Key length
+** @attr Idlen [ajuint] Secondary index identifier length
+** @attr Padding [char[4]] Padding to alignment boundary
+******************************************************************************/
+
+typedef struct BtreeSBulkrec
+{
+    ajulong Seq;
+    ajulong Offset;
+    size_t Text;
+    size_t Ref;
+    ajuint Dbno;
+    ajuint Keylen;
+    ajuint Idlen;
+    char   Padding[4];
+} BtreeOBulkrec;
+
+#define BtreePBulkrec BtreeOBulkrec*
+
+
+
+
+/* @datastatic BtreePBulk *****************************************************
+**
+** Bulk load buffer for one index. Terms are collected and sorted, and
+** written to sorted run files in the index directory when the buffer
+** reaches its memory limit. The runs are merged and the terms written
+** to the index in key order when the caches are flushed.
+**
+** @alias BtreeSBulk
+** @alias BtreeOBulk
+**
+** @attr Cache [AjPBtcache] Index cache
+** @attr Load [AjPBtload] Index bulk load while terms are written
+** @attr Recs [BtreePBulkrec] Buffered terms
+** @attr Text [char*] Buffered key and identifier text
+** @attr Refs [ajulong*] Buffered reference file offsets
+** @attr Runs [AjPList] Sorted run file names
+** @attr Idirectory [AjPStr] Index directory
+** @attr Runname [AjPStr] Run file name prefix
+** @attr Seq [ajulong] Number of terms buffered
+** @attr Nrecs [size_t] Number of buffered terms
+** @attr Maxrecs [size_t] Size of the term array
+** @attr Textlen [size_t] Used length of the text buffer
+** @attr Textmax [size_t] Size of the text buffer
+** @attr Nrefs [size_t] Used length of the reference offset buffer
+** @attr Maxrefs [size_t] Size of the reference offset buffer
+** @attr Maxmem [size_t] Memory limit before a run is written
+** @attr Refcount [ajuint] Number of reference files per entry,
+**                        zero for a secondary index
+** @attr Secondary [AjBool] True for a secondary (keyword) index
+******************************************************************************/
+
+typedef struct BtreeSBulk
+{
+    AjPBtcache Cache;
+    AjPBtload Load;
+    BtreePBulkrec Recs;
+    char *Text;
+    ajulong *Refs;
+    AjPList Runs;
+    AjPStr Idirectory;
+    AjPStr Runname;
+    ajulong Seq;
+    size_t Nrecs;
+    size_t Maxrecs;
+    size_t Textlen;
+    size_t Textmax;
+    size_t Nrefs;
+    size_t Maxrefs;
+    size_t Maxmem;
+    ajuint Refcount;
+    AjBool Secondary;
+} BtreeOBulk;
+
+#define BtreePBulk BtreeOBulk*
+
+
+
+
+/* @datastatic BtreePBulkrun **************************************************
+**
+** Sorted run file being merged into an index
+**
+** @alias BtreeSBulkrun
+** @alias BtreeOBulkrun
+**
+** @attr File [AjPFile] Run file
+** @attr Key [AjPStr] Current key
+** @attr Id [AjPStr] Current secondary index identifier
+** @attr Refs [ajulong*] Current reference file offsets
+** @attr Offset [ajulong] Current data file offset
+** @attr Dbno [ajuint] Current data file number
+** @attr Done [AjBool] True when the run is exhausted
+******************************************************************************/
+
+typedef struct BtreeSBulkrun
+{
+    AjPFile File;
+    AjPStr Key;
+    AjPStr Id;
+    ajulong *Refs;
+    ajulong Offset;
+    ajuint Dbno;
+    AjBool Done;
+} BtreeOBulkrun;
+
+#define BtreePBulkrun BtreeOBulkrun*
+
+
+
+
+/* @datastatic BtreePWorkers **************************************************
+**
+** Worker processes parsing data files in parallel
+**
+** Each worker parses every Nworkers-th data file into a spool file and
+** writes one byte to its pipe when a file is finished. The parent reads
+** the spool files back in data file order.
+**
+** @alias BtreeSWorkers
+** @alias BtreeOWorkers
+**
+** @attr Spool [AjPFile] Spool file for the current data file
+** @attr Fields [EmbPBtreeField*] Index fields in spool file order
+** @attr Pids [ajint*] Worker process identifiers
+** @attr Fds [int*] Read end of each worker pipe in the parent
+** @attr Nfields [ajuint] Number of index fields
+** @attr Nworkers [ajuint] Number of worker processes
+** @attr Worker [ajuint] Worker number from 1, zero in the parent
+** @attr Fd [int] Write end of the pipe in a worker
+******************************************************************************/
+
+typedef struct BtreeSWorkers
+{
+    AjPFile Spool;
+    EmbPBtreeField *Fields;
+    ajint *Pids;
+    int *Fds;
+    ajuint Nfields;
+    ajuint Nworkers;
+    ajuint Worker;
+    int Fd;
+} BtreeOWorkers;
+
+#define BtreePWorkers BtreeOWorkers*
+
+
 
 
 static AjPStr embindexLine      = NULL;
@@ -49,10 +224,38 @@ static AjPStrTok embindexHandle = NULL;
 
 static AjPStr  indexWord = NULL;
 static AjPBtId indexId   = NULL;
+static AjPStr  indexBulkKey = NULL;
+static const char *indexBulkText = NULL;
 
 static AjPFile btreeCreateFile(const AjPStr idirectory, const AjPStr dbname,
 			       const char *add);
 
+static void       btreeBulkAdd(BtreePBulk bulk, const AjPStr key,
+                               const AjPStr id, ajuint dbno, ajulong offset,
+                               const ajlong *reffpos);
+static int        btreeBulkCompare(const void *item1, const void *item2);
+static void       btreeBulkDel(BtreePBulk *Pbulk);
+static void       btreeBulkInsert(BtreePBulk bulk, const char *key,
+                                  const char *id, ajuint dbno,
+                                  ajulong offset, const ajulong *refs);
+static void       btreeBulkLoad(BtreePBulk bulk);
+static BtreePBulk btreeBulkNew(AjPBtcache cache, const AjPStr idirectory,
+                               const AjPStr dbname, const AjPStr extension,
+                               ajuint refcount, AjBool secondary,
+                               size_t maxmem);
+static AjBool     btreeBulkRunNext(BtreePBulkrun run, const BtreePBulk bulk);
+static void       btreeBulkWriteRun(BtreePBulk bulk);
+
+static AjBool        btreeWorkerRead(BtreePWorkers workers,
+                                     EmbPBtreeEntry entry);
+static AjPFile       btreeWorkerSpool(const EmbPBtreeEntry entry, ajuint ifile,
+                                      AjBool output);
+static void          btreeWorkerWrite(BtreePWorkers workers,
+                                      const EmbPBtreeEntry entry);
+static void          btreeWorkersDel(BtreePWorkers *Pworkers);
+static BtreePWorkers btreeWorkersNew(const EmbPBtreeEntry entry);
+static void          btreeWorkersWait(BtreePWorkers workers);
+
 
 
 
@@ -74,6 +277,10 @@ void embBtreeIndexEntry(EmbPBtreeEntry entry,
     AjBool dotrunc = ajFalse;
     ajuint iref;
 
+    /* worker processes only spool the parsed entries */
+    if(entry->workers && ((BtreePWorkers) entry->workers)->Worker)
+        return;
+
     if(!indexId)
         indexId = ajBtreeIdNew(entry->refcount);
 
@@ -100,6 +307,14 @@ void embBtreeIndexEntry(EmbPBtreeEntry entry,
             ajStrTruncateLen(&entry->id,entry->idlen);
         }
 
+        if(entry->bulk)
+        {
+            btreeBulkAdd((BtreePBulk) entry->bulk, entry->id, NULL,
+                         dbno, (ajulong) entry->fpos, entry->reffpos);
+
+            return;
+        }
+
         ajStrAssignS(&indexId->id,entry->id);
         indexId->dbno = dbno;
         indexId->dups = 0;
@@ -169,7 +384,12 @@ void embBtreeIndexField(EmbPBtreeField field,
             ajStrTruncateLen(&indexWord,field->len);
         }
 
-        if(field->secondary)
+        if(field->bulk)
+        {
+            btreeBulkAdd((BtreePBulk) field->bulk, indexWord, entry->id,
+                         dbno, (ajulong) entry->fpos, entry->reffpos);
+        }
+        else if(field->secondary)
         {
             ajBtreeKeyIndex(field->cache, indexWord, entry->id);
         }
@@ -245,6 +465,14 @@ ajuint embBtreeIndexPrimary(EmbPBtreeField field,
             ajStrTruncateLen(&indexWord,field->len);
         }
 
+        if(field->bulk)
+        {
+            btreeBulkAdd((BtreePBulk) field->bulk, indexWord, NULL,
+                         dbno, (ajulong) entry->fpos, entry->reffpos);
+            ret++;
+            continue;
+        }
+
         ajStrAssignS(&indexId->id, indexWord);
         indexId->dbno = dbno;
         indexId->dups = 0;
@@ -310,7 +538,12 @@ ajuint embBtreeIndexSecondary(EmbPBtreeField field,
             ajStrTruncateLen(&indexWord,field->len);
         }
 
-        ajBtreeKeyIndex(field->cache, indexWord, entry->id);
+        if(field->bulk)
+            btreeBulkAdd((BtreePBulk) field->bulk, indexWord, entry->id,
+                         0, 0UL, NULL);
+        else
+            ajBtreeKeyIndex(field->cache, indexWord, entry->id);
+
         ret++;
     }
 
@@ -2110,6 +2343,7 @@ EmbPBtreeEntry embBtreeEntryNew(ajuint refcount)
     AJNEW0(thys);
 
     thys->do_id          = ajFalse;
+    thys->threads        = 1;
 
     thys->dbname  = ajStrNew();
     thys->dbrs    = ajStrNew();
@@ -2158,6 +2392,8 @@ void embBtreeEntryDel(EmbPBtreeEntry* pthis)
 {
     EmbPBtreeEntry thys;
     EmbPBtreeField field;
+    BtreePBulk bulk = NULL;
+    BtreePWorkers workers = NULL;
     AjPStr tmpstr = NULL;
 
     ajuint iref;
@@ -2204,6 +2440,20 @@ void embBtreeEntryDel(EmbPBtreeEntry* pthis)
 
     ajStrDel(&thys->id);
 
+    if(thys->bulk)
+    {
+        bulk = (BtreePBulk) thys->bulk;
+        btreeBulkDel(&bulk);
+        thys->bulk = NULL;
+    }
+
+    if(thys->workers)
+    {
+        workers = (BtreePWorkers) thys->workers;
+        btreeWorkersDel(&workers);
+        thys->workers = NULL;
+    }
+
     AJFREE(*pthis);
 
     return;
@@ -2212,6 +2462,48 @@ void embBtreeEntryDel(EmbPBtreeEntry* pthis)
 
 
 
+/* @func embBtreeEntrySetBulk *************************************************
+**
+** Set database entry to be bulk loaded on writing.
+**
+** Index terms are buffered and sorted, using run files in the index
+** directory when the buffers exceed the memory limit, and written to
+** each index in key order by embBtreeFlushCaches. The limit in megabytes
+** is taken from the EMBOSS_BTREEBULKMEMORY variable and shared between
+** the index files.
+**
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void embBtreeEntrySetBulk(EmbPBtreeEntry entry)
+{
+    AjPStr value = NULL;
+    ajulong megabytes = BTREEBULKMEMORY;
+    ajulong n = 0UL;
+
+    if(ajNamGetValueC("btreebulkmemory", &value))
+    {
+        if(ajStrToUlong(value, &n) && n)
+            megabytes = n;
+        else
+            ajErr("Bad value for environment variable 'BTREEBULKMEMORY'");
+    }
+
+    ajStrDel(&value);
+
+    entry->bulkmemory = megabytes * 1024 * 1024;
+
+    return;
+}
+
+
+
+
 /* @func embBtreeEntrySetCompressed *******************************************
 **
 ** Set database entry to be compressed on writing
@@ -2234,6 +2526,49 @@ void embBtreeEntrySetCompressed(EmbPBtreeEntry entry)
 
 
 
+/* @func embBtreeEntrySetThreads **********************************************
+**
+** Set the number of worker processes parsing the data files.
+**
+** With more than one worker, embBtreeWorkerSkip starts worker processes
+** which each parse a share of the data files into spool files in the
+** index directory. The indexes are built from the spool files in data
+** file order, so they are the same whatever the number of workers.
+**
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+** @param [r] threads [ajuint] Number of worker processes
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void embBtreeEntrySetThreads(EmbPBtreeEntry entry, ajuint threads)
+{
+#ifdef WIN32
+    if(threads > 1)
+        ajWarn("Worker processes are not supported in this build, "
+               "using one thread");
+
+    threads = 1;
+#endif /* WIN32 */
+
+    /* the debug file is not protected against concurrent writes */
+    if(threads > 1 && ajDebugOn())
+    {
+        ajWarn("Debug output requested, using one thread");
+        threads = 1;
+    }
+
+    entry->threads = threads;
+
+    return;
+}
+
+
+
+
 /* @func embBtreeSetFields ****************************************************
 **
 ** Set database fields to index
@@ -2849,6 +3184,7 @@ AjBool embBtreeOpenCaches(EmbPBtreeEntry entry)
     ajuint level    = 0;
     ajlong count    = 0L;
     ajlong countall = 0L;
+    size_t maxmem;
     AjIList iter;
     EmbPBtreeField field;
     
@@ -2935,6 +3271,35 @@ AjBool embBtreeOpenCaches(EmbPBtreeEntry entry)
         ajListIterDel(&iter);
     }
 
+    if(entry->bulkmemory)
+    {
+        maxmem = (size_t) (entry->bulkmemory /
+                           (ajListGetLength(entry->fields) + 1));
+
+        if(entry->do_id)
+            entry->bulk = btreeBulkNew(entry->idcache, entry->idirectory,
+                                       entry->dbname, entry->idextension,
+                                       entry->refcount, ajFalse, maxmem);
+
+        if(ajListGetLength(entry->fields))
+        {
+            iter = ajListIterNewread(entry->fields);
+
+            while(!ajListIterDone(iter))
+            {
+                field = ajListIterGet(iter);
+                field->bulk = btreeBulkNew(field->cache, entry->idirectory,
+                                           entry->dbname,
+                                           field->extension,
+                                           entry->refcount,
+                                           field->secondary,
+                                           maxmem);
+            }
+
+            ajListIterDel(&iter);
+        }
+    }
+
     return ajTrue;
 }
 
@@ -2958,6 +3323,8 @@ AjBool embBtreeCloseCaches(EmbPBtreeEntry entry)
     AjIList iter;
     EmbPBtreeField field;
 
+    embBtreeFlushCaches(entry);
+
     if(entry->do_id)
     {
 	ajBtreeCacheDel(&entry->idcache);
@@ -3048,6 +3415,8 @@ AjBool embBtreeDumpParameters(EmbPBtreeEntry entry)
     AjIList iter;
     EmbPBtreeField field;
 
+    embBtreeFlushCaches(entry);
+
     if(entry->do_id)
 	ajBtreeWriteParamsS(entry->idcache, entry->dbname,
                             entry->idextension, entry->idirectory);
@@ -3071,33 +3440,101 @@ AjBool embBtreeDumpParameters(EmbPBtreeEntry entry)
 
 
 
-/* @func embBtreeFieldNewC ****************************************************
+/* @func embBtreeFlushCaches **************************************************
 **
-** Constructor for a Btree index field
+** Write any bulk loaded index terms to the index files in key order.
 **
-** @param [r] nametxt [const char*] Name
-** @return [EmbPBtreeField] Btree field
+** Called by embBtreeDumpParameters and embBtreeCloseCaches, and
+** available to applications that report timing for the index build.
 **
-** @release 6.4.0
+** @param [u] entry [EmbPBtreeEntry] database data
+**
+** @return [AjBool] true on success
+**
+** @release 6.6.0
+** @@
 ******************************************************************************/
 
-EmbPBtreeField embBtreeFieldNewC(const char* nametxt)
+AjBool embBtreeFlushCaches(EmbPBtreeEntry entry)
 {
-    EmbPBtreeField ret = NULL;
-
-    AJNEW0(ret);
+    AjIList iter;
+    EmbPBtreeField field;
+    BtreePBulk bulk = NULL;
 
-    ajStrAssignC(&ret->name, nametxt);
-    ajStrAssignS(&ret->extension, ajBtreeFieldGetExtensionC(nametxt));
-    ret->secondary = ajBtreeFieldGetSecondaryC(nametxt);
+    if(entry->bulk)
+    {
+        bulk = (BtreePBulk) entry->bulk;
+        btreeBulkLoad(bulk);
+        btreeBulkDel(&bulk);
+        entry->bulk = NULL;
+    }
 
-    if(!ajStrGetLen(ret->extension))
+    if(ajListGetLength(entry->fields))
     {
-        ajStrAssignK(&ret->extension, 'x');
-        ajStrAppendC(&ret->extension, nametxt);
+        iter = ajListIterNewread(entry->fields);
+
+        while(!ajListIterDone(iter))
+        {
+            field = ajListIterGet(iter);
+
+            if(field->bulk)
+            {
+                bulk = (BtreePBulk) field->bulk;
+                btreeBulkLoad(bulk);
+                btreeBulkDel(&bulk);
+                field->bulk = NULL;
+            }
+        }
+
+        ajListIterDel(&iter);
     }
 
-    ret->data = ajListNew();
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic btreeBulkNew ***************************************************
+**
+** Constructor for an index bulk load buffer
+**
+** @param [u] cache [AjPBtcache] Index cache
+** @param [r] idirectory [const AjPStr] Index directory
+** @param [r] dbname [const AjPStr] Database name
+** @param [r] extension [const AjPStr] Index file extension
+** @param [r] refcount [ajuint] Number of reference files per entry,
+**                            ignored for a secondary index
+** @param [r] secondary [AjBool] True for a secondary (keyword) index
+** @param [r] maxmem [size_t] Memory limit before a sorted run is written
+**
+** @return [BtreePBulk] Bulk load buffer
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static BtreePBulk btreeBulkNew(AjPBtcache cache, const AjPStr idirectory,
+                               const AjPStr dbname, const AjPStr extension,
+                               ajuint refcount, AjBool secondary,
+                               size_t maxmem)
+{
+    BtreePBulk ret = NULL;
+
+    AJNEW0(ret);
+
+    ret->Cache      = cache;
+    ret->Runs       = ajListstrNew();
+    ret->Idirectory = ajStrNewS(idirectory);
+    ret->Runname    = ajStrNew();
+    ret->Maxmem     = maxmem;
+    ret->Secondary  = secondary;
+
+    /* secondary index terms are given no reference file offsets */
+    if(!secondary)
+        ret->Refcount = refcount;
+
+    ajFmtPrintS(&ret->Runname, "%S.%S", dbname, extension);
 
     return ret;
 }
@@ -3105,73 +3542,1168 @@ EmbPBtreeField embBtreeFieldNewC(const char* nametxt)
 
 
 
-/* @func embBtreeFieldNewS ****************************************************
+/* @funcstatic btreeBulkDel ***************************************************
 **
-** Constructor for a Btree index field
+** Destructor for an index bulk load buffer. Any run files still on disk
+** are removed.
 **
-** @param [r] name [const AjPStr] Name
-** @param [r] refcount [ajuint] Number of reference files
-** @return [EmbPBtreeField] Btree field
+** @param [d] Pbulk [BtreePBulk*] Bulk load buffer
 **
-** @release 6.4.0
+** @return [void]
+**
+** @release 6.6.0
+** @@
 ******************************************************************************/
 
-EmbPBtreeField embBtreeFieldNewS(const AjPStr name, ajuint refcount)
+static void btreeBulkDel(BtreePBulk *Pbulk)
 {
-    EmbPBtreeField ret = NULL;
+    BtreePBulk thys;
+    AjPStr runfile = NULL;
 
-    AJNEW0(ret);
+    if(!Pbulk || !*Pbulk)
+        return;
 
-    ret->name = ajStrNewS(name);
-    ret->extension = ajStrNewS(ajBtreeFieldGetExtensionS(name));
-    ret->secondary = ajBtreeFieldGetSecondaryS(name);
+    thys = *Pbulk;
 
-    if(!ajStrGetLen(ret->extension))
+    while(ajListstrPop(thys->Runs, &runfile))
     {
-        ajStrAssignK(&ret->extension, 'x');
-        ajStrAppendS(&ret->extension, name);
+        ajSysFileUnlinkS(runfile);
+        ajStrDel(&runfile);
     }
 
-    ret->maxkey = ajStrNewC("");
+    ajListstrFree(&thys->Runs);
+    ajStrDel(&thys->Idirectory);
+    ajStrDel(&thys->Runname);
 
-    ret->data = ajListNew();
+    AJFREE(thys->Recs);
+    AJFREE(thys->Text);
+    AJFREE(thys->Refs);
 
-    ret->refcount = refcount;
+    AJFREE(*Pbulk);
+    *Pbulk = NULL;
 
-    return ret;
+    return;
 }
 
 
 
 
-/* @func embBtreeFieldDel *****************************************************
+/* @funcstatic btreeBulkAdd ***************************************************
 **
-** Destructor for a Btree index field
+** Add a term to an index bulk load buffer, writing a sorted run file if
+** the buffer has reached its memory limit.
+**
+** The key is converted to the form stored in the index, so that terms
+** sort in the order the index will hold them.
+**
+** @param [u] bulk [BtreePBulk] Bulk load buffer
+** @param [r] key [const AjPStr] Key
+** @param [r] id [const AjPStr] Entry identifier for a secondary index
+** @param [r] dbno [ajuint] Data file number for a primary index
+** @param [r] offset [ajulong] Data file offset for a primary index
+** @param [r] reffpos [const ajlong*] Reference file offsets for a
+**                                    primary index, NULL for a
+**                                    secondary index
 **
-** @param [d] Pthis [EmbPBtreeField*] Btree index field object
 ** @return [void]
 **
-** @release 6.4.0
+** @release 6.6.0
+** @@
 ******************************************************************************/
 
-void embBtreeFieldDel(EmbPBtreeField *Pthis)
+static void btreeBulkAdd(BtreePBulk bulk, const AjPStr key,
+                         const AjPStr id, ajuint dbno, ajulong offset,
+                         const ajlong *reffpos)
 {
-    EmbPBtreeField  thys;
+    BtreePBulkrec rec;
+    size_t need;
+    size_t newmax;
+    size_t used;
+    ajuint keylen;
+    ajuint idlen = 0;
+    ajuint iref;
 
-    if(!Pthis) return;
+    ajStrAssignS(&indexBulkKey, key);
+    ajStrFmtQuery(&indexBulkKey);
 
-    thys = *Pthis;
+    if(MAJSTRGETLEN(indexBulkKey) > bulk->Cache->keylimit)
+        ajStrTruncateLen(&indexBulkKey, bulk->Cache->keylimit);
 
-    ajStrDel(&thys->name);
-    ajStrDel(&thys->extension);
-    ajStrDel(&thys->maxkey);
-    ajListstrFree(&thys->data);
+    keylen = MAJSTRGETLEN(indexBulkKey);
 
-    while(thys->freecount)
-        ajStrDel(&thys->freelist[--thys->freecount]);
+    if(bulk->Secondary)
+        idlen = MAJSTRGETLEN(id);
 
-    if(thys->freelist)
-        AJFREE(thys->freelist);
+    need = keylen + 1 + idlen + 1;
+
+    if(bulk->Textlen + need > bulk->Textmax)
+    {
+        newmax = 2 * bulk->Textmax;
+
+        if(newmax < bulk->Textlen + need)
+            newmax = bulk->Textlen + need;
+
+        if(newmax < 4096)
+            newmax = 4096;
+
+        AJCRESIZE(bulk->Text, newmax);
+        bulk->Textmax = newmax;
+    }
+
+    if(bulk->Nrecs == bulk->Maxrecs)
+    {
+        bulk->Maxrecs = bulk->Maxrecs ? 2 * bulk->Maxrecs : 1024;
+        AJCRESIZE(bulk->Recs, bulk->Maxrecs);
+    }
+
+    if(bulk->Refcount && bulk->Nrefs + bulk->Refcount > bulk->Maxrefs)
+    {
+        bulk->Maxrefs = bulk->Maxrefs ?
+            2 * bulk->Maxrefs : 1024 * bulk->Refcount;
+        AJCRESIZE(bulk->Refs, bulk->Maxrefs);
+    }
+
+    rec = &bulk->Recs[bulk->Nrecs++];
+
+    rec->Seq    = bulk->Seq++;
+    rec->Offset = offset;
+    rec->Text   = bulk->Textlen;
+    rec->Ref    = bulk->Nrefs;
+    rec->Dbno   = dbno;
+    rec->Keylen = keylen;
+    rec->Idlen  = idlen;
+
+    memcpy(&bulk->Text[bulk->Textlen], MAJSTRGETPTR(indexBulkKey), keylen+1);
+    bulk->Textlen += keylen+1;
+
+    if(bulk->Secondary)
+        memcpy(&bulk->Text[bulk->Textlen], MAJSTRGETPTR(id), idlen+1);
+    else
+        bulk->Text[bulk->Textlen] = '\0';
+
+    bulk->Textlen += idlen+1;
+
+    for(iref=0; iref < bulk->Refcount; iref++)
+        bulk->Refs[bulk->Nrefs++] = (ajulong) reffpos[iref];
+
+    used = bulk->Nrecs * sizeof(BtreeOBulkrec) + bulk->Textlen +
+        bulk->Nrefs * sizeof(ajulong);
+
+    if(used >= bulk->Maxmem)
+        btreeBulkWriteRun(bulk);
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeBulkCompare ***********************************************
+**
+** Sort comparison for buffered index terms: by key, then in the order
+** they were parsed so that duplicate keys keep their input order.
+**
+** @param [r] item1 [const void*] First term
+** @param [r] item2 [const void*] Second term
+**
+** @return [int] Comparison result
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static int btreeBulkCompare(const void *item1, const void *item2)
+{
+    const BtreeOBulkrec *rec1 = item1;
+    const BtreeOBulkrec *rec2 = item2;
+    int ret;
+
+    ret = strcmp(&indexBulkText[rec1->Text], &indexBulkText[rec2->Text]);
+
+    if(ret)
+        return ret;
+
+    if(rec1->Seq < rec2->Seq)
+        return -1;
+
+    if(rec1->Seq > rec2->Seq)
+        return 1;
+
+    return 0;
+}
+
+
+
+
+/* @funcstatic btreeBulkWriteRun **********************************************
+**
+** Sort the buffered terms and write them to a run file in the index
+** directory, emptying the buffer.
+**
+** @param [u] bulk [BtreePBulk] Bulk load buffer
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeBulkWriteRun(BtreePBulk bulk)
+{
+    AjPFile outf = NULL;
+    AjPStr add = NULL;
+    const BtreeOBulkrec *rec;
+    const char *text;
+    size_t i;
+    ajuint iref;
+
+    if(!bulk->Nrecs)
+        return;
+
+    indexBulkText = bulk->Text;
+    qsort(bulk->Recs, bulk->Nrecs, sizeof(BtreeOBulkrec), btreeBulkCompare);
+    indexBulkText = NULL;
+
+    ajFmtPrintS(&add, ".%Lu.tmp", (ajulong) ajListGetLength(bulk->Runs));
+    outf = btreeCreateFile(bulk->Idirectory, bulk->Runname,
+                           MAJSTRGETPTR(add));
+
+    if(!outf)
+        ajFatal("Cannot open bulk load file %S%S in '%S'",
+                bulk->Runname, add, bulk->Idirectory);
+
+    for(i=0; i < bulk->Nrecs; i++)
+    {
+        rec = &bulk->Recs[i];
+        text = &bulk->Text[rec->Text];
+
+        ajWritebinUint4(outf, rec->Keylen);
+        ajWritebinChar(outf, text, rec->Keylen);
+
+        if(bulk->Secondary)
+        {
+            ajWritebinUint4(outf, rec->Idlen);
+            ajWritebinChar(outf, &text[rec->Keylen+1], rec->Idlen);
+        }
+        else
+        {
+            ajWritebinUint4(outf, rec->Dbno);
+            ajWritebinUint8(outf, rec->Offset);
+
+            for(iref=0; iref < bulk->Refcount; iref++)
+                ajWritebinUint8(outf, bulk->Refs[rec->Ref+iref]);
+        }
+    }
+
+    ajDebug("btreeBulkWriteRun '%F' terms: %Lu\n",
+            outf, (ajulong) bulk->Nrecs);
+
+    ajListstrPushAppend(bulk->Runs, ajStrNewS(ajFileGetNameS(outf)));
+    ajFileClose(&outf);
+    ajStrDel(&add);
+
+    bulk->Nrecs   = 0;
+    bulk->Textlen = 0;
+    bulk->Nrefs   = 0;
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeBulkRunNext ***********************************************
+**
+** Read the next term from a sorted run file
+**
+** @param [u] run [BtreePBulkrun] Run file being merged
+** @param [r] bulk [const BtreePBulk] Bulk load buffer
+**
+** @return [AjBool] True if a term was read, false at the end of the run
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeBulkRunNext(BtreePBulkrun run, const BtreePBulk bulk)
+{
+    ajuint len = 0;
+    ajuint iref;
+
+    if(!ajReadbinUint4(run->File, &len))
+    {
+        run->Done = ajTrue;
+
+        return ajFalse;
+    }
+
+    ajReadbinStr(run->File, len, &run->Key);
+
+    if(bulk->Secondary)
+    {
+        ajReadbinUint4(run->File, &len);
+        ajReadbinStr(run->File, len, &run->Id);
+    }
+    else
+    {
+        ajReadbinUint4(run->File, &run->Dbno);
+        ajReadbinUint8(run->File, &run->Offset);
+
+        for(iref=0; iref < bulk->Refcount; iref++)
+            ajReadbinUint8(run->File, &run->Refs[iref]);
+    }
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic btreeBulkInsert ************************************************
+**
+** Load one term into the index of a bulk load buffer
+**
+** @param [u] bulk [BtreePBulk] Bulk load buffer
+** @param [r] key [const char*] Key
+** @param [r] id [const char*] Entry identifier for a secondary index
+** @param [r] dbno [ajuint] Data file number for a primary index
+** @param [r] offset [ajulong] Data file offset for a primary index
+** @param [r] refs [const ajulong*] Reference file offsets for a
+**                                  primary index
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeBulkInsert(BtreePBulk bulk, const char *key,
+                            const char *id, ajuint dbno,
+                            ajulong offset, const ajulong *refs)
+{
+    ajuint iref;
+
+    if(bulk->Secondary)
+    {
+        ajStrAssignC(&indexBulkKey, key);
+        ajStrAssignC(&indexWord, id);
+        ajBtreeLoadKey(bulk->Load, indexBulkKey, indexWord);
+
+        return;
+    }
+
+    if(!indexId)
+        indexId = ajBtreeIdNew(bulk->Refcount);
+
+    ajStrAssignC(&indexId->id, key);
+    indexId->dbno = dbno;
+    indexId->dups = 0;
+    indexId->offset = offset;
+    indexId->refcount = bulk->Refcount;
+
+    for(iref=0; iref < bulk->Refcount; iref++)
+        indexId->refoffsets[iref] = refs[iref];
+
+    ajBtreeLoadIdent(bulk->Load, indexId);
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeBulkLoad **************************************************
+**
+** Write all terms in a bulk load buffer to its index in key order.
+**
+** If no run files were needed the buffer is sorted in memory. Otherwise
+** the remaining terms are written as a final run and all the runs are
+** merged, reading one term at a time from each.
+**
+** The sorted terms fill the index buckets and nodes in turn, building
+** the tree bottom-up.
+**
+** @param [u] bulk [BtreePBulk] Bulk load buffer
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeBulkLoad(BtreePBulk bulk)
+{
+    BtreePBulkrun runs = NULL;
+    const BtreeOBulkrec *rec;
+    const char *text;
+    const AjPStr runname = NULL;
+    AjPStr runfile = NULL;
+    AjIList iter;
+    ajuint nruns;
+    ajuint i;
+    ajuint best;
+    size_t j;
+
+    bulk->Load = ajBtreeLoadNew(bulk->Cache);
+
+    if(!ajListGetLength(bulk->Runs))
+    {
+        indexBulkText = bulk->Text;
+        qsort(bulk->Recs, bulk->Nrecs, sizeof(BtreeOBulkrec),
+              btreeBulkCompare);
+        indexBulkText = NULL;
+
+        for(j=0; j < bulk->Nrecs; j++)
+        {
+            rec = &bulk->Recs[j];
+            text = &bulk->Text[rec->Text];
+            btreeBulkInsert(bulk, text, &text[rec->Keylen+1],
+                            rec->Dbno, rec->Offset,
+                            bulk->Refcount ? &bulk->Refs[rec->Ref] : NULL);
+        }
+
+        bulk->Nrecs   = 0;
+        bulk->Textlen = 0;
+        bulk->Nrefs   = 0;
+
+        ajBtreeLoadEnd(bulk->Load);
+        ajBtreeLoadDel(&bulk->Load);
+
+        return;
+    }
+
+    btreeBulkWriteRun(bulk);
+
+    AJFREE(bulk->Recs);
+    AJFREE(bulk->Text);
+    AJFREE(bulk->Refs);
+    bulk->Maxrecs = 0;
+    bulk->Textmax = 0;
+    bulk->Maxrefs = 0;
+
+    nruns = (ajuint) ajListGetLength(bulk->Runs);
+    AJCNEW0(runs, nruns);
+
+    iter = ajListIterNewread(bulk->Runs);
+    i = 0;
+
+    while(!ajListIterDone(iter))
+    {
+        runname = ajListIterGet(iter);
+        runs[i].File = ajFileNewInNameS(runname);
+
+        if(!runs[i].File)
+            ajFatal("Cannot open bulk load file '%S'", runname);
+
+        if(bulk->Refcount)
+            AJCNEW0(runs[i].Refs, bulk->Refcount);
+
+        btreeBulkRunNext(&runs[i], bulk);
+        i++;
+    }
+
+    ajListIterDel(&iter);
+
+    ajDebug("btreeBulkLoad '%S' merging %u runs\n", bulk->Runname, nruns);
+
+    for(;;)
+    {
+        best = nruns;
+
+        for(i=0; i < nruns; i++)
+        {
+            if(runs[i].Done)
+                continue;
+
+            if(best == nruns ||
+               strcmp(MAJSTRGETPTR(runs[i].Key),
+                      MAJSTRGETPTR(runs[best].Key)) < 0)
+                best = i;
+        }
+
+        if(best == nruns)
+            break;
+
+        btreeBulkInsert(bulk, MAJSTRGETPTR(runs[best].Key),
+                        MAJSTRGETPTR(runs[best].Id),
+                        runs[best].Dbno, runs[best].Offset, runs[best].Refs);
+        btreeBulkRunNext(&runs[best], bulk);
+    }
+
+    for(i=0; i < nruns; i++)
+    {
+        ajFileClose(&runs[i].File);
+        ajStrDel(&runs[i].Key);
+        ajStrDel(&runs[i].Id);
+        AJFREE(runs[i].Refs);
+    }
+
+    AJFREE(runs);
+
+    ajBtreeLoadEnd(bulk->Load);
+    ajBtreeLoadDel(&bulk->Load);
+
+    while(ajListstrPop(bulk->Runs, &runfile))
+    {
+        ajSysFileUnlinkS(runfile);
+        ajStrDel(&runfile);
+    }
+
+    return;
+}
+
+
+
+
+/* @func embBtreeWorkerSkip ***************************************************
+**
+** Test whether a data file is parsed by another worker process.
+**
+** Called for each data file in turn. The first call starts the worker
+** processes if more than one was set by embBtreeEntrySetThreads. A
+** worker opens a spool file for each of its own data files. The parent
+** waits until a worker has finished the data file and opens its spool
+** file to read the entries back.
+**
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+** @param [r] ifile [ajuint] Data file number
+**
+** @return [AjBool] True if the caller should skip this data file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embBtreeWorkerSkip(EmbPBtreeEntry entry, ajuint ifile)
+{
+    BtreePWorkers workers = NULL;
+#ifndef WIN32
+    ssize_t ret;
+    char done;
+#endif /* !WIN32 */
+
+    if(entry->threads < 2)
+        return ajFalse;
+
+    if(!entry->workers)
+        entry->workers = btreeWorkersNew(entry);
+
+    workers = (BtreePWorkers) entry->workers;
+
+    if(workers->Worker)
+    {
+        if(ifile % workers->Nworkers + 1 != workers->Worker)
+            return ajTrue;
+
+        workers->Spool = btreeWorkerSpool(entry, ifile, ajTrue);
+
+        return ajFalse;
+    }
+
+#ifndef WIN32
+    do
+    {
+        ret = read(workers->Fds[ifile % workers->Nworkers], &done, 1);
+    } while(ret < 0 && errno == EINTR);
+
+    if(ret != 1)
+        ajDie("Worker process %u failed to parse data file %u",
+              ifile % workers->Nworkers + 1, ifile + 1);
+#endif /* !WIN32 */
+
+    workers->Spool = btreeWorkerSpool(entry, ifile, ajFalse);
+
+    return ajFalse;
+}
+
+
+
+/* @func embBtreeWorkerIsChild ************************************************
+**
+** Test whether the caller is a worker process, which parses data files
+** into spool files and must not write any other output.
+**
+** @param [r] entry [const EmbPBtreeEntry] Database entry information
+**
+** @return [AjBool] True in a worker process
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embBtreeWorkerIsChild(const EmbPBtreeEntry entry)
+{
+    const BtreeOWorkers *workers = (const BtreeOWorkers *) entry->workers;
+
+    if(!workers)
+        return ajFalse;
+
+    if(workers->Worker)
+        return ajTrue;
+
+    return ajFalse;
+}
+
+
+
+
+/* @func embBtreeWorkerIsSpooled **********************************************
+**
+** Test whether the entries of the current data file are read from the
+** spool file of a worker process, rather than parsed by the caller.
+**
+** @param [r] entry [const EmbPBtreeEntry] Database entry information
+**
+** @return [AjBool] True if entries are read back from a worker
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embBtreeWorkerIsSpooled(const EmbPBtreeEntry entry)
+{
+    const BtreeOWorkers *workers = (const BtreeOWorkers *) entry->workers;
+
+    if(!workers || workers->Worker)
+        return ajFalse;
+
+    return ajTrue;
+}
+
+
+
+
+/* @func embBtreeWorkerNext ***************************************************
+**
+** Pass on the result of parsing the next entry of a data file.
+**
+** In a worker process a parsed entry is written to the spool file and
+** its field tokens are used up. In the parent the next entry is read
+** back from the spool file, with the id, file positions and field tokens
+** as the parser left them. Otherwise the parse result is returned.
+**
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+** @param [r] parsed [AjBool] True if the caller parsed an entry
+**
+** @return [AjBool] True if there is an entry to index
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embBtreeWorkerNext(EmbPBtreeEntry entry, AjBool parsed)
+{
+    BtreePWorkers workers = (BtreePWorkers) entry->workers;
+
+    if(!workers)
+        return parsed;
+
+    if(!workers->Worker)
+        return btreeWorkerRead(workers, entry);
+
+    if(parsed)
+        btreeWorkerWrite(workers, entry);
+
+    return parsed;
+}
+
+
+
+
+/* @func embBtreeWorkerDone ***************************************************
+**
+** Finish a data file.
+**
+** A worker process closes its spool file and tells the parent, and
+** exits after its last data file. The parent removes the spool file
+** and, after the last data file, waits for the workers to exit.
+**
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+** @param [r] ifile [ajuint] Data file number
+**
+** @return [AjBool] True in a worker process, where the caller should
+**                  skip reporting on the data file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embBtreeWorkerDone(EmbPBtreeEntry entry, ajuint ifile)
+{
+    BtreePWorkers workers = (BtreePWorkers) entry->workers;
+    AjPStr spoolname = NULL;
+
+    if(!workers)
+        return ajFalse;
+
+    if(workers->Worker)
+    {
+        ajFileClose(&workers->Spool);
+
+#ifndef WIN32
+        if(write(workers->Fd, "", 1) != 1)
+            ajExitAbort();
+
+        if(ifile + workers->Nworkers >= entry->nfiles)
+            _exit(EXIT_SUCCESS);
+#endif /* !WIN32 */
+
+        return ajTrue;
+    }
+
+    spoolname = ajStrNewS(ajFileGetNameS(workers->Spool));
+    ajFileClose(&workers->Spool);
+    ajSysFileUnlinkS(spoolname);
+    ajStrDel(&spoolname);
+
+    if(ifile + 1 >= entry->nfiles)
+        btreeWorkersWait(workers);
+
+    return ajFalse;
+}
+
+
+
+
+/* @funcstatic btreeWorkersNew ************************************************
+**
+** Start worker processes to parse the data files of a database entry
+**
+** Each worker inherits the parent state, including the parser settings,
+** and returns with its own worker number.
+**
+** Processes are used so that the dbx application parsers run unchanged.
+** They keep their line buffers and regular expressions in file statics,
+** and write each entry's id, file positions and field terms into the one
+** shared EmbPBtreeEntry. A worker has its own copy of all of this.
+**
+** @param [r] entry [const EmbPBtreeEntry] Database entry information
+**
+** @return [BtreePWorkers] Worker process state
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static BtreePWorkers btreeWorkersNew(const EmbPBtreeEntry entry)
+{
+    BtreePWorkers workers = NULL;
+#ifndef WIN32
+    int fds[2];
+    pid_t pid;
+    ajuint i;
+    ajuint j;
+#endif /* !WIN32 */
+
+    AJNEW0(workers);
+
+    workers->Nworkers = entry->threads;
+
+    if(workers->Nworkers > entry->nfiles)
+        workers->Nworkers = entry->nfiles;
+
+    workers->Nfields = (ajuint) ajListToarray(entry->fields,
+                                              (void***) &workers->Fields);
+    AJCNEW0(workers->Pids, workers->Nworkers);
+    AJCNEW0(workers->Fds, workers->Nworkers);
+
+#ifndef WIN32
+    /* the workers must not write out buffers inherited from the parent */
+    fflush(NULL);
+
+    for(i=0; i < workers->Nworkers; i++)
+    {
+        if(pipe(fds))
+            ajFatal("Cannot create pipe for worker process: %s",
+                    strerror(errno));
+
+        pid = fork();
+
+        if(pid == -1)
+            ajFatal("System fork failed");
+
+        if(!pid)
+        {
+            for(j=0; j < i; j++)
+                close(workers->Fds[j]);
+
+            close(fds[0]);
+            workers->Fd = fds[1];
+            workers->Worker = i + 1;
+
+            return workers;
+        }
+
+        close(fds[1]);
+        workers->Pids[i] = (ajint) pid;
+        workers->Fds[i] = fds[0];
+    }
+
+    ajDebug("btreeWorkersNew started %u workers for %u files\n",
+            workers->Nworkers, entry->nfiles);
+#else
+    ajFatal("Worker processes are not supported in this build");
+#endif /* !WIN32 */
+
+    return workers;
+}
+
+
+
+
+/* @funcstatic btreeWorkersDel ************************************************
+**
+** Destructor for worker process state
+**
+** @param [d] Pworkers [BtreePWorkers*] Worker process state
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeWorkersDel(BtreePWorkers *Pworkers)
+{
+    BtreePWorkers workers = *Pworkers;
+#ifndef WIN32
+    ajuint i;
+#endif /* !WIN32 */
+
+    if(!workers)
+        return;
+
+    ajFileClose(&workers->Spool);
+
+#ifndef WIN32
+    if(!workers->Worker)
+        for(i=0; i < workers->Nworkers; i++)
+            close(workers->Fds[i]);
+#endif /* !WIN32 */
+
+    AJFREE(workers->Fields);
+    AJFREE(workers->Pids);
+    AJFREE(workers->Fds);
+    AJFREE(*Pworkers);
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeWorkersWait ***********************************************
+**
+** Wait for the worker processes to exit after the last data file
+**
+** @param [u] workers [BtreePWorkers] Worker process state
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeWorkersWait(BtreePWorkers workers)
+{
+#ifndef WIN32
+    pid_t retval;
+    int status = 0;
+    ajuint i;
+
+    for(i=0; i < workers->Nworkers; i++)
+    {
+        if(!workers->Pids[i])
+            continue;
+
+        while((retval=waitpid((pid_t) workers->Pids[i], &status, 0)) !=
+              (pid_t) workers->Pids[i])
+        {
+            if(retval == -1)
+                if(errno != EINTR)
+                    break;
+        }
+
+        if(retval == -1 || !WIFEXITED(status) || WEXITSTATUS(status))
+            ajDie("Worker process %u failed", i + 1);
+
+        workers->Pids[i] = 0;
+    }
+#else
+    (void) workers;
+#endif /* !WIN32 */
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeWorkerSpool ***********************************************
+**
+** Open the spool file for a data file in the index directory
+**
+** @param [r] entry [const EmbPBtreeEntry] Database entry information
+** @param [r] ifile [ajuint] Data file number
+** @param [r] output [AjBool] True to create the file for writing
+**
+** @return [AjPFile] Spool file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjPFile btreeWorkerSpool(const EmbPBtreeEntry entry, ajuint ifile,
+                                AjBool output)
+{
+    AjPStr filename = NULL;
+    AjPFile spool = NULL;
+
+    if(!ajStrGetLen(entry->idirectory))
+        ajFmtPrintS(&filename, "%S.%u.spool", entry->dbname, ifile);
+    else
+        ajFmtPrintS(&filename, "%S%s%S.%u.spool",
+                    entry->idirectory, SLASH_STRING, entry->dbname, ifile);
+
+    if(output)
+        spool = ajFileNewOutNameS(filename);
+    else
+        spool = ajFileNewInNameS(filename);
+
+    if(!spool)
+        ajFatal("Cannot open spool file %S", filename);
+
+    ajStrDel(&filename);
+
+    return spool;
+}
+
+
+
+
+/* @funcstatic btreeWorkerWrite ***********************************************
+**
+** Write a parsed entry to the spool file of a worker process, using up
+** the field tokens
+**
+** @param [u] workers [BtreePWorkers] Worker process state
+** @param [r] entry [const EmbPBtreeEntry] Database entry information
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void btreeWorkerWrite(BtreePWorkers workers,
+                             const EmbPBtreeEntry entry)
+{
+    EmbPBtreeField field;
+    ajuint ifield;
+    ajuint iref;
+
+    ajWritebinUint8(workers->Spool, (ajulong) entry->fpos);
+
+    for(iref=0; iref < entry->refcount; iref++)
+        ajWritebinUint8(workers->Spool, (ajulong) entry->reffpos[iref]);
+
+    ajWritebinUint4(workers->Spool, MAJSTRGETLEN(entry->id));
+    ajWritebinChar(workers->Spool, MAJSTRGETPTR(entry->id),
+                   MAJSTRGETLEN(entry->id));
+
+    for(ifield=0; ifield < workers->Nfields; ifield++)
+    {
+        field = workers->Fields[ifield];
+
+        ajWritebinUint4(workers->Spool,
+                        (ajuint) ajListGetLength(field->data));
+
+        while(embBtreeFieldGetdataS(field, &indexWord))
+        {
+            ajWritebinUint4(workers->Spool, MAJSTRGETLEN(indexWord));
+            ajWritebinChar(workers->Spool, MAJSTRGETPTR(indexWord),
+                           MAJSTRGETLEN(indexWord));
+        }
+    }
+
+    return;
+}
+
+
+
+
+/* @funcstatic btreeWorkerRead ************************************************
+**
+** Read the next entry from the spool file of a worker process
+**
+** @param [u] workers [BtreePWorkers] Worker process state
+** @param [u] entry [EmbPBtreeEntry] Database entry information
+**
+** @return [AjBool] True if an entry was read, false at the end of the file
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool btreeWorkerRead(BtreePWorkers workers,
+                              EmbPBtreeEntry entry)
+{
+    EmbPBtreeField field;
+    AjPStr str = NULL;
+    ajulong pos = 0UL;
+    ajuint len = 0;
+    ajuint ntokens = 0;
+    ajuint ifield;
+    ajuint iref;
+    ajuint i;
+
+    if(!ajReadbinUint8(workers->Spool, &pos))
+        return ajFalse;
+
+    entry->fpos = (ajlong) pos;
+
+    for(iref=0; iref < entry->refcount; iref++)
+    {
+        ajReadbinUint8(workers->Spool, &pos);
+        entry->reffpos[iref] = (ajlong) pos;
+    }
+
+    ajReadbinUint4(workers->Spool, &len);
+    ajReadbinStr(workers->Spool, len, &entry->id);
+
+    for(ifield=0; ifield < workers->Nfields; ifield++)
+    {
+        field = workers->Fields[ifield];
+
+        ajReadbinUint4(workers->Spool, &ntokens);
+
+        for(i=0; i < ntokens; i++)
+        {
+            if(field->freecount)
+                str = field->freelist[--field->freecount];
+
+            ajReadbinUint4(workers->Spool, &len);
+            ajReadbinStr(workers->Spool, len, &str);
+            ajListstrPushAppend(field->data, str);
+            str = NULL;
+        }
+    }
+
+    return ajTrue;
+}
+
+
+
+
+/* @func embBtreeFieldNewC ****************************************************
+**
+** Constructor for a Btree index field
+**
+** @param [r] nametxt [const char*] Name
+** @return [EmbPBtreeField] Btree field
+**
+** @release 6.4.0
+******************************************************************************/
+
+EmbPBtreeField embBtreeFieldNewC(const char* nametxt)
+{
+    EmbPBtreeField ret = NULL;
+
+    AJNEW0(ret);
+
+    ajStrAssignC(&ret->name, nametxt);
+    ajStrAssignS(&ret->extension, ajBtreeFieldGetExtensionC(nametxt));
+    ret->secondary = ajBtreeFieldGetSecondaryC(nametxt);
+
+    if(!ajStrGetLen(ret->extension))
+    {
+        ajStrAssignK(&ret->extension, 'x');
+        ajStrAppendC(&ret->extension, nametxt);
+    }
+
+    ret->data = ajListNew();
+
+    return ret;
+}
+
+
+
+
+/* @func embBtreeFieldNewS ****************************************************
+**
+** Constructor for a Btree index field
+**
+** @param [r] name [const AjPStr] Name
+** @param [r] refcount [ajuint] Number of reference files
+** @return [EmbPBtreeField] Btree field
+**
+** @release 6.4.0
+******************************************************************************/
+
+EmbPBtreeField embBtreeFieldNewS(const AjPStr name, ajuint refcount)
+{
+    EmbPBtreeField ret = NULL;
+
+    AJNEW0(ret);
+
+    ret->name = ajStrNewS(name);
+    ret->extension = ajStrNewS(ajBtreeFieldGetExtensionS(name));
+    ret->secondary = ajBtreeFieldGetSecondaryS(name);
+
+    if(!ajStrGetLen(ret->extension))
+    {
+        ajStrAssignK(&ret->extension, 'x');
+        ajStrAppendS(&ret->extension, name);
+    }
+
+    ret->maxkey = ajStrNewC("");
+
+    ret->data = ajListNew();
+
+    ret->refcount = refcount;
+
+    return ret;
+}
+
+
+
+
+/* @func embBtreeFieldDel *****************************************************
+**
+** Destructor for a Btree index field
+**
+** @param [d] Pthis [EmbPBtreeField*] Btree index field object
+** @return [void]
+**
+** @release 6.4.0
+******************************************************************************/
+
+void embBtreeFieldDel(EmbPBtreeField *Pthis)
+{
+    EmbPBtreeField  thys;
+    BtreePBulk bulk = NULL;
+
+    if(!Pthis) return;
+
+    thys = *Pthis;
+
+    ajStrDel(&thys->name);
+    ajStrDel(&thys->extension);
+    ajStrDel(&thys->maxkey);
+    ajListstrFree(&thys->data);
+
+    while(thys->freecount)
+        ajStrDel(&thys->freelist[--thys->freecount]);
+
+    if(thys->freelist)
+        AJFREE(thys->freelist);
+
+    if(thys->bulk)
+    {
+        bulk = (BtreePBulk) thys->bulk;
+        btreeBulkDel(&bulk);
+        thys->bulk = NULL;
+    }
 
     AJFREE(*Pthis);
     *Pthis = NULL;
@@ -3268,6 +4800,7 @@ void embIndexExit(void)
     ajStrTokenDel(&embindexHandle);
 
     ajStrDel(&indexWord);
+    ajStrDel(&indexBulkKey);
     ajBtreeIdDel(&indexId);
 
     return;
@@ -79,12 +79,19 @@ AJ_BEGIN_DECLS
 ** @attr fields [AjPList] EMBOSS index field structures
 ** @attr id [AjPStr] Entry identifier
 ** @attr idcache [AjPBtcache] Id cache structure
+** @attr bulk [void*] Private bulk load buffer for the id index,
+**                    NULL unless bulk loading
+** @attr bulkmemory [ajulong] Memory limit in bytes for bulk loading,
+**                            zero to insert terms as they are parsed
+** @attr workers [void*] Private worker process state, NULL unless data
+**                       files are parsed in parallel
 ** @attr pripagecount [ajlong] Cache primary page count
 ** @attr secpagecount [ajlong] Cache secondary page count
 ** @attr do_id [AjBool] If true, build id index
 ** @attr compressed [AjBool] If true, compress id index
 ** @attr nfiles [ajuint] Data file count
 ** @attr refcount [ajuint] Reference file(s) for each entry
+** @attr threads [ajuint] Number of worker processes parsing data files
 ** @attr idlen [ajuint] Maximum id length in index
 ** @attr idmaxlen [ajuint] Maximum id length in data
 ** @attr idtruncate [ajuint] Number of ids truncated
@@ -119,6 +126,9 @@ typedef struct EmbSBtreeEntry
 
     AjPStr id;
     AjPBtcache idcache;
+    void *bulk;
+    ajulong bulkmemory;
+    void *workers;
     ajlong pripagecount;
     ajlong secpagecount;
 
@@ -128,6 +138,7 @@ typedef struct EmbSBtreeEntry
     ajuint nfiles;
 
     ajuint refcount;
+    ajuint threads;
 
     ajuint idlen;
     ajuint idmaxlen;
@@ -166,6 +177,7 @@ typedef struct EmbSBtreeEntry
 ** @attr extension [AjPStr] File extension
 ** @attr maxkey    [AjPStr] Longest keyword found
 ** @attr freelist  [AjPStr*] Free data elements for reuse
+** @attr bulk      [void*] Private bulk load buffer, NULL unless bulk loading
 ** @attr pripagecount [ajulong] Index primary page count
 ** @attr secpagecount [ajulong] Index secondary page count
 ** @attr pripagesize  [ajuint] Index primary page size
@@ -196,6 +208,7 @@ typedef struct EmbSBtreeField
     AjPStr extension;
     AjPStr maxkey;
     AjPStr *freelist;
+    void *bulk;
     ajulong pripagecount;
     ajulong secpagecount;
     ajuint pripagesize;
@@ -284,7 +297,9 @@ void   embBtreeFastaSV(const AjPStr kwline, AjPList kwlist, ajuint maxlen);
 ajuint  embBtreeReadDir(AjPStr **filelist, const AjPStr fdirectory,
 		       const AjPStr files, const AjPStr exclude);
 EmbPBtreeEntry embBtreeEntryNew(ajuint refcount);
+void           embBtreeEntrySetBulk(EmbPBtreeEntry entry);
 void           embBtreeEntrySetCompressed(EmbPBtreeEntry entry);
+void           embBtreeEntrySetThreads(EmbPBtreeEntry entry, ajuint threads);
 ajuint         embBtreeSetFields(EmbPBtreeEntry entry, AjPStr const * fields);
 void           embBtreeEntryDel(EmbPBtreeEntry *thys);
 void           embBtreeSetDbInfo(EmbPBtreeEntry entry, const AjPStr name,
@@ -299,6 +314,12 @@ void           embBtreeGetRsInfo(EmbPBtreeEntry entry);
 AjBool         embBtreeOpenCaches(EmbPBtreeEntry entry);
 AjBool         embBtreeCloseCaches(EmbPBtreeEntry entry);
 AjBool         embBtreeDumpParameters(EmbPBtreeEntry entry);
+AjBool         embBtreeFlushCaches(EmbPBtreeEntry entry);
+AjBool         embBtreeWorkerDone(EmbPBtreeEntry entry, ajuint ifile);
+AjBool         embBtreeWorkerIsChild(const EmbPBtreeEntry entry);
+AjBool         embBtreeWorkerIsSpooled(const EmbPBtreeEntry entry);
+AjBool         embBtreeWorkerNext(EmbPBtreeEntry entry, AjBool parsed);
+AjBool         embBtreeWorkerSkip(EmbPBtreeEntry entry, ajuint ifile);
 
 EmbPBtreeField embBtreeFieldNewC(const char* nametxt);
 EmbPBtreeField embBtreeFieldNewS(const AjPStr name, ajuint refcount);
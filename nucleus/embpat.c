@@ -74,6 +74,7 @@ static PatOTypes patTypes[] =
   {"Regex",   "Prosite converted to regex"},
   {"TUB",     "Tarhio-Ukkonen-Bleasby"},
   {"OUB",     "Brute force processing"},
+  {"WM",      "Wu-Manber bit-parallel mismatch pattern"},
   {NULL, NULL}
 };
 
@@ -109,6 +110,34 @@ static void    patRestrictPushHit(const EmbPPatRestrict enz,
 				 AjBool forward, AjBool plasmid);
 static void    patRestrictMethylMod(AjPStr *str, AjPStr *rstr,
                                     AjPList methlist);
+static void    patRestrictScanLimits(const EmbPPatRestrict enz, ajuint len,
+                                      AjBool plasmid,
+                                      ajuint *limit, ajint *mincut);
+static ajuint  patRestrictScanPos(const EmbPPatRestrict enz, const char *p,
+                                   ajuint i, ajuint len, ajuint limit,
+                                   ajint mincut, AjBool ambiguity,
+                                   AjBool plasmid, AjBool forward,
+                                   ajuint begin, AjPList tx);
+static ajuint  patRestrictScanSort(AjPList tx, ajuint hits,
+                                    ajuint min, ajuint max, AjPList l);
+static AjBool  patRestrictAnchor(const EmbPPatRestrict enz,
+                                  AjBool ambiguity,
+                                  AjPStr *Panchor, ajuint *Poffset);
+static ajuint  patRestrictScanCand(const EmbPPatRestrict enz,
+                                    const char *p,
+                                    const AjPUint cand, ajuint ncand,
+                                    const AjPUint amb, ajuint namb,
+                                    ajuint offset, ajuint alen, ajuint len,
+                                    AjBool ambiguity, AjBool plasmid,
+                                    AjBool forward, ajuint begin,
+                                    AjPList tx);
+static ajuint  patRestrictScanAll(const AjPList enzlist,
+                                   const AjPStr substr, const AjPStr binstr,
+                                   const AjPStr revstr, const AjPStr binrev,
+                                   ajuint len, AjBool ambiguity,
+                                   AjBool plasmid, ajuint min, ajuint max,
+                                   ajuint begin, AjPList l);
+static void    patUintAppend(AjPUint *thys, ajuint elem, ajuint v);
 static AjPList patRestrictReadMethyl(AjPFile methfile);
 
 
@@ -1570,191 +1599,143 @@ static void patRestrictMethylMod(AjPStr *Pstr, AjPStr *Prstr, AjPList methlist)
 
 
 
-/* @func embPatRestrictScan ***************************************************
+/* @funcstatic patRestrictScanLimits ******************************************
 **
-** Scan a sequence with a restriction object
+** Last start position and minimum cut offset for scanning a sequence
+** with a restriction enzyme
 **
-** @param [r] enz [const EmbPPatRestrict] Enyme information
-** @param [r] substr [const AjPStr] Sequence as ASCII
-** @param [r] binstr [const AjPStr] Sequence as binary IUB
-** @param [r] revstr [const AjPStr] Sequence as ASCII reversed
-** @param [r] binrev [const AjPStr] Sequence as binary IUB reversed
+** @param [r] enz [const EmbPPatRestrict] Enzyme information
 ** @param [r] len [ajuint] Length of sequence
-** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
 ** @param [r] plasmid [AjBool] Allow circular DNA
-** @param [r] min [ajuint] Minimum # of matches allowed
-** @param [r] max [ajuint] Maximum # of matches
-** @param [r] begin [ajuint] Sequence offset
-** @param [u] l [AjPList] List to push hits to
+** @param [w] limit [ajuint*] Number of start positions to scan
+** @param [w] mincut [ajint*] Minimum cut offset
 **
-** @return [ajuint] Number of matches
+** @return [void]
 **
-** @release 1.0.0
+** @release 6.6.0
 ******************************************************************************/
 
-ajuint embPatRestrictScan(const EmbPPatRestrict enz,
-			 const AjPStr substr, const AjPStr binstr,
-			 const AjPStr revstr, const AjPStr binrev, ajuint len,
-			 AjBool ambiguity, AjBool plasmid, ajuint min,
-			 ajuint max, ajuint begin, AjPList l)
+static void patRestrictScanLimits(const EmbPPatRestrict enz, ajuint len,
+                                  AjBool plasmid,
+                                  ajuint *limit, ajint *mincut)
 {
-    ajuint limit;
-    ajuint i;
-    ajuint j;
-    ajuint hits;
-    ajuint rhits = 0;
-    const char *p;
-    const char *q;
-    const char *t;
-    ajint  mincut;
-    ajint  maxcut;
-    AjBool forward;
-    ajint  v;
-    AjPList tx     = NULL;
-    AjPList ty     = NULL;
-    EmbPMatMatch m = NULL;
-    EmbPMatMatch z = NULL;
-
-    if(len < enz->len)
-        return 0;
-
     if(plasmid)
-	limit=len;
+	*limit = len;
     else
-	limit=len-enz->len+1;
-
-    mincut=AJMIN(enz->cut1,enz->cut2);
-
-    if(enz->ncuts==4)
-    {
-	mincut=AJMIN(mincut,enz->cut3);
-	mincut=AJMIN(mincut,enz->cut4);
-    }
+	*limit = len-enz->len+1;
 
-    maxcut=AJMAX(enz->cut1,enz->cut2);
+    *mincut = AJMIN(enz->cut1,enz->cut2);
 
     if(enz->ncuts==4)
     {
-	maxcut=AJMAX(maxcut,enz->cut3);
-	maxcut=AJMAX(maxcut,enz->cut4);
+	*mincut = AJMIN(*mincut,enz->cut3);
+	*mincut = AJMIN(*mincut,enz->cut4);
     }
 
-    ajDebug("embPatRestrictScan '%S' '%S' ncuts:%d blunt:%b\n",
-	    enz->cod, enz->pat, enz->ncuts, enz->blunt);
-    /* ajDebug("cut1:%d 2:%d 3:%d 4:%d\n",
-	    enz->cut1, enz->cut2, enz->cut3, enz->cut4 ); */
-
-    tx = ajListNew();
-    ty = ajListNew();
-
-    if(ambiguity)
-    {
-	p = ajStrGetPtr(binstr);
-	t = ajStrGetPtr(enz->bin);
-
-	forward = ajTrue;
-
-	for(i=0,hits=0;i<limit;++i)
-	{
-	    for(j=0,q=t;j<enz->len;++j,++q)
-	    {
-		v=*(p+i+j);
+    return;
+}
 
-		if(!(*q & v) || v==15)
-		    break;
-	    }
 
-	    if(j==enz->len && !plasmid && (i+enz->cut1>=len ||
-					      i+enz->cut2>=len))
-		continue;
 
-	    if(j==enz->len && (plasmid || i+mincut+1>0) && i<limit)
-	    {
-		++hits;
-		patRestrictPushHit(enz,tx,i,begin,len,forward, plasmid);
-	    }
 
-	}
+/* @funcstatic patRestrictScanPos *********************************************
+**
+** Test a restriction enzyme site at one sequence position and push
+** the hit if it matches and cuts within the sequence
+**
+** @param [r] enz [const EmbPPatRestrict] Enzyme information
+** @param [r] p [const char*] Sequence as ASCII or as binary IUB
+** @param [r] i [ajuint] Start position
+** @param [r] len [ajuint] Length of sequence
+** @param [r] limit [ajuint] Number of start positions to scan
+** @param [r] mincut [ajint] Minimum cut offset
+** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
+** @param [r] plasmid [AjBool] Allow circular DNA
+** @param [r] forward [AjBool] True if forward strand
+** @param [r] begin [ajuint] Sequence offset
+** @param [u] tx [AjPList] List to push hits to
+**
+** @return [ajuint] 1 if a hit was pushed, else 0
+**
+** @release 6.6.0
+******************************************************************************/
 
-	forward = ajFalse;
-	p = ajStrGetPtr(binrev);
+static ajuint patRestrictScanPos(const EmbPPatRestrict enz, const char *p,
+                                 ajuint i, ajuint len, ajuint limit,
+                                 ajint mincut, AjBool ambiguity,
+                                 AjBool plasmid, AjBool forward,
+                                 ajuint begin, AjPList tx)
+{
+    const char *q;
+    ajuint j;
+    ajint  v;
 
-	for(i=0;i<limit;++i)
+    if(ambiguity)
+    {
+	for(j=0,q=ajStrGetPtr(enz->bin);j<enz->len;++j,++q)
 	{
-	    for(j=0,q=t;j<enz->len;++j,++q)
-	    {
-		v = *(p+i+j);
-
-		if(!(*q & v) || v==15)
-		    break;
-	    }
-
-	    if(j==enz->len && !plasmid && (i+enz->cut1>=len ||
-					      i+enz->cut2>=len))
-		continue;
-
-	    if(j==enz->len && (plasmid || i+mincut+1>0) && i<limit)
-	    {
-		++hits;
-		patRestrictPushHit(enz,tx,i,begin,len,forward, plasmid);
-	    }
+	    v = *(p+i+j);
 
+	    if(!(*q & v) || v==15)
+		break;
 	}
-
     }
     else
     {
-	p = ajStrGetPtr(substr);
-	t = ajStrGetPtr(enz->pat);
-	forward = ajTrue;
-
-	for(i=0,hits=0;i<limit;++i)
+	for(j=0,q=ajStrGetPtr(enz->pat);j<enz->len;++j,++q)
 	{
-	    for(j=0,q=t;j<enz->len;++j,++q)
-	    {
-		v=*(p+i+j);
+	    v = *(p+i+j);
 
-		if(*q != v || v=='N')
-		    break;
-	    }
+	    if(*q != v || v=='N')
+		break;
+	}
+    }
 
-	    if(j==enz->len && !plasmid && (i+enz->cut1>=len ||
-					      i+enz->cut2>=len))
-		continue;
+    if(j==enz->len && !plasmid && (i+enz->cut1>=len ||
+				      i+enz->cut2>=len))
+	return 0;
 
-	    if(j==enz->len && (plasmid || i+mincut+1>0) && i<limit)
-	    {
-		++hits;
-		patRestrictPushHit(enz,tx,i,begin,len,forward, plasmid);
-	    }
+    if(j==enz->len && (plasmid || i+mincut+1>0) && i<limit)
+    {
+	patRestrictPushHit(enz,tx,i,begin,len,forward, plasmid);
 
-	}
+	return 1;
+    }
 
-	forward = ajFalse;
-	p = ajStrGetPtr(revstr);
+    return 0;
+}
 
-	for(i=0;i<limit;++i)
-	{
-	    for(j=0,q=t;j<enz->len;++j,++q)
-	    {
-		v = *(p+i+j);
 
-		if(*q != v || v=='N')
-		    break;
-	    }
 
-	    if(j==enz->len && !plasmid && (i+enz->cut1>=len ||
-					      i+enz->cut2>=len))
-		continue;
 
-	    if(j==enz->len && (plasmid || i+mincut+1>0) && i<limit)
-	    {
-		++hits;
-		patRestrictPushHit(enz,tx,i,begin,len,forward, plasmid);
-	    }
-	}
-    }
+/* @funcstatic patRestrictScanSort ********************************************
+**
+** Sort the hits of one restriction enzyme by cut position, remove
+** hits at the same cut and keep them only if the number of cuts is
+** within the allowed range
+**
+** @param [u] tx [AjPList] Hits of one enzyme, freed on return
+** @param [r] hits [ajuint] Number of hits
+** @param [r] min [ajuint] Minimum # of matches allowed
+** @param [r] max [ajuint] Maximum # of matches
+** @param [u] l [AjPList] List to push hits to
+**
+** @return [ajuint] Number of hits kept
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajuint patRestrictScanSort(AjPList tx, ajuint hits,
+                                  ajuint min, ajuint max, AjPList l)
+{
+    ajuint i;
+    ajuint rhits = 0;
+    ajint  v;
+    AjPList ty     = NULL;
+    EmbPMatMatch m = NULL;
+    EmbPMatMatch z = NULL;
 
+    ty = ajListNew();
 
     if(hits)
     {
@@ -1810,124 +1791,552 @@ ajuint embPatRestrictScan(const EmbPPatRestrict enz,
 
 
 
-/* @func embPatKMPInit ********************************************************
+/* @funcstatic patRestrictAnchor **********************************************
 **
-** Initialise a Knuth-Morris-Pratt pattern.
+** Choose the part of a restriction site that every matching sequence
+** must contain exactly. Without ambiguity this is the whole site. With
+** ambiguity it is the longest run of single bases, as binary IUB codes.
 **
-** @param [r] pat [const AjPStr] pattern
-** @param [r] len [ajuint] length of pattern
-** @param [w] next [ajint *] offset table
+** @param [r] enz [const EmbPPatRestrict] Enzyme information
+** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
+** @param [w] Panchor [AjPStr*] Anchor word
+** @param [w] Poffset [ajuint*] Anchor offset in the site
 **
-** @return [void]
+** @return [AjBool] False if the site has no single base
 **
-** @release 1.0.0
+** @release 6.6.0
 ******************************************************************************/
 
-void embPatKMPInit(const AjPStr pat, ajuint len, ajint *next)
+static AjBool patRestrictAnchor(const EmbPPatRestrict enz, AjBool ambiguity,
+                                AjPStr *Panchor, ajuint *Poffset)
 {
-    ajuint i;
-    ajint k;
-    ajuint t;
-    const char *p;
-
-    p = ajStrGetPtr(pat);
-    t = len-1;
-
-    i = 0;
-    k = -1;
-    next[0] = -1;
+    const char *q;
+    ajuint j;
+    ajuint run = 0;
+    ajuint best = 0;
+    ajuint bestend = 0;
 
-    while(i<t)
+    if(!ambiguity)
     {
-	while(k>=0 && p[i]!=p[k])
-	    k = next[k];
+	ajStrAssignSubS(Panchor,enz->pat,0,enz->len-1);
+	*Poffset = 0;
 
-	++i;
-	++k;
+	return ajTrue;
+    }
 
-	if(p[i]==p[k])
-	    next[i] = next[k];
+    q = ajStrGetPtr(enz->bin);
+
+    for(j=0;j<enz->len;++j)
+    {
+	if(q[j]==1 || q[j]==2 || q[j]==4 || q[j]==8)
+	{
+	    if(++run > best)
+	    {
+		best = run;
+		bestend = j;
+	    }
+	}
 	else
-	    next[i] = k;
+	    run = 0;
     }
 
-    return;
+    if(!best)
+	return ajFalse;
+
+    *Poffset = bestend+1-best;
+    ajStrAssignSubS(Panchor,enz->bin,*Poffset,bestend);
+
+    return ajTrue;
 }
 
 
 
 
-/* @func embPatKMPSearch ******************************************************
+/* @funcstatic patRestrictScanCand ********************************************
 **
-** Perform a Knuth-Morris-Pratt search
+** Test the candidate start positions of one enzyme on one strand: the
+** occurrences of its anchor, and the windows whose anchor holds an
+** ambiguity code
 **
-** @param [r] str [const AjPStr] string to search
-** @param [r] pat [const AjPStr] pattern to use
-** @param [r] slen [ajuint] length of string
-** @param [r] plen [ajuint] length of pattern
-** @param [r] next [const ajint *] array from embPatKMPInit (can be -1)
-** @param [r] start [ajuint] position within str to start search
+** @param [r] enz [const EmbPPatRestrict] Enzyme information
+** @param [r] p [const char*] Sequence as ASCII or as binary IUB
+** @param [r] cand [const AjPUint] Anchor start positions
+** @param [r] ncand [ajuint] Number of anchor start positions
+** @param [r] amb [const AjPUint] Positions of ambiguity codes
+** @param [r] namb [ajuint] Number of ambiguity code positions
+** @param [r] offset [ajuint] Anchor offset in the site
+** @param [r] alen [ajuint] Anchor length
+** @param [r] len [ajuint] Length of sequence
+** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
+** @param [r] plasmid [AjBool] Allow circular DNA
+** @param [r] forward [AjBool] True if forward strand
+** @param [r] begin [ajuint] Sequence offset
+** @param [u] tx [AjPList] List to push hits to
 **
-** @return [ajuint] Index of match in str or -1 if not found
+** @return [ajuint] Number of hits
 **
-** @release 1.0.0
+** @release 6.6.0
 ******************************************************************************/
 
-ajuint embPatKMPSearch(const AjPStr str, const AjPStr pat,
-		      ajuint slen, ajuint plen, const ajint *next,
-		      ajuint start)
+static ajuint patRestrictScanCand(const EmbPPatRestrict enz, const char *p,
+                                  const AjPUint cand, ajuint ncand,
+                                  const AjPUint amb, ajuint namb,
+                                  ajuint offset, ajuint alen, ajuint len,
+                                  AjBool ambiguity, AjBool plasmid,
+                                  AjBool forward, ajuint begin, AjPList tx)
 {
-    ajuint i;
-    ajint j;
-    const char *p;
-    const char *q;
+    ajuint limit;
+    ajint  mincut;
+    ajuint hits = 0;
+    ajuint ic = 0;
+    ajuint ia = 0;
+    ajuint x;
+    ajuint a = 0;
+    ajuint lo = 0;
+    ajuint hi = 0;
+    ajuint next = 0;
+    AjBool isa;
 
-    p = ajStrGetPtr(str);
-    q = ajStrGetPtr(pat);
+    patRestrictScanLimits(enz,len,plasmid,&limit,&mincut);
 
-    i = start;
-    j = 0;
+    /*
+    ** Merge the anchor occurrences with the starts [lo,hi) whose anchor
+    ** holds an ambiguity code. The two never share a start, as an
+    ** anchor only matches single bases.
+    */
 
-    while(i<slen && j<(ajint)plen)
+    for(;;)
     {
-	while(j>=0 && p[i]!=q[j])
-	    j = next[j];
+	while(lo >= hi && ia < namb)
+	{
+	    x = ajUintGet(amb,ia++);
 
-	++i;
-	++j;
-    }
+	    if(x < offset)
+		continue;
 
-    if(j==(ajint)plen)
-	return i-plen;
+	    hi = x - offset + 1;
+	    lo = (x + 1 >= offset + alen) ? x + 1 - offset - alen : 0;
 
-    return -1;
-}
+	    if(lo < next)
+		lo = next;
 
+	    if(hi > limit)
+		hi = limit;
+	}
 
+	isa = ajFalse;
 
+	while(ic < ncand)
+	{
+	    x = ajUintGet(cand,ic);
 
-/* @func embPatBMHInit ********************************************************
-**
-** Initialise a Boyer-Moore-Horspool pattern.
-**
-** @param [r] pat [const AjPStr] pattern
-** @param [r] len [ajuint] pattern length
-** @param [w] skip [ajint *] offset table (can be -1)
-**
-** @return [void]
-**
-** @release 1.0.0
-******************************************************************************/
+	    if(x < offset)
+	    {
+		++ic;
+		continue;
+	    }
 
-void embPatBMHInit(const AjPStr pat, ajuint len, ajint *skip)
-{
-    ajuint i;
-    ajuint t;
-    const char *p;
+	    if(x - offset >= limit)
+		ic = ncand;
+	    else
+	    {
+		a = x - offset;
+		isa = ajTrue;
+	    }
 
-    p = ajStrGetPtr(pat);
+	    break;
+	}
 
-    t = len-1;
+	if(lo < hi && (!isa || lo < a))
+	{
+	    hits += patRestrictScanPos(enz,p,lo,len,limit,mincut,
+				       ambiguity,plasmid,forward,begin,tx);
+	    next = ++lo;
+	}
+	else if(isa)
+	{
+	    hits += patRestrictScanPos(enz,p,a,len,limit,mincut,
+				       ambiguity,plasmid,forward,begin,tx);
+	    ++ic;
+	}
+	else
+	    break;
+    }
+
+    return hits;
+}
+
+
+
+
+/* @funcstatic patRestrictScanAll *********************************************
+**
+** Scan a sequence with a list of restriction enzymes in one pass per
+** strand. The anchors of all sites are found by one multiple pattern
+** automaton and only their positions are tested. Hits are added to the
+** list enzyme by enzyme, as embPatRestrictScan would for each in turn.
+**
+** @param [r] enzlist [const AjPList] Enzymes
+** @param [r] substr [const AjPStr] Sequence as ASCII
+** @param [r] binstr [const AjPStr] Sequence as binary IUB
+** @param [r] revstr [const AjPStr] Sequence as ASCII reversed
+** @param [r] binrev [const AjPStr] Sequence as binary IUB reversed
+** @param [r] len [ajuint] Length of sequence
+** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
+** @param [r] plasmid [AjBool] Allow circular DNA
+** @param [r] min [ajuint] Minimum # of matches allowed
+** @param [r] max [ajuint] Maximum # of matches
+** @param [r] begin [ajuint] Sequence offset
+** @param [u] l [AjPList] List to push hits to
+**
+** @return [ajuint] Number of matches
+**
+** @release 6.6.0
+******************************************************************************/
+
+static ajuint patRestrictScanAll(const AjPList enzlist,
+                                 const AjPStr substr, const AjPStr binstr,
+                                 const AjPStr revstr, const AjPStr binrev,
+                                 ajuint len, AjBool ambiguity,
+                                 AjBool plasmid, ajuint min, ajuint max,
+                                 ajuint begin, AjPList l)
+{
+    EmbPPatRestrict *enzarr = NULL;
+    EmbPPatMulti multi = NULL;
+    AjPStr anchor = NULL;
+    AjBool *hasanchor = NULL;
+    ajuint *ids = NULL;
+    ajuint *offsets = NULL;
+    AjPUint *fstarts = NULL;
+    AjPUint *rstarts = NULL;
+    ajuint *nfstarts = NULL;
+    ajuint *nrstarts = NULL;
+    AjPUint famb = NULL;
+    AjPUint ramb = NULL;
+    ajuint nfamb = 0;
+    ajuint nramb = 0;
+    ajuint nenz;
+    ajuint hits = 0;
+    ajuint n;
+    ajuint i;
+    ajuint w;
+    const char *p;
+    const char *q;
+    char c;
+    AjPList tx = NULL;
+    EmbPPatRestrict enz;
+
+    nenz = (ajuint) ajListToarray(enzlist,(void***)&enzarr);
+
+    if(!nenz)
+	return 0;
+
+    AJCNEW0(hasanchor,nenz);
+    AJCNEW0(ids,nenz);
+    AJCNEW0(offsets,nenz);
+
+    multi = embPatMultiNew();
+
+    for(i=0;i<nenz;++i)
+    {
+	enz = enzarr[i];
+
+	if(len < enz->len)
+	    continue;
+
+	if(patRestrictAnchor(enz,ambiguity,&anchor,&offsets[i]))
+	{
+	    hasanchor[i] = ajTrue;
+	    ids[i] = embPatMultiAdd(multi,anchor);
+	}
+    }
+
+    if(multi->Nwords)
+    {
+	embPatMultiCompile(multi);
+
+	AJCNEW0(fstarts,multi->Nwords);
+	AJCNEW0(rstarts,multi->Nwords);
+	AJCNEW0(nfstarts,multi->Nwords);
+	AJCNEW0(nrstarts,multi->Nwords);
+
+	embPatMultiSearch(multi,ambiguity ? binstr : substr,
+			  fstarts,nfstarts);
+	embPatMultiSearch(multi,ambiguity ? binrev : revstr,
+			  rstarts,nrstarts);
+    }
+
+    /* positions where a binary code is neither a single base nor N */
+
+    if(ambiguity)
+    {
+	famb = ajUintNew();
+	ramb = ajUintNew();
+	p = ajStrGetPtr(binstr);
+	q = ajStrGetPtr(binrev);
+	n = ajStrGetLen(binstr);
+
+	for(i=0;i<n;++i)
+	{
+	    c = p[i];
+
+	    if(c && c!=1 && c!=2 && c!=4 && c!=8 && c!=15)
+		patUintAppend(&famb,nfamb++,i);
+
+	    c = q[i];
+
+	    if(c && c!=1 && c!=2 && c!=4 && c!=8 && c!=15)
+		patUintAppend(&ramb,nramb++,i);
+	}
+    }
+
+    for(i=0;i<nenz;++i)
+    {
+	enz = enzarr[i];
+
+	if(!hasanchor[i])
+	{
+	    hits += embPatRestrictScan(enz,substr,binstr,revstr,binrev,len,
+				       ambiguity,plasmid,min,max,begin,l);
+	    continue;
+	}
+
+	ajDebug("embPatRestrictScan '%S' '%S' ncuts:%d blunt:%b\n",
+		enz->cod, enz->pat, enz->ncuts, enz->blunt);
+
+	w = ids[i];
+	tx = ajListNew();
+
+	n = patRestrictScanCand(enz,
+				ambiguity ? ajStrGetPtr(binstr) :
+				ajStrGetPtr(substr),
+				fstarts[w],nfstarts[w],famb,nfamb,
+				offsets[i],
+				ajStrGetLen(multi->Words[w]),len,
+				ambiguity,plasmid,ajTrue,begin,tx);
+	n += patRestrictScanCand(enz,
+				 ambiguity ? ajStrGetPtr(binrev) :
+				 ajStrGetPtr(revstr),
+				 rstarts[w],nrstarts[w],ramb,nramb,
+				 offsets[i],
+				 ajStrGetLen(multi->Words[w]),len,
+				 ambiguity,plasmid,ajFalse,begin,tx);
+
+	hits += patRestrictScanSort(tx,n,min,max,l);
+    }
+
+    if(fstarts)
+    {
+	for(w=0;w<multi->Nwords;++w)
+	{
+	    ajUintDel(&fstarts[w]);
+	    ajUintDel(&rstarts[w]);
+	}
+
+	AJFREE(fstarts);
+	AJFREE(rstarts);
+	AJFREE(nfstarts);
+	AJFREE(nrstarts);
+    }
+
+    ajUintDel(&famb);
+    ajUintDel(&ramb);
+    embPatMultiDel(&multi);
+    ajStrDel(&anchor);
+    AJFREE(hasanchor);
+    AJFREE(ids);
+    AJFREE(offsets);
+    AJFREE(enzarr);
+
+    return hits;
+}
+
+
+
+
+/* @func embPatRestrictScan ***************************************************
+**
+** Scan a sequence with a restriction object
+**
+** @param [r] enz [const EmbPPatRestrict] Enyme information
+** @param [r] substr [const AjPStr] Sequence as ASCII
+** @param [r] binstr [const AjPStr] Sequence as binary IUB
+** @param [r] revstr [const AjPStr] Sequence as ASCII reversed
+** @param [r] binrev [const AjPStr] Sequence as binary IUB reversed
+** @param [r] len [ajuint] Length of sequence
+** @param [r] ambiguity [AjBool] Allow ambiguity (binary search)
+** @param [r] plasmid [AjBool] Allow circular DNA
+** @param [r] min [ajuint] Minimum # of matches allowed
+** @param [r] max [ajuint] Maximum # of matches
+** @param [r] begin [ajuint] Sequence offset
+** @param [u] l [AjPList] List to push hits to
+**
+** @return [ajuint] Number of matches
+**
+** @release 1.0.0
+******************************************************************************/
+
+ajuint embPatRestrictScan(const EmbPPatRestrict enz,
+			 const AjPStr substr, const AjPStr binstr,
+			 const AjPStr revstr, const AjPStr binrev, ajuint len,
+			 AjBool ambiguity, AjBool plasmid, ajuint min,
+			 ajuint max, ajuint begin, AjPList l)
+{
+    ajuint limit;
+    ajuint i;
+    ajuint hits = 0;
+    const char *p;
+    ajint  mincut;
+    AjPList tx     = NULL;
+
+    if(len < enz->len)
+        return 0;
+
+    patRestrictScanLimits(enz,len,plasmid,&limit,&mincut);
+
+    ajDebug("embPatRestrictScan '%S' '%S' ncuts:%d blunt:%b\n",
+	    enz->cod, enz->pat, enz->ncuts, enz->blunt);
+    /* ajDebug("cut1:%d 2:%d 3:%d 4:%d\n",
+	    enz->cut1, enz->cut2, enz->cut3, enz->cut4 ); */
+
+    tx = ajListNew();
+
+    p = ambiguity ? ajStrGetPtr(binstr) : ajStrGetPtr(substr);
+
+    for(i=0;i<limit;++i)
+	hits += patRestrictScanPos(enz,p,i,len,limit,mincut,ambiguity,
+				   plasmid,ajTrue,begin,tx);
+
+    p = ambiguity ? ajStrGetPtr(binrev) : ajStrGetPtr(revstr);
+
+    for(i=0;i<limit;++i)
+	hits += patRestrictScanPos(enz,p,i,len,limit,mincut,ambiguity,
+				   plasmid,ajFalse,begin,tx);
+
+    return patRestrictScanSort(tx,hits,min,max,l);
+}
+
+
+
+
+/* @func embPatKMPInit ********************************************************
+**
+** Initialise a Knuth-Morris-Pratt pattern.
+**
+** @param [r] pat [const AjPStr] pattern
+** @param [r] len [ajuint] length of pattern
+** @param [w] next [ajint *] offset table
+**
+** @return [void]
+**
+** @release 1.0.0
+******************************************************************************/
+
+void embPatKMPInit(const AjPStr pat, ajuint len, ajint *next)
+{
+    ajuint i;
+    ajint k;
+    ajuint t;
+    const char *p;
+
+    p = ajStrGetPtr(pat);
+    t = len-1;
+
+    i = 0;
+    k = -1;
+    next[0] = -1;
+
+    while(i<t)
+    {
+	while(k>=0 && p[i]!=p[k])
+	    k = next[k];
+
+	++i;
+	++k;
+
+	if(p[i]==p[k])
+	    next[i] = next[k];
+	else
+	    next[i] = k;
+    }
+
+    return;
+}
+
+
+
+
+/* @func embPatKMPSearch ******************************************************
+**
+** Perform a Knuth-Morris-Pratt search
+**
+** @param [r] str [const AjPStr] string to search
+** @param [r] pat [const AjPStr] pattern to use
+** @param [r] slen [ajuint] length of string
+** @param [r] plen [ajuint] length of pattern
+** @param [r] next [const ajint *] array from embPatKMPInit (can be -1)
+** @param [r] start [ajuint] position within str to start search
+**
+** @return [ajuint] Index of match in str or -1 if not found
+**
+** @release 1.0.0
+******************************************************************************/
+
+ajuint embPatKMPSearch(const AjPStr str, const AjPStr pat,
+		      ajuint slen, ajuint plen, const ajint *next,
+		      ajuint start)
+{
+    ajuint i;
+    ajint j;
+    const char *p;
+    const char *q;
+
+    p = ajStrGetPtr(str);
+    q = ajStrGetPtr(pat);
+
+    i = start;
+    j = 0;
+
+    while(i<slen && j<(ajint)plen)
+    {
+	while(j>=0 && p[i]!=q[j])
+	    j = next[j];
+
+	++i;
+	++j;
+    }
+
+    if(j==(ajint)plen)
+	return i-plen;
+
+    return -1;
+}
+
+
+
+
+/* @func embPatBMHInit ********************************************************
+**
+** Initialise a Boyer-Moore-Horspool pattern.
+**
+** @param [r] pat [const AjPStr] pattern
+** @param [r] len [ajuint] pattern length
+** @param [w] skip [ajint *] offset table (can be -1)
+**
+** @return [void]
+**
+** @release 1.0.0
+******************************************************************************/
+
+void embPatBMHInit(const AjPStr pat, ajuint len, ajint *skip)
+{
+    ajuint i;
+    ajuint t;
+    const char *p;
+
+    p = ajStrGetPtr(pat);
+
+    t = len-1;
 
     for(i=0;i<AJALPHA;++i)
 	skip[i] = t;
@@ -3298,281 +3707,779 @@ ajuint embPatTUSearch(const AjPStr pat, const AjPStr text, ajuint slen,
 	    }
 	}
 
-	i+=skip;
+	i+=skip;
+    }
+
+    return matches;
+}
+
+
+
+
+/* @func embPatTUBInit ********************************************************
+**
+** Initialise a Tarhio-Ukkonen-Bleasby search
+**
+** @param [r] pat [const AjPStr] pattern
+** @param [w] skipm [ajuint **] mismatch skip array
+** @param [r] m [ajuint] real pattern length
+** @param [r] k [ajuint] allowed mismatches
+** @param [r] plen [ajuint] full pattern length (incl ajcompl & class)
+**
+** @return [void]
+**
+** @release 1.0.0
+******************************************************************************/
+
+void embPatTUBInit(const AjPStr pat, ajuint **skipm, ajuint m, ajuint k,
+		   ajuint plen)
+{
+    const char *p;
+    const char *q;
+    const char *s;
+    ajint i;
+    ajint j;
+    ajint jj;
+    ajint x;
+    ajint z;
+    ajuint flag;
+    ajuint ready[AJALPHA];
+
+    p = ajStrGetPtr(pat);
+
+    for(i=0;i<AJALPHA;++i)
+    {
+	ready[i] = m;
+
+        /*
+        ** AJB: Note that if the mismatches are 1 less than the real
+        ** pattern length then the skip value can become 0 - hence
+        ** the use of AJMAX to ensure that the skip value is always
+        ** positive. This prevents a potential infinite loop in the
+        ** upcoming TUBSearch function. Need to check the original
+        ** algorithm to check that nothing is amiss here, then
+        ** delete this comment block.
+        */
+	for(j=m-k-1;j<(ajint)m;++j)
+	    skipm[j][i] = AJMAX(m-k-1,1);
+    }
+
+    p += plen-1;
+
+    if(*p=='}' || *p==']')
+    {
+	while(*p!='{' && *p!='[')
+	    --p;
+
+	--p;
+    }
+    else
+	--p;
+
+    for(j=m-2;j>-1;--j)
+    {
+	jj = m-k-1;
+	x = AJMAX(j+1,jj);
+
+	if(*p=='?')
+	{
+	    for(z='A';z<='Z';++z)
+	    {
+		for(i=ready[z]-1;i>=x;--i)
+		    skipm[i][z] = i-j;
+
+		ready[z] = x;
+	    }
+
+	    --p;
+	    continue;
+	}
+
+	if(*p==']')
+	{
+	    --p;
+	    while(*p!='[')
+	    {
+		for(i=ready[(ajuint)*p]-1;i>=x;--i)
+		    skipm[i][(ajuint)*p] = i-j;
+		ready[(ajuint)*p] = x;
+		--p;
+	    }
+	    --p;
+	    continue;
+	}
+
+	if(*p=='}')
+	{
+	    s=--p;
+
+	    for(z='A';z<='Z';++z)
+	    {
+		q    = s;
+		flag = 0;
+
+		while(*q!='{')
+		{
+		    if(*q==z)
+		    {
+			flag = 1;
+			break;
+		    }
+
+		    --q;
+		}
+
+		if(!flag)
+		{
+		    for(i=ready[z]-1;i>=x;--i)
+			skipm[i][z] = i-j;
+
+		    ready[z] = x;
+		}
+	    }
+
+	    while(*p!='{')
+		--p;
+
+	    --p;
+	    continue;
+	}
+
+	for(i=ready[(ajuint)*p]-1;i>=x;--i)
+	    skipm[i][(ajuint)*p] = i-j;
+
+	ready[(ajuint)*p] = x;
+	--p;
+    }
+
+    return;
+}
+
+
+
+
+/* @func embPatTUBSearch ******************************************************
+**
+** Perform a Tarhio-Ukkonen-Bleasby search
+**
+** @param [r] pat [const AjPStr] pattern
+** @param [r] text [const AjPStr] text to search (incl ajcompl/class)
+** @param [r] slen [ajuint] length of text
+** @param [r] skipm [ajuint * const *] mismatch skip array
+** @param [r] m [ajuint] real pattern length
+** @param [r] k [ajuint] allowed mismatches
+** @param [r] begin [ajuint] text offset
+** @param [u] l [AjPList] list to push to
+** @param [r] amino [AjBool] true if text start
+** @param [r] carboxyl [AjBool] true if text end
+** @param [r] name [const AjPStr] name of text
+** @param [r] plen [ajuint] total pattern length
+**
+** @return [ajuint] number of hits
+**
+** @release 1.0.0
+******************************************************************************/
+
+ajuint embPatTUBSearch(const AjPStr pat,const AjPStr text, ajuint slen,
+		      ajuint * const *skipm, ajuint m,
+		      ajuint k, ajuint begin, AjPList l, AjBool amino,
+		      AjBool carboxyl, const AjPStr name, ajuint plen)
+{
+    ajuint i;
+    ajint j;
+    ajint jj;
+    ajuint h;
+    ajuint mm;
+    ajuint skip;
+    const char *p;
+    const char *q;
+    const char *s;
+
+    ajuint  matches;
+    ajint  a;
+    ajuint  flag;
+
+    s = ajStrGetPtr(pat);
+    q = ajStrGetPtr(text);
+
+    matches = 0;
+
+    i = m-1;
+
+    while(i<slen)
+    {
+	h = i;
+	j = m-1;
+	p = s+plen-1;
+	skip = m-k;
+	mm = 0;
+
+	while(j>-1 && mm<=k)
+	{
+	    jj = m-k-1;
+
+	    if(j>=jj)
+		skip = AJMIN(skip,skipm[j][(ajuint)q[h]]);
+
+	    a = q[h];
+
+	    if(*p!='?')
+	    {
+		if(*p==']')
+		{
+		    flag = 0;
+		    --p;
+
+		    while(*p!='[')
+		    {
+			if(a==*p)
+			    flag = 1;
+
+			--p;
+		    }
+
+		    if(!flag)
+			++mm;
+		}
+		else if(*p=='}')
+		{
+		    flag = 0;
+		    --p;
+
+		    while(*p!='{')
+		    {
+			if(a==*p)
+			    flag=1;
+			--p;
+		    }
+
+		    if(flag)
+			++mm;
+		}
+		else
+		    if(a!=*p)
+			++mm;
+	    }
+
+	    --p;
+	    --h;
+	    --j;
+	}
+
+	if(mm<=k)
+	{
+	    if(amino && h+1)
+		return matches;
+
+	    if(!carboxyl || (carboxyl && h+1==slen-m))
+	    {
+		++matches;
+		embPatPushHit(l,name,h+1,m,begin,mm);
+	    }
+	}
+
+	i += skip;
+    }
+
+    return matches;
+}
+
+
+
+
+/* @func embPatWMInit *********************************************************
+**
+** Initialise a Wu-Manber bit-parallel mismatch search
+**
+** Sets, for each text character, the bit of every pattern position
+** that the character matches. Patterns longer than 64 positions
+** use several 64-bit words per character.
+**
+** @param [r] pat [const AjPStr] pattern (incl ajcompl & class)
+** @param [r] m [ajuint] real pattern length
+** @param [w] masks [ajulong*] character masks (AJALPHA * words)
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+void embPatWMInit(const AjPStr pat, ajuint m, ajulong *masks)
+{
+    const char *p;
+    ajuint nwords;
+    ajuint ppos;
+    ajuint i;
+    ajuint j;
+
+    nwords = (m + 63) / 64;
+
+    for(i=0;i<AJALPHA*nwords;++i)
+        masks[i] = 0;
+
+    p = ajStrGetPtr(pat);
+    ppos = 0;
+
+    for(j=0;j<m && p[ppos];++j)
+    {
+        for(i=1;i<AJALPHA;++i)
+            if(patBruteCharMatch(p+ppos,(char)i))
+                masks[i*nwords + j/64] |= (ajulong)1 << (j%64);
+
+        ppos = patBruteNextPatChar(p,ppos);
+    }
+
+    return;
+}
+
+
+
+
+/* @func embPatWMSearch *******************************************************
+**
+** Perform a Wu-Manber bit-parallel search allowing mismatches
+**
+** One state vector is kept for each number of mismatches from 0 to mm
+** so the reported mismatch count is the Hamming distance of each hit.
+**
+** @param [r] str [const AjPStr] text to search
+** @param [r] name [const AjPStr] name of text
+** @param [r] begin [ajuint] text offset
+** @param [r] m [ajuint] real pattern length
+** @param [r] mm [ajuint] allowed mismatches (Hamming distance)
+** @param [r] masks [const ajulong*] character masks from embPatWMInit
+** @param [u] l [AjPList] list to push hits to
+** @param [r] amino [AjBool] if true, match at amino terminal end
+** @param [r] carboxyl [AjBool] if true, match at carboxyl terminal end
+**
+** @return [ajuint] number of hits
+**
+** @release 6.6.0
+******************************************************************************/
+
+ajuint embPatWMSearch(const AjPStr str, const AjPStr name,
+                      ajuint begin, ajuint m, ajuint mm,
+                      const ajulong *masks,
+                      AjPList l, AjBool amino, AjBool carboxyl)
+{
+    const unsigned char *p;
+    ajuint slen;
+    ajuint first;
+    ajuint last;
+    ajuint nwords;
+    ajuint topword;
+    ajulong topbit;
+    ajulong *state;
+    ajulong *r;
+    const ajulong *b;
+    ajulong old;
+    ajulong prev;
+    ajulong next;
+    ajuint matches = 0;
+    ajuint i;
+    ajuint d;
+    ajuint w;
+
+    slen = ajStrGetLen(str);
+
+    if(!m || slen < m)
+        return 0;
+
+    first = carboxyl ? slen - m : 0;
+    last  = amino ? m : slen;
+
+    if(first + m > last)
+        return 0;
+
+    p = (const unsigned char *) ajStrGetPtr(str);
+
+    nwords  = (m + 63) / 64;
+    topword = (m - 1) / 64;
+    topbit  = (ajulong)1 << ((m - 1) % 64);
+
+    AJCNEW0(state,(mm+1)*nwords);
+
+    if(nwords == 1)
+    {
+        for(i=first;i<last;++i)
+        {
+            b = &masks[p[i]];
+            prev = 0;
+
+            for(d=0;d<=mm;++d)
+            {
+                old = state[d];
+                state[d] = (((old << 1) | 1) & *b) | prev;
+                prev = (old << 1) | 1;
+            }
+
+            if(state[mm] & topbit)
+            {
+                for(d=0;!(state[d] & topbit);++d)
+                    continue;
+
+                embPatPushHit(l,name,i-m+1,m,begin,d);
+                ++matches;
+            }
+        }
+    }
+    else
+    {
+        for(i=first;i<last;++i)
+        {
+            b = &masks[p[i]*nwords];
+
+            /* high words first, so each still sees the old lower word */
+            for(w=nwords;w-- > 0;)
+            {
+                prev = 0;
+
+                for(d=0;d<=mm;++d)
+                {
+                    r = &state[d*nwords];
+                    old = r[w];
+                    next = (old << 1) | (w ? r[w-1] >> 63 : 1);
+                    r[w] = (next & b[w]) | prev;
+                    prev = next;
+                }
+            }
+
+            if(state[mm*nwords + topword] & topbit)
+            {
+                for(d=0;!(state[d*nwords + topword] & topbit);++d)
+                    continue;
+
+                embPatPushHit(l,name,i-m+1,m,begin,d);
+                ++matches;
+            }
+        }
+    }
+
+    AJFREE(state);
+
+    return matches;
+}
+
+
+
+
+/* @funcstatic patUintAppend **************************************************
+**
+** Append a value to an unsigned integer array, doubling the reserved
+** size when it is full. ajUintPut only grows by a fixed block, which is
+** quadratic for the long lists of word positions in a sequence.
+**
+** @param [u] thys [AjPUint*] Array
+** @param [r] elem [ajuint] Element to set, the current length
+** @param [r] v [ajuint] Value
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void patUintAppend(AjPUint *thys, ajuint elem, ajuint v)
+{
+    AjPUint bigger;
+
+    if(elem >= (*thys)->Res)
+    {
+        bigger = ajUintNewRes(2*elem);
+        memcpy(bigger->Ptr,(*thys)->Ptr,(*thys)->Len*sizeof(ajuint));
+        bigger->Len = (*thys)->Len;
+        ajUintDel(thys);
+        *thys = bigger;
+    }
+
+    ajUintPut(thys,elem,v);
+
+    return;
+}
+
+
+
+
+/* @func embPatMultiNew *******************************************************
+**
+** Constructor for a multiple pattern Aho-Corasick automaton
+**
+** @return [EmbPPatMulti] Empty automaton
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+EmbPPatMulti embPatMultiNew(void)
+{
+    EmbPPatMulti thys;
+
+    AJNEW0(thys);
+
+    return thys;
+}
+
+
+
+
+/* @func embPatMultiDel *******************************************************
+**
+** Destructor for a multiple pattern automaton
+**
+** @param [d] pthis [EmbPPatMulti*] Automaton
+**
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void embPatMultiDel(EmbPPatMulti *pthis)
+{
+    EmbPPatMulti thys;
+    ajuint i;
+
+    if(!pthis || !*pthis)
+        return;
+
+    thys = *pthis;
+
+    for(i=0;i<thys->Nwords;++i)
+        ajStrDel(&thys->Words[i]);
+
+    AJFREE(thys->Words);
+    AJFREE(thys->Next);
+    AJFREE(thys->Word);
+    AJFREE(thys->Dict);
+    AJFREE(*pthis);
+
+    return;
+}
+
+
+
+
+/* @func embPatMultiAdd *******************************************************
+**
+** Add a word to a multiple pattern automaton before it is compiled.
+** Words are compared as bytes, so binary codes can be used as well
+** as characters.
+**
+** @param [u] thys [EmbPPatMulti] Automaton
+** @param [r] word [const AjPStr] Word
+**
+** @return [ajuint] Word number. A repeated word returns the number
+**                  it was first given.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajuint embPatMultiAdd(EmbPPatMulti thys, const AjPStr word)
+{
+    ajuint i;
+
+    if(thys->Next)
+        ajFatal("embPatMultiAdd: automaton is already compiled");
+
+    if(!ajStrGetLen(word))
+        ajFatal("embPatMultiAdd: empty word");
+
+    for(i=0;i<thys->Nwords;++i)
+        if(ajStrMatchS(thys->Words[i],word))
+            return i;
+
+    if(thys->Nwords == thys->Maxwords)
+    {
+        thys->Maxwords = thys->Maxwords ? 2*thys->Maxwords : 64;
+        AJCRESIZE0(thys->Words,thys->Nwords,thys->Maxwords);
     }
 
-    return matches;
+    thys->Words[thys->Nwords] = ajStrNewS(word);
+
+    return thys->Nwords++;
 }
 
 
 
 
-/* @func embPatTUBInit ********************************************************
+/* @func embPatMultiCompile ***************************************************
 **
-** Initialise a Tarhio-Ukkonen-Bleasby search
+** Build the complete transition table of a multiple pattern automaton
+** from the trie of its words and their failure links
 **
-** @param [r] pat [const AjPStr] pattern
-** @param [w] skipm [ajuint **] mismatch skip array
-** @param [r] m [ajuint] real pattern length
-** @param [r] k [ajuint] allowed mismatches
-** @param [r] plen [ajuint] full pattern length (incl ajcompl & class)
+** @param [u] thys [EmbPPatMulti] Automaton
 **
 ** @return [void]
 **
-** @release 1.0.0
+** @release 6.6.0
+** @@
 ******************************************************************************/
 
-void embPatTUBInit(const AjPStr pat, ajuint **skipm, ajuint m, ajuint k,
-		   ajuint plen)
+void embPatMultiCompile(EmbPPatMulti thys)
 {
-    const char *p;
-    const char *q;
-    const char *s;
-    ajint i;
-    ajint j;
-    ajint jj;
-    ajint x;
-    ajint z;
-    ajuint flag;
-    ajuint ready[AJALPHA];
-
-    p = ajStrGetPtr(pat);
-
-    for(i=0;i<AJALPHA;++i)
-    {
-	ready[i] = m;
+    const unsigned char *p;
+    ajuint *fail;
+    ajuint *queue;
+    ajuint maxstates = 1;
+    ajuint nalpha;
+    ajuint qhead;
+    ajuint qtail;
+    ajuint state;
+    ajuint child;
+    ajuint i;
+    ajuint j;
+    ajuint s;
 
-        /*
-        ** AJB: Note that if the mismatches are 1 less than the real
-        ** pattern length then the skip value can become 0 - hence
-        ** the use of AJMAX to ensure that the skip value is always
-        ** positive. This prevents a potential infinite loop in the
-        ** upcoming TUBSearch function. Need to check the original
-        ** algorithm to check that nothing is amiss here, then
-        ** delete this comment block.
-        */
-	for(j=m-k-1;j<(ajint)m;++j)
-	    skipm[j][i] = AJMAX(m-k-1,1);
-    }
+    if(thys->Next)
+        return;
 
-    p += plen-1;
+    nalpha = 1;
 
-    if(*p=='}' || *p==']')
+    for(i=0;i<thys->Nwords;++i)
     {
-	while(*p!='{' && *p!='[')
-	    --p;
+        p = (const unsigned char *) ajStrGetPtr(thys->Words[i]);
 
-	--p;
-    }
-    else
-	--p;
+        for(j=0;j<ajStrGetLen(thys->Words[i]);++j)
+            if(!thys->Alphabet[p[j]])
+                thys->Alphabet[p[j]] = nalpha++;
 
-    for(j=m-2;j>-1;--j)
-    {
-	jj = m-k-1;
-	x = AJMAX(j+1,jj);
+        maxstates += ajStrGetLen(thys->Words[i]);
+    }
 
-	if(*p=='?')
-	{
-	    for(z='A';z<='Z';++z)
-	    {
-		for(i=ready[z]-1;i>=x;--i)
-		    skipm[i][z] = i-j;
+    thys->Nalpha = nalpha;
 
-		ready[z] = x;
-	    }
+    AJCNEW0(thys->Next,(size_t)maxstates*nalpha);
+    AJCNEW0(thys->Word,maxstates);
+    AJCNEW0(thys->Dict,maxstates);
+    thys->Nstates = 1;
 
-	    --p;
-	    continue;
-	}
+    /* the trie, with 0 for a missing child as the root is no child */
 
-	if(*p==']')
-	{
-	    --p;
-	    while(*p!='[')
-	    {
-		for(i=ready[(ajuint)*p]-1;i>=x;--i)
-		    skipm[i][(ajuint)*p] = i-j;
-		ready[(ajuint)*p] = x;
-		--p;
-	    }
-	    --p;
-	    continue;
-	}
+    for(i=0;i<thys->Nwords;++i)
+    {
+        p = (const unsigned char *) ajStrGetPtr(thys->Words[i]);
+        state = 0;
 
-	if(*p=='}')
-	{
-	    s=--p;
+        for(j=0;j<ajStrGetLen(thys->Words[i]);++j)
+        {
+            s = thys->Alphabet[p[j]];
 
-	    for(z='A';z<='Z';++z)
-	    {
-		q    = s;
-		flag = 0;
+            if(!thys->Next[state*nalpha+s])
+                thys->Next[state*nalpha+s] = thys->Nstates++;
 
-		while(*q!='{')
-		{
-		    if(*q==z)
-		    {
-			flag = 1;
-			break;
-		    }
+            state = thys->Next[state*nalpha+s];
+        }
 
-		    --q;
-		}
+        thys->Word[state] = i+1;
+    }
 
-		if(!flag)
-		{
-		    for(i=ready[z]-1;i>=x;--i)
-			skipm[i][z] = i-j;
+    /*
+    ** Breadth first, so the failure state of each state is complete
+    ** before its missing transitions are copied from it
+    */
 
-		    ready[z] = x;
-		}
-	    }
+    AJCNEW0(fail,thys->Nstates);
+    AJCNEW0(queue,thys->Nstates);
+    qhead = qtail = 0;
 
-	    while(*p!='{')
-		--p;
+    for(s=1;s<nalpha;++s)
+        if((child = thys->Next[s]))
+            queue[qtail++] = child;
 
-	    --p;
-	    continue;
-	}
+    while(qhead < qtail)
+    {
+        state = queue[qhead++];
 
-	for(i=ready[(ajuint)*p]-1;i>=x;--i)
-	    skipm[i][(ajuint)*p] = i-j;
+        for(s=1;s<nalpha;++s)
+        {
+            child = thys->Next[state*nalpha+s];
 
-	ready[(ajuint)*p] = x;
-	--p;
+            if(child)
+            {
+                fail[child] = thys->Next[fail[state]*nalpha+s];
+                thys->Dict[child] = thys->Word[fail[child]] ?
+                    fail[child] : thys->Dict[fail[child]];
+                queue[qtail++] = child;
+            }
+            else
+                thys->Next[state*nalpha+s] =
+                    thys->Next[fail[state]*nalpha+s];
+        }
     }
 
+    AJFREE(fail);
+    AJFREE(queue);
+
     return;
 }
 
 
 
 
-/* @func embPatTUBSearch ******************************************************
+/* @func embPatMultiSearch ****************************************************
 **
-** Perform a Tarhio-Ukkonen-Bleasby search
+** Find all occurrences of all words of a compiled multiple pattern
+** automaton in one pass over a text
 **
-** @param [r] pat [const AjPStr] pattern
-** @param [r] text [const AjPStr] text to search (incl ajcompl/class)
-** @param [r] slen [ajuint] length of text
-** @param [r] skipm [ajuint * const *] mismatch skip array
-** @param [r] m [ajuint] real pattern length
-** @param [r] k [ajuint] allowed mismatches
-** @param [r] begin [ajuint] text offset
-** @param [u] l [AjPList] list to push to
-** @param [r] amino [AjBool] true if text start
-** @param [r] carboxyl [AjBool] true if text end
-** @param [r] name [const AjPStr] name of text
-** @param [r] plen [ajuint] total pattern length
+** @param [r] thys [const EmbPPatMulti] Compiled automaton
+** @param [r] text [const AjPStr] Text to search
+** @param [u] starts [AjPUint*] Start positions for each word number,
+**                              created if NULL
+** @param [w] nstarts [ajuint*] Number of start positions for each word
 **
-** @return [ajuint] number of hits
+** @return [ajuint] Total number of occurrences
 **
-** @release 1.0.0
+** @release 6.6.0
+** @@
 ******************************************************************************/
 
-ajuint embPatTUBSearch(const AjPStr pat,const AjPStr text, ajuint slen,
-		      ajuint * const *skipm, ajuint m,
-		      ajuint k, ajuint begin, AjPList l, AjBool amino,
-		      AjBool carboxyl, const AjPStr name, ajuint plen)
+ajuint embPatMultiSearch(const EmbPPatMulti thys, const AjPStr text,
+                         AjPUint *starts, ajuint *nstarts)
 {
+    const unsigned char *p;
+    const ajuint *next;
+    const ajuint *alpha;
+    ajuint nalpha;
+    ajuint len;
+    ajuint state = 0;
+    ajuint out;
+    ajuint w;
     ajuint i;
-    ajint j;
-    ajint jj;
-    ajuint h;
-    ajuint mm;
-    ajuint skip;
-    const char *p;
-    const char *q;
-    const char *s;
-
-    ajuint  matches;
-    ajint  a;
-    ajuint  flag;
-
-    s = ajStrGetPtr(pat);
-    q = ajStrGetPtr(text);
-
-    matches = 0;
+    ajuint hits = 0;
 
-    i = m-1;
+    if(!thys->Next)
+        ajFatal("embPatMultiSearch: automaton is not compiled");
 
-    while(i<slen)
+    for(i=0;i<thys->Nwords;++i)
     {
-	h = i;
-	j = m-1;
-	p = s+plen-1;
-	skip = m-k;
-	mm = 0;
-
-	while(j>-1 && mm<=k)
-	{
-	    jj = m-k-1;
-
-	    if(j>=jj)
-		skip = AJMIN(skip,skipm[j][(ajuint)q[h]]);
-
-	    a = q[h];
-
-	    if(*p!='?')
-	    {
-		if(*p==']')
-		{
-		    flag = 0;
-		    --p;
-
-		    while(*p!='[')
-		    {
-			if(a==*p)
-			    flag = 1;
-
-			--p;
-		    }
-
-		    if(!flag)
-			++mm;
-		}
-		else if(*p=='}')
-		{
-		    flag = 0;
-		    --p;
-
-		    while(*p!='{')
-		    {
-			if(a==*p)
-			    flag=1;
-			--p;
-		    }
-
-		    if(flag)
-			++mm;
-		}
-		else
-		    if(a!=*p)
-			++mm;
-	    }
+        if(!starts[i])
+            starts[i] = ajUintNew();
 
-	    --p;
-	    --h;
-	    --j;
-	}
+        nstarts[i] = 0;
+    }
 
-	if(mm<=k)
-	{
-	    if(amino && h+1)
-		return matches;
+    p      = (const unsigned char *) ajStrGetPtr(text);
+    len    = ajStrGetLen(text);
+    next   = thys->Next;
+    alpha  = thys->Alphabet;
+    nalpha = thys->Nalpha;
 
-	    if(!carboxyl || (carboxyl && h+1==slen-m))
-	    {
-		++matches;
-		embPatPushHit(l,name,h+1,m,begin,mm);
-	    }
-	}
+    for(i=0;i<len;++i)
+    {
+        state = next[state*nalpha + alpha[p[i]]];
 
-	i += skip;
+        for(out = thys->Word[state] ? state : thys->Dict[state];
+            out;
+            out = thys->Dict[out])
+        {
+            w = thys->Word[out] - 1;
+            patUintAppend(&starts[w],nstarts[w]++,
+                          i + 1 - ajStrGetLen(thys->Words[w]));
+            ++hits;
+        }
     }
 
-    return matches;
+    return hits;
 }
 
 
@@ -4625,6 +5532,8 @@ ajuint embPatRestrictMatch(const AjPSeq seq, ajuint begin, ajuint end,
     AjPList methlist = NULL;
     
     EmbPPatRestrict enz;
+    EmbPPatRestrict enzused = NULL;
+    AjPList enzlist = NULL;
     MethPData md = NULL;
     
 
@@ -4653,6 +5562,7 @@ ajuint embPatRestrictMatch(const AjPSeq seq, ajuint begin, ajuint end,
     binrev = ajStrNew();
 
     enz = embPatRestrictNew();
+    enzlist = ajListNew();
 
     if(methyl)
         methlist = patRestrictReadMethyl(methfile);
@@ -4769,10 +5679,18 @@ ajuint embPatRestrictMatch(const AjPSeq seq, ajuint begin, ajuint end,
 		continue;
 	}
 
-	hits += embPatRestrictScan(enz,substr,binstr,revstr,binrev,len,
-				   ambiguity,plasmid,min,max,begin,l);
+	ajListPushAppend(enzlist,enz);
+	enz = embPatRestrictNew();
     }
 
+    hits = patRestrictScanAll(enzlist,substr,binstr,revstr,binrev,len,
+			      ambiguity,plasmid,min,max,begin,l);
+
+    while(ajListPop(enzlist,(void **)&enzused))
+	embPatRestrictDel(&enzused);
+
+    ajListFree(&enzlist);
+
 
 
     for(i=0;i<ne;++i)
@@ -5390,6 +6308,12 @@ void embPatCompileII (AjPPatComp thys, ajuint mismatch)
 	break;
     case 7:
 	break;
+    case PATSEQ_WM:
+	if (!thys->wmtable)
+	    AJCNEW0(thys->wmtable,AJALPHA*((thys->m+63)/64));
+
+	embPatWMInit(thys->pattern,thys->m,thys->wmtable);
+	break;
     default:
 	ajFatal("embPatCompileII: Cannot compile pattern");
 	break;
@@ -5535,6 +6459,12 @@ void embPatFuzzSearchII (AjPPatComp thys, ajuint begin, const AjPStr name,
 				 l,begin,mismatch,name);
 	break;
 
+    case PATSEQ_WM:
+	*hits = embPatWMSearch(text,name,begin,thys->m,mismatch,thys->wmtable,
+			       l,thys->amino,thys->carboxyl);
+	*tidy = (const void *) thys->wmtable;
+	break;
+
     default:
 	ajFatal("Can't handle pattern type %S\n",thys->pattern);
 	break;
@@ -5680,6 +6610,12 @@ void embPatFuzzSearchAllII (AjPPatComp thys, ajuint begin, const AjPStr name,
 				 l,begin,mismatch,name);
 	break;
 
+    case PATSEQ_WM:
+	*hits = embPatWMSearch(text,name,begin,thys->m,mismatch,thys->wmtable,
+			       l,thys->amino,thys->carboxyl);
+	*tidy = (const void *) thys->wmtable;
+	break;
+
     default:
 	ajFatal("Can't handle pattern type %S\n",thys->pattern);
 	break;
@@ -5755,6 +6691,14 @@ ajuint embPatGetTypeII (AjPPatComp thys, const AjPStr pattern, ajuint mismatch,
 	/* Boyer Moore Horspool is the choice for long exact patterns */
 	type = 1;
     }
+    else if(mismatch && !range && mismatch<thys->m)
+    {
+	/*
+	**  Wu-Manber bit-parallel search for mismatches, with or without
+	**  classes and dontcares, for any pattern length
+	*/
+	type = PATSEQ_WM;
+    }
     else if(mismatch && !dontcare && !range && !fclass && !compl &&
 	    plen<AJALPHA/2)
     {
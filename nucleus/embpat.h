@@ -74,6 +74,7 @@ AJ_BEGIN_DECLS
 ** @value PATSEQ_PROSITE Prosite pattern as regular expression
 ** @value PATSEQ_TUB     Tarhito, Ukkonen, Bleasby
 ** @value PATSEQ_OTHER   Brute force processing
+** @value PATSEQ_WM      Wu-Manber bit-parallel mismatches
 ** @value PATSEQ_MAX     Beyond last defined value
 ******************************************************************************/
 
@@ -87,6 +88,7 @@ typedef enum AjOPatseqType
     PATSEQ_PROSITE,
     PATSEQ_TUB,
     PATSEQ_OTHER,
+    PATSEQ_WM,
     PATSEQ_MAX
 } EmbEPatseqType;
 
@@ -162,6 +164,44 @@ typedef struct EmbSPatRestrict
 
 
 
+/* @data EmbPPatMulti *********************************************************
+**
+** NUCLEUS data structure for a multiple pattern Aho-Corasick automaton.
+** Words are added first, then compiled into a complete transition
+** table so each text character costs one lookup for any number of words.
+**
+** @alias EmbSPatMulti
+** @alias EmbOPatMulti
+**
+** @attr Words [AjPStr*] Words by word number
+** @attr Next [ajuint*] Transitions, Nalpha entries per state
+** @attr Word [ajuint*] Word number plus one ending at each state, or zero
+** @attr Dict [ajuint*] Next state on the failure chain ending a word
+** @attr Alphabet [ajuint[256]] Symbol of each character, zero if unused
+** @attr Nwords [ajuint] Number of words
+** @attr Maxwords [ajuint] Size of Words array
+** @attr Nstates [ajuint] Number of states
+** @attr Nalpha [ajuint] Number of symbols, including zero for others
+** @@
+******************************************************************************/
+
+typedef struct EmbSPatMulti
+{
+    AjPStr *Words;
+    ajuint *Next;
+    ajuint *Word;
+    ajuint *Dict;
+    ajuint Alphabet[256];
+    ajuint Nwords;
+    ajuint Maxwords;
+    ajuint Nstates;
+    ajuint Nalpha;
+} EmbOPatMulti;
+#define EmbPPatMulti EmbOPatMulti*
+
+
+
+
 #define EmbPPatBYPNode AjOPatBYPNode*
 #define EmbOPatBYPNode AjOPatBYPNode
 
@@ -279,6 +319,13 @@ ajuint          embPatMatchGetLen (const EmbPPatMatch data, ajuint indexnum);
 ajuint          embPatMatchGetNumber (const EmbPPatMatch data);
 ajuint          embPatMatchGetStart (const EmbPPatMatch data, ajuint indexnum);
 
+ajuint          embPatMultiAdd (EmbPPatMulti thys, const AjPStr word);
+void            embPatMultiCompile (EmbPPatMulti thys);
+void            embPatMultiDel (EmbPPatMulti *pthis);
+EmbPPatMulti    embPatMultiNew (void);
+ajuint          embPatMultiSearch (const EmbPPatMulti thys, const AjPStr text,
+				   AjPUint *starts, ajuint *nstarts);
+
 AjPStr          embPatPrositeToRegExp (const AjPStr s);
 AjPStr          embPatPrositeToRegExpEnds (const AjPStr s,
 					   AjBool start, AjBool end);
@@ -354,6 +401,12 @@ ajuint          embPatVariablePattern (const AjPStr pattern,
 				       ajuint mode,
 				       ajuint mismatch, ajuint begin);
 
+void            embPatWMInit (const AjPStr pat, ajuint m, ajulong *masks);
+ajuint          embPatWMSearch (const AjPStr str, const AjPStr name,
+				ajuint begin, ajuint m, ajuint mm,
+				const ajulong *masks,
+				AjPList l, AjBool amino, AjBool carboxyl);
+
 /*
 ** End of prototype definitions
 */
@@ -38,6 +38,25 @@
 static AjPStr featMotifNuc = NULL;
 static AjPStr featMotifProt = NULL;
 
+static EmbPPatMulti patlistMulti = NULL;
+static AjPPatlistSeq patlistMultiList = NULL;
+static AjPPatComp *patlistMultiComp = NULL;
+static ajuint *patlistMultiWord = NULL;
+static ajuint *patlistMultiOffset = NULL;
+static ajuint patlistMultiNpats = 0;
+
+static AjBool patlistMultiAnchor(const AjPPatComp pat,
+                                 AjPStr *word, ajuint *offset);
+static AjBool patlistMultiBuild(AjPPatlistSeq plist);
+static void   patlistMultiClear(void);
+static void   patlistMultiSearch(AjPFeattable ftable, const AjPSeq seq,
+                                 AjPPatlistSeq plist, AjBool reverse);
+static void   patternSeqFeatAll(AjPFeattable ftable, const AjPSeq seq,
+                                const AjPPatternSeq pat, AjBool reverse,
+                                AjPList list, ajuint hits);
+static void   patternSeqString(const AjPSeq seq, AjBool reverse,
+                               AjPStr *seqstr);
+
 
 
 
@@ -119,11 +138,22 @@ void embPatlistSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
         compPat = ajPatternSeqGetCompiled(patseq);
 
 	if (!compPat && !embPatternSeqCompile(patseq))
-        {
             ajPatlistSeqRemoveCurrent(plist);
-            continue;
-        }
+    }
+
+    ajPatlistSeqRewind(plist);
 
+    /* exact patterns are found together in one pass */
+
+    if (patlistMultiBuild(plist))
+    {
+        patlistMultiSearch(ftable,seq,plist,reverse);
+
+        return;
+    }
+
+    while (ajPatlistSeqGetNext(plist,&patseq))
+    {
         embPatternSeqSearchAll(ftable,seq,patseq,reverse);
         ajDebug("end loop\n");
     }
@@ -136,6 +166,301 @@ void embPatlistSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
 
 
 
+/* @funcstatic patlistMultiAnchor *********************************************
+**
+** Find the word a compiled pattern can be found by in a multiple pattern
+** automaton. Exact patterns are their own word. For classes and
+** dontcares it is the longest run of single characters, and every
+** occurrence is then tested against the whole pattern.
+**
+** @param [r] pat [const AjPPatComp] Compiled pattern
+** @param [w] word [AjPStr*] Anchor word
+** @param [w] offset [ajuint*] Anchor offset in the pattern
+** @return [AjBool] True if the pattern can be searched for this way
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool patlistMultiAnchor(const AjPPatComp pat,
+                                 AjPStr *word, ajuint *offset)
+{
+    ajuint i;
+    ajuint j;
+    ajuint n;
+    ajuint run = 0;
+    ajuint best = 0;
+    char c = '\0';
+    char fixed[AJWORD];
+
+    if(pat->amino || pat->carboxyl)
+        return ajFalse;
+
+    if(pat->type == 1 || pat->type == 3)
+    {
+        ajStrAssignS(word,pat->pattern);
+        *offset = 0;
+
+        return ajTrue;
+    }
+
+    if(pat->type != 4 || !pat->m)
+        return ajFalse;
+
+    /* a position is single if only one character clears its bit */
+
+    for(j=0;j<pat->m;++j)
+    {
+        for(i=0,n=0;i<AJALPHA2 && n<2;++i)
+            if(!(pat->sotable[i] & (1U << (j*AJBPS))))
+            {
+                c = (char) i;
+                ++n;
+            }
+
+        fixed[j] = (n == 1) ? c : '\0';
+
+        if(fixed[j])
+        {
+            ++run;
+
+            if(run > best)
+            {
+                best = run;
+                *offset = j + 1 - run;
+            }
+        }
+        else
+            run = 0;
+    }
+
+    if(!best)
+        return ajFalse;
+
+    ajStrAssignLenC(word,&fixed[*offset],best);
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic patlistMultiBuild **********************************************
+**
+** Compile a multiple pattern automaton for the exact patterns of a list,
+** or reuse the one compiled for the same list before.
+**
+** @param [u] plist [AjPPatlistSeq] List of compiled patterns
+** @return [AjBool] True if at least two patterns are in the automaton
+**
+** @release 6.6.0
+******************************************************************************/
+
+static AjBool patlistMultiBuild(AjPPatlistSeq plist)
+{
+    AjPPatternSeq patseq = NULL;
+    AjPStr word = NULL;
+    ajuint npats;
+    ajuint nmulti = 0;
+    ajuint offset = 0;
+    ajuint i;
+    AjBool same;
+
+    npats = ajPatlistSeqGetSize(plist);
+
+    if(plist == patlistMultiList && npats == patlistMultiNpats)
+    {
+        same = ajTrue;
+        i = 0;
+
+        while(ajPatlistSeqGetNext(plist,&patseq))
+            if(ajPatternSeqGetCompiled(patseq) != patlistMultiComp[i++])
+                same = ajFalse;
+
+        if(same)
+            return (patlistMulti != NULL);
+    }
+
+    patlistMultiClear();
+
+    patlistMultiList = plist;
+    patlistMultiNpats = npats;
+    AJCNEW0(patlistMultiComp,npats+1);
+    AJCNEW0(patlistMultiWord,npats+1);
+    AJCNEW0(patlistMultiOffset,npats+1);
+
+    patlistMulti = embPatMultiNew();
+    i = 0;
+
+    while(ajPatlistSeqGetNext(plist,&patseq))
+    {
+        patlistMultiComp[i] = ajPatternSeqGetCompiled(patseq);
+
+        if(patlistMultiAnchor(patlistMultiComp[i],&word,&offset))
+        {
+            patlistMultiWord[i] = embPatMultiAdd(patlistMulti,word) + 1;
+            patlistMultiOffset[i] = offset;
+            ++nmulti;
+        }
+
+        ++i;
+    }
+
+    ajStrDel(&word);
+
+    if(nmulti < 2)
+    {
+        embPatMultiDel(&patlistMulti);
+
+        return ajFalse;
+    }
+
+    embPatMultiCompile(patlistMulti);
+
+    ajDebug("patlistMultiBuild: %u of %u patterns with %u words\n",
+            nmulti, npats, patlistMulti->Nwords);
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic patlistMultiClear **********************************************
+**
+** Delete the multiple pattern automaton of a pattern list
+**
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void patlistMultiClear(void)
+{
+    embPatMultiDel(&patlistMulti);
+    AJFREE(patlistMultiComp);
+    AJFREE(patlistMultiWord);
+    AJFREE(patlistMultiOffset);
+    patlistMultiList = NULL;
+    patlistMultiNpats = 0;
+
+    return;
+}
+
+
+
+
+/* @funcstatic patlistMultiSearch *********************************************
+**
+** Search with a pattern list in one pass of its multiple pattern
+** automaton. Other patterns are searched for one by one. Features are
+** reported in the same order as embPatternSeqSearchAll would for
+** each pattern in turn.
+**
+** @param [w] ftable [AjPFeattable] Table of found features
+** @param [r] seq [const AjPSeq] Sequence to search
+** @param [u] plist [AjPPatlistSeq] List of compiled patterns
+** @param [r] reverse [AjBool] Search reverse sequence as well
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void patlistMultiSearch(AjPFeattable ftable, const AjPSeq seq,
+                               AjPPatlistSeq plist, AjBool reverse)
+{
+    AjPPatternSeq patseq = NULL;
+    AjPPatComp pat;
+    AjPStr seqstr = NULL;
+    AjPList list;
+    AjPUint *starts = NULL;
+    ajuint *nstarts = NULL;
+    const char *p;
+    ajuint slen;
+    ajuint begin;
+    ajuint hits;
+    ajuint plen;
+    ajuint off;
+    ajuint w;
+    ajuint i = 0;
+    ajuint j;
+    ajuint k;
+    ajuint x;
+
+    if(!ajSeqGetLen(seq))
+        return;
+
+    begin = ajSeqGetBeginTrue(seq);
+    patternSeqString(seq,reverse,&seqstr);
+    p = ajStrGetPtr(seqstr);
+    slen = ajStrGetLen(seqstr);
+
+    AJCNEW0(starts,patlistMulti->Nwords);
+    AJCNEW0(nstarts,patlistMulti->Nwords);
+
+    embPatMultiSearch(patlistMulti,seqstr,starts,nstarts);
+
+    while(ajPatlistSeqGetNext(plist,&patseq))
+    {
+        if(!patlistMultiWord[i])
+        {
+            embPatternSeqSearchAll(ftable,seq,patseq,reverse);
+            ++i;
+            continue;
+        }
+
+        pat  = patlistMultiComp[i];
+        w    = patlistMultiWord[i] - 1;
+        off  = patlistMultiOffset[i];
+        plen = (pat->type == 4) ? pat->m : ajStrGetLen(pat->pattern);
+        list = ajListNew();
+        hits = 0;
+
+        for(k=0;k<nstarts[w];++k)
+        {
+            x = ajUintGet(starts[w],k);
+
+            if(x < off || x - off + plen > slen)
+                continue;
+
+            x -= off;
+
+            if(pat->type == 4)
+            {
+                for(j=0;j<plen;++j)
+                    if(pat->sotable[(ajuint)p[x+j]] & (1U << (j*AJBPS)))
+                        break;
+
+                if(j < plen)
+                    continue;
+            }
+
+            embPatPushHit(list,ajSeqGetNameS(seq),x,plen,begin,0);
+            ++hits;
+        }
+
+        ajDebug("patlistMultiSearch '%S' type %d found %u hits\n",
+                pat->pattern, pat->type, hits);
+
+        patternSeqFeatAll(ftable,seq,patseq,reverse,list,hits);
+        ajListFree(&list);
+        ++i;
+    }
+
+    ajPatlistSeqRewind(plist);
+
+    for(w=0;w<patlistMulti->Nwords;++w)
+        ajUintDel(&starts[w]);
+
+    AJFREE(starts);
+    AJFREE(nstarts);
+    ajStrDel(&seqstr);
+
+    return;
+}
+
+
+
+
 /* @func embPatlistRegexSearch ************************************************
 **
 ** The main search function of patterns. It compiles the patterns and searches
@@ -677,14 +1002,94 @@ void embPatternSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
 {
     const void *tidy;
     ajuint hits;
-    ajuint i;
     AjPPatComp pattern;
+    AjPList list   = NULL;
+    AjPStr seqstr  = NULL;
+
+    if(!ajSeqGetLen(seq))
+        return;
+
+    pattern = ajPatternSeqGetCompiled(pat);
+    patternSeqString(seq,reverse,&seqstr);
+
+    /*ajDebug("seqlen:%d len: %d offset: %d offend: %d begin: %d end: %d\n"
+	   "'%S'\n",
+	   seqlen , ajSeqGetLen(seq), ajSeqGetOffset(seq),
+	   ajSeqGetOffend(seq), ajSeqGetBegin(seq), ajSeqGetEnd(seq),
+	   seqstr);*/
+
+    ajDebug("embPatternSeqSearchAll '%S' protein: %B reverse: %B\n",
+	    pattern->pattern, pat->Protein, reverse);
+    list = ajListNew();
+    embPatFuzzSearchAllII(pattern,ajSeqGetBeginTrue(seq),
+                          ajSeqGetNameS(seq),seqstr,list,
+                          ajPatternSeqGetMismatch(pat),&hits,&tidy);
+
+    ajDebug ("embPatternSeqSearchAll: found %d hits\n",hits);
+
+    patternSeqFeatAll(ftable,seq,pat,reverse,list,hits);
+
+    ajStrDel(&seqstr);
+    ajListFree(&list);
+
+    return;
+}
+
+
+
+
+/* @funcstatic patternSeqString ***********************************************
+**
+** Sequence string to search with a sequence pattern: the sequence from
+** its true begin to end in upper case, reversed for the reverse strand
+**
+** @param [r] seq [const AjPSeq] Sequence
+** @param [r] reverse [AjBool] Reverse strand
+** @param [w] seqstr [AjPStr*] Sequence string
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void patternSeqString(const AjPSeq seq, AjBool reverse,
+                             AjPStr *seqstr)
+{
+    ajStrAssignSubS(seqstr, ajSeqGetSeqS(seq),
+                    ajSeqGetBeginTrue(seq)-1,ajSeqGetEndTrue(seq)-1);
+
+    if (reverse)
+        ajSeqstrReverse(seqstr);
+
+    ajStrFmtUpper(seqstr);
+
+    return;
+}
+
+
+
+
+/* @funcstatic patternSeqFeatAll **********************************************
+**
+** Report the hits of a sequence pattern as features
+**
+** @param [w] ftable [AjPFeattable] Table of found features
+** @param [r] seq [const AjPSeq] Sequence searched
+** @param [r] pat [const AjPPatternSeq] Pattern searched with
+** @param [r] reverse [AjBool] Reverse strand was searched
+** @param [u] list [AjPList] Hits, most recent first, deleted on return
+** @param [r] hits [ajuint] Number of hits
+** @return [void]
+**
+** @release 6.6.0
+******************************************************************************/
+
+static void patternSeqFeatAll(AjPFeattable ftable, const AjPSeq seq,
+                              const AjPPatternSeq pat, AjBool reverse,
+                              AjPList list, ajuint hits)
+{
+    ajuint i;
     EmbPMatMatch m = NULL;
     AjPFeature sf  = NULL;
-    AjPSeq revseq  = NULL;
-    AjPList list   = ajListNew();
-    AjPStr seqstr  = ajStrNew();
-    AjPStr seqname = ajStrNew();
     AjPStr tmp     = ajStrNew();
     ajint adj;
     ajint begin;
@@ -692,9 +1097,6 @@ void embPatternSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
     ajint seqlen;
 
     seqlen = ajSeqGetLen(seq);
-    if(!seqlen)
-        return;
-
     isreversed = ajSeqIsReversedTrue(seq);
 
     if(isreversed)
@@ -709,34 +1111,6 @@ void embPatternSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
     if(!ajStrGetLen(featMotifNuc))
         ajStrAssignC(&featMotifNuc, "SO:0000714");
 
-    ajStrAssignS(&seqname,ajSeqGetNameS(seq));
-    pattern = ajPatternSeqGetCompiled(pat);
-
-    if (reverse)
-    {
-        revseq = ajSeqNewSeq(seq);
-        ajStrAssignSubS(&seqstr, ajSeqGetSeqS(revseq),
-			begin-1,adj-1);
-        ajSeqstrReverse(&seqstr);
-    }
-    else
-        ajStrAssignSubS(&seqstr, ajSeqGetSeqS(seq),
-			begin-1,adj-1);
-
-    ajStrFmtUpper(&seqstr);
-    /*ajDebug("seqlen:%d len: %d offset: %d offend: %d begin: %d end: %d\n"
-	   "'%S'\n",
-	   seqlen , ajSeqGetLen(seq), ajSeqGetOffset(seq),
-	   ajSeqGetOffend(seq), ajSeqGetBegin(seq), ajSeqGetEnd(seq),
-	   seqstr);*/
-
-    ajDebug("embPatternSeqSearchAll '%S' protein: %B reverse: %B\n",
-	    pattern->pattern, pat->Protein, reverse);
-    embPatFuzzSearchAllII(pattern,begin,seqname,seqstr,list,
-                          ajPatternSeqGetMismatch(pat),&hits,&tidy);
-
-    ajDebug ("embPatternSeqSearchAll: found %d hits\n",hits);
-
     if(!reverse)
 	ajListReverse(list);
 
@@ -789,13 +1163,7 @@ void embPatternSeqSearchAll(AjPFeattable ftable, const AjPSeq seq,
         embMatMatchDel(&m);
     }
 
-    ajStrDel(&seqname);
-    ajStrDel(&seqstr);
     ajStrDel(&tmp);
-    ajListFree(&list);
-
-    if (reverse)
-        ajSeqDel(&revseq);
 
     return;
 }
@@ -865,6 +1233,7 @@ void embPatlistExit(void)
 {
     ajStrDel(&featMotifNuc);
     ajStrDel(&featMotifProt);
+    patlistMultiClear();
 
     return;
 }
@@ -69,6 +69,31 @@ static AjPList wordCurList = NULL;
 
 
 
+
+/* @datastatic WordPIndexItem *************************************************
+**
+** Word location used in building a packed word index
+**
+** @alias WordSIndexItem
+** @alias WordOIndexItem
+**
+** @attr Code [ajulong] Word code
+** @attr Seqindx [ajuint] Sequence number
+** @attr Pos [ajuint] Start position in the sequence
+** @@
+******************************************************************************/
+
+typedef struct WordSIndexItem
+{
+    ajulong Code;
+    ajuint Seqindx;
+    ajuint Pos;
+} WordOIndexItem;
+
+#define WordPIndexItem WordOIndexItem*
+
+
+
 static ajint    wordCmpStr(const void *x, const void *y);
 static ajint    wordCompare(const void *x, const void *y);
 static void     wordCurIterTrace(const AjIList curiter);
@@ -78,16 +103,49 @@ static ajint    wordDeadZone(EmbPWordMatch match,
 			     int deadx2, ajint deady2, ajint minlength);
 static void     wordListInsertNodeOld(AjPListNode* pnode, void* x);
 static void     wordListInsertOld(AjIList iter, void* x);
+static void     wordMatchAdd(AjPList hitlist, AjIList curiter,
+                             const AjPSeq seq2, ajuint knew, ajuint i);
 static ajint    wordMatchCmp(const void* v1, const void* v2);
 static ajint    wordMatchCmpPos(const void* v1, const void* v2);
 static void     wordNewListTrace(ajint i, const AjPList newlist);
 static void     wordOrderPosMatchTable(AjPList unorderedList);
 
+static AjBool   wordStartFirst(const char* seqc, char skipchar,
+                               ajuint ilast, ajuint* Pi);
+static AjBool   wordStartNext(const char* seqc, char skipchar,
+                              ajuint ilast, ajuint* Pi);
 static ajulong  wordStrHash(const void *key, ajulong hashsize);
 
+static ajuint   wordAlphabetSet(const AjPSeq* seqs, ajuint nseqs,
+                                ajint* alphabet);
+static ajuint   wordGetOrder(const AjPSeq* seqs, ajuint nseqs,
+                             ajuint wordlen, ajuint nwords,
+                             const ajuint* starts, const ajuint* seqindxs,
+                             const ajuint* locs, ajuint** Porder);
+static ajuint   wordMatchExtend(const char* seqc, ajuint seqlen, ajuint pos,
+                                const char* text, ajuint tlen, ajuint* Pii,
+                                ajuint matchlen);
+
 static void     wordVFreeLocs(void **value);
 static void     wordVFreeSeqlocs(void **value);
 
+static AjBool   wordIndexFind(const EmbPWordIndex windex, ajulong code,
+                              ajuint* Pword);
+static EmbPWordIndex wordIndexNew(const AjPSeq* seqs, ajuint nseqs);
+static void     wordIndexSort(WordPIndexItem items, WordPIndexItem tmp,
+                              ajulong nitems, ajuint nbits);
+
+static AjBool   wordSuffixFind(const EmbPWordSuffix wsuffix,
+                               const ajuint* codes, ajuint* Pword);
+static void     wordSuffixLocs(EmbPWordSuffix wsuffix);
+static ajint    wordSuffixMatchCmp(const void* v1, const void* v2);
+static void     wordSuffixMatches(EmbPWordSuffix wsuffix);
+static EmbPWordSuffix wordSuffixNew(const AjPSeq* seqs, ajuint nseqs);
+static ajint    wordSuffixOffsetCmp(const void* v1, const void* v2);
+static ajuint   wordSuffixSeqindx(const EmbPWordSuffix wsuffix, ajuint pos);
+static void     wordSuffixSort(const ajuint* text, ajuint n, ajuint ncodes,
+                               ajuint* sa, ajuint* rank);
+
 static ajint    wordRabinKarpCmp(const void *trgseq, const void *qryseq);
 static ajulong  wordRabinKarpConstant(ajuint m);
 
@@ -615,6 +673,208 @@ void embWordMatchListConvToFeat(const AjPList list,
 
 
 
+/* @funcstatic wordStartFirst *************************************************
+**
+** Finds the first word in a sequence with no ambiguity code
+**
+** @param [r] seqc [const char*] Sequence
+** @param [r] skipchar [char] Ambiguity code, N or X
+** @param [r] ilast [ajuint] Start of the last word in the sequence
+** @param [w] Pi [ajuint*] Start of the first word
+** @return [AjBool] ajTrue if a word was found
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool wordStartFirst(const char* seqc, char skipchar, ajuint ilast,
+                             ajuint* Pi)
+{
+    ajuint i = 0;
+    ajuint j = 0;
+
+    while(j<wordLength)
+    {
+	if((char)toupper((ajint)seqc[i+j]) == skipchar)
+	{
+	    ajDebug("Skip '%c' at start from %d",
+		    skipchar, i+j+1);
+
+	    while((char)toupper((ajint)seqc[i+j]) == skipchar)
+		i++;
+
+	    ajDebug(" to %d\n",
+		    i+j);
+	    j = 0;
+
+	    if(i > ilast)
+		return ajFalse;
+	}
+	else
+	    j++;
+    }
+
+    *Pi = i;
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic wordStartNext **************************************************
+**
+** Finds the next word in a sequence, stepping over ambiguity codes.
+**
+** Only the last residue of each word is tested, so once a run of
+** ambiguity codes is passed a word can still contain a later ambiguity
+** code within one word length. Word tables and word indexes share this
+** rule so they hold the same words.
+**
+** @param [r] seqc [const char*] Sequence
+** @param [r] skipchar [char] Ambiguity code, N or X
+** @param [r] ilast [ajuint] Start of the last word in the sequence
+** @param [u] Pi [ajuint*] Start of the word to test, updated to the
+**                         start of the next word
+** @return [AjBool] ajTrue if a word was found
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool wordStartNext(const char* seqc, char skipchar, ajuint ilast,
+                            ajuint* Pi)
+{
+    ajuint i = *Pi;
+    ajuint j = wordLength - 1;
+
+    while(i <= ilast)
+    {
+	if((char)toupper((ajint)seqc[i+j]) != skipchar)
+	{
+	    *Pi = i;
+
+	    return ajTrue;
+	}
+
+	ajDebug("Skip '%c' from %d", skipchar, j);
+
+	while((char)toupper((ajint)seqc[i+j]) == skipchar)
+	    i++;
+
+	i += j;
+	ajDebug(" to %d\n", i);
+    }
+
+    return ajFalse;
+}
+
+
+
+
+/* @funcstatic wordAlphabetSet ************************************************
+**
+** Numbers the residues found in a set of sequences in character order,
+** so that word codes sort in the same order as the words
+**
+** Ambiguity codes are included, as a word may contain them
+**
+** @param [r] seqs [const AjPSeq*] Sequences
+** @param [r] nseqs [ajuint] Number of sequences
+** @param [w] alphabet [ajint*] Residue code for each character,
+**                              -1 if not found
+** @return [ajuint] Number of residue codes
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint wordAlphabetSet(const AjPSeq* seqs, ajuint nseqs,
+                              ajint* alphabet)
+{
+    AjBool present[256];
+    const char *cp;
+    ajuint nalpha = 0;
+    ajuint len;
+    ajuint pos;
+    ajuint i;
+    ajint c;
+
+    for(c=0; c < 256; c++)
+        present[c] = ajFalse;
+
+    for(i=0; i < nseqs; i++)
+    {
+        len = ajSeqGetLen(seqs[i]);
+
+        if(len < wordLength)
+            continue;
+
+        cp = ajSeqGetSeqC(seqs[i]);
+
+        for(pos=0; pos < len; pos++)
+            present[toupper((ajint) (unsigned char) cp[pos])] = ajTrue;
+    }
+
+    for(c=0; c < 256; c++)
+        alphabet[c] = -1;
+
+    for(c=0; c < 256; c++)
+    {
+        if(!present[c])
+            continue;
+
+        alphabet[c] = nalpha;
+        alphabet[tolower(c)] = nalpha;
+        nalpha++;
+    }
+
+    return nalpha;
+}
+
+
+
+
+/* @funcstatic wordMatchExtend ************************************************
+**
+** Extends a word match between a sequence and a text, ignoring case
+**
+** @param [r] seqc [const char*] Sequence
+** @param [r] seqlen [ajuint] Sequence length
+** @param [r] pos [ajuint] Start of the match in the sequence
+** @param [r] text [const char*] Text
+** @param [r] tlen [ajuint] Text length
+** @param [u] Pii [ajuint*] Text position after the matched word,
+**                          returned as one past the last position tested
+** @param [r] matchlen [ajuint] Length matched so far
+** @return [ajuint] Length of the extended match
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint wordMatchExtend(const char* seqc, ajuint seqlen, ajuint pos,
+                              const char* text, ajuint tlen, ajuint* Pii,
+                              ajuint matchlen)
+{
+    ajuint ii = *Pii;
+
+    while(ii<tlen && pos+matchlen<seqlen)
+    {
+        if(toupper((int)seqc[pos+matchlen]) != toupper((int)text[ii++]))
+            break;
+        else
+            ++matchlen;
+    }
+
+    *Pii = ii;
+
+    return matchlen;
+}
+
+
+
+
 /* @func embWordGetTable ******************************************************
 **
 ** Builds a table of all words in a sequence.
@@ -631,9 +891,9 @@ void embWordMatchListConvToFeat(const AjPList list,
 
 AjBool embWordGetTable(AjPTable *table, const AjPSeq seq)
 {
+    const char * seqc;
     const char * startptr;
-    ajuint i;
-    ajuint j;
+    ajuint i = 0;
     ajuint ilast;
     ajuint *k;
     EmbPWord rec;
@@ -673,61 +933,21 @@ AjBool embWordGetTable(AjPTable *table, const AjPSeq seq)
     }
 
     /* initialise ptr to start of seq string */
-    startptr = ajSeqGetSeqC(seq);
+    seqc = ajSeqGetSeqC(seq);
 
-    i = 0;
     ilast = ajSeqGetLen(seq) - wordLength;
 
-    j=0;
-
-    while(j<wordLength)
+    if(!wordStartFirst(seqc, skipchar, ilast, &i))
     {
-	if((char)toupper((ajint)startptr[j]) == skipchar)
-	{
-	    ajDebug("Skip '%c' at start from %d",
-		    skipchar, i+j+1);
-
-	    while((char)toupper((ajint)startptr[j]) == skipchar)
-	    {
-		i++;
-		startptr++;
-	    }
-
-	    ajDebug(" to %d\n",
-		    i+j);
-	    j = 0;
-
-	    if(i > ilast)
-            {
-		ajDebug("sequence has no word without ambiguity code '%c'\n",
-			skipchar);
+	ajDebug("sequence has no word without ambiguity code '%c'\n",
+		skipchar);
 
-		return ajFalse;
-	    }
-	}
-	else
-	    j++;
+	return ajFalse;
     }
 
-    j = wordLength - 1;
-
-    while(i <= ilast)
+    while(wordStartNext(seqc, skipchar, ilast, &i))
     {
-	if((char)toupper((ajint)startptr[j]) == skipchar)
-	{
-	    ajDebug("Skip '%c' from %d", skipchar, j);
-
-	    while((char)toupper((ajint)startptr[j]) == skipchar)
-	    {
-		i++;
-		startptr++;
-	    }
-
-	    i += j;
-	    startptr += j;
-	    ajDebug(" to %d\n", i);
-	    continue;
-	}
+	startptr = &seqc[i];
 
 	rec = (EmbPWord) ajTableFetchmodV(*table, startptr);
 
@@ -763,9 +983,7 @@ AjBool embWordGetTable(AjPTable *table, const AjPSeq seq)
 
 	ajListPushAppend(seqlocs->locs, k);
 
-	startptr++;
 	i++;
-
     }
 
     ajDebug("table done, size %Lu\n", ajTableGetLength(*table));
@@ -940,6 +1158,99 @@ static ajint wordMatchCmpPos(const void* v1, const void* v2)
 
 
 
+/* @funcstatic wordMatchAdd ***************************************************
+**
+** Adds a word match at one position in the second sequence, either
+** extending an ongoing match or starting a new one.
+**
+** Ongoing matches that cannot be extended beyond the current position
+** are removed from the list of current matches.
+**
+** @param [u] hitlist [AjPList] List of all matches
+** @param [u] curiter [AjIList] Iterator over the current matches,
+**                              or NULL if there are none
+** @param [r] seq2 [const AjPSeq] Second sequence
+** @param [r] knew [ajuint] Word position in the first sequence
+** @param [r] i [ajuint] Word position in the second sequence
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void wordMatchAdd(AjPList hitlist, AjIList curiter,
+                         const AjPSeq seq2, ajuint knew, ajuint i)
+{
+    EmbPWordMatch newmatch;
+    EmbPWordMatch curmatch = NULL;
+    ajuint kcur = 0;
+    ajuint kcur2 = 0;
+    AjBool matched = ajFalse;
+
+    ajListIterRewind(curiter);
+
+    while(!ajListIterDone(curiter) )
+    {
+        curmatch = ajListIterGet(curiter);
+        kcur = curmatch->seq1start + curmatch->length -
+            wordLength + 1;
+        kcur2 = curmatch->seq2start + curmatch->length -
+            wordLength + 1;
+        /*ajDebug(".test kcur/knew %u/%u kcur2/i %u/%u\n",
+          kcur, knew, kcur2, i);*/
+
+        /* when we test, we may have already incremented
+           one of the matches - so test old and new kcur2 */
+        if(kcur2 != i && kcur2 != i+1)
+        {
+            /*ajDebug("finished kcur: %u kcur2: %u i: %u\n",
+              kcur, kcur2,i);*/
+            ajListIterRemove(curiter);
+            continue;
+        }
+
+        if(kcur == knew && kcur2 == i)
+        {			/* check continued matches */
+            /* ajDebug("**match knew: %d kcur: %d kcur2: %d "
+               "start1: %d "
+               "start2: %d len: %d i:%d\n",
+               knew, kcur, kcur2,curmatch->seq1start,
+               curmatch->seq2start,curmatch->length, i);*/
+            curmatch->length++;
+            matched = ajTrue;
+            continue;
+        }
+    }
+
+    if(!matched)
+    {			/* new current match */
+        /* add to hitlist */
+        newmatch = embWordMatchNew(seq2, knew, i, wordLength);
+        ajListPushAppend(hitlist, newmatch);
+
+        if(curiter)
+        {			/* add to wordCurList */
+            /*ajDebug("...ajListInsert using curiter %u\n",
+              ajListGetLength(wordCurList));*/
+            wordListInsertOld(curiter, newmatch);
+            /*wordCurListTrace(wordCurList);*/
+            /*wordCurIterTrace(curiter);*/
+        }
+        else
+        {
+            /*ajDebug("...ajListPushAppend to wordCurList %u\n",
+              ajListGetLength(wordCurList));*/
+            ajListPushAppend(wordCurList, newmatch);
+            /* wordCurListTrace(wordCurList); */
+        }
+    }
+
+    return;
+}
+
+
+
+
 /* @func embWordBuildMatchTable ***********************************************
 **
 ** Create a linked list of all the matches and order them by the
@@ -973,17 +1284,12 @@ AjPList embWordBuildMatchTable(const AjPTable seq1MatchTable,
     EmbPWordSeqLocs* seqlocs=NULL;
     const char *startptr;
     EmbPWord wordmatch;
-    EmbPWordMatch newmatch;
-    EmbPWordMatch curmatch = NULL;
     AjIList newiter;
     AjIList curiter;
     void *ptr = NULL;
 
     ajint *k = 0;
-    ajuint kcur = 0;
-    ajuint kcur2 = 0;
     ajuint knew = 0;
-    AjBool matched = ajFalse;
 
     assert(wordLength > 0);
 
@@ -1036,10 +1342,6 @@ AjPList embWordBuildMatchTable(const AjPTable seq1MatchTable,
                 /*ajDebug("wordCurList size %d\n",
                   ajListGetLength(wordCurList));*/
 		curiter = ajListIterNew(wordCurList);
-
-		curmatch = ajListIterGet(curiter);
-		kcur = curmatch->seq1start + curmatch->length - wordLength + 1;
-		kcur2 = curmatch->seq2start + curmatch->length - wordLength + 1;
 	    }
 	    else
 		curiter = NULL;
@@ -1051,68 +1353,7 @@ AjPList embWordBuildMatchTable(const AjPTable seq1MatchTable,
 
                 /*ajDebug("knew: %u i:%u\n", knew, i);*/
 		/* compare to current hits to test for extending */
-
-                ajListIterRewind(curiter);
-                matched = ajFalse;
-
-                while(!ajListIterDone(curiter) )
-                {
-		    curmatch = ajListIterGet(curiter);
-		    kcur = curmatch->seq1start + curmatch->length -
-                        wordLength + 1;
-                    kcur2 = curmatch->seq2start + curmatch->length -
-                        wordLength + 1;
-                    /*ajDebug(".test kcur/knew %u/%u kcur2/i %u/%u\n",
-                      kcur, knew, kcur2, i);*/
-
-                    /* when we test, we may have already incremented
-                       one of the matches - so test old and new kcur2 */
-                    if(kcur2 != i && kcur2 != i+1)
-                    {
-                        /*ajDebug("finished kcur: %u kcur2: %u i: %u\n",
-                          kcur, kcur2,i);*/
-                        ajListIterRemove(curiter);
-                        continue;
-                    }
-
-                    if(kcur == knew && kcur2 == i)
-                    {			/* check continued matches */
-                        /* ajDebug("**match knew: %d kcur: %d kcur2: %d "
-                           "start1: %d "
-                                "start2: %d len: %d i:%d\n",
-                                knew, kcur, kcur2,curmatch->seq1start,
-                                curmatch->seq2start,curmatch->length, i);*/
-			curmatch->length++;
-                        matched = ajTrue;
-                        continue;
-                    }
-                }
-
-                if(!matched)
-                {			/* new current match */
-                    /*ajDebug("save start1: %d start2: %d len: %d\n",
-                            match2->seq1start, match2->seq2start,
-                            match2->length);*/
-                    /* add to hitlist */
-                    newmatch = embWordMatchNew(seq2, knew, i, wordLength);
-                    ajListPushAppend(hitlist, newmatch);
-
-                    if(curiter)
-                    {			/* add to wordCurList */
-                        /*ajDebug("...ajListInsert using curiter %u\n",
-                          ajListGetLength(wordCurList));*/
-                        wordListInsertOld(curiter, newmatch);
-                        /*wordCurListTrace(wordCurList);*/
-                        /*wordCurIterTrace(curiter);*/
-                    }
-                    else
-                    {
-                        /*ajDebug("...ajListPushAppend to wordCurList %u\n",
-                          ajListGetLength(wordCurList));*/
-                        ajListPushAppend(wordCurList, newmatch);
-                        /* wordCurListTrace(wordCurList); */
-                    }
-                }
+                wordMatchAdd(hitlist, curiter, seq2, knew, i);
  		/* ajDebug("k: %d i: %d\n", *k, i); */
 	    }
 
@@ -1886,14 +2127,9 @@ ajuint embWordRabinKarpSearch(const AjPStr sseq,
                             continue;
 
                         /* this is where we extend matches */
-                        while(ii<tlen  && pos+matchlen<ajSeqGetLen(seq))
-                        {
-			  if(toupper((int)seq_[pos+matchlen]) !=
-			     toupper((int)text[ii++]))
-                                break;
-                            else
-                                ++matchlen;
-                        }
+                        matchlen = wordMatchExtend(seq_, ajSeqGetLen(seq),
+                                                   pos, text, tlen, &ii,
+                                                   matchlen);
 
                         nMatches ++;
 
@@ -1931,6 +2167,1955 @@ ajuint embWordRabinKarpSearch(const AjPStr sseq,
 
 
 
+/* @funcstatic wordIndexNew ***************************************************
+**
+** Builds a packed word index for an array of sequences.
+**
+** The word length must be defined by a call to embWordLength.
+**
+** Words are taken as for embWordGetTable, which steps over the
+** sequence's ambiguity character (N for nucleotides, X for proteins).
+**
+** @param [r] seqs [const AjPSeq*] Sequences
+** @param [r] nseqs [ajuint] Number of sequences
+** @return [EmbPWordIndex] Word index, or NULL if no words were found or
+**                         a word cannot be encoded in 64 bits
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static EmbPWordIndex wordIndexNew(const AjPSeq* seqs, ajuint nseqs)
+{
+    EmbPWordIndex ret = NULL;
+    WordPIndexItem items = NULL;
+    WordPIndexItem tmp = NULL;
+    const char *cp;
+    char skipchar;
+    ajulong nitems = 0;
+    ajulong n = 0;
+    ajulong j;
+    ajulong code;
+    ajulong mask;
+    ajuint nalpha = 0;
+    ajuint nbits = 1;
+    ajuint totbits;
+    ajuint bucketbits;
+    ajuint nbuckets;
+    ajuint len;
+    ajuint ilast;
+    ajuint pos;
+    ajuint next;
+    ajuint i;
+    ajuint iword;
+    AjBool rolling;
+
+    assert(wordLength > 0);
+
+    for(i=0; i < nseqs; i++)
+    {
+        len = ajSeqGetLen(seqs[i]);
+
+        if(len >= wordLength)
+            nitems += len - wordLength + 1;
+    }
+
+    if(!nitems)
+        return NULL;
+
+    AJNEW0(ret);
+
+    /* residues are numbered in character order so codes sort as words */
+
+    nalpha = wordAlphabetSet(seqs, nseqs, ret->Alphabet);
+
+    while(((ajuint) 1 << nbits) < nalpha)
+        nbits++;
+
+    totbits = nbits * wordLength;
+
+    ajDebug("wordIndexNew nseqs %u wordlength %u alphabet %u bits %u\n",
+            nseqs, wordLength, nalpha, totbits);
+
+    if(totbits > 64)
+    {
+        AJFREE(ret);
+
+        return NULL;
+    }
+
+    if(totbits == 64)
+        mask = ~(ajulong) 0;
+    else
+        mask = ((ajulong) 1 << totbits) - 1;
+
+    ret->Wordlen = wordLength;
+    ret->Bits = nbits;
+
+    AJCNEW(items, nitems);
+
+    for(i=0; i < nseqs; i++)
+    {
+        len = ajSeqGetLen(seqs[i]);
+
+        if(len < wordLength)
+            continue;
+
+        skipchar = 'X';
+
+        if(ajSeqIsNuc(seqs[i]))
+            skipchar = 'N';
+
+        cp = ajSeqGetSeqC(seqs[i]);
+        ilast = len - wordLength;
+
+        if(!wordStartFirst(cp, skipchar, ilast, &pos))
+            continue;
+
+        code = 0;
+        next = 0;
+        rolling = ajFalse;
+
+        /* the same words as embWordGetTable, coded as they are found */
+
+        while(wordStartNext(cp, skipchar, ilast, &pos))
+        {
+            if(rolling && pos == next)
+                code = ((code << nbits) |
+                        (ajulong) ret->Alphabet[(unsigned char)
+                                                cp[pos+wordLength-1]]) & mask;
+            else
+            {
+                code = 0;
+
+                for(j=0; j < wordLength; j++)
+                    code = (code << nbits) |
+                        (ajulong) ret->Alphabet[(unsigned char) cp[pos+j]];
+            }
+
+            items[n].Code = code;
+            items[n].Seqindx = i;
+            items[n].Pos = pos;
+            n++;
+
+            rolling = ajTrue;
+            next = ++pos;
+        }
+    }
+
+    if(!n)
+    {
+        AJFREE(items);
+        AJFREE(ret);
+
+        return NULL;
+    }
+
+    /*
+    ** Items were generated in sequence and position order,
+    ** so a stable sort on the code alone keeps that order for each word
+    */
+
+    AJCNEW(tmp, n);
+    wordIndexSort(items, tmp, n, totbits);
+    AJFREE(tmp);
+
+    ret->Nlocs = (ajuint) n;
+    ret->Nseqs = nseqs;
+
+    for(j=0; j < n; j++)
+        if(!j || items[j].Code != items[j-1].Code)
+            ret->Nwords++;
+
+    AJCNEW(ret->Seqs, nseqs);
+    AJCNEW(ret->Codes, ret->Nwords);
+    AJCNEW(ret->Starts, ret->Nwords+1);
+    AJCNEW(ret->Seqindxs, n);
+    AJCNEW(ret->Locs, n);
+    AJCNEW0(ret->Wordseqs, ret->Nwords);
+    AJCNEW0(ret->Nmatches, ret->Nwords);
+    AJCNEW0(ret->Lenmatches, ret->Nwords);
+    AJCNEW0(ret->Seqmatches, nseqs);
+
+    for(i=0; i < nseqs; i++)
+        ret->Seqs[i] = seqs[i];
+
+    iword = 0;
+
+    for(j=0; j < n; j++)
+    {
+        if(!j || items[j].Code != items[j-1].Code)
+        {
+            ret->Codes[iword] = items[j].Code;
+            ret->Starts[iword] = (ajuint) j;
+            ret->Wordseqs[iword] = 1;
+            iword++;
+        }
+        else if(items[j].Seqindx != items[j-1].Seqindx)
+            ret->Wordseqs[iword-1]++;
+
+        ret->Seqindxs[j] = items[j].Seqindx;
+        ret->Locs[j] = items[j].Pos;
+    }
+
+    ret->Starts[ret->Nwords] = (ajuint) n;
+
+    AJFREE(items);
+
+    /* bucket the codes by their leading bits to narrow each search */
+
+    bucketbits = totbits;
+
+    if(bucketbits > 16)
+        bucketbits = 16;
+
+    ret->Bucketshift = totbits - bucketbits;
+    nbuckets = (ajuint) 1 << bucketbits;
+    AJCNEW(ret->Buckets, nbuckets+1);
+
+    iword = 0;
+
+    for(i=0; i < nbuckets; i++)
+    {
+        while(iword < ret->Nwords &&
+              (ret->Codes[iword] >> ret->Bucketshift) < (ajulong) i)
+            iword++;
+
+        ret->Buckets[i] = iword;
+    }
+
+    ret->Buckets[nbuckets] = ret->Nwords;
+
+    ajDebug("wordIndexNew words %u locations %u\n",
+            ret->Nwords, ret->Nlocs);
+
+    return ret;
+}
+
+
+
+
+/* @funcstatic wordIndexSort **************************************************
+**
+** Stable radix sort of word index items by word code.
+**
+** @param [u] items [WordPIndexItem] Items to be sorted
+** @param [w] tmp [WordPIndexItem] Work array of the same size
+** @param [r] nitems [ajulong] Number of items
+** @param [r] nbits [ajuint] Number of bits used in the codes
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void wordIndexSort(WordPIndexItem items, WordPIndexItem tmp,
+                          ajulong nitems, ajuint nbits)
+{
+    ajulong count[256];
+    WordPIndexItem from = items;
+    WordPIndexItem to = tmp;
+    WordPIndexItem swap;
+    ajulong total;
+    ajulong k;
+    ajulong i;
+    ajuint shift;
+    ajuint j;
+
+    for(shift=0; shift < nbits; shift += 8)
+    {
+        for(j=0; j < 256; j++)
+            count[j] = 0;
+
+        for(i=0; i < nitems; i++)
+            count[(from[i].Code >> shift) & 0xff]++;
+
+        total = 0;
+
+        for(j=0; j < 256; j++)
+        {
+            k = count[j];
+            count[j] = total;
+            total += k;
+        }
+
+        for(i=0; i < nitems; i++)
+            to[count[(from[i].Code >> shift) & 0xff]++] = from[i];
+
+        swap = from;
+        from = to;
+        to = swap;
+    }
+
+    if(from != items)
+        memcpy(items, from, nitems * sizeof(*items));
+
+    return;
+}
+
+
+
+
+/* @funcstatic wordIndexFind **************************************************
+**
+** Finds a word code in a packed word index.
+**
+** @param [r] windex [const EmbPWordIndex] Word index
+** @param [r] code [ajulong] Word code
+** @param [w] Pword [ajuint*] Word number
+** @return [AjBool] ajTrue if the word was found
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool wordIndexFind(const EmbPWordIndex windex, ajulong code,
+                            ajuint* Pword)
+{
+    ajulong bucket;
+    ajuint lo;
+    ajuint hi;
+    ajuint mid;
+
+    bucket = code >> windex->Bucketshift;
+    lo = windex->Buckets[bucket];
+    hi = windex->Buckets[bucket+1];
+
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+
+        if(windex->Codes[mid] < code)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if(lo < windex->Buckets[bucket+1] && windex->Codes[lo] == code)
+    {
+        *Pword = lo;
+
+        return ajTrue;
+    }
+
+    return ajFalse;
+}
+
+
+
+
+/* @func embWordIndexNewSeq ***************************************************
+**
+** Builds a packed index of all words in a sequence.
+**
+** The word length must be defined by a call to embWordLength.
+**
+** @param [r] seq [const AjPSeq] Sequence to be "worded"
+** @return [EmbPWordIndex] Word index, or NULL if the sequence has no words
+**                         or a word cannot be encoded in 64 bits, in which
+**                         case embWordGetTable should be used instead.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+EmbPWordIndex embWordIndexNewSeq(const AjPSeq seq)
+{
+    return wordIndexNew(&seq, 1);
+}
+
+
+
+
+/* @func embWordIndexNewSeqset ************************************************
+**
+** Builds a packed index of all words in a sequence set.
+**
+** The word length must be defined by a call to embWordLength.
+**
+** @param [r] seqset [const AjPSeqset] Sequence set
+** @return [EmbPWordIndex] Word index, or NULL if there are no words
+**                         or a word cannot be encoded in 64 bits, in which
+**                         case embWordGetTable should be used instead.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+EmbPWordIndex embWordIndexNewSeqset(const AjPSeqset seqset)
+{
+    EmbPWordIndex ret;
+    const AjPSeq* seqs = NULL;
+    ajuint nseqs;
+    ajuint i;
+
+    nseqs = (ajuint) ajSeqsetGetSize(seqset);
+
+    if(!nseqs)
+        return NULL;
+
+    AJCNEW(seqs, nseqs);
+
+    for(i=0; i < nseqs; i++)
+        seqs[i] = ajSeqsetGetseqSeq(seqset, i);
+
+    ret = wordIndexNew(seqs, nseqs);
+
+    AJFREE(seqs);
+
+    return ret;
+}
+
+
+
+
+/* @func embWordIndexDel ******************************************************
+**
+** Deletes a packed word index.
+**
+** @param [d] Pwindex [EmbPWordIndex*] Word index
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void embWordIndexDel(EmbPWordIndex *Pwindex)
+{
+    EmbPWordIndex windex;
+
+    if(!Pwindex || !*Pwindex)
+        return;
+
+    windex = *Pwindex;
+
+    AJFREE(windex->Seqs);
+    AJFREE(windex->Codes);
+    AJFREE(windex->Starts);
+    AJFREE(windex->Seqindxs);
+    AJFREE(windex->Locs);
+    AJFREE(windex->Buckets);
+    AJFREE(windex->Wordseqs);
+    AJFREE(windex->Nmatches);
+    AJFREE(windex->Lenmatches);
+    AJFREE(windex->Seqmatches);
+
+    AJFREE(*Pwindex);
+
+    return;
+}
+
+
+
+
+/* @func embWordIndexGetWord **************************************************
+**
+** Returns a word from a packed word index, as it is first found in the
+** indexed sequences.
+**
+** @param [r] windex [const EmbPWordIndex] Word index
+** @param [r] i [ajuint] Word number
+** @param [w] Pword [AjPStr*] Word
+** @return [AjBool] ajTrue if the word number is in the index
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embWordIndexGetWord(const EmbPWordIndex windex, ajuint i,
+                           AjPStr *Pword)
+{
+    ajuint j;
+
+    ajStrAssignClear(Pword);
+
+    if(i >= windex->Nwords)
+        return ajFalse;
+
+    j = windex->Starts[i];
+
+    ajStrAssignLenC(Pword,
+                    &ajSeqGetSeqC(windex->Seqs[windex->Seqindxs[j]])
+                    [windex->Locs[j]],
+                    windex->Wordlen);
+
+    return ajTrue;
+}
+
+
+
+
+/* @funcstatic wordGetOrder ***************************************************
+**
+** Returns the word numbers of a packed word index or suffix array in the
+** order embWordRabinKarpInit returns the same words from a word table
+** built by embWordGetTable.
+**
+** @param [r] seqs [const AjPSeq*] Indexed sequences
+** @param [r] nseqs [ajuint] Number of sequences
+** @param [r] wordlen [ajuint] Word length
+** @param [r] nwords [ajuint] Number of words
+** @param [r] starts [const ajuint*] First location of each word
+** @param [r] seqindxs [const ajuint*] Sequence number for each location
+** @param [r] locs [const ajuint*] Start position for each location
+** @param [w] Porder [ajuint**] Word numbers in Rabin-Karp pattern order
+** @return [ajuint] Number of words
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint wordGetOrder(const AjPSeq* seqs, ajuint nseqs, ajuint wordlen,
+                           ajuint nwords, const ajuint* starts,
+                           const ajuint* seqindxs, const ajuint* locs,
+                           ajuint** Porder)
+{
+    AjPTable table = NULL;
+    WordPIndexItem items = NULL;
+    WordPIndexItem tmp = NULL;
+    ajuint* offsets = NULL;
+    ajuint* firsts = NULL;
+    ajuint* wordnums = NULL;
+    ajuint** values = NULL;
+    const char* word;
+    ajulong patternHash;
+    ajuint tablesize = 0;
+    ajuint totlen = 0;
+    ajuint len;
+    ajuint nfound;
+    ajuint i;
+    ajuint j;
+
+    AJCNEW(offsets, nseqs);
+
+    for(i=0; i < nseqs; i++)
+    {
+        len = ajSeqGetLen(seqs[i]);
+
+        if(!tablesize && len >= wordlen)
+            tablesize = len;
+
+        offsets[i] = totlen;
+        totlen += len;
+    }
+
+    /* words are added to a word table as they are first found */
+
+    AJCNEW(firsts, totlen);
+    AJCNEW(wordnums, nwords);
+
+    for(j=0; j < totlen; j++)
+        firsts[j] = nwords;
+
+    for(i=0; i < nwords; i++)
+    {
+        j = starts[i];
+        firsts[offsets[seqindxs[j]] + locs[j]] = i;
+        wordnums[i] = i;
+    }
+
+    table = ajTableNewFunctionLen(tablesize, &wordCmpStr, &wordStrHash,
+                                  NULL, NULL);
+
+    for(i=0; i < nseqs; i++)
+    {
+        len = ajSeqGetLen(seqs[i]);
+
+        for(j=0; j < len; j++)
+            if(firsts[offsets[i] + j] < nwords)
+                ajTablePut(table,
+                           (void*) &ajSeqGetSeqC(seqs[i])[j],
+                           &wordnums[firsts[offsets[i] + j]]);
+    }
+
+    nfound = (ajuint) ajTableToarrayValues(table, (void***) &values);
+
+    /* then stable sorted by pattern hash value as in embWordRabinKarpInit */
+
+    AJCNEW(items, nfound);
+    AJCNEW(tmp, nfound);
+
+    for(i=0; i < nfound; i++)
+    {
+        j = starts[*values[i]];
+        word = &ajSeqGetSeqC(seqs[seqindxs[j]])[locs[j]];
+        patternHash = 0;
+
+        for(j=0; j < wordlen; j++)
+            patternHash = (RK_RADIX * patternHash +
+                           toupper((int)word[j])) % RK_MODULUS;
+
+        items[i].Code = patternHash;
+        items[i].Pos = *values[i];
+    }
+
+    wordIndexSort(items, tmp, nfound, 32);
+
+    AJCNEW(*Porder, nfound);
+
+    for(i=0; i < nfound; i++)
+        (*Porder)[i] = items[i].Pos;
+
+    AJFREE(tmp);
+    AJFREE(items);
+    AJFREE(values);
+    ajTableFree(&table);
+    AJFREE(wordnums);
+    AJFREE(firsts);
+    AJFREE(offsets);
+
+    return nfound;
+}
+
+
+
+
+/* @func embWordIndexGetOrder *************************************************
+**
+** Returns the word numbers of a packed word index in the order
+** embWordRabinKarpInit returns the same words from a word table built by
+** embWordGetTable, so results can be reported in the same order.
+**
+** @param [r] windex [const EmbPWordIndex] Word index
+** @param [w] Porder [ajuint**] Word numbers in Rabin-Karp pattern order
+** @return [ajuint] Number of words
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajuint embWordIndexGetOrder(const EmbPWordIndex windex, ajuint** Porder)
+{
+    return wordGetOrder(windex->Seqs, windex->Nseqs, windex->Wordlen,
+                        windex->Nwords, windex->Starts, windex->Seqindxs,
+                        windex->Locs, Porder);
+}
+
+
+
+
+/* @func embWordIndexBuildMatchTable ******************************************
+**
+** Create a linked list of all the matches between the sequence in a
+** packed word index and a second sequence, ordered as for
+** embWordBuildMatchTable.
+**
+** @param [r] windex [const EmbPWordIndex] Word index for a single sequence
+** @param [r] seq2 [const AjPSeq] Second sequence
+** @param [r] orderit [ajint] 1 to sort results at end, else 0.
+** @return [AjPList] List of matches.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjPList embWordIndexBuildMatchTable(const EmbPWordIndex windex,
+                                    const AjPSeq seq2, ajint orderit)
+{
+    AjPList hitlist = NULL;
+    AjIList curiter;
+    const char *cp;
+    void *ptr = NULL;
+    ajulong code = 0;
+    ajulong mask;
+    ajuint nvalid = 0;
+    ajuint len;
+    ajuint pos;
+    ajuint iword;
+    ajuint j;
+    ajint ires;
+
+    assert(wordLength > 0);
+
+    hitlist = ajListNew();
+
+    if(!wordCurList)
+	wordCurList = ajListNew();
+
+    len = ajSeqGetLen(seq2);
+
+    if(len < wordLength)
+    {
+	ajWarn("ERROR: Sequence %S length %d less than word length %d",
+	       ajSeqGetUsaS(seq2), len, wordLength);
+
+	return hitlist;
+    }
+
+    if(windex->Bits * windex->Wordlen == 64)
+        mask = ~(ajulong) 0;
+    else
+        mask = ((ajulong) 1 << (windex->Bits * windex->Wordlen)) - 1;
+
+    cp = ajSeqGetSeqC(seq2);
+
+    for(pos=0; pos < len; pos++)
+    {
+        ires = windex->Alphabet[(unsigned char) cp[pos]];
+
+        if(ires < 0)
+        {
+            nvalid = 0;
+            continue;
+        }
+
+        code = ((code << windex->Bits) | (ajulong) ires) & mask;
+
+        if(++nvalid < wordLength)
+            continue;
+
+        if(!wordIndexFind(windex, code, &iword))
+            continue;
+
+        if(ajListGetLength(wordCurList))
+            curiter = ajListIterNew(wordCurList);
+        else
+            curiter = NULL;
+
+        for(j=windex->Starts[iword]; j < windex->Starts[iword+1]; j++)
+            wordMatchAdd(hitlist, curiter, seq2, windex->Locs[j],
+                         pos + 1 - wordLength);
+
+        ajListIterDel(&curiter);
+    }
+
+    if(orderit)
+	wordOrderMatchTable(hitlist);
+
+    while(ajListPop(wordCurList,(void **)&ptr));
+
+    return hitlist;
+}
+
+
+
+
+/* @func embWordIndexSearch ***************************************************
+**
+** Searches a sequence for all words in a packed word index, extending
+** each word match as far as possible.
+**
+** Results and statistics are as for embWordRabinKarpSearch, with the
+** statistics kept in the word index.
+**
+** @param [u] windex [EmbPWordIndex] Word index
+** @param [r] sseq [const AjPStr] Sequence to be scanned for the words
+** @param [u] matchlist [AjPList*] List of matches for each sequence
+**                                 in the word index
+** @param [u] lastlocation [ajuint*] Position of the search for each sequence
+**                                   in the word index
+** @param [r] checkmode [AjBool] If true, not writing features or alignments
+**                               but running to produce match statistics only
+** @return [ajuint] total number of matches
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajuint embWordIndexSearch(EmbPWordIndex windex, const AjPStr sseq,
+                          AjPList* matchlist, ajuint* lastlocation,
+                          AjBool checkmode)
+{
+    const char *text;
+    const char *seqc;
+    const AjPSeq seq;
+    ajulong code = 0;
+    ajulong mask;
+    ajuint nvalid = 0;
+    ajuint plen;
+    ajuint tlen;
+    ajuint seqlen;
+    ajuint i;
+    ajuint ii;
+    ajuint j;
+    ajuint jend;
+    ajuint iword;
+    ajuint seqsetindx;
+    ajuint seq2start;
+    ajuint matchlen;
+    ajuint maxloc;
+    ajuint pos;
+    ajuint nMatches = 0;
+    ajint ires;
+
+    plen = windex->Wordlen;
+    text = ajStrGetPtr(sseq);
+    tlen = ajStrGetLen(sseq);
+
+    if(windex->Bits * plen == 64)
+        mask = ~(ajulong) 0;
+    else
+        mask = ((ajulong) 1 << (windex->Bits * plen)) - 1;
+
+    /* i is the end of the current word, as in embWordRabinKarpSearch */
+
+    for(i=1; i <= tlen; i++)
+    {
+        ires = windex->Alphabet[(unsigned char) text[i-1]];
+
+        if(ires < 0)
+        {
+            nvalid = 0;
+            continue;
+        }
+
+        code = ((code << windex->Bits) | (ajulong) ires) & mask;
+
+        if(++nvalid < plen)
+            continue;
+
+        if(!wordIndexFind(windex, code, &iword))
+            continue;
+
+        seq2start = i - plen;
+        j = windex->Starts[iword];
+
+        while(j < windex->Starts[iword+1])
+        {
+            seqsetindx = windex->Seqindxs[j];
+
+            for(jend = j+1; jend < windex->Starts[iword+1]; jend++)
+                if(windex->Seqindxs[jend] != seqsetindx)
+                    break;
+
+            if(lastlocation[seqsetindx] >= i)
+            {
+                j = jend;
+                continue;
+            }
+
+            seq = windex->Seqs[seqsetindx];
+            seqc = ajSeqGetSeqC(seq);
+            seqlen = ajSeqGetLen(seq);
+            maxloc = 0;
+
+            for(; j < jend; j++)
+            {
+                pos = windex->Locs[j];
+                ii = i;
+
+                /* this is where we extend matches */
+                matchlen = wordMatchExtend(seqc, seqlen, pos, text, tlen,
+                                           &ii, plen);
+
+                nMatches++;
+
+                if(!checkmode)
+                    ajListPushAppend(matchlist[seqsetindx],
+                                     embWordMatchNew(seq, pos, seq2start,
+                                                     matchlen));
+
+                if(ii > maxloc)
+                    maxloc = ii;
+
+                windex->Lenmatches[iword] += matchlen;
+                windex->Nmatches[iword]++;
+                windex->Seqmatches[seqsetindx]++;
+            }
+
+            if(maxloc > 0)
+                lastlocation[seqsetindx] = maxloc;
+        }
+    }
+
+    return nMatches;
+}
+
+
+
+
+/* @funcstatic wordSuffixNew **************************************************
+**
+** Builds a generalised suffix array for an array of sequences.
+**
+** The word length must be defined by a call to embWordLength.
+**
+** The suffixes are sorted by prefix doubling, and the common prefix
+** lengths are calculated from the sorted suffixes in linear time.
+**
+** Words are taken as for embWordGetTable, which steps over the
+** sequence's ambiguity character (N for nucleotides, X for proteins).
+**
+** @param [r] seqs [const AjPSeq*] Sequences
+** @param [r] nseqs [ajuint] Number of sequences
+** @return [EmbPWordSuffix] Suffix array, or NULL if no words were found
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static EmbPWordSuffix wordSuffixNew(const AjPSeq* seqs, ajuint nseqs)
+{
+    EmbPWordSuffix ret = NULL;
+    ajuint* sa = NULL;
+    ajuint* rank = NULL;
+    ajuint* lcp = NULL;
+    const char *cp;
+    char skipchar;
+    ajulong textlen = 1;
+    ajuint n;
+    ajuint ncodes;
+    ajuint nalpha = 0;
+    ajuint len;
+    ajuint ilast;
+    ajuint pos;
+    ajuint i;
+    ajuint j;
+    ajuint k;
+    ajuint h;
+    ajuint minlcp;
+    ajint ires;
+
+    assert(wordLength > 0);
+
+    for(i=0; i < nseqs; i++)
+        textlen += (ajulong) ajSeqGetLen(seqs[i]) + 1;
+
+    if(textlen >= (ajulong) UINT_MAX / 2)
+    {
+        ajWarn("Sequences too long for a suffix array: %Lu residues",
+               textlen);
+
+        return NULL;
+    }
+
+    n = (ajuint) textlen;
+
+    AJNEW0(ret);
+    ret->Wordlen = wordLength;
+    ret->Nseqs = nseqs;
+    ret->Textlen = n;
+
+    /* residues are numbered as for a packed word index */
+
+    nalpha = wordAlphabetSet(seqs, nseqs, ret->Alphabet);
+    ret->Nalpha = nalpha;
+
+    /*
+    ** separators are numbered after the residues, each with its own code.
+    ** Characters only found in sequences too short for a word are also
+    ** separators
+    */
+
+    AJCNEW(ret->Seqs, nseqs);
+    AJCNEW(ret->Seqstarts, nseqs+1);
+    AJCNEW(ret->Text, n);
+    AJCNEW0(ret->Wordruns, n);
+
+    ncodes = nalpha;
+    k = 0;
+    ret->Text[k++] = ncodes++;
+
+    for(i=0; i < nseqs; i++)
+    {
+        ret->Seqs[i] = seqs[i];
+        ret->Seqstarts[i] = k;
+
+        len = ajSeqGetLen(seqs[i]);
+        cp = ajSeqGetSeqC(seqs[i]);
+
+        for(pos=0; pos < len; pos++)
+        {
+            ires = ret->Alphabet[(unsigned char) cp[pos]];
+
+            if(ires < 0)
+                ret->Text[k++] = ncodes++;
+            else
+                ret->Text[k++] = (ajuint) ires;
+        }
+
+        ret->Text[k++] = ncodes++;
+
+        if(len < wordLength)
+            continue;
+
+        /* mark the same words as embWordGetTable */
+
+        skipchar = 'X';
+
+        if(ajSeqIsNuc(seqs[i]))
+            skipchar = 'N';
+
+        ilast = len - wordLength;
+
+        if(!wordStartFirst(cp, skipchar, ilast, &pos))
+            continue;
+
+        while(wordStartNext(cp, skipchar, ilast, &pos))
+            ret->Wordruns[ret->Seqstarts[i] + pos++] = 1;
+    }
+
+    ret->Seqstarts[nseqs] = n;
+
+    /* count the words starting at each offset and the offsets after it */
+
+    for(i=n-1; i > 0; i--)
+        if(ret->Wordruns[i-1])
+            ret->Wordruns[i-1] += ret->Wordruns[i];
+
+    ajDebug("wordSuffixNew nseqs %u wordlength %u alphabet %u text %u\n",
+            nseqs, wordLength, nalpha, n);
+
+    AJCNEW(sa, n);
+    AJCNEW(rank, n);
+    wordSuffixSort(ret->Text, n, ncodes, sa, rank);
+
+    /* common prefix with the previous suffix, by Kasai's method */
+
+    AJCNEW(lcp, n);
+    h = 0;
+
+    for(i=0; i < n; i++)
+    {
+        if(!rank[i])
+        {
+            lcp[0] = 0;
+            h = 0;
+            continue;
+        }
+
+        j = sa[rank[i]-1];
+
+        /* separator codes are unique, so this stops before the end */
+        while(ret->Text[i+h] == ret->Text[j+h])
+            h++;
+
+        lcp[rank[i]] = h;
+
+        if(h)
+            h--;
+    }
+
+    /* length of the residue run starting at each position */
+
+    rank[n-1] = 0;
+
+    for(i=n-1; i > 0; i--)
+    {
+        if(ret->Text[i-1] < nalpha)
+            rank[i-1] = rank[i] + 1;
+        else
+            rank[i-1] = 0;
+    }
+
+    /* keep the suffixes that start with a full word */
+
+    k = 0;
+    minlcp = 0;
+
+    for(i=0; i < n; i++)
+    {
+        if(lcp[i] < minlcp)
+            minlcp = lcp[i];
+
+        if(rank[sa[i]] < wordLength)
+            continue;
+
+        sa[k] = sa[i];
+        lcp[k] = k ? minlcp : 0;
+        minlcp = UINT_MAX;
+        k++;
+    }
+
+    AJFREE(rank);
+
+    if(!k)
+    {
+        AJFREE(sa);
+        AJFREE(lcp);
+        embWordSuffixDel(&ret);
+
+        return NULL;
+    }
+
+    ret->Nsuffixes = k;
+    ret->Suffixes = sa;
+    ret->Lcp = lcp;
+    AJCRESIZE(ret->Suffixes, k);
+    AJCRESIZE(ret->Lcp, k);
+    AJCNEW(ret->Suffixseqs, k);
+
+    for(i=0; i < k; i++)
+    {
+        ret->Suffixseqs[i] = wordSuffixSeqindx(ret, ret->Suffixes[i]);
+
+        if(!i || ret->Lcp[i] < wordLength)
+            ret->Nblocks++;
+    }
+
+    AJCNEW(ret->Blocks, ret->Nblocks+1);
+
+    j = 0;
+
+    for(i=0; i < k; i++)
+        if(!i || ret->Lcp[i] < wordLength)
+            ret->Blocks[j++] = i;
+
+    ret->Blocks[j] = k;
+
+    wordSuffixLocs(ret);
+
+    if(!ret->Nwords)
+    {
+        embWordSuffixDel(&ret);
+
+        return NULL;
+    }
+
+    AJCNEW0(ret->Nmatches, ret->Nwords);
+    AJCNEW0(ret->Lenmatches, ret->Nwords);
+    AJCNEW0(ret->Seqmatches, nseqs);
+
+    ajDebug("wordSuffixNew words %u suffixes %u\n",
+            ret->Nwords, ret->Nsuffixes);
+
+    return ret;
+}
+
+
+
+
+/* @funcstatic wordSuffixSort *************************************************
+**
+** Sorts all suffixes of a text by prefix doubling, with a stable
+** counting sort at each step.
+**
+** The last code in the text must be unique, so that every suffix
+** is different.
+**
+** @param [r] text [const ajuint*] Text codes
+** @param [r] n [ajuint] Text length
+** @param [r] ncodes [ajuint] Number of codes in the text
+** @param [w] sa [ajuint*] Suffix array
+** @param [w] rank [ajuint*] Position of each suffix in the suffix array
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void wordSuffixSort(const ajuint* text, ajuint n, ajuint ncodes,
+                           ajuint* sa, ajuint* rank)
+{
+    ajuint* rankout = rank;
+    ajuint* tmp = NULL;
+    ajuint* count = NULL;
+    ajuint* swap;
+    ajuint nclass;
+    ajuint h;
+    ajuint i;
+    ajuint p;
+    ajuint a;
+    ajuint b;
+
+    AJCNEW(tmp, n);
+    AJCNEW0(count, (ncodes > n) ? ncodes : n);
+
+    /* sort by the first code */
+
+    for(i=0; i < n; i++)
+        count[text[i]]++;
+
+    for(i=1; i < ncodes; i++)
+        count[i] += count[i-1];
+
+    for(i=n; i > 0; i--)
+        sa[--count[text[i-1]]] = i-1;
+
+    rank[sa[0]] = 0;
+    nclass = 1;
+
+    for(i=1; i < n; i++)
+    {
+        if(text[sa[i]] != text[sa[i-1]])
+            nclass++;
+
+        rank[sa[i]] = nclass - 1;
+    }
+
+    /* then by twice as many codes until every suffix is ranked apart */
+
+    for(h=1; nclass < n; h <<= 1)
+    {
+        p = 0;
+
+        for(i = (h < n) ? n-h : 0; i < n; i++)
+            tmp[p++] = i;
+
+        for(i=0; i < n; i++)
+            if(sa[i] >= h)
+                tmp[p++] = sa[i] - h;
+
+        memset(count, 0, nclass * sizeof(*count));
+
+        for(i=0; i < n; i++)
+            count[rank[i]]++;
+
+        for(i=1; i < nclass; i++)
+            count[i] += count[i-1];
+
+        for(i=n; i > 0; i--)
+            sa[--count[rank[tmp[i-1]]]] = tmp[i-1];
+
+        tmp[sa[0]] = 0;
+        nclass = 1;
+
+        for(i=1; i < n; i++)
+        {
+            a = sa[i-1];
+            b = sa[i];
+
+            if(rank[a] != rank[b] ||
+               ((a+h < n) ? rank[a+h] + 1 : 0) !=
+               ((b+h < n) ? rank[b+h] + 1 : 0))
+                nclass++;
+
+            tmp[b] = nclass - 1;
+        }
+
+        swap = rank;
+        rank = tmp;
+        tmp = swap;
+    }
+
+    /* the ranks may have been swapped into the work array */
+
+    if(rank != rankout)
+    {
+        memcpy(rankout, rank, n * sizeof(*rank));
+        tmp = rank;
+    }
+
+    AJFREE(count);
+    AJFREE(tmp);
+
+    return;
+}
+
+
+
+
+/* @funcstatic wordSuffixSeqindx **********************************************
+**
+** Returns the sequence number for a text offset in a suffix array.
+**
+** @param [r] wsuffix [const EmbPWordSuffix] Suffix array
+** @param [r] pos [ajuint] Text offset
+** @return [ajuint] Sequence number
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajuint wordSuffixSeqindx(const EmbPWordSuffix wsuffix, ajuint pos)
+{
+    ajuint lo = 0;
+    ajuint hi;
+    ajuint mid;
+
+    hi = wsuffix->Nseqs;
+
+    /* last sequence starting at or before the offset */
+
+    while(hi - lo > 1)
+    {
+        mid = lo + (hi - lo) / 2;
+
+        if(wsuffix->Seqstarts[mid] <= pos)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+
+
+/* @funcstatic wordSuffixFind *************************************************
+**
+** Finds a word in a suffix array.
+**
+** @param [r] wsuffix [const EmbPWordSuffix] Suffix array
+** @param [r] codes [const ajuint*] Residue codes of the word
+** @param [w] Pword [ajuint*] Word number
+** @return [AjBool] ajTrue if the word was found
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static AjBool wordSuffixFind(const EmbPWordSuffix wsuffix,
+                             const ajuint* codes, ajuint* Pword)
+{
+    const ajuint* text;
+    ajuint lo = 0;
+    ajuint hi;
+    ajuint mid;
+    ajuint i;
+
+    hi = wsuffix->Nwords;
+
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        i = wsuffix->Starts[mid];
+        text = &wsuffix->Text[wsuffix->Seqstarts[wsuffix->Seqindxs[i]] +
+                              wsuffix->Locs[i]];
+
+        for(i=0; i < wsuffix->Wordlen; i++)
+            if(text[i] != codes[i])
+                break;
+
+        if(i == wsuffix->Wordlen)
+        {
+            *Pword = mid;
+
+            return ajTrue;
+        }
+
+        if(text[i] < codes[i])
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return ajFalse;
+}
+
+
+
+
+/* @funcstatic wordSuffixLocs *************************************************
+**
+** Sets the word locations in a suffix array, sorted by word, then by
+** sequence and by position, as in a packed word index.
+**
+** Only suffixes starting with a word found by embWordGetTable are
+** locations, so blocks of suffixes with none are not words.
+**
+** @param [u] wsuffix [EmbPWordSuffix] Suffix array
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void wordSuffixLocs(EmbPWordSuffix wsuffix)
+{
+    ajuint* offsets = NULL;
+    ajuint iblock;
+    ajuint i;
+    ajuint first;
+    ajuint nlocs = 0;
+
+    for(i=0; i < wsuffix->Nsuffixes; i++)
+        if(wsuffix->Wordruns[wsuffix->Suffixes[i]])
+            nlocs++;
+
+    AJCNEW(offsets, nlocs);
+    AJCNEW(wsuffix->Seqindxs, nlocs);
+    AJCNEW(wsuffix->Locs, nlocs);
+    AJCNEW(wsuffix->Starts, wsuffix->Nblocks+1);
+    AJCNEW0(wsuffix->Wordseqs, wsuffix->Nblocks);
+
+    nlocs = 0;
+
+    for(iblock=0; iblock < wsuffix->Nblocks; iblock++)
+    {
+        first = nlocs;
+
+        for(i=wsuffix->Blocks[iblock]; i < wsuffix->Blocks[iblock+1]; i++)
+            if(wsuffix->Wordruns[wsuffix->Suffixes[i]])
+                offsets[nlocs++] = wsuffix->Suffixes[i];
+
+        if(nlocs == first)
+            continue;
+
+        /* text order is sequence order, then position order */
+        qsort(&offsets[first], nlocs - first,
+              sizeof(*offsets), &wordSuffixOffsetCmp);
+
+        wsuffix->Starts[wsuffix->Nwords] = first;
+
+        for(i=first; i < nlocs; i++)
+        {
+            wsuffix->Seqindxs[i] = wordSuffixSeqindx(wsuffix, offsets[i]);
+            wsuffix->Locs[i] = offsets[i] -
+                wsuffix->Seqstarts[wsuffix->Seqindxs[i]];
+
+            if(i == first ||
+               wsuffix->Seqindxs[i] != wsuffix->Seqindxs[i-1])
+                wsuffix->Wordseqs[wsuffix->Nwords]++;
+        }
+
+        wsuffix->Nwords++;
+    }
+
+    wsuffix->Starts[wsuffix->Nwords] = nlocs;
+    wsuffix->Nlocs = nlocs;
+
+    AJFREE(offsets);
+
+    return;
+}
+
+
+
+
+/* @funcstatic wordSuffixOffsetCmp ********************************************
+**
+** Compares two text offsets for sorting.
+**
+** @param [r] v1 [const void*] First offset
+** @param [r] v2 [const void*] Comparison offset
+** @return [ajint] Comparison value. 0 if equal, -1 if first is lower,
+**               +1 if first is higher.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajint wordSuffixOffsetCmp(const void* v1, const void* v2)
+{
+    ajuint o1 = *(const ajuint*) v1;
+    ajuint o2 = *(const ajuint*) v2;
+
+    if(o1 < o2)
+        return -1;
+
+    if(o1 > o2)
+        return 1;
+
+    return 0;
+}
+
+
+
+
+/* @funcstatic wordSuffixMatches **********************************************
+**
+** Finds all matches of at least the word length between different
+** sequences in a suffix array, as embWordBuildMatchTable would find them
+** with a word table for the first sequence of each pair.
+**
+** Within the block of suffixes for each word, the common prefix of
+** two suffixes is the smallest common prefix between them in the suffix
+** array. A match starts where the first sequence has a word table word
+** and the residues before the two suffixes differ or that position has no
+** word, so the match cannot be extended to the left. It extends as long
+** as the residues agree and the first sequence has a word at each step.
+**
+** The matches are sorted by sequence pair, then as for
+** embWordBuildMatchTable by length and start positions.
+**
+** @param [u] wsuffix [EmbPWordSuffix] Suffix array
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static void wordSuffixMatches(EmbPWordSuffix wsuffix)
+{
+    EmbPWordSuffixMatch match;
+    const ajuint* text;
+    const ajuint* runs;
+    ajulong size = 0;
+    ajuint iblock;
+    ajuint last;
+    ajuint x;
+    ajuint y;
+    ajuint posx;
+    ajuint posy;
+    ajuint pos1;
+    ajuint pos2;
+    ajuint seqx;
+    ajuint seqy;
+    ajuint nwords;
+    ajuint minlcp;
+
+    if(wsuffix->Matches)
+        return;
+
+    text = wsuffix->Text;
+    runs = wsuffix->Wordruns;
+
+    for(iblock=0; iblock < wsuffix->Nblocks; iblock++)
+    {
+        last = wsuffix->Blocks[iblock+1];
+
+        for(x=wsuffix->Blocks[iblock]; x < last; x++)
+        {
+            posx = wsuffix->Suffixes[x];
+            seqx = wsuffix->Suffixseqs[x];
+            minlcp = UINT_MAX;
+
+            for(y=x+1; y < last; y++)
+            {
+                if(wsuffix->Lcp[y] < minlcp)
+                    minlcp = wsuffix->Lcp[y];
+
+                seqy = wsuffix->Suffixseqs[y];
+
+                if(seqy == seqx)
+                    continue;
+
+                posy = wsuffix->Suffixes[y];
+
+                if(seqx < seqy)
+                {
+                    pos1 = posx;
+                    pos2 = posy;
+                }
+                else
+                {
+                    pos1 = posy;
+                    pos2 = posx;
+                }
+
+                /* only words in the first sequence's word table match */
+                if(!runs[pos1])
+                    continue;
+
+                /* separator codes are unique so never match here */
+                if(runs[pos1-1] && text[pos1-1] == text[pos2-1])
+                    continue;
+
+                nwords = minlcp - wsuffix->Wordlen + 1;
+
+                if(runs[pos1] < nwords)
+                    nwords = runs[pos1];
+
+                if(wsuffix->Nmatchpairs == size)
+                {
+                    size = size ? 2*size : 1024;
+                    AJCRESIZE(wsuffix->Matches, size);
+                }
+
+                match = &wsuffix->Matches[wsuffix->Nmatchpairs++];
+                match->Length = wsuffix->Wordlen + nwords - 1;
+
+                if(seqx < seqy)
+                {
+                    match->Seq1 = seqx;
+                    match->Seq2 = seqy;
+                }
+                else
+                {
+                    match->Seq1 = seqy;
+                    match->Seq2 = seqx;
+                }
+
+                match->Start1 = pos1 - wsuffix->Seqstarts[match->Seq1];
+                match->Start2 = pos2 - wsuffix->Seqstarts[match->Seq2];
+            }
+        }
+    }
+
+    /* an empty array still records that the search was done */
+
+    if(!size)
+        AJCNEW(wsuffix->Matches, 1);
+
+    qsort(wsuffix->Matches, (size_t) wsuffix->Nmatchpairs,
+          sizeof(*wsuffix->Matches), &wordSuffixMatchCmp);
+
+    ajDebug("wordSuffixMatches %Lu matches\n", wsuffix->Nmatchpairs);
+
+    return;
+}
+
+
+
+
+/* @funcstatic wordSuffixMatchCmp *********************************************
+**
+** Compares two suffix array matches so the result can be used in sorting.
+** The comparison is done by sequence numbers, then as for wordMatchCmp
+** by size, first sequence start and second sequence start.
+**
+** @param [r] v1 [const void*] First match
+** @param [r] v2 [const void*] Comparison match
+** @return [ajint] Comparison value. 0 if equal, -1 if first is lower,
+**               +1 if first is higher.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+static ajint wordSuffixMatchCmp(const void* v1, const void* v2)
+{
+    const EmbOWordSuffixMatch* m1 = (const EmbOWordSuffixMatch*) v1;
+    const EmbOWordSuffixMatch* m2 = (const EmbOWordSuffixMatch*) v2;
+
+    if(m1->Seq1 != m2->Seq1)
+        return (m1->Seq1 < m2->Seq1) ? -1 : 1;
+
+    if(m1->Seq2 != m2->Seq2)
+        return (m1->Seq2 < m2->Seq2) ? -1 : 1;
+
+    if(m1->Length != m2->Length)
+        return (m1->Length > m2->Length) ? -1 : 1;
+
+    if(m1->Start1 != m2->Start1)
+        return (m1->Start1 < m2->Start1) ? -1 : 1;
+
+    if(m1->Start2 != m2->Start2)
+        return (m1->Start2 < m2->Start2) ? -1 : 1;
+
+    return 0;
+}
+
+
+
+
+/* @func embWordSuffixNewSeqset ***********************************************
+**
+** Builds a generalised suffix array of all words in a sequence set.
+**
+** The word length must be defined by a call to embWordLength.
+**
+** @param [r] seqset [const AjPSeqset] Sequence set
+** @return [EmbPWordSuffix] Suffix array, or NULL if there are no words
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+EmbPWordSuffix embWordSuffixNewSeqset(const AjPSeqset seqset)
+{
+    EmbPWordSuffix ret;
+    const AjPSeq* seqs = NULL;
+    ajuint nseqs;
+    ajuint i;
+
+    nseqs = (ajuint) ajSeqsetGetSize(seqset);
+
+    if(!nseqs)
+        return NULL;
+
+    AJCNEW(seqs, nseqs);
+
+    for(i=0; i < nseqs; i++)
+        seqs[i] = ajSeqsetGetseqSeq(seqset, i);
+
+    ret = wordSuffixNew(seqs, nseqs);
+
+    AJFREE(seqs);
+
+    return ret;
+}
+
+
+
+
+/* @func embWordSuffixDel *****************************************************
+**
+** Deletes a suffix array.
+**
+** @param [d] Pwsuffix [EmbPWordSuffix*] Suffix array
+** @return [void]
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+void embWordSuffixDel(EmbPWordSuffix *Pwsuffix)
+{
+    EmbPWordSuffix wsuffix;
+
+    if(!Pwsuffix || !*Pwsuffix)
+        return;
+
+    wsuffix = *Pwsuffix;
+
+    AJFREE(wsuffix->Seqs);
+    AJFREE(wsuffix->Text);
+    AJFREE(wsuffix->Seqstarts);
+    AJFREE(wsuffix->Wordruns);
+    AJFREE(wsuffix->Suffixes);
+    AJFREE(wsuffix->Suffixseqs);
+    AJFREE(wsuffix->Lcp);
+    AJFREE(wsuffix->Blocks);
+    AJFREE(wsuffix->Starts);
+    AJFREE(wsuffix->Seqindxs);
+    AJFREE(wsuffix->Locs);
+    AJFREE(wsuffix->Wordseqs);
+    AJFREE(wsuffix->Nmatches);
+    AJFREE(wsuffix->Lenmatches);
+    AJFREE(wsuffix->Seqmatches);
+    AJFREE(wsuffix->Matches);
+
+    AJFREE(*Pwsuffix);
+
+    return;
+}
+
+
+
+
+/* @func embWordSuffixGetOrder ************************************************
+**
+** Returns the word numbers of a suffix array in the order
+** embWordRabinKarpInit returns the same words from a word table built by
+** embWordGetTable, so results can be reported in the same order.
+**
+** @param [r] wsuffix [const EmbPWordSuffix] Suffix array
+** @param [w] Porder [ajuint**] Word numbers in Rabin-Karp pattern order
+** @return [ajuint] Number of words
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajuint embWordSuffixGetOrder(const EmbPWordSuffix wsuffix, ajuint** Porder)
+{
+    return wordGetOrder(wsuffix->Seqs, wsuffix->Nseqs, wsuffix->Wordlen,
+                        wsuffix->Nwords, wsuffix->Starts, wsuffix->Seqindxs,
+                        wsuffix->Locs, Porder);
+}
+
+
+
+
+/* @func embWordSuffixGetWord *************************************************
+**
+** Returns a word from a suffix array, as it is first found in the
+** indexed sequences.
+**
+** @param [r] wsuffix [const EmbPWordSuffix] Suffix array
+** @param [r] i [ajuint] Word number
+** @param [w] Pword [AjPStr*] Word
+** @return [AjBool] ajTrue if the word number is in the suffix array
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjBool embWordSuffixGetWord(const EmbPWordSuffix wsuffix, ajuint i,
+                            AjPStr *Pword)
+{
+    ajuint j;
+
+    ajStrAssignClear(Pword);
+
+    if(i >= wsuffix->Nwords)
+        return ajFalse;
+
+    j = wsuffix->Starts[i];
+
+    ajStrAssignLenC(Pword,
+                    &ajSeqGetSeqC(wsuffix->Seqs[wsuffix->Seqindxs[j]])
+                    [wsuffix->Locs[j]],
+                    wsuffix->Wordlen);
+
+    return ajTrue;
+}
+
+
+
+
+/* @func embWordSuffixBuildMatchTable *****************************************
+**
+** Create a linked list of all the matches between two sequences in a
+** suffix array, found and ordered as for embWordBuildMatchTable with the
+** first sequence used for the word table.
+**
+** All matches between all pairs of sequences are found in a single pass
+** on the first call.
+**
+** @param [u] wsuffix [EmbPWordSuffix] Suffix array
+** @param [r] seq1 [ajuint] First sequence number
+** @param [r] seq2 [ajuint] Second sequence number, greater than seq1
+** @return [AjPList] List of matches.
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+AjPList embWordSuffixBuildMatchTable(EmbPWordSuffix wsuffix,
+                                     ajuint seq1, ajuint seq2)
+{
+    AjPList hitlist;
+    const EmbOWordSuffixMatch* match;
+    ajulong lo = 0;
+    ajulong hi;
+    ajulong mid;
+
+    hitlist = ajListNew();
+
+    wordSuffixMatches(wsuffix);
+
+    hi = wsuffix->Nmatchpairs;
+
+    while(lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        match = &wsuffix->Matches[mid];
+
+        if(match->Seq1 < seq1 ||
+           (match->Seq1 == seq1 && match->Seq2 < seq2))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for(; lo < wsuffix->Nmatchpairs; lo++)
+    {
+        match = &wsuffix->Matches[lo];
+
+        if(match->Seq1 != seq1 || match->Seq2 != seq2)
+            break;
+
+        ajListPushAppend(hitlist,
+                         embWordMatchNew(wsuffix->Seqs[seq2],
+                                         match->Start1, match->Start2,
+                                         (ajint) match->Length));
+    }
+
+    return hitlist;
+}
+
+
+
+
+/* @func embWordSuffixSearch **************************************************
+**
+** Searches a sequence for all words in a suffix array, extending
+** each word match as far as possible.
+**
+** Results and statistics are as for embWordIndexSearch, with the
+** statistics kept in the suffix array.
+**
+** @param [u] wsuffix [EmbPWordSuffix] Suffix array
+** @param [r] sseq [const AjPStr] Sequence to be scanned for the words
+** @param [u] matchlist [AjPList*] List of matches for each sequence
+**                                 in the suffix array
+** @param [u] lastlocation [ajuint*] Position of the search for each sequence
+**                                   in the suffix array
+** @param [r] checkmode [AjBool] If true, not writing features or alignments
+**                               but running to produce match statistics only
+** @return [ajuint] total number of matches
+**
+** @release 6.6.0
+** @@
+******************************************************************************/
+
+ajuint embWordSuffixSearch(EmbPWordSuffix wsuffix, const AjPStr sseq,
+                           AjPList* matchlist, ajuint* lastlocation,
+                           AjBool checkmode)
+{
+    ajuint* codes = NULL;
+    const char *text;
+    const char *seqc;
+    const AjPSeq seq;
+    ajuint nvalid = 0;
+    ajuint plen;
+    ajuint tlen;
+    ajuint seqlen;
+    ajuint i;
+    ajuint ii;
+    ajuint j;
+    ajuint jend;
+    ajuint iword;
+    ajuint seqsetindx;
+    ajuint seq2start;
+    ajuint matchlen;
+    ajuint maxloc;
+    ajuint pos;
+    ajuint nMatches = 0;
+    ajint ires;
+
+    plen = wsuffix->Wordlen;
+    text = ajStrGetPtr(sseq);
+    tlen = ajStrGetLen(sseq);
+
+    if(tlen < plen)
+        return 0;
+
+    AJCNEW(codes, tlen);
+
+    /* i is the end of the current word, as in embWordRabinKarpSearch */
+
+    for(i=1; i <= tlen; i++)
+    {
+        ires = wsuffix->Alphabet[(unsigned char) text[i-1]];
+
+        if(ires < 0)
+        {
+            nvalid = 0;
+            continue;
+        }
+
+        codes[i-1] = (ajuint) ires;
+
+        if(++nvalid < plen)
+            continue;
+
+        if(!wordSuffixFind(wsuffix, &codes[i-plen], &iword))
+            continue;
+
+        seq2start = i - plen;
+        j = wsuffix->Starts[iword];
+
+        while(j < wsuffix->Starts[iword+1])
+        {
+            seqsetindx = wsuffix->Seqindxs[j];
+
+            for(jend = j+1; jend < wsuffix->Starts[iword+1]; jend++)
+                if(wsuffix->Seqindxs[jend] != seqsetindx)
+                    break;
+
+            if(lastlocation[seqsetindx] >= i)
+            {
+                j = jend;
+                continue;
+            }
+
+            seq = wsuffix->Seqs[seqsetindx];
+            seqc = ajSeqGetSeqC(seq);
+            seqlen = ajSeqGetLen(seq);
+            maxloc = 0;
+
+            for(; j < jend; j++)
+            {
+                pos = wsuffix->Locs[j];
+                ii = i;
+
+                /* this is where we extend matches */
+                matchlen = wordMatchExtend(seqc, seqlen, pos, text, tlen,
+                                           &ii, plen);
+
+                nMatches++;
+
+                if(!checkmode)
+                    ajListPushAppend(matchlist[seqsetindx],
+                                     embWordMatchNew(seq, pos, seq2start,
+                                                     matchlen));
+
+                if(ii > maxloc)
+                    maxloc = ii;
+
+                wsuffix->Lenmatches[iword] += matchlen;
+                wsuffix->Nmatches[iword]++;
+                wsuffix->Seqmatches[seqsetindx]++;
+            }
+
+            if(maxloc > 0)
+                lastlocation[seqsetindx] = maxloc;
+        }
+    }
+
+    AJFREE(codes);
+
+    return nMatches;
+}
+
+
+
+
 /* @func embWordMatchIter *****************************************************
 **
 ** Return the start positions and length for the next match.
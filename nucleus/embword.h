@@ -167,6 +167,190 @@ typedef struct EmbSWordRK {
 
 
 
+/* @data EmbPWordIndex ********************************************************
+**
+** Packed index of the words in one or more sequences, used in place of
+** a word table when each word can be encoded in a 64-bit integer.
+**
+** Residues are numbered in alphabetical order of the characters found in
+** the indexed sequences, so sorting the word codes also sorts the words.
+** The distinct word codes are held in a sorted array. The start
+** positions of all words are held in flat arrays, sorted by word, then
+** by sequence and by position.
+**
+** The last 3 arrays (Nmatches, Lenmatches, Seqmatches) are updated
+** by embWordIndexSearch.
+**
+** @attr Seqs [const AjPSeq*] Indexed sequences
+** @attr Codes [ajulong*] Sorted distinct word codes
+** @attr Starts [ajuint*] Offset of the first location of each word,
+**                        with a final entry for the total locations
+** @attr Seqindxs [ajuint*] Sequence number for each location
+** @attr Locs [ajuint*] Start position for each location
+** @attr Buckets [ajuint*] First word for each value of the
+**                         leading bits of the code
+** @attr Wordseqs [ajuint*] Number of sequences each word is found in
+** @attr Nmatches [ajuint*] Number of matches for each word
+** @attr Lenmatches [ajulong*] Total length of matches for each word
+** @attr Seqmatches [ajuint*] Number of matches for each sequence
+** @attr Nwords [ajuint] Number of distinct words
+** @attr Nlocs [ajuint] Number of word locations
+** @attr Nseqs [ajuint] Number of sequences
+** @attr Wordlen [ajuint] Word length
+** @attr Bits [ajuint] Number of bits for each residue
+** @attr Bucketshift [ajuint] Shift to give the leading bits of a code
+** @attr Alphabet [ajint[256]] Residue number for each character,
+**                             -1 if not in a word
+** @@
+******************************************************************************/
+
+typedef struct EmbSWordIndex {
+    const AjPSeq* Seqs;
+    ajulong* Codes;
+    ajuint* Starts;
+    ajuint* Seqindxs;
+    ajuint* Locs;
+    ajuint* Buckets;
+    ajuint* Wordseqs;
+    ajuint* Nmatches;
+    ajulong* Lenmatches;
+    ajuint* Seqmatches;
+    ajuint Nwords;
+    ajuint Nlocs;
+    ajuint Nseqs;
+    ajuint Wordlen;
+    ajuint Bits;
+    ajuint Bucketshift;
+    ajint Alphabet[256];
+} EmbOWordIndex;
+
+#define EmbPWordIndex EmbOWordIndex*
+
+
+
+
+/* @data EmbPWordSuffixMatch **************************************************
+**
+** Maximal exact match between two sequences in a suffix array index
+**
+** @attr Seq1 [ajuint] Sequence number of the first sequence
+** @attr Seq2 [ajuint] Sequence number of the second sequence,
+**                     always greater than Seq1
+** @attr Start1 [ajuint] Match start position in the first sequence
+** @attr Start2 [ajuint] Match start position in the second sequence
+** @attr Length [ajuint] Length of match
+** @@
+******************************************************************************/
+
+typedef struct EmbSWordSuffixMatch {
+    ajuint Seq1;
+    ajuint Seq2;
+    ajuint Start1;
+    ajuint Start2;
+    ajuint Length;
+} EmbOWordSuffixMatch;
+
+#define EmbPWordSuffixMatch EmbOWordSuffixMatch*
+
+
+
+
+/* @data EmbPWordSuffix *******************************************************
+**
+** Generalised suffix array over one or more sequences, used in place of
+** a word table or packed word index for words of any length.
+**
+** All sequences are held as one text of residue codes. Each sequence
+** is preceded and followed by a separator with its own code so no
+** match can extend across one.
+**
+** Residues are numbered as in a packed word index, in alphabetical order
+** of the characters found in the indexed sequences, so ambiguity codes
+** are residues like any other. Only suffixes starting with a full word
+** are kept, so the suffixes for each distinct word form one block in the
+** suffix array and the blocks are in alphabetical order.
+**
+** The words are those embWordGetTable would find, which start only at
+** some positions next to an ambiguity code (N for nucleotides, X for
+** proteins). Their locations are kept as in a packed word index, so
+** words are numbered and reported in the same way.
+**
+** The statistics (Nmatches, Lenmatches, Seqmatches) are set by
+** embWordSuffixSearch. The Matches array is set by the first call to
+** embWordSuffixBuildMatchTable.
+**
+** @attr Seqs [const AjPSeq*] Indexed sequences
+** @attr Text [ajuint*] Residue and separator codes for all sequences
+** @attr Seqstarts [ajuint*] Text offset of the first residue of each
+**                           sequence, with a final entry for the text length
+** @attr Wordruns [ajuint*] Number of word table words starting at each
+**                          text offset and the offsets after it
+** @attr Suffixes [ajuint*] Text offset of each suffix in sorted order
+** @attr Suffixseqs [ajuint*] Sequence number of each suffix
+** @attr Lcp [ajuint*] Length of the common prefix of each suffix and
+**                     the suffix before it
+** @attr Blocks [ajuint*] First suffix of each block of suffixes starting
+**                        with the same word, with a final entry for the
+**                        number of suffixes
+** @attr Starts [ajuint*] First location of each distinct word,
+**                        with a final entry for the number of locations
+** @attr Seqindxs [ajuint*] Sequence number for each word location,
+**                          sorted by word, then by sequence and position
+** @attr Locs [ajuint*] Start position for each word location
+** @attr Wordseqs [ajuint*] Number of sequences each word is found in
+** @attr Nmatches [ajuint*] Number of matches for each word
+** @attr Lenmatches [ajulong*] Total length of matches for each word
+** @attr Seqmatches [ajuint*] Number of matches for each sequence
+** @attr Matches [EmbPWordSuffixMatch] Maximal exact matches between
+**                                     all pairs of sequences
+** @attr Nmatchpairs [ajulong] Number of maximal exact matches
+** @attr Textlen [ajuint] Length of the text
+** @attr Nsuffixes [ajuint] Number of suffixes starting with a full word
+** @attr Nblocks [ajuint] Number of blocks of suffixes
+** @attr Nwords [ajuint] Number of distinct words
+** @attr Nlocs [ajuint] Number of word locations
+** @attr Nseqs [ajuint] Number of sequences
+** @attr Nalpha [ajuint] Number of residue codes
+** @attr Wordlen [ajuint] Word length
+** @attr Alphabet [ajint[256]] Residue code for each character,
+**                             -1 if not in a word
+** @@
+******************************************************************************/
+
+typedef struct EmbSWordSuffix {
+    const AjPSeq* Seqs;
+    ajuint* Text;
+    ajuint* Seqstarts;
+    ajuint* Wordruns;
+    ajuint* Suffixes;
+    ajuint* Suffixseqs;
+    ajuint* Lcp;
+    ajuint* Blocks;
+    ajuint* Starts;
+    ajuint* Seqindxs;
+    ajuint* Locs;
+    ajuint* Wordseqs;
+    ajuint* Nmatches;
+    ajulong* Lenmatches;
+    ajuint* Seqmatches;
+    EmbPWordSuffixMatch Matches;
+    ajulong Nmatchpairs;
+    ajuint Textlen;
+    ajuint Nsuffixes;
+    ajuint Nblocks;
+    ajuint Nwords;
+    ajuint Nlocs;
+    ajuint Nseqs;
+    ajuint Nalpha;
+    ajuint Wordlen;
+    ajint Alphabet[256];
+} EmbOWordSuffix;
+
+#define EmbPWordSuffix EmbOWordSuffix*
+
+
+
+
 /* ========================================================================= */
 /* =========================== public functions ============================ */
 /* ========================================================================= */
@@ -183,6 +367,19 @@ void    embWordClear (void);
 void    embWordExit(void);
 void    embWordFreeTable(AjPTable *table);
 AjBool  embWordGetTable (AjPTable *table, const AjPSeq seq);
+
+AjPList embWordIndexBuildMatchTable(const EmbPWordIndex windex,
+                                    const AjPSeq seq2, ajint orderit);
+void    embWordIndexDel(EmbPWordIndex *Pwindex);
+ajuint  embWordIndexGetOrder(const EmbPWordIndex windex, ajuint** Porder);
+AjBool  embWordIndexGetWord(const EmbPWordIndex windex, ajuint i,
+                            AjPStr *Pword);
+EmbPWordIndex embWordIndexNewSeq(const AjPSeq seq);
+EmbPWordIndex embWordIndexNewSeqset(const AjPSeqset seqset);
+ajuint  embWordIndexSearch(EmbPWordIndex windex, const AjPStr sseq,
+                           AjPList* matchlist, ajuint* lastlocation,
+                           AjBool checkmode);
+
 void    embWordLength (ajint wordlen);
 AjBool  embWordMatchIter (AjIList iter, ajint* start1, ajint* start2,
 			  ajint* len, const AjPSeq* seq);
@@ -196,6 +393,18 @@ void    embWordPrintTable  (const AjPTable table);
 void    embWordPrintTableF (const AjPTable table, AjPFile outf);
 void    embWordPrintTableFI (const AjPTable table, ajint mincount,
 			     AjPFile outf);
+
+AjPList embWordSuffixBuildMatchTable(EmbPWordSuffix wsuffix,
+                                     ajuint seq1, ajuint seq2);
+void    embWordSuffixDel(EmbPWordSuffix *Pwsuffix);
+ajuint  embWordSuffixGetOrder(const EmbPWordSuffix wsuffix, ajuint** Porder);
+AjBool  embWordSuffixGetWord(const EmbPWordSuffix wsuffix, ajuint i,
+                             AjPStr *Pword);
+EmbPWordSuffix embWordSuffixNewSeqset(const AjPSeqset seqset);
+ajuint  embWordSuffixSearch(EmbPWordSuffix wsuffix, const AjPStr sseq,
+                            AjPList* matchlist, ajuint* lastlocation,
+                            AjBool checkmode);
+
 void    embWordMatchListConvToFeat(const AjPList list,
 				   AjPFeattable *tab1, AjPFeattable *tab2,
 				   const AjPSeq seq1, const AjPSeq seq2);